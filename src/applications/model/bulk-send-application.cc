@@ -26,6 +26,7 @@
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
+#include "ns3/packet-pool.h"
 #include "ns3/uinteger.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/tcp-socket-factory.h"
@@ -75,6 +76,13 @@ BulkSendApplication::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&BulkSendApplication::m_enableE2EStats),
                    MakeBooleanChecker ())
+    .AddAttribute ("PacketPoolSize",
+                   "The number of packets allocated in advance and recycled once "
+                   "they are no longer in use. The value zero disables the "
+                   "packet pool.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&BulkSendApplication::m_packetPoolSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&BulkSendApplication::m_txTrace),
                      "ns3::Packet::TracedCallback")
@@ -119,6 +127,7 @@ BulkSendApplication::DoDispose (void)
   NS_LOG_FUNCTION (this);
 
   m_socket = 0;
+  m_packetPool = 0;
   // chain up
   Application::DoDispose ();
 }
@@ -176,6 +185,11 @@ void BulkSendApplication::StartApplication (void) // Called at time specified by
       m_socket->SetSendCallback (
         MakeCallback (&BulkSendApplication::DataSend, this));
     }
+  if (m_packetPoolSize > 0 && m_packetPool == 0)
+    {
+      m_packetPool = Create<PacketPool> (m_packetPoolSize);
+      m_packetPool->Reserve (m_packetPoolSize);
+    }
   if (m_connected)
     {
       m_socket->GetSockName (from);
@@ -201,6 +215,16 @@ void BulkSendApplication::StopApplication (void) // Called at time specified by
 
 // Private helpers
 
+Ptr<Packet>
+BulkSendApplication::AllocatePacket (uint32_t size)
+{
+  if (m_packetPool != 0)
+    {
+      return m_packetPool->Allocate (size);
+    }
+  return Create<Packet> (size);
+}
+
 void BulkSendApplication::SendData (const Address &from, const Address &to)
 {
   NS_LOG_FUNCTION (this);
@@ -228,13 +252,13 @@ void BulkSendApplication::SendData (const Address &from, const Address &to)
           header.SetSeq (m_seq++);
           header.SetSize (toSend);
           NS_ABORT_IF (toSend < header.GetSerializedSize ());
-          packet = Create<Packet> (toSend - header.GetSerializedSize ());
+          packet = AllocatePacket (toSend - header.GetSerializedSize ());
           packet->AddHeader (header);
           m_txTraceWithStats (packet, from, to, header);
         }
       else
         {
-          packet = Create<Packet> (toSend);
+          packet = AllocatePacket (toSend);
         }
 
       int actual = m_socket->Send (packet);
@@ -32,6 +32,7 @@ namespace ns3 {
 
 class Address;
 class Socket;
+class PacketPool;
 
 /**
  * \ingroup applications
@@ -120,6 +121,13 @@ private:
    */
   void SendData (const Address &from, const Address &to);
 
+  /**
+   * \brief Allocate a packet, from the packet pool if enabled
+   * \param size the packet payload size
+   * \returns the packet
+   */
+  Ptr<Packet> AllocatePacket (uint32_t size);
+
   Ptr<Socket>     m_socket;       //!< Associated socket
   Address         m_peer;         //!< Peer address
   Address         m_local;        //!< Local address to bind to
@@ -130,6 +138,8 @@ private:
   TypeId          m_tid;          //!< The type of protocol to use.
   uint32_t        m_seq {0};      //!< Sequence
   bool            m_enableE2EStats {false}; //!< Enable or disable the e2e statistic generation
+  uint32_t        m_packetPoolSize; //!< Size of the packet pool (zero to disable it)
+  Ptr<PacketPool> m_packetPool;   //!< Pool the packets are allocated from, if any
 
 
   /// Traced Callback: sent packets
@@ -35,6 +35,7 @@
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
+#include "ns3/packet-pool.h"
 #include "ns3/uinteger.h"
 #include "ns3/trace-source-accessor.h"
 #include "onoff-application.h"
@@ -99,6 +100,13 @@ OnOffApplication::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&OnOffApplication::m_enableE2EStats),
                    MakeBooleanChecker ())
+    .AddAttribute ("PacketPoolSize",
+                   "The number of packets allocated in advance and recycled once "
+                   "they are no longer in use. The value zero disables the "
+                   "packet pool.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&OnOffApplication::m_packetPoolSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&OnOffApplication::m_txTrace),
                      "ns3::Packet::TracedCallback")
@@ -158,6 +166,7 @@ OnOffApplication::DoDispose (void)
 
   CancelEvents ();
   m_socket = 0;
+  m_packetPool = 0;
   // chain up
   Application::DoDispose ();
 }
@@ -206,6 +215,11 @@ void OnOffApplication::StartApplication () // Called at time specified by Start
         MakeCallback (&OnOffApplication::ConnectionSucceeded, this),
         MakeCallback (&OnOffApplication::ConnectionFailed, this));
     }
+  if (m_packetPoolSize > 0 && m_packetPool == 0)
+    {
+      m_packetPool = Create<PacketPool> (m_packetPoolSize);
+      m_packetPool->Reserve (m_packetPoolSize);
+    }
   m_cbrRateFailSafe = m_cbrRate;
 
   // Insure no pending event
@@ -304,6 +318,16 @@ void OnOffApplication::ScheduleStopEvent ()
 }
 
 
+Ptr<Packet>
+OnOffApplication::AllocatePacket (uint32_t size)
+{
+  if (m_packetPool != 0)
+    {
+      return m_packetPool->Allocate (size);
+    }
+  return Create<Packet> (size);
+}
+
 void OnOffApplication::SendPacket ()
 {
   NS_LOG_FUNCTION (this);
@@ -320,13 +344,13 @@ void OnOffApplication::SendPacket ()
       header.SetSeq (m_seq++);
       header.SetSize (m_pktSize);
       NS_ABORT_IF (m_pktSize < header.GetSerializedSize ());
-      packet = Create<Packet> (m_pktSize - header.GetSerializedSize ());
+      packet = AllocatePacket (m_pktSize - header.GetSerializedSize ());
       packet->AddHeader (header);
       m_txTraceWithStats (packet, from, to, header);
     }
   else
     {
-      packet = Create<Packet> (m_pktSize);
+      packet = AllocatePacket (m_pktSize);
     }
 
   m_txTrace (packet);
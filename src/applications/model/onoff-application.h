@@ -38,6 +38,7 @@ namespace ns3 {
 class Address;
 class RandomVariableStream;
 class Socket;
+class PacketPool;
 
 /**
  * \ingroup applications 
@@ -142,6 +143,13 @@ private:
    */
   void CancelEvents ();
 
+  /**
+   * \brief Allocate a packet, from the packet pool if enabled
+   * \param size the packet payload size
+   * \returns the packet
+   */
+  Ptr<Packet> AllocatePacket (uint32_t size);
+
   // Event handlers
   /**
    * \brief Start an On period
@@ -174,6 +182,8 @@ private:
   TypeId          m_tid;          //!< Type of the socket used
   uint32_t        m_seq {0};      //!< Sequence
   bool            m_enableE2EStats {false}; //!< Enable or disable the e2e statistic generation
+  uint32_t        m_packetPoolSize; //!< Size of the packet pool (zero to disable it)
+  Ptr<PacketPool> m_packetPool;   //!< Pool the packets are allocated from, if any
 
 
   /// Traced Callback: transmitted packets.
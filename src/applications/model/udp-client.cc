@@ -27,6 +27,7 @@
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
+#include "ns3/packet-pool.h"
 #include "ns3/uinteger.h"
 #include "udp-client.h"
 #include "seq-ts-header.h"
@@ -69,6 +70,13 @@ UdpClient::GetTypeId (void)
                    UintegerValue (1024),
                    MakeUintegerAccessor (&UdpClient::m_size),
                    MakeUintegerChecker<uint32_t> (12,65507))
+    .AddAttribute ("PacketPoolSize",
+                   "The number of packets allocated in advance and recycled once "
+                   "they are no longer in use. The value zero disables the "
+                   "packet pool.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&UdpClient::m_packetPoolSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -105,6 +113,7 @@ void
 UdpClient::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_packetPool = 0;
   Application::DoDispose ();
 }
 
@@ -157,6 +166,11 @@ UdpClient::StartApplication (void)
 
   m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
   m_socket->SetAllowBroadcast (true);
+  if (m_packetPoolSize > 0 && m_packetPool == 0)
+    {
+      m_packetPool = Create<PacketPool> (m_packetPoolSize);
+      m_packetPool->Reserve (m_packetPoolSize);
+    }
   m_sendEvent = Simulator::Schedule (Seconds (0.0), &UdpClient::Send, this);
 }
 
@@ -174,7 +188,15 @@ UdpClient::Send (void)
   NS_ASSERT (m_sendEvent.IsExpired ());
   SeqTsHeader seqTs;
   seqTs.SetSeq (m_sent);
-  Ptr<Packet> p = Create<Packet> (m_size-(8+4)); // 8+4 : the size of the seqTs header
+  Ptr<Packet> p;
+  if (m_packetPool != 0)
+    {
+      p = m_packetPool->Allocate (m_size-(8+4)); // 8+4 : the size of the seqTs header
+    }
+  else
+    {
+      p = Create<Packet> (m_size-(8+4));
+    }
   p->AddHeader (seqTs);
 
   std::stringstream peerAddressStringStream;
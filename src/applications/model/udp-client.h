@@ -32,6 +32,7 @@ namespace ns3 {
 
 class Socket;
 class Packet;
+class PacketPool;
 
 /**
  * \ingroup udpclientserver
@@ -87,6 +88,8 @@ private:
   Address m_peerAddress; //!< Remote peer address
   uint16_t m_peerPort; //!< Remote peer port
   EventId m_sendEvent; //!< Event to send the next packet
+  uint32_t m_packetPoolSize; //!< Size of the packet pool (zero to disable it)
+  Ptr<PacketPool> m_packetPool; //!< Pool the packets are allocated from, if any
 
 };
 
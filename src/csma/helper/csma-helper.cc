@@ -310,9 +310,13 @@ CsmaHelper::InstallPriv (Ptr<Node> node, Ptr<CsmaChannel> channel) const
   Ptr<Queue<Packet> > queue = m_queueFactory.Create<Queue<Packet> > ();
   device->SetQueue (queue);
   device->Attach (channel);
-  // Aggregate a NetDeviceQueueInterface object
+  // Aggregate a NetDeviceQueueInterface object, through which the device
+  // receives the packets dequeued by the queue disc in bursts
   Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
   ndqi->GetTxQueue (0)->ConnectQueueTraces (queue);
+  CsmaNetDevice *rawDevice = PeekPointer (device);
+  ndqi->SetSendBurstCallback ([rawDevice] (const std::vector<Ptr<QueueDiscItem> > &items)
+                              { rawDevice->SendBurst (items); });
   device->AggregateObject (ndqi);
 
   return device;
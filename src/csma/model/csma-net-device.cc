@@ -20,6 +20,7 @@
 
 #include "ns3/log.h"
 #include "ns3/queue.h"
+#include "ns3/queue-item.h"
 #include "ns3/simulator.h"
 #include "ns3/ethernet-header.h"
 #include "ns3/ethernet-trailer.h"
@@ -997,6 +998,44 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
   return true;
 }
 
+void
+CsmaNetDevice::SendBurst (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  NS_ASSERT (IsLinkUp ());
+
+  Mac48Address source = Mac48Address::ConvertFrom (GetAddress ());
+  for (const auto &item : items)
+    {
+      Ptr<Packet> packet = item->GetPacket ();
+      if (IsSendEnabled () == false)
+        {
+          m_macTxDropTrace (packet);
+          continue;
+        }
+      AddHeader (packet, source, Mac48Address::ConvertFrom (item->GetAddress ()), item->GetProtocol ());
+      m_macTxTrace (packet);
+      if (m_queue->Enqueue (packet) == false)
+        {
+          m_macTxDropTrace (packet);
+        }
+    }
+
+  //
+  // If the device is idle, start the transmission of the first packet of the
+  // burst. The following ones are transmitted one after the other (see
+  // TransmitCompleteEvent)
+  //
+  if (m_txMachineState == READY && m_queue->IsEmpty () == false)
+    {
+      m_currentPkt = m_queue->Dequeue ();
+      m_promiscSnifferTrace (m_currentPkt);
+      m_snifferTrace (m_currentPkt);
+      TransmitStart ();
+    }
+}
+
 Ptr<Node>
 CsmaNetDevice::GetNode (void) const
 {
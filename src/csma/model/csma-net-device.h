@@ -22,6 +22,7 @@
 #define CSMA_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
 #include "ns3/node.h"
 #include "ns3/backoff.h"
 #include "ns3/address.h"
@@ -37,6 +38,7 @@
 namespace ns3 {
 
 template <typename Item> class Queue;
+class QueueDiscItem;
 class CsmaChannel;
 class ErrorModel;
 
@@ -284,6 +286,15 @@ public:
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, 
                          uint16_t protocolNumber);
 
+  /**
+   * Start sending a burst of packets dequeued by a queue disc down the
+   * channel. All the packets are placed in the transmit queue before the
+   * transmission of the first one starts, if the transmitter is idle.
+   * \param items the packets to send, with their destination address and
+   *        protocol number
+   */
+  void SendBurst (const std::vector<Ptr<QueueDiscItem> > &items);
+
   /**
    * Get the node to which this device is attached.
    *
@@ -101,11 +101,32 @@ typedef std::map<InterfacePairIpv6, Ptr<OutputStreamWrapper> > InterfaceStreamMa
 static InterfaceFileMapIpv6 g_interfaceFileMapIpv6; /**< A mapping of Ipv6/interface pairs to pcap files */
 static InterfaceStreamMapIpv6 g_interfaceStreamMapIpv6; /**< A mapping of Ipv6/interface pairs to pcap files */
 
+//
+// The nodes on which the installation of the IPv6 stack is deferred keep,
+// by node identifier, the index plus one (zero when nothing is deferred) of
+// the copy of the helper which will install it. The copies are shared by
+// the nodes installed with the same IPv6 configuration, and, as the node
+// identifiers, do not survive the simulation.
+//
+static std::vector<std::shared_ptr<const InternetStackHelper> > g_ipv6OnDemandHelpers; /**< The helpers installing the deferred IPv6 stacks */
+static std::vector<uint32_t> g_ipv6OnDemandNodes; /**< The index plus one of the helper of each node in g_ipv6OnDemandHelpers */
+
+/**
+ * \brief Forget the IPv6 stacks deferred, at the end of the simulation
+ */
+static void
+ClearIpv6OnDemand (void)
+{
+  g_ipv6OnDemandHelpers.clear ();
+  g_ipv6OnDemandNodes.clear ();
+}
+
 InternetStackHelper::InternetStackHelper ()
   : m_routing (0),
     m_routingv6 (0),
     m_ipv4Enabled (true),
     m_ipv6Enabled (true),
+    m_ipv6OnDemand (false),
     m_ipv4ArpJitterEnabled (true),
     m_ipv6NsRsJitterEnabled (true)
 
@@ -140,6 +161,7 @@ InternetStackHelper::InternetStackHelper (const InternetStackHelper &o)
   m_routingv6 = o.m_routingv6->Copy ();
   m_ipv4Enabled = o.m_ipv4Enabled;
   m_ipv6Enabled = o.m_ipv6Enabled;
+  m_ipv6OnDemand = o.m_ipv6OnDemand;
   m_tcpFactory = o.m_tcpFactory;
   m_ipv4ArpJitterEnabled = o.m_ipv4ArpJitterEnabled;
   m_ipv6NsRsJitterEnabled = o.m_ipv6NsRsJitterEnabled;
@@ -154,6 +176,7 @@ InternetStackHelper::operator = (const InternetStackHelper &o)
     }
   m_routing = o.m_routing->Copy ();
   m_routingv6 = o.m_routingv6->Copy ();
+  m_ipv6OnDemandHelper.reset ();
   return *this;
 }
 
@@ -166,6 +189,7 @@ InternetStackHelper::Reset (void)
   m_routingv6 = 0;
   m_ipv4Enabled = true;
   m_ipv6Enabled = true;
+  m_ipv6OnDemand = false;
   m_ipv4ArpJitterEnabled = true;
   m_ipv6NsRsJitterEnabled = true;
   Initialize ();
@@ -183,6 +207,7 @@ InternetStackHelper::SetRoutingHelper (const Ipv6RoutingHelper &routing)
 {
   delete m_routingv6;
   m_routingv6 = routing.Copy ();
+  m_ipv6OnDemandHelper.reset ();
 }
 
 void
@@ -196,6 +221,11 @@ void InternetStackHelper::SetIpv6StackInstall (bool enable)
   m_ipv6Enabled = enable;
 }
 
+void InternetStackHelper::SetIpv6StackInstallOnDemand (bool enable)
+{
+  m_ipv6OnDemand = enable;
+}
+
 void InternetStackHelper::SetIpv4ArpJitter (bool enable)
 {
   m_ipv4ArpJitterEnabled = enable;
@@ -204,6 +234,7 @@ void InternetStackHelper::SetIpv4ArpJitter (bool enable)
 void InternetStackHelper::SetIpv6NsRsJitter (bool enable)
 {
   m_ipv6NsRsJitterEnabled = enable;
+  m_ipv6OnDemandHelper.reset ();
 }
 
 int64_t
@@ -318,29 +349,21 @@ InternetStackHelper::Install (Ptr<Node> node) const
   if (m_ipv6Enabled)
     {
       /* IPv6 stack */
-      if (node->GetObject<Ipv6> () != 0)
+      if (node->GetObject<Ipv6> () != 0
+          || (node->GetId () < g_ipv6OnDemandNodes.size () && g_ipv6OnDemandNodes[node->GetId ()] != 0))
         {
           NS_FATAL_ERROR ("InternetStackHelper::Install (): Aggregating " 
                           "an InternetStack to a node with an existing Ipv6 object");
           return;
         }
-
-      CreateAndAggregateObjectFromTypeId (node, "ns3::Ipv6L3Protocol");
-      CreateAndAggregateObjectFromTypeId (node, "ns3::Icmpv6L4Protocol");
-      if (m_ipv6NsRsJitterEnabled == false)
+      if (m_ipv6OnDemand)
         {
-          Ptr<Icmpv6L4Protocol> icmpv6l4 = node->GetObject<Icmpv6L4Protocol> ();
-          NS_ASSERT (icmpv6l4);
-          icmpv6l4->SetAttribute ("SolicitationJitter", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+          DeferIpv6 (node);
+        }
+      else
+        {
+          InstallIpv6 (node);
         }
-      // Set routing
-      Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
-      Ptr<Ipv6RoutingProtocol> ipv6Routing = m_routingv6->Create (node);
-      ipv6->SetRoutingProtocol (ipv6Routing);
-
-      /* register IPv6 extensions and options */
-      ipv6->RegisterExtensions ();
-      ipv6->RegisterOptions ();
     }
 
   if (m_ipv4Enabled || m_ipv6Enabled)
@@ -362,6 +385,68 @@ InternetStackHelper::Install (Ptr<Node> node) const
     }
 }
 
+void
+InternetStackHelper::InstallIpv6 (Ptr<Node> node) const
+{
+  NS_LOG_FUNCTION (this << node);
+  CreateAndAggregateObjectFromTypeId (node, "ns3::Ipv6L3Protocol");
+  CreateAndAggregateObjectFromTypeId (node, "ns3::Icmpv6L4Protocol");
+  if (m_ipv6NsRsJitterEnabled == false)
+    {
+      Ptr<Icmpv6L4Protocol> icmpv6l4 = node->GetObject<Icmpv6L4Protocol> ();
+      NS_ASSERT (icmpv6l4);
+      icmpv6l4->SetAttribute ("SolicitationJitter", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+    }
+  // Set routing
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  Ptr<Ipv6RoutingProtocol> ipv6Routing = m_routingv6->Create (node);
+  ipv6->SetRoutingProtocol (ipv6Routing);
+
+  /* register IPv6 extensions and options */
+  ipv6->RegisterExtensions ();
+  ipv6->RegisterOptions ();
+}
+
+void
+InternetStackHelper::DeferIpv6 (Ptr<Node> node) const
+{
+  NS_LOG_FUNCTION (this << node);
+  if (!m_ipv6OnDemandHelper)
+    {
+      // The copy does not defer the installation
+      std::shared_ptr<InternetStackHelper> helper = std::make_shared<InternetStackHelper> (*this);
+      helper->m_ipv6OnDemand = false;
+      m_ipv6OnDemandHelper = helper;
+    }
+  if (g_ipv6OnDemandHelpers.empty ())
+    {
+      Simulator::ScheduleDestroy (&ClearIpv6OnDemand);
+    }
+  if (g_ipv6OnDemandHelpers.empty () || g_ipv6OnDemandHelpers.back () != m_ipv6OnDemandHelper)
+    {
+      g_ipv6OnDemandHelpers.push_back (m_ipv6OnDemandHelper);
+    }
+  if (node->GetId () >= g_ipv6OnDemandNodes.size ())
+    {
+      g_ipv6OnDemandNodes.resize (node->GetId () + 1, 0);
+    }
+  g_ipv6OnDemandNodes[node->GetId ()] = g_ipv6OnDemandHelpers.size ();
+}
+
+void
+InternetStackHelper::InstallIpv6OnDemand (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (node);
+  uint32_t id = node->GetId ();
+  if (id >= g_ipv6OnDemandNodes.size () || g_ipv6OnDemandNodes[id] == 0)
+    {
+      return;
+    }
+  std::shared_ptr<const InternetStackHelper> helper = g_ipv6OnDemandHelpers[g_ipv6OnDemandNodes[id] - 1];
+  g_ipv6OnDemandNodes[id] = 0;
+  helper->InstallIpv6 (node);
+}
+
 void
 InternetStackHelper::Install (std::string nodeName) const
 {
@@ -29,6 +29,7 @@
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv6-l3-protocol.h"
 #include "internet-trace-helper.h"
+#include <memory>
 
 namespace ns3 {
 
@@ -82,6 +83,11 @@ class Ipv6RoutingHelper;
  *  - a PacketSocketFactory
  *  - Ipv4 routing (a list routing object, a global routing object, and a static routing object)
  *  - Ipv6 routing (a static routing object)
+ *
+ * With SetIpv6StackInstallOnDemand, the IPv6 objects are aggregated to a
+ * node only when an interface of the node is first configured by an
+ * Ipv6AddressHelper, so that the nodes which never use IPv6 do not hold an
+ * IPv6 stack.
  */
 class InternetStackHelper : public PcapHelperForIpv4, public PcapHelperForIpv6, 
                             public AsciiTraceHelperForIpv4, public AsciiTraceHelperForIpv6
@@ -211,6 +217,31 @@ public:
    */
   void SetIpv6StackInstall (bool enable);
 
+  /**
+   * \brief Enable/disable the installation of the IPv6 stack on demand.
+   *
+   * When enabled, Install does not aggregate the IPv6 stack (Ipv6L3Protocol,
+   * Icmpv6L4Protocol, the IPv6 routing protocol, extensions and options) to
+   * the nodes: the stack is installed on a node, with the configuration the
+   * helper had at Install time, when Ipv6AddressHelper first configures an
+   * interface of the node (see InstallIpv6OnDemand). Until then, the node
+   * has no Ipv6 object, so the IPv6 routing and tracing helpers must be used
+   * after the IPv6 addresses are assigned. Disabled by default.
+   *
+   * \param enable enable state
+   */
+  void SetIpv6StackInstallOnDemand (bool enable);
+
+  /**
+   * \brief Install the IPv6 stack deferred on a node, if any
+   *
+   * Install the IPv6 stack on a node on which an InternetStackHelper
+   * deferred it (see SetIpv6StackInstallOnDemand); do nothing otherwise.
+   *
+   * \param node the node
+   */
+  static void InstallIpv6OnDemand (Ptr<Node> node);
+
   /**
    * \brief Enable/disable IPv4 ARP Jitter.
    * \param enable enable state
@@ -300,6 +331,18 @@ private:
    */
   void Initialize (void);
 
+  /**
+   * \brief Aggregate the IPv6 stack to a node
+   * \param node the node
+   */
+  void InstallIpv6 (Ptr<Node> node) const;
+
+  /**
+   * \brief Defer the installation of the IPv6 stack on a node
+   * \param node the node
+   */
+  void DeferIpv6 (Ptr<Node> node) const;
+
   /**
    * \brief TCP objects factory
    */
@@ -360,6 +403,17 @@ private:
    */
   bool m_ipv6Enabled;
 
+  /**
+   * \brief IPv6 install on demand state (enabled/disabled) ?
+   */
+  bool m_ipv6OnDemand;
+
+  /**
+   * \brief Copy of the helper installing the IPv6 stacks deferred, shared
+   * by the nodes until the IPv6 configuration changes
+   */
+  mutable std::shared_ptr<const InternetStackHelper> m_ipv6OnDemandHelper;
+
   /**
    * \brief IPv4 ARP Jitter state (enabled/disabled) ?
    */
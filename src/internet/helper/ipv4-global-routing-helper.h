@@ -82,6 +82,9 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * Only the routers whose shortest path tree may have changed have their
+   * routes recomputed (see GlobalRouteManager::UpdateGlobalRoutes ()).
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
@@ -33,6 +33,7 @@
 #include "ns3/traffic-control-layer.h"
 #include "ns3/net-device-queue-interface.h"
 
+#include "internet-stack-helper.h"
 #include "ipv6-address-helper.h"
 
 namespace ns3 
@@ -219,6 +220,8 @@ Ipv6InterfaceContainer Ipv6AddressHelper::Assign (const NetDeviceContainer &c)
       Ptr<Node> node = device->GetNode ();
       NS_ASSERT_MSG (node, "Ipv6AddressHelper::Allocate (): Bad node");
 
+      // The IPv6 stack of the node may have been deferred until now
+      InternetStackHelper::InstallIpv6OnDemand (node);
       Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
       NS_ASSERT_MSG (ipv6, "Ipv6AddressHelper::Allocate (): Bad ipv6");
       int32_t ifIndex = 0;
@@ -276,6 +279,8 @@ Ipv6InterfaceContainer Ipv6AddressHelper::Assign (const NetDeviceContainer &c, s
       Ptr<Node> node = device->GetNode ();
       NS_ASSERT_MSG (node, "Ipv6AddressHelper::Allocate (): Bad node");
 
+      // The IPv6 stack of the node may have been deferred until now
+      InternetStackHelper::InstallIpv6OnDemand (node);
       Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
       NS_ASSERT_MSG (ipv6, "Ipv6AddressHelper::Allocate (): Bad ipv6");
 
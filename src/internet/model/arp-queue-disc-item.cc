@@ -90,7 +90,14 @@ ArpQueueDiscItem::Mark (void)
 uint32_t
 ArpQueueDiscItem::Hash (uint32_t perturbation) const
 {
-  NS_LOG_FUNCTION (this << perturbation);
+  Hasher hasher;
+  return Hash (hasher, perturbation);
+}
+
+uint32_t
+ArpQueueDiscItem::Hash (Hasher &hasher, uint32_t perturbation) const
+{
+  NS_LOG_FUNCTION (this << &hasher << perturbation);
 
   Ipv4Address ipv4Src = m_header.GetSourceIpv4Address ();
   Ipv4Address ipv4Dst = m_header.GetDestinationIpv4Address ();
@@ -114,7 +121,7 @@ ArpQueueDiscItem::Hash (uint32_t perturbation) const
   // Linux calculates jhash2 (jenkins hash), we calculate murmur3 because it is
   // already available in ns-3
 
-  uint32_t hash = Hash32 ((char*) buf, tmp+5);
+  uint32_t hash = hasher.clear ().GetHash32 ((char*) buf, tmp+5);
 
   NS_LOG_DEBUG ("Hash value " << hash);
 
@@ -81,6 +81,15 @@ public:
    */
   virtual uint32_t Hash (uint32_t perturbation) const;
 
+  /**
+   * \brief Computes the hash of the packet's 5-tuple with the given hasher
+   *
+   * \param hasher the hasher, cleared before use
+   * \param perturbation hash perturbation value
+   * \return the hash of the packet's 5-tuple
+   */
+  virtual uint32_t Hash (Hasher &hasher, uint32_t perturbation) const;
+
 private:
   /**
    * \brief Default constructor
@@ -51,22 +51,24 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 {
   typedef CandidateQueue::CandidateList_t List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  List_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::Before);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->vertex->GetVertexId () << ", "
+      << iter->vertex->GetDistanceFromRoot () << ", "
+      << iter->vertex->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_order (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +96,14 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate candidate;
+  candidate.vertex = vNew;
+  candidate.distance = vNew->GetDistanceFromRoot ();
+  candidate.order = m_order++;
+  m_candidates.push_back (candidate);
+  m_positions[vNew] = m_candidates.size () - 1;
+  m_addresses.insert (std::make_pair (vNew->GetVertexId (), vNew));
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -110,8 +115,24 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().vertex;
+  m_positions.erase (v);
+  std::pair<AddressMap_t::iterator, AddressMap_t::iterator> range = m_addresses.equal_range (v->GetVertexId ());
+  for (AddressMap_t::iterator i = range.first; i != range.second; i++)
+    {
+      if (i->second == v)
+        {
+          m_addresses.erase (i);
+          break;
+        }
+    }
+  Candidate last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -124,7 +145,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -145,18 +166,20 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  std::pair<AddressMap_t::const_iterator, AddressMap_t::const_iterator> range = m_addresses.equal_range (addr);
+  SPFVertex *found = 0;
+  uint32_t foundPosition = 0;
+  // The first of several vertices with the same ID in the pop order
+  for (AddressMap_t::const_iterator i = range.first; i != range.second; i++)
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
+      uint32_t position = m_positions.find (i->second)->second;
+      if (found == 0 || Before (m_candidates[position], m_candidates[foundPosition]))
         {
-          return v;
+          found = i->second;
+          foundPosition = position;
         }
     }
-
-  return 0;
+  return found;
 }
 
 void
@@ -164,11 +187,87 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  // Like a stable sort of the queue by the current distances: the
+  // candidates at the same distance keep their previous order.
+  std::sort (m_candidates.begin (), m_candidates.end (), &CandidateQueue::Before);
+  for (CandidateList_t::iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
+    {
+      i->distance = i->vertex->GetDistanceFromRoot ();
+      i->order = m_order++;
+    }
+  std::sort (m_candidates.begin (), m_candidates.end (), &CandidateQueue::Before);
+  for (uint32_t i = 0; i < m_candidates.size (); i++)
+    {
+      m_positions[m_candidates[i].vertex] = i;
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  std::unordered_map<SPFVertex*, uint32_t>::iterator position = m_positions.find (v);
+  NS_ASSERT_MSG (position != m_positions.end (), "Vertex not in the CandidateQueue");
+  uint32_t index = position->second;
+  m_candidates[index].distance = v->GetDistanceFromRoot ();
+  m_candidates[index].order = m_order++;
+  SiftUp (index);
+  SiftDown (m_positions[v]);
+}
+
+void
+CandidateQueue::Place (uint32_t index, const Candidate &candidate)
+{
+  m_candidates[index] = candidate;
+  m_positions[candidate.vertex] = index;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t index)
+{
+  Candidate candidate = m_candidates[index];
+  while (index > 0)
+    {
+      uint32_t parent = (index - 1) / 2;
+      if (!Before (candidate, m_candidates[parent]))
+        {
+          break;
+        }
+      Place (index, m_candidates[parent]);
+      index = parent;
+    }
+  Place (index, candidate);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t index)
+{
+  Candidate candidate = m_candidates[index];
+  uint32_t size = m_candidates.size ();
+  while (true)
+    {
+      uint32_t child = 2 * index + 1;
+      if (child >= size)
+        {
+          break;
+        }
+      if (child + 1 < size && Before (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!Before (m_candidates[child], candidate))
+        {
+          break;
+        }
+      Place (index, m_candidates[child]);
+      index = child;
+    }
+  Place (index, candidate);
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -176,25 +275,24 @@ CandidateQueue::Reorder (void)
  *
  * This ordering is necessary for implementing ECMP
  */
-bool 
-CandidateQueue::CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2)
+bool
+CandidateQueue::Before (const Candidate &c1, const Candidate &c2)
 {
-  NS_LOG_FUNCTION (&v1 << &v2);
-
-  bool result = false;
-  if (v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ())
+  if (c1.distance != c2.distance)
     {
-      result = true;
+      return c1.distance < c2.distance;
     }
-  else if (v1->GetDistanceFromRoot () == v2->GetDistanceFromRoot ())
+  SPFVertex::VertexType t1 = c1.vertex->GetVertexType ();
+  SPFVertex::VertexType t2 = c2.vertex->GetVertexType ();
+  if (t1 == SPFVertex::VertexNetwork && t2 == SPFVertex::VertexRouter)
     {
-      if (v1->GetVertexType () == SPFVertex::VertexNetwork 
-          && v2->GetVertexType () == SPFVertex::VertexRouter)
-        {
-          result = true;
-        }
+      return true;
+    }
+  if (t1 == SPFVertex::VertexRouter && t2 == SPFVertex::VertexNetwork)
+    {
+      return false;
     }
-  return result;
+  return c1.order < c2.order;
 }
 
 } // namespace ns3
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +48,11 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap, with an index of the vertices by address, so
+ * that Push, Pop, Find and the reordering of a single vertex are logarithmic.
+ * Vertices at the same distance and of the same type are popped in the
+ * order they were pushed, or their distance last decreased.
  */
 class CandidateQueue
 {
@@ -154,6 +160,18 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Reorders the Candidate Queue after the distance of a vertex of the
+ * queue decreased.
+ *
+ * This is the logarithmic counterpart of Reorder (), for the only change
+ * of the routing calculations: a shorter path found to a candidate.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance decreased.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -171,21 +189,53 @@ private:
  * \return copied object
  */
   CandidateQueue& operator= (CandidateQueue& sr);
+
+  /// A candidate of the heap
+  struct Candidate
+  {
+    SPFVertex *vertex;    //!< the vertex
+    uint32_t distance;    //!< the distance of the vertex when it was queued or reordered
+    uint64_t order;       //!< the order the vertex was queued or reordered
+  };
+
 /**
- * \brief return true if v1 < v2
+ * \brief return true if c1 < c2
  *
- * SPFVertexes are added into the queue according to the ordering
- * defined by this method. If v1 should be popped before v2, this 
- * method return true; false otherwise
+ * SPFVertexes are popped from the queue according to the ordering
+ * defined by this method: by distance, then network vertices before
+ * router vertices, then in the order they were queued.
  *
- * \param v1 first operand
- * \param v2 second operand
- * \return True if v1 should be popped before v2; false otherwise
+ * \param c1 first operand
+ * \param c2 second operand
+ * \return True if c1 should be popped before c2; false otherwise
+ */
+  static bool Before (const Candidate &c1, const Candidate &c2);
+
+/**
+ * \brief Move a candidate up the heap until the heap is ordered.
+ * \param index the candidate position
+ */
+  void SiftUp (uint32_t index);
+
+/**
+ * \brief Move a candidate down the heap until the heap is ordered.
+ * \param index the candidate position
+ */
+  void SiftDown (uint32_t index);
+
+/**
+ * \brief Store a candidate in the heap and update the index.
+ * \param index the candidate position
+ * \param candidate the candidate
  */
-  static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
+  void Place (uint32_t index, const Candidate &candidate);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
+  typedef std::vector<Candidate> CandidateList_t; //!< heap of SPFVertex candidates
   CandidateList_t m_candidates;  //!< SPFVertex candidates
+  std::unordered_map<SPFVertex*, uint32_t> m_positions;  //!< positions of the candidates in the heap
+  typedef std::unordered_multimap<Ipv4Address, SPFVertex*, Ipv4AddressHash> AddressMap_t; //!< index of the candidates by vertex ID
+  AddressMap_t m_addresses;  //!< candidates by vertex ID
+  uint64_t m_order;  //!< the order of the next queued or reordered candidate
 
   /**
    * \brief Stream insertion operator.
@@ -26,23 +26,42 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <functional>
 #include <iostream>
+#include "ns3/core-config.h"
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
+#include "ns3/simulator.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/uinteger.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
-#include "candidate-queue.h"
 #include "ipv4-global-routing.h"
+#include "ipv4-routing-table-entry.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \relates GlobalRouteManagerImpl
+ * \anchor GlobalValueGlobalRoutingThreads
+ * \brief The number of threads calculating the global routes.
+ */
+static GlobalValue g_globalRoutingThreads = GlobalValue ("GlobalRoutingThreads",
+                                                         "The number of threads calculating the global routes",
+                                                         UintegerValue (1),
+                                                         MakeUintegerChecker<uint32_t> (1));
+
 /**
  * \brief Stream insertion operator.
  *
@@ -138,8 +157,9 @@ SPFVertex::~SPFVertex ()
       // remove the current vertex from its parent's children list. Check
       // if the size of the list is reduced, or the child<->parent relation
       // is not bidirectional
-      uint32_t orgCount = (*piter)->m_children.size ();
-      (*piter)->m_children.remove (this);
+      ListOfSPFVertex_t &siblings = (*piter)->m_children;
+      uint32_t orgCount = siblings.size ();
+      siblings.erase (std::remove (siblings.begin (), siblings.end (), this), siblings.end ());
       uint32_t newCount = (*piter)->m_children.size ();
       if (orgCount > newCount)
         {
@@ -250,12 +270,7 @@ SPFVertex::GetParent (uint32_t i) const
       NS_LOG_LOGIC ("Index to SPFVertex's parent is out-of-range.");
       return 0;
     }
-  ListOfSPFVertex_t::const_iterator iter = m_parents.begin ();
-  while (i-- > 0) 
-    {
-      iter++;
-    }
-  return *iter;
+  return m_parents[i];
 }
 
 void 
@@ -268,8 +283,8 @@ SPFVertex::MergeParent (const SPFVertex* v)
   m_parents.insert (m_parents.end (), 
                     v->m_parents.begin (), v->m_parents.end ());
   // remove duplication
-  m_parents.sort ();
-  m_parents.unique ();
+  std::sort (m_parents.begin (), m_parents.end ());
+  m_parents.erase (std::unique (m_parents.begin (), m_parents.end ()), m_parents.end ());
   NS_LOG_LOGIC ("After merge, list of parents = " << m_parents);
 }
 
@@ -298,13 +313,9 @@ SPFVertex::NodeExit_t
 SPFVertex::GetRootExitDirection (uint32_t i) const
 {
   NS_LOG_FUNCTION (this << i);
-  typedef ListOfNodeExit_t::const_iterator CIter_t;
 
   NS_ASSERT_MSG (i < m_ecmpRootExits.size (), "Index out-of-range when accessing SPFVertex::m_ecmpRootExits!");
-  CIter_t iter = m_ecmpRootExits.begin ();
-  while (i-- > 0) { iter++; }
-
-  return *iter;
+  return m_ecmpRootExits[i];
 }
 
 SPFVertex::NodeExit_t 
@@ -327,8 +338,8 @@ SPFVertex::MergeRootExitDirections (const SPFVertex* vertex)
   const ListOfNodeExit_t& extList = vertex->m_ecmpRootExits;
   m_ecmpRootExits.insert (m_ecmpRootExits.end (), 
                           extList.begin (), extList.end ());
-  m_ecmpRootExits.sort ();
-  m_ecmpRootExits.unique ();
+  std::sort (m_ecmpRootExits.begin (), m_ecmpRootExits.end ());
+  m_ecmpRootExits.erase (std::unique (m_ecmpRootExits.begin (), m_ecmpRootExits.end ()), m_ecmpRootExits.end ());
 }
 
 void 
@@ -365,19 +376,8 @@ SPFVertex*
 SPFVertex::GetChild (uint32_t n) const
 {
   NS_LOG_FUNCTION (this << n);
-  uint32_t j = 0;
-
-  for ( ListOfSPFVertex_t::const_iterator i = m_children.begin ();
-        i != m_children.end ();
-        i++, j++)
-    {
-      if (j == n)
-        {
-          return *i;
-        }
-    }
-  NS_ASSERT_MSG (false, "Index <n> out of range.");
-  return 0;
+  NS_ASSERT_MSG (n < m_children.size (), "Index <n> out of range.");
+  return m_children[n];
 }
 
 uint32_t
@@ -419,10 +419,14 @@ SPFVertex::ClearVertexProcessed (void)
 //
 // ---------------------------------------------------------------------------
 
+const uint32_t GlobalRouteManagerLSDB::NO_VERTEX;
+
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
-    m_database (),
-    m_extdatabase ()
+    m_vertexIds (),
+    m_vertexLSAs (),
+    m_extdatabase (),
+    m_indexed (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -430,11 +434,10 @@ GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
 GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
 {
   NS_LOG_FUNCTION (this);
-  LSDBMap_t::iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  for (uint32_t j = 0; j < m_vertexLSAs.size (); j++)
     {
       NS_LOG_LOGIC ("free LSA");
-      GlobalRoutingLSA* temp = i->second;
+      GlobalRoutingLSA* temp = m_vertexLSAs[j];
       delete temp;
     }
   for (uint32_t j = 0; j < m_extdatabase.size (); j++)
@@ -443,18 +446,18 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
       GlobalRoutingLSA* temp = m_extdatabase.at (j);
       delete temp;
     }
-  NS_LOG_LOGIC ("clear map");
-  m_database.clear ();
+  NS_LOG_LOGIC ("clear database");
+  m_vertexIds.clear ();
+  m_vertexLSAs.clear ();
 }
 
 void
 GlobalRouteManagerLSDB::Initialize ()
 {
   NS_LOG_FUNCTION (this);
-  LSDBMap_t::iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  for (uint32_t i = 0; i < m_vertexLSAs.size (); i++)
     {
-      GlobalRoutingLSA* temp = i->second;
+      GlobalRoutingLSA* temp = m_vertexLSAs[i];
       temp->SetStatus (GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
     }
 }
@@ -463,13 +466,15 @@ void
 GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
 {
   NS_LOG_FUNCTION (this << addr << lsa);
+  NS_ASSERT_MSG (!m_indexed, "No LSA may be inserted once the LSDB is indexed");
   if (lsa->GetLSType () == GlobalRoutingLSA::ASExternalLSAs) 
     {
       m_extdatabase.push_back (lsa);
     } 
   else
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      m_vertexIds.push_back (addr);
+      m_vertexLSAs.push_back (lsa);
     }
 }
 
@@ -492,17 +497,52 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by its address: the first one inserted, until the LSDB is
+// indexed.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  if (!m_indexed)
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      std::vector<Ipv4Address>::const_iterator i = std::find (m_vertexIds.begin (), m_vertexIds.end (), addr);
+      return i == m_vertexIds.end () ? 0 : m_vertexLSAs[i - m_vertexIds.begin ()];
     }
-  return 0;
+  uint32_t index = GetVertexIndex (addr);
+  return index == NO_VERTEX ? 0 : m_vertexLSAs[index];
+}
+
+/**
+ * \brief Compare the first member of a pair with a value
+ * \param entry the pair
+ * \param addr the value
+ * \returns true if the first member of the pair is less than the value
+ */
+static bool
+LinkDataLess (const std::pair<Ipv4Address, uint32_t> &entry, Ipv4Address addr)
+{
+  return entry.first < addr;
+}
+
+/**
+ * \brief Compare the first members of two pairs
+ * \param a the first pair
+ * \param b the second pair
+ * \returns true if the first member of the first pair is less
+ */
+static bool
+LinkDataEntryLess (const std::pair<Ipv4Address, uint32_t> &a, const std::pair<Ipv4Address, uint32_t> &b)
+{
+  return a.first < b.first;
+}
+
+/**
+ * \brief Compare the first members of two pairs
+ * \param a the first pair
+ * \param b the second pair
+ * \returns true if the first members of the pairs are equal
+ */
+static bool
+LinkDataEntryEqual (const std::pair<Ipv4Address, uint32_t> &a, const std::pair<Ipv4Address, uint32_t> &b)
+{
+  return a.first == b.first;
 }
 
 GlobalRoutingLSA*
@@ -510,35 +550,236 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the LinkData of its TransitNetwork link records.  The
+// LSA with the lowest address is returned when several have the same
+// LinkData.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  if (!m_indexed)
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+      GlobalRoutingLSA *found = 0;
+      for (uint32_t i = 0; i < m_vertexLSAs.size (); i++)
         {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
+          GlobalRoutingLSA *lsa = m_vertexLSAs[i];
+          if (found != 0 && !(lsa->GetLinkStateId () < found->GetLinkStateId ()))
             {
-              return temp;
+              continue;
+            }
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+              if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
+                  lr->GetLinkData () == addr)
+                {
+                  found = lsa;
+                  break;
+                }
             }
         }
+      return found;
+    }
+  LinkDataIndex_t::const_iterator i = std::lower_bound (m_linkDataIndex.begin (), m_linkDataIndex.end (),
+                                                        addr, &LinkDataLess);
+  if (i != m_linkDataIndex.end () && i->first == addr)
+    {
+      return m_vertexLSAs[i->second];
     }
   return 0;
 }
 
+void
+GlobalRouteManagerLSDB::GetLinkStateIds (std::vector<Ipv4Address> &ids) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Ipv4Address>::size_type first = ids.size ();
+  ids.insert (ids.end (), m_vertexIds.begin (), m_vertexIds.end ());
+  if (!m_indexed)
+    {
+      std::sort (ids.begin () + first, ids.end ());
+      ids.erase (std::unique (ids.begin () + first, ids.end ()), ids.end ());
+    }
+}
+
+void
+GlobalRouteManagerLSDB::BuildIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_indexed)
+    {
+      return;
+    }
+//
+// Number the vertices in the order of their link state IDs.  Of several LSAs
+// with the same link state ID, the first one inserted is kept.
+//
+  std::vector<std::pair<Ipv4Address, uint32_t> > order;
+  order.reserve (m_vertexIds.size ());
+  for (uint32_t i = 0; i < m_vertexIds.size (); i++)
+    {
+      order.push_back (std::make_pair (m_vertexIds[i], i));
+    }
+  std::sort (order.begin (), order.end ());
+  std::vector<Ipv4Address> ids;
+  std::vector<GlobalRoutingLSA*> lsas;
+  for (uint32_t i = 0; i < order.size (); i++)
+    {
+      GlobalRoutingLSA *lsa = m_vertexLSAs[order[i].second];
+      if (!ids.empty () && ids.back () == order[i].first)
+        {
+          NS_LOG_LOGIC ("free duplicate LSA");
+          delete lsa;
+          continue;
+        }
+      ids.push_back (order[i].first);
+      lsas.push_back (lsa);
+    }
+  m_vertexIds.swap (ids);
+  m_vertexLSAs.swap (lsas);
+  std::vector<std::pair<Ipv4Address, uint32_t> > ().swap (order);
+//
+// Index the vertices by the LinkData of their TransitNetwork link records,
+// keeping the lowest index when several have the same LinkData, and count
+// the links.
+//
+  uint32_t nLinks = 0;
+  m_linkDataIndex.clear ();
+  for (uint32_t i = 0; i < m_vertexLSAs.size (); i++)
+    {
+      GlobalRoutingLSA *lsa = m_vertexLSAs[i];
+      nLinks += lsa->GetNLinkRecords () + lsa->GetNAttachedRouters ();
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              m_linkDataIndex.push_back (std::make_pair (lr->GetLinkData (), i));
+            }
+        }
+    }
+  std::stable_sort (m_linkDataIndex.begin (), m_linkDataIndex.end (), &LinkDataEntryLess);
+  m_linkDataIndex.erase (std::unique (m_linkDataIndex.begin (), m_linkDataIndex.end (),
+                                      &LinkDataEntryEqual),
+                         m_linkDataIndex.end ());
+  LinkDataIndex_t (m_linkDataIndex).swap (m_linkDataIndex);
+  m_indexed = true;
+//
+// Move the link records and the attached routers to the links, in order,
+// leaving only the headers of the LSAs.
+//
+  m_linkOffsets.clear ();
+  m_linkOffsets.reserve (m_vertexLSAs.size () + 1);
+  m_links.clear ();
+  m_links.reserve (nLinks);
+  for (uint32_t i = 0; i < m_vertexLSAs.size (); i++)
+    {
+      m_linkOffsets.push_back (m_links.size ());
+      GlobalRoutingLSA *lsa = m_vertexLSAs[i];
+      for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+        {
+          Link link;
+          link.linkId = lsa->GetAttachedRouter (j).Get ();
+          link.linkData = 0;
+          link.vertex = NO_VERTEX;
+          link.metric = 0;
+          link.type = GlobalRoutingLinkRecord::Unknown;
+          GlobalRoutingLSA *router = GetLSAByLinkData (lsa->GetAttachedRouter (j));
+          if (router != 0)
+            {
+              link.vertex = GetVertexIndex (router->GetLinkStateId ());
+            }
+          m_links.push_back (link);
+        }
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          Link link;
+          link.linkId = lr->GetLinkId ().Get ();
+          link.linkData = lr->GetLinkData ().Get ();
+          link.vertex = NO_VERTEX;
+          link.metric = lr->GetMetric ();
+          link.type = lr->GetLinkType ();
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint ||
+              lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              link.vertex = GetVertexIndex (lr->GetLinkId ());
+            }
+          m_links.push_back (link);
+        }
+    }
+  m_linkOffsets.push_back (m_links.size ());
+  for (uint32_t i = 0; i < m_vertexLSAs.size (); i++)
+    {
+      m_vertexLSAs[i]->ClearLinkRecords ();
+      m_vertexLSAs[i]->ClearAttachedRouters ();
+    }
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetNVertices () const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_indexed, "The LSDB must be indexed");
+  return m_vertexLSAs.size ();
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetVertexIndex (Ipv4Address addr) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  NS_ASSERT_MSG (m_indexed, "The LSDB must be indexed");
+  std::vector<Ipv4Address>::const_iterator i = std::lower_bound (m_vertexIds.begin (), m_vertexIds.end (), addr);
+  if (i == m_vertexIds.end () || *i != addr)
+    {
+      return NO_VERTEX;
+    }
+  return i - m_vertexIds.begin ();
+}
+
+Ipv4Address
+GlobalRouteManagerLSDB::GetVertexId (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  return m_vertexIds[index];
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetVertexLSA (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  return m_vertexLSAs[index];
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetNLinks (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  return m_linkOffsets[index + 1] - m_linkOffsets[index];
+}
+
+const GlobalRouteManagerLSDB::Link&
+GlobalRouteManagerLSDB::GetLink (uint32_t index, uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << index << i);
+  return m_links[m_linkOffsets[index] + i];
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
 //
 // ---------------------------------------------------------------------------
 
+const uint64_t GlobalRouteManagerImpl::NO_DISTANCE;
+
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfRoot (GlobalRouteManagerLSDB::NO_VERTEX),
+    m_workerNodes (0),
+    m_routeFilter (0),
+    m_spfRoutes (0),
+    m_candidateOrder (0),
+    m_jobs (0),
+    m_firstJob (0),
+    m_jobStride (1)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -571,25 +812,7 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
-      Ptr<Node> node = *i;
-      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-      if (router == 0)
-        {
-          continue;
-        }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteRoutes (*i);
     }
   if (m_lsdb)
     {
@@ -597,6 +820,66 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
       delete m_lsdb;
       m_lsdb = new GlobalRouteManagerLSDB ();
     }
+  m_routerNodes.clear ();
+}
+
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+}
+
+Ptr<Node>
+GlobalRouteManagerImpl::GetRouterNode (Ipv4Address routerId)
+{
+  NS_LOG_FUNCTION (this << routerId);
+  if (m_workerNodes != 0)
+    {
+      std::map<Ipv4Address, Node *>::const_iterator i = m_workerNodes->find (routerId);
+      return i == m_workerNodes->end () ? 0 : i->second;
+    }
+  std::map<Ipv4Address, Ptr<Node> >::const_iterator i = m_routerNodes.find (routerId);
+  if (i == m_routerNodes.end ())
+    {
+//
+// Nodes are never removed from the simulation, so the cache only has to be
+// refreshed when a router is not found in it.
+//
+      m_routerNodes.clear ();
+      NodeList::Iterator listEnd = NodeList::End ();
+      for (NodeList::Iterator j = NodeList::Begin (); j != listEnd; j++)
+        {
+          Ptr<GlobalRouter> rtr = (*j)->GetObject<GlobalRouter> ();
+          if (rtr != 0)
+            {
+              m_routerNodes.insert (std::make_pair (rtr->GetRouterId (), *j));
+            }
+        }
+      i = m_routerNodes.find (routerId);
+      if (i == m_routerNodes.end ())
+        {
+          return 0;
+        }
+    }
+  return i->second;
 }
 
 //
@@ -612,6 +895,8 @@ void
 GlobalRouteManagerImpl::BuildGlobalRoutingDatabase () 
 {
   NS_LOG_FUNCTION (this);
+  SystemWallClockMs timer;
+  timer.Start ();
 //
 // Walk the list of nodes looking for the GlobalRouter Interface.  Nodes with
 // global router interfaces are, not too surprisingly, our routers.
@@ -656,6 +941,8 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
           m_lsdb->Insert (lsa->GetLinkStateId (), lsa); 
         }
     }
+  m_lsdb->BuildIndex ();
+  NS_LOG_INFO ("Built the routing database in " << timer.End () << " ms");
 }
 
 //
@@ -699,6 +986,9 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  SystemWallClockMs timer;
+  timer.Start ();
+  std::vector<SPFJob> jobs;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -723,278 +1013,753 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          jobs.push_back (SPFJob ());
+          jobs.back ().root = rtr->GetRouterId ();
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+  SPFCalculate (jobs);
+  NS_LOG_INFO ("Finished SPF calculation in " << timer.End () << " ms");
 }
 
 //
-// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
-// 16.1 (2) for further details.
-//
-// We're passed a parameter <v> that is a vertex which is already in the SPF
-// tree.  A vertex represents a router node.  We also get a reference to the
-// SPF candidate queue, which is a priority queue containing the shortest paths
-// to the networks we know about.
+// After a change of the topology, a new routing database is built and
+// compared with the previous one.  Only the point-to-point and stub link
+// records of the router LSAs are expected to change (links going up or down,
+// metric changes); any other change falls back to the computation of all the
+// routes.
 //
-// We examine the links in v's LSA and update the list of candidates with any
-// vertices not already on the list.  If a lower-cost path is found to a
-// vertex already on the candidate list, store the new (lower) cost.
+// A router whose shortest path tree uses a link that has changed, or which
+// may now use a new link, has its SPF recalculated.  For the other routers,
+// the tree is the same as before, so only their routes to the destinations
+// whose advertising routers have changed must be updated.
 //
 void
-GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+GlobalRouteManagerImpl::UpdateGlobalRoutes ()
 {
-  NS_LOG_FUNCTION (this << v << &candidate);
+  NS_LOG_FUNCTION (this);
+  std::vector<Ipv4Address> ids;
+  m_lsdb->GetLinkStateIds (ids);
+  if (ids.empty ())
+    {
+      NS_LOG_INFO ("No previous routing database, computing all the routes");
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+  SystemWallClockMs timer;
+  timer.Start ();
+  GlobalRouteManagerLSDB *oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
 
-  SPFVertex* w = 0;
-  GlobalRoutingLSA* w_lsa = 0;
-  GlobalRoutingLinkRecord *l = 0;
-  uint32_t distance = 0;
-  uint32_t numRecordsInVertex = 0;
-//
-// V points to a Router-LSA or Network-LSA
-// Loop over the links in router LSA or attached routers in Network LSA
-//
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
+  std::set<Ipv4Address> affected;
+  DestinationSet_t changed;
+  if (!FindChanges (oldLsdb, affected, changed))
     {
-      numRecordsInVertex = v->GetLSA ()->GetNLinkRecords (); 
+      NS_LOG_INFO ("The routes cannot be updated incrementally, computing all the routes");
+      delete oldLsdb;
+      NodeList::Iterator listEnd = NodeList::End ();
+      for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+        {
+          DeleteRoutes (*i);
+        }
+      InitializeRoutes ();
+      return;
     }
-  if (v->GetVertexType () == SPFVertex::VertexNetwork)
+//
+// Sort the destinations of the changed link records by how the routes of the
+// other routers to them are updated:
+//  - the destinations that are no longer advertised are removed;
+//  - a network advertised by two routers, and now only by one of them (a
+//    point-to-point link with one side down), is updated by removing the
+//    routes through the other router, which are the same as its routes to
+//    an unchanged host address of that router;
+//  - the routes to the other destinations are recalculated by an SPF
+//    calculation which stops when their advertising routers are in the tree.
+//
+  DestinationMap_t oldDestinations;
+  DestinationMap_t newDestinations;
+  GetDestinations (oldLsdb, oldDestinations);
+  GetDestinations (m_lsdb, newDestinations);
+  delete oldLsdb;
+  DestinationSet_t removed;
+  DestinationSet_t recalculated;
+  std::set<Ipv4Address> targets;
+  std::vector<std::pair<Destination_t, Destination_t> > withdrawn; // the network and the host address
+  std::vector<Ipv4Address> remaining; // the router still advertising each withdrawn network
+  for (DestinationSet_t::const_iterator i = changed.begin (); i != changed.end (); i++)
     {
-      numRecordsInVertex = v->GetLSA ()->GetNAttachedRouters (); 
+      std::vector<Advertiser_t> before = oldDestinations[*i];
+      std::vector<Advertiser_t> after = newDestinations[*i];
+      std::sort (before.begin (), before.end ());
+      std::sort (after.begin (), after.end ());
+      if (before == after)
+        {
+          continue;
+        }
+      if (after.empty ())
+        {
+          removed.insert (*i);
+          continue;
+        }
+      if (before.size () == 2 && after.size () == 1 && 
+          before[0].second == GlobalRoutingLinkRecord::StubNetwork &&
+          before[1].second == GlobalRoutingLinkRecord::StubNetwork &&
+          (after[0] == before[0] || after[0] == before[1]))
+        {
+          Ipv4Address withdrawing = after[0] == before[0] ? before[1].first : before[0].first;
+          uint32_t index = m_lsdb->GetVertexIndex (withdrawing);
+          for (uint32_t j = 0; j < m_lsdb->GetNLinks (index); j++)
+            {
+              const GlobalRouteManagerLSDB::Link &link = m_lsdb->GetLink (index, j);
+              if (link.type != GlobalRoutingLinkRecord::PointToPoint)
+                {
+                  continue;
+                }
+              Destination_t host (Ipv4Address (link.linkData), Ipv4Mask::GetOnes ().Get ());
+              std::vector<Advertiser_t> advertisers (1, Advertiser_t (withdrawing, GlobalRoutingLinkRecord::PointToPoint));
+              if (oldDestinations[host] == advertisers && newDestinations[host] == advertisers)
+                {
+                  withdrawn.push_back (std::make_pair (*i, host));
+                  remaining.push_back (after[0].first);
+                  break;
+                }
+            }
+          if (!withdrawn.empty () && withdrawn.back ().first == *i)
+            {
+              continue;
+            }
+        }
+      recalculated.insert (*i);
+      for (uint32_t j = 0; j < after.size (); j++)
+        {
+          targets.insert (after[j].first);
+        }
     }
 
-  for (uint32_t i = 0; i < numRecordsInVertex; i++)
+  uint32_t nRecalculated = 0;
+  uint32_t nTruncated = 0;
+  std::vector<SPFJob> jobs;
+  uint32_t systemId = Simulator::GetSystemId ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
-// Get w_lsa:  In case of V is Router-LSA
-      if (v->GetVertexType () == SPFVertex::VertexRouter) 
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      // Ignore nodes that are not assigned to our systemId (distributed sim)
+      if (node->GetSystemId () != systemId || !rtr || rtr->GetNumLSAs () == 0)
         {
-          NS_LOG_LOGIC ("Examining link " << i << " of " << 
-                        v->GetVertexId () << "'s " <<
-                        v->GetLSA ()->GetNLinkRecords () << " link records");
-//
-// (a) If this is a link to a stub network, examine the next link in V's LSA.
-// Links to stub networks will be considered in the second stage of the
-// shortest path calculation.
-//
-          l = v->GetLSA ()->GetLinkRecord (i);
-          NS_ASSERT (l != 0);
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+          continue;
+        }
+      Ipv4Address routerId = rtr->GetRouterId ();
+      if (affected.find (routerId) != affected.end ())
+        {
+          DeleteRoutes (node);
+          jobs.push_back (SPFJob ());
+          jobs.back ().root = routerId;
+          nRecalculated++;
+          continue;
+        }
+      Ptr<Ipv4GlobalRouting> gr = rtr->GetRoutingProtocol ();
+      for (DestinationSet_t::const_iterator j = removed.begin (); j != removed.end (); j++)
+        {
+          gr->RemoveRoutesTo (j->first, Ipv4Mask (j->second));
+        }
+      DestinationSet_t destinations = recalculated;
+      std::set<Ipv4Address> routerTargets = targets;
+      for (uint32_t j = 0; j < withdrawn.size (); j++)
+        {
+          Ipv4Address network = withdrawn[j].first.first;
+          Ipv4Mask mask (withdrawn[j].first.second);
+          std::vector<Ipv4RoutingTableEntry *> routes = gr->GetRoutesTo (network, mask);
+          std::vector<Ipv4RoutingTableEntry *> withdrawnRoutes = 
+            gr->GetRoutesTo (withdrawn[j].second.first, Ipv4Mask (withdrawn[j].second.second));
+//
+// The routes to the network are the routes through each of its two
+// advertising routers, in the order of the shortest path tree.  Those through
+// the withdrawing router are either first or last.
+//
+          std::vector<std::pair<Ipv4Address, uint32_t> > nextHops;
+          for (uint32_t k = 0; k < routes.size (); k++)
+            {
+              nextHops.push_back (std::make_pair (routes[k]->GetGateway (), routes[k]->GetInterface ()));
+            }
+          std::vector<std::pair<Ipv4Address, uint32_t> > withdrawnNextHops;
+          for (uint32_t k = 0; k < withdrawnRoutes.size (); k++)
             {
-              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
+              withdrawnNextHops.push_back (std::make_pair (withdrawnRoutes[k]->GetGateway (), withdrawnRoutes[k]->GetInterface ()));
+            }
+          uint32_t n = withdrawnNextHops.size ();
+          bool first = n <= nextHops.size () && 
+            std::equal (withdrawnNextHops.begin (), withdrawnNextHops.end (), nextHops.begin ());
+          bool last = n <= nextHops.size () && 
+            std::equal (withdrawnNextHops.begin (), withdrawnNextHops.end (), nextHops.end () - n);
+          if (first && last && 
+              !std::equal (nextHops.begin () + n, nextHops.end (), nextHops.begin ()))
+            {
+              first = false;
+              last = false;
+            }
+          if (!first && !last)
+            {
+              destinations.insert (withdrawn[j].first);
+              routerTargets.insert (remaining[j]);
               continue;
             }
-//
-// (b) Otherwise, W is a transit vertex (router or transit network).  Look up
-// the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
-// database. 
-//
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+          gr->RemoveRoutesTo (network, mask);
+          std::vector<std::pair<Ipv4Address, uint32_t> >::const_iterator k = nextHops.begin ();
+          std::vector<std::pair<Ipv4Address, uint32_t> >::const_iterator end = nextHops.end ();
+          if (first)
             {
-//
-// Lookup the link state advertisement of the new link -- we call it <w> in
-// the link state database.
-//
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a P2P record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+              k += n;
             }
-          else if (l->GetLinkType () == 
-                   GlobalRoutingLinkRecord::TransitNetwork)
+          else
             {
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a Transit record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+              end -= n;
             }
-          else 
+          for (; k != end; k++)
             {
-              NS_ASSERT_MSG (0, "illegal Link Type");
+              gr->AddNetworkRouteTo (network, mask, k->first, k->second);
             }
         }
-// Get w_lsa:  In case of V is Network-LSA
-      if (v->GetVertexType () == SPFVertex::VertexNetwork) 
+      if (!destinations.empty ())
         {
-          w_lsa = m_lsdb->GetLSAByLinkData 
-              (v->GetLSA ()->GetAttachedRouter (i));
-          if (!w_lsa)
+          for (DestinationSet_t::const_iterator j = destinations.begin (); j != destinations.end (); j++)
             {
-              continue;
+              gr->RemoveRoutesTo (j->first, Ipv4Mask (j->second));
             }
-          NS_LOG_LOGIC ("Found a Network LSA from " << 
-                        v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+          jobs.push_back (SPFJob ());
+          jobs.back ().root = routerId;
+          jobs.back ().destinations.swap (destinations);
+          jobs.back ().targets.swap (routerTargets);
+          nTruncated++;
+        }
+    }
+  SPFCalculate (jobs);
+  NS_LOG_INFO ("Updated the routes in " << timer.End () << " ms: " << 
+               nRecalculated << " routers recalculated, " << 
+               nTruncated << " routers partially recalculated, " << 
+               removed.size () << " destinations removed");
+}
+
+bool
+GlobalRouteManagerImpl::FindChanges (GlobalRouteManagerLSDB *oldLsdb, std::set<Ipv4Address> &routers,
+                                     DestinationSet_t &destinations)
+{
+  NS_LOG_FUNCTION (this << oldLsdb);
+  std::vector<Ipv4Address> ids;
+  std::vector<Ipv4Address> oldIds;
+  m_lsdb->GetLinkStateIds (ids);
+  oldLsdb->GetLinkStateIds (oldIds);
+  if (ids != oldIds)
+    {
+      NS_LOG_LOGIC ("Routers or networks were added or removed");
+      return false;
+    }
+  if (m_lsdb->GetNumExtLSAs () != oldLsdb->GetNumExtLSAs ())
+    {
+      NS_LOG_LOGIC ("External routes were added or removed");
+      return false;
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA *lsa = m_lsdb->GetExtLSA (i);
+      GlobalRoutingLSA *oldLsa = oldLsdb->GetExtLSA (i);
+      if (lsa->GetLinkStateId () != oldLsa->GetLinkStateId () ||
+          lsa->GetNetworkLSANetworkMask () != oldLsa->GetNetworkLSANetworkMask () ||
+          lsa->GetAdvertisingRouter () != oldLsa->GetAdvertisingRouter ())
+        {
+          NS_LOG_LOGIC ("External routes have changed");
+          return false;
         }
+    }
 
-// Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
-//
-// (c) If vertex W is already on the shortest-path tree, examine the next
-// link in the LSA.
 //
-// If the link is to a router that is already in the shortest path first tree
-// then we have it covered -- ignore it.
+// Both databases have the same vertices, hence the same vertex indices.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+  GlobalRouteManagerLSDB *lsdbs[2] = { oldLsdb, m_lsdb };
+  std::map<uint32_t, std::vector<uint64_t> > distances[2];
+  for (uint32_t i = 0; i < ids.size (); i++)
+    {
+      GlobalRoutingLSA *lsa = m_lsdb->GetVertexLSA (i);
+      GlobalRoutingLSA *oldLsa = oldLsdb->GetVertexLSA (i);
+      uint32_t nLinks = m_lsdb->GetNLinks (i);
+      uint32_t nOldLinks = oldLsdb->GetNLinks (i);
+      if (lsa->GetLSType () != oldLsa->GetLSType ())
+        {
+          return false;
+        }
+      if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
         {
-          NS_LOG_LOGIC ("Skipping ->  LSA "<< 
-                        w_lsa->GetLinkStateId () << " already in SPF tree");
+          if (lsa->GetNetworkLSANetworkMask () != oldLsa->GetNetworkLSANetworkMask () ||
+              nLinks != nOldLinks)
+            {
+              NS_LOG_LOGIC ("Network " << ids[i] << " has changed");
+              return false;
+            }
+          for (uint32_t j = 0; j < nLinks; j++)
+            {
+              if (m_lsdb->GetLink (i, j).linkId != oldLsdb->GetLink (i, j).linkId)
+                {
+                  NS_LOG_LOGIC ("Network " << ids[i] << " has changed");
+                  return false;
+                }
+            }
           continue;
         }
 //
-// (d) Calculate the link state cost D of the resulting path from the root to 
-// vertex W.  D is equal to the sum of the link state cost of the (already 
-// calculated) shortest path to vertex V and the advertised cost of the link
-// between vertices V and W.
+// Match the link records of the two LSAs.  The records present in both must
+// be in the same order, since it determines the order of the routes.
 //
-      if (v->GetLSA ()->GetLSType () == GlobalRoutingLSA::RouterLSA)
+      std::vector<bool> matched[2];
+      matched[0].resize (nOldLinks, false);
+      matched[1].resize (nLinks, false);
+      bool same = nLinks == nOldLinks;
+      uint32_t next = 0;
+      for (uint32_t j = 0; j < nOldLinks; j++)
         {
-          NS_ASSERT (l != 0);
-          distance = v->GetDistanceFromRoot () + l->GetMetric ();
+          const GlobalRouteManagerLSDB::Link &oldLink = oldLsdb->GetLink (i, j);
+          for (uint32_t k = 0; k < nLinks; k++)
+            {
+              const GlobalRouteManagerLSDB::Link &link = m_lsdb->GetLink (i, k);
+              if (matched[1][k] || link.type != oldLink.type ||
+                  link.linkId != oldLink.linkId ||
+                  link.linkData != oldLink.linkData ||
+                  link.metric != oldLink.metric)
+                {
+                  continue;
+                }
+              if (k < next)
+                {
+                  NS_LOG_LOGIC ("The link records of router " << ids[i] << " were reordered");
+                  return false;
+                }
+              matched[0][j] = true;
+              matched[1][k] = true;
+              next = k + 1;
+              break;
+            }
+          same = same && matched[0][j];
+        }
+      if (same)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("The link records of router " << ids[i] << " have changed");
+      routers.insert (ids[i]);
+      for (uint32_t side = 0; side < 2; side++)
+        {
+          for (uint32_t j = 0; j < lsdbs[side]->GetNLinks (i); j++)
+            {
+              if (matched[side][j])
+                {
+                  continue;
+                }
+              const GlobalRouteManagerLSDB::Link &link = lsdbs[side]->GetLink (i, j);
+              if (link.type == GlobalRoutingLinkRecord::PointToPoint)
+                {
+                  destinations.insert (Destination_t (Ipv4Address (link.linkData), Ipv4Mask::GetOnes ().Get ()));
+                  routers.insert (Ipv4Address (link.linkId));
+                  FindRoutersUsingLink (lsdbs[side], i, link.vertex, link.metric,
+                                        distances[side], routers);
+                }
+              else if (link.type == GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  Ipv4Mask mask (link.linkData);
+                  destinations.insert (Destination_t (Ipv4Address (link.linkId).CombineMask (mask), mask.Get ()));
+                }
+              else
+                {
+                  NS_LOG_LOGIC ("The transit link records of router " << ids[i] << " have changed");
+                  return false;
+                }
+            }
+        }
+    }
+  return true;
+}
+
+void
+GlobalRouteManagerImpl::GetDestinations (GlobalRouteManagerLSDB *lsdb, DestinationMap_t &destinations)
+{
+  NS_LOG_FUNCTION (this << lsdb);
+  for (uint32_t i = 0; i < lsdb->GetNVertices (); i++)
+    {
+      GlobalRoutingLSA *lsa = lsdb->GetVertexLSA (i);
+      Ipv4Address id = lsdb->GetVertexId (i);
+      if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          Ipv4Mask mask = lsa->GetNetworkLSANetworkMask ();
+          Destination_t network (id.CombineMask (mask), mask.Get ());
+          destinations[network].push_back (Advertiser_t (id, GlobalRoutingLinkRecord::TransitNetwork));
+          continue;
+        }
+      for (uint32_t j = 0; j < lsdb->GetNLinks (i); j++)
+        {
+          const GlobalRouteManagerLSDB::Link &link = lsdb->GetLink (i, j);
+          if (link.type == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              Destination_t host (Ipv4Address (link.linkData), Ipv4Mask::GetOnes ().Get ());
+              destinations[host].push_back (Advertiser_t (id, GlobalRoutingLinkRecord::PointToPoint));
+            }
+          else if (link.type == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              Ipv4Mask mask (link.linkData);
+              Destination_t network (Ipv4Address (link.linkId).CombineMask (mask), mask.Get ());
+              destinations[network].push_back (Advertiser_t (id, GlobalRoutingLinkRecord::StubNetwork));
+            }
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::FindRoutersUsingLink (GlobalRouteManagerLSDB *lsdb, uint32_t from,
+                                              uint32_t to, uint32_t metric,
+                                              std::map<uint32_t, std::vector<uint64_t> > &distances,
+                                              std::set<Ipv4Address> &routers)
+{
+  NS_LOG_FUNCTION (this << lsdb << from << to << metric);
+  if (to == GlobalRouteManagerLSDB::NO_VERTEX)
+    {
+      return;
+    }
+  if (distances.find (from) == distances.end ())
+    {
+      ComputeDistancesTo (lsdb, from, distances[from]);
+    }
+  if (distances.find (to) == distances.end ())
+    {
+      ComputeDistancesTo (lsdb, to, distances[to]);
+    }
+  const std::vector<uint64_t> &toFrom = distances[from];
+  const std::vector<uint64_t> &toTo = distances[to];
+  for (uint32_t i = 0; i < toFrom.size (); i++)
+    {
+      if (toFrom[i] != NO_DISTANCE && toTo[i] != NO_DISTANCE && toFrom[i] + metric == toTo[i])
+        {
+          routers.insert (lsdb->GetVertexId (i));
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::ComputeDistancesTo (GlobalRouteManagerLSDB *lsdb, uint32_t to,
+                                            std::vector<uint64_t> &distances)
+{
+  NS_LOG_FUNCTION (this << lsdb << to);
+//
+// The links of the SPF calculation (see SPFNext), reversed, in compressed
+// sparse row form.
+//
+  uint32_t nVertices = lsdb->GetNVertices ();
+  std::vector<uint32_t> offsets (nVertices + 1, 0);
+  for (uint32_t i = 0; i < nVertices; i++)
+    {
+      for (uint32_t j = 0; j < lsdb->GetNLinks (i); j++)
+        {
+          const GlobalRouteManagerLSDB::Link &link = lsdb->GetLink (i, j);
+          if (link.vertex != GlobalRouteManagerLSDB::NO_VERTEX)
+            {
+              offsets[link.vertex + 1]++;
+            }
+        }
+    }
+  for (uint32_t i = 0; i < nVertices; i++)
+    {
+      offsets[i + 1] += offsets[i];
+    }
+  std::vector<std::pair<uint32_t, uint32_t> > predecessors (offsets[nVertices]);
+  std::vector<uint32_t> next (offsets.begin (), offsets.end () - 1);
+  for (uint32_t i = 0; i < nVertices; i++)
+    {
+      for (uint32_t j = 0; j < lsdb->GetNLinks (i); j++)
+        {
+          const GlobalRouteManagerLSDB::Link &link = lsdb->GetLink (i, j);
+          if (link.vertex != GlobalRouteManagerLSDB::NO_VERTEX)
+            {
+              predecessors[next[link.vertex]++] = std::make_pair (i, link.metric);
+            }
+        }
+    }
+
+  typedef std::pair<uint64_t, uint32_t> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+  distances.assign (nVertices, NO_DISTANCE);
+  distances[to] = 0;
+  queue.push (Entry (0, to));
+  while (!queue.empty ())
+    {
+      Entry entry = queue.top ();
+      queue.pop ();
+      if (entry.first > distances[entry.second])
+        {
+          continue;
+        }
+      for (uint32_t i = offsets[entry.second]; i < offsets[entry.second + 1]; i++)
+        {
+          uint64_t distance = entry.first + predecessors[i].second;
+          if (distance < distances[predecessors[i].first])
+            {
+              distances[predecessors[i].first] = distance;
+              queue.push (Entry (distance, predecessors[i].first));
+            }
+        }
+    }
+}
+
+//
+// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
+// 16.1 (2) for further details.
+//
+// We're passed a parameter <v> that is a vertex which is already in the SPF
+// tree.  A vertex represents a router node.  The candidates are kept in a
+// priority queue containing the shortest paths to the networks we know
+// about.
+//
+// We examine the links of v and update the list of candidates with any
+// vertices not already on the list.  If a lower-cost path is found to a
+// vertex already on the candidate list, store the new (lower) cost.
+//
+void
+GlobalRouteManagerImpl::SPFNext (uint32_t v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  bool vIsRouter = m_lsdb->GetVertexLSA (v)->GetLSType () == GlobalRoutingLSA::RouterLSA;
+//
+// V is a Router-LSA or Network-LSA
+// Loop over the links in router LSA or attached routers in Network LSA, as
+// indexed by the LSDB.
+//
+  uint32_t numRecordsInVertex = m_lsdb->GetNLinks (v);
+
+  for (uint32_t i = 0; i < numRecordsInVertex; i++)
+    {
+      const GlobalRouteManagerLSDB::Link &link = m_lsdb->GetLink (v, i);
+      uint32_t w = link.vertex;
+// Get w:  In case of V is Router-LSA
+      if (vIsRouter) 
+        {
+          NS_LOG_LOGIC ("Examining link " << i << " of " << 
+                        m_lsdb->GetVertexId (v) << "'s " <<
+                        numRecordsInVertex << " link records");
+//
+// (a) If this is a link to a stub network, examine the next link in V's LSA.
+// Links to stub networks will be considered in the second stage of the
+// shortest path calculation.
+//
+          if (link.type == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              NS_LOG_LOGIC ("Found a Stub record to " << Ipv4Address (link.linkId));
+              continue;
+            }
+//
+// (b) Otherwise, W is a transit vertex (router or transit network).  Look up
+// the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
+// database. 
+//
+          NS_ASSERT_MSG (link.type == GlobalRoutingLinkRecord::PointToPoint ||
+                         link.type == GlobalRoutingLinkRecord::TransitNetwork,
+                         "illegal Link Type");
+          NS_ASSERT (w != GlobalRouteManagerLSDB::NO_VERTEX);
+          NS_LOG_LOGIC ("Found a P2P or Transit record from " << 
+                        m_lsdb->GetVertexId (v) << " to " << m_lsdb->GetVertexId (w));
         }
+// Get w:  In case of V is Network-LSA, skip the attached routers without LSA
       else
         {
-          distance = v->GetDistanceFromRoot ();
+          if (w == GlobalRouteManagerLSDB::NO_VERTEX)
+            {
+              continue;
+            }
+          NS_LOG_LOGIC ("Found a Network LSA from " << 
+                        m_lsdb->GetVertexId (v) << " to " << m_lsdb->GetVertexId (w));
+        }
+
+// Note:  w at this point may be either RouterLSA or NetworkLSA
+//
+// (c) If vertex W is already on the shortest-path tree, examine the next
+// link in the LSA.
+//
+// If the link is to a router that is already in the shortest path first tree
+// then we have it covered -- ignore it.
+//
+      SPFState &ws = m_spfState[w];
+      if (ws.status == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+        {
+          NS_LOG_LOGIC ("Skipping -> LSA " << 
+                        m_lsdb->GetVertexId (w) << " already in SPF tree");
+          continue;
+        }
+//
+// (d) Calculate the link state cost D of the resulting path from the root to 
+// vertex W.  D is equal to the sum of the link state cost of the (already 
+// calculated) shortest path to vertex V and the advertised cost of the link
+// between vertices V and W.
+//
+      uint32_t distance = m_spfState[v].distance;
+      if (vIsRouter)
+        {
+          distance += link.metric;
         }
 
-      NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
+      NS_LOG_LOGIC ("Considering w " << m_lsdb->GetVertexId (w));
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (ws.status == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
 // by <w>.  This will (among other things) find the next hop address to send
 // packets destined for this network to, and also find the outbound interface
 // used to forward the packets.
-
-// prepare vertex w
-          w = new SPFVertex (w_lsa);
-          if (SPFNexthopCalculation (v, w, l, distance))
-            {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+          SPFNexthopCalculation (v, w, vIsRouter ? &link : 0, ws.exits);
+          ws.distance = distance;
+          ws.parents.assign (1, v);
+          ws.status = GlobalRoutingLSA::LSA_SPF_CANDIDATE;
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
 //
-              candidate.Push (w);
-              NS_LOG_LOGIC ("Pushing " << 
-                            w->GetVertexId () << ", parent vertexId: " <<
-                            v->GetVertexId () << ", distance: " <<
-                            w->GetDistanceFromRoot ());
-            }
-          else
-            NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
-                           << "return false, but it does now!");
+          SPFPushCandidate (w);
+          NS_LOG_LOGIC ("Pushing " << 
+                        m_lsdb->GetVertexId (w) << ", parent vertexId: " <<
+                        m_lsdb->GetVertexId (v) << ", distance: " << distance);
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (ws.status == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
-// We have already considered the link represented by <w>.  What wse have to
+// We have already considered the link represented by <w>.  What we have to
 // do now is to decide if this new router represents a route with a shorter
 // distance metric.
 //
-// So, locate the vertex in the candidate queue and take a look at the 
-// distance.
-
 /* (quagga-0.98.6) W is already on the candidate list; call it cw.
 * Compare the previously calculated cost (cw->distance)
 * with the cost we just determined (w->distance) to see
 * if we've found a shorter path.
 */
-          SPFVertex* cw;
-          cw = candidate.Find (w_lsa->GetLinkStateId ());
-          if (cw->GetDistanceFromRoot () < distance)
+          if (ws.distance < distance)
             {
 //
 // This is not a shorter path, so don't do anything.
 //
               continue;
             }
-          else if (cw->GetDistanceFromRoot () == distance)
+          else if (ws.distance == distance)
             {
 //
 // This path is one with an equal cost.
 //
               NS_LOG_LOGIC ("Equal cost multiple paths found.");
-
-// At this point, there are two instances 'w' and 'cw' of the
-// same vertex, the vertex that is currently being considered
-// for adding into the shortest path tree. 'w' is the instance
-// as seen from the root via vertex 'v', and 'cw' is the instance 
-// as seen from the root via some other vertices other than 'v'.
-// These two instances are being merged in the following code.
-// In particular, the parent nodes, the next hops, and the root's
-// output interfaces of the two instances are being merged.
-// 
-// Note that this is functionally equivalent to calling
-// ospf_nexthop_merge (cw->nexthop, w->nexthop) in quagga-0.98.6
-// (ospf_spf.c::859), although the detail implementation
-// is very different from quagga (blame ns3::GlobalRouteManagerImpl)
-
-// prepare vertex w
-              w = new SPFVertex (w_lsa);
-              SPFNexthopCalculation (v, w, l, distance);
-              cw->MergeRootExitDirections (w);
-              cw->MergeParent (w);
-// SPFVertexAddParent (w) is necessary as the destructor of 
-// SPFVertex checks if the vertex and its parent is linked
-// bidirectionally
-              SPFVertexAddParent (w);
-              delete w;
+//
+// The parents, the next hops and the root's output interfaces of the paths
+// through <v> are merged with those of the other paths.  This is
+// functionally equivalent to calling ospf_nexthop_merge (cw->nexthop,
+// w->nexthop) in quagga-0.98.6 (ospf_spf.c::859).
+//
+              SPFNexthopCalculation (v, w, vIsRouter ? &link : 0, m_exits);
+              ws.exits.insert (ws.exits.end (), m_exits.begin (), m_exits.end ());
+              std::sort (ws.exits.begin (), ws.exits.end ());
+              ws.exits.erase (std::unique (ws.exits.begin (), ws.exits.end ()), ws.exits.end ());
+              if (std::find (ws.parents.begin (), ws.parents.end (), v) == ws.parents.end ())
+                {
+                  ws.parents.push_back (v);
+                }
             }
-          else // cw->GetDistanceFromRoot () > w->GetDistanceFromRoot ()
+          else // ws.distance > distance
             {
 // 
 // this path represents a new, lower-cost path to <w> (the vertex we found in
 // the current link record of the link state advertisement of the current root
-// (vertex <v>)
-//
-// N.B. the nexthop_calculation is conditional, if it finds a valid nexthop
-// it will call spf_add_parents, which will flush the old parents
-//
-              if (SPFNexthopCalculation (v, cw, l, distance))
-                {
-//
-// If we've changed the cost to get to the vertex represented by <w>, we 
-// must reorder the priority queue keyed to that cost.
+// (vertex <v>).  The previous parents are flushed, and the vertex is pushed
+// again with its new cost, the previous entry being skipped when popped.
 //
-                  candidate.Reorder ();
-                }
+              SPFNexthopCalculation (v, w, vIsRouter ? &link : 0, ws.exits);
+              ws.distance = distance;
+              ws.parents.assign (1, v);
+              SPFPushCandidate (w);
             } // new lower cost path found
         } // end W is already on the candidate list
     } // end loop over the links in V's LSA
 }
 
 //
-// This method is derived from quagga ospf_nexthop_calculation() 16.1.1.
+// A candidate is popped first if its distance is smaller; in case of a tie,
+// networks are popped before routers, in order to find all the equal-cost
+// paths, then the candidates are popped in the order they were pushed.
+//
+bool
+GlobalRouteManagerImpl::SPFCandidateAfter (const SPFCandidate &c1, const SPFCandidate &c2)
+{
+  if (c1.distance != c2.distance)
+    {
+      return c1.distance > c2.distance;
+    }
+  if (c1.network != c2.network)
+    {
+      return c2.network;
+    }
+  return c1.order > c2.order;
+}
+
+void
+GlobalRouteManagerImpl::SPFPushCandidate (uint32_t v)
+{
+  NS_LOG_FUNCTION (this << v);
+  SPFCandidate candidate;
+  candidate.distance = m_spfState[v].distance;
+  candidate.network = m_lsdb->GetVertexLSA (v)->GetLSType () == GlobalRoutingLSA::NetworkLSA;
+  candidate.order = m_candidateOrder++;
+  candidate.vertex = v;
+  m_spfState[v].order = candidate.order;
+  m_candidates.push_back (candidate);
+  std::push_heap (m_candidates.begin (), m_candidates.end (), &GlobalRouteManagerImpl::SPFCandidateAfter);
+}
+
+uint32_t
+GlobalRouteManagerImpl::SPFPopCandidate (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_candidates.empty ())
+    {
+      SPFCandidate candidate = m_candidates.front ();
+      std::pop_heap (m_candidates.begin (), m_candidates.end (), &GlobalRouteManagerImpl::SPFCandidateAfter);
+      m_candidates.pop_back ();
+//
+// A candidate pushed again at a lower cost leaves its previous entry in the
+// queue.
+//
+      if (m_spfState[candidate.vertex].status == GlobalRoutingLSA::LSA_SPF_CANDIDATE &&
+          m_spfState[candidate.vertex].order == candidate.order)
+        {
+          return candidate.vertex;
+        }
+    }
+  return GlobalRouteManagerLSDB::NO_VERTEX;
+}
+
 //
-// Calculate nexthop from root through V (parent) to vertex W (destination)
-// with given distance from root->W.
+// This method is derived from quagga ospf_nexthop_calculation() 16.1.1.
 //
-// As appropriate, set w's parent, distance, and nexthop information
+// Calculate nexthop from root through V (parent) to vertex W (destination).
+// The caller sets the distance and the parents of W.
 //
 // For now, this is greatly simplified from the quagga code
 //
-int
+void
 GlobalRouteManagerImpl::SPFNexthopCalculation (
-  SPFVertex* v, 
-  SPFVertex* w,
-  GlobalRoutingLinkRecord* l,
-  uint32_t distance)
+  uint32_t v, 
+  uint32_t w,
+  const GlobalRouteManagerLSDB::Link* l,
+  std::vector<SPFVertex::NodeExit_t> &exits)
 {
-  NS_LOG_FUNCTION (this << v << w << l << distance);
-//
-// If w is a NetworkVertex, l should be null
-/*
-  if (w->GetVertexType () == SPFVertex::VertexNetwork && l)
-    {
-        NS_ASSERT_MSG (0, "Error:  SPFNexthopCalculation parameter problem");
-    }
-*/
+  NS_LOG_FUNCTION (this << v << w << l);
+  exits.clear ();
+  bool wIsRouter = m_lsdb->GetVertexLSA (w)->GetLSType () == GlobalRoutingLSA::RouterLSA;
 
 //
-// The vertex m_spfroot is a distinguished vertex representing the node at
+// The vertex m_spfRoot is a distinguished vertex representing the node at
 // the root of the calculations.  That is, it is the node for which we are
 // calculating the routes.
 //
@@ -1016,7 +1781,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // The point-to-point link information is only useful in this calculation when
 // we are examining the root node. 
 //
-  if (v == m_spfroot)
+  if (v == m_spfRoot)
     {
 //
 // In this case <v> is the root node, which means it is the starting point
@@ -1026,105 +1791,82 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // node if this root node is a router.  We then need to see if this node <w>
 // is a router.
 //
-      if (w->GetVertexType () == SPFVertex::VertexRouter) 
+      if (wIsRouter) 
         {
 //
-// In the case of point-to-point links, the link data field (m_linkData) of a
-// Global Router Link Record contains the local IP address.  If we look at the
-// link record describing the link from the perspecive of <w> (the remote
-// node from the viewpoint of <v>) back to the root node, we can discover the
-// IP address of the router to which <v> is adjacent.  This is a distinguished
-// address -- the next hop address to get from <v> to <w> and all networks 
-// accessed through that path.
-//
-// SPFGetNextLink () is a little odd.  used in this way it is just going to
-// return the link record describing the link from <w> to <v>.  Think of it as
-// SPFGetLink.
+// In the case of point-to-point links, the link data field of a link
+// describing the link from the perspecive of <w> (the remote node from the
+// viewpoint of <v>) back to the root node is the IP address of the router to
+// which <v> is adjacent.  This is a distinguished address -- the next hop
+// address to get from <v> to <w> and all networks accessed through that path.
 //
           NS_ASSERT (l);
-          GlobalRoutingLinkRecord *linkRemote = 0;
-          linkRemote = SPFGetNextLink (w, v, linkRemote);
-// 
-// At this point, <l> is the Global Router Link Record describing the point-
-// to point link from <v> to <w> from the perspective of <v>; and <linkRemote>
-// is the Global Router Link Record describing that same link from the 
-// perspective of <w> (back to <v>).  Now we can just copy the next hop 
-// address from the m_linkData member variable.
-// 
-// The next hop member variable we put in <w> has the sense "in order to get
-// from the root node to the host represented by vertex <w>, you have to send
-// the packet to the next hop address specified in w->m_nextHop.
-//
-          Ipv4Address nextHop = linkRemote->GetLinkData ();
+          const GlobalRouteManagerLSDB::Link *linkRemote = SPFGetLink (w, v);
+          NS_ASSERT_MSG (linkRemote, "No link back from " << m_lsdb->GetVertexId (w) <<
+                         " to " << m_lsdb->GetVertexId (v));
+          Ipv4Address nextHop (linkRemote->linkData);
 // 
 // Now find the outgoing interface corresponding to the point to point link
 // from the perspective of <v> -- remember that <l> is the link "from"
 // <v> "to" <w>.
 //
-          uint32_t outIf = FindOutgoingInterfaceId (l->GetLinkData ());
+          uint32_t outIf = FindOutgoingInterfaceId (Ipv4Address (l->linkData));
 
-          w->SetRootExitDirection (nextHop, outIf);
-          w->SetDistanceFromRoot (distance);
-          w->SetParent (v);
+          exits.push_back (SPFVertex::NodeExit_t (nextHop, outIf));
           NS_LOG_LOGIC ("Next hop from " << 
-                        v->GetVertexId () << " to " << w->GetVertexId () <<
+                        m_lsdb->GetVertexId (v) << " to " << m_lsdb->GetVertexId (w) <<
                         " goes through next hop " << nextHop <<
-                        " via outgoing interface " << outIf <<
-                        " with distance " << distance);
+                        " via outgoing interface " << outIf);
         }  // end W is a router vertes
       else 
         {
-          NS_ASSERT (w->GetVertexType () == SPFVertex::VertexNetwork);
 // W is a directly connected network; no next hop is required
-          GlobalRoutingLSA* w_lsa = w->GetLSA ();
+          GlobalRoutingLSA* w_lsa = m_lsdb->GetVertexLSA (w);
           NS_ASSERT (w_lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA);
 // Find outgoing interface ID for this network
           uint32_t outIf = FindOutgoingInterfaceId (w_lsa->GetLinkStateId (), 
                                                     w_lsa->GetNetworkLSANetworkMask () );
 // Set the next hop to 0.0.0.0 meaning "not exist"
           Ipv4Address nextHop = Ipv4Address::GetZero ();
-          w->SetRootExitDirection (nextHop, outIf);
-          w->SetDistanceFromRoot (distance);
-          w->SetParent (v);
+          exits.push_back (SPFVertex::NodeExit_t (nextHop, outIf));
           NS_LOG_LOGIC ("Next hop from " << 
-                        v->GetVertexId () << " to network " << w->GetVertexId () <<
-                        " via outgoing interface " << outIf <<
-                        " with distance " << distance);
-          return 1;
+                        m_lsdb->GetVertexId (v) << " to network " << m_lsdb->GetVertexId (w) <<
+                        " via outgoing interface " << outIf);
         }
     } // end v is the root
-  else if (v->GetVertexType () == SPFVertex::VertexNetwork) 
+  else if (m_lsdb->GetVertexLSA (v)->GetLSType () == GlobalRoutingLSA::NetworkLSA) 
     {
-// See if any of v's parents are the root
-      if (v->GetParent () == m_spfroot)
-        {
 // 16.1.1 para 5. ...the parent vertex is a network that
 // directly connects the calculating router to the destination
 // router.  The list of next hops is then determined by
 // examining the destination's router-LSA...
-          NS_ASSERT (w->GetVertexType () == SPFVertex::VertexRouter);
-          GlobalRoutingLinkRecord *linkRemote = 0;
-          while ((linkRemote = SPFGetNextLink (w, v, linkRemote)))
+//
+// The exits of the root without next hop are those through the networks
+// which directly connect it to the destination.  For these, the link of the
+// destination back to the network provides the IP address of the next hop
+// router; the outgoing interface is inherited from the network.  The other
+// exits are inherited.
+//
+      NS_ASSERT (wIsRouter);
+      const std::vector<SPFVertex::NodeExit_t> &vExits = m_spfState[v].exits;
+      for (uint32_t i = 0; i < vExits.size (); i++)
+        {
+          SPFVertex::NodeExit_t exit = vExits[i];
+          if (exit.first == Ipv4Address::GetZero ())
             {
-/* ...For each link in the router-LSA that points back to the
- * parent network, the link's Link Data field provides the IP
- * address of a next hop router.  The outgoing interface to
- * use can then be derived from the next hop IP address (or 
- * it can be inherited from the parent network).
- */
-              Ipv4Address nextHop = linkRemote->GetLinkData ();
-              uint32_t outIf = v->GetRootExitDirection ().second;
-              w->SetRootExitDirection (nextHop, outIf);
+              const GlobalRouteManagerLSDB::Link *linkRemote = SPFGetLink (w, v);
+              NS_ASSERT_MSG (linkRemote, "No link back from " << m_lsdb->GetVertexId (w) <<
+                             " to " << m_lsdb->GetVertexId (v));
+              exit.first = Ipv4Address (linkRemote->linkData);
               NS_LOG_LOGIC ("Next hop from " <<
-                            v->GetVertexId () << " to " << w->GetVertexId () <<
-                            " goes through next hop " << nextHop <<
-                            " via outgoing interface " << outIf);
+                            m_lsdb->GetVertexId (v) << " to " << m_lsdb->GetVertexId (w) <<
+                            " goes through next hop " << exit.first <<
+                            " via outgoing interface " << exit.second);
             }
+          exits.push_back (exit);
         }
-      else 
-        {
-          w->SetRootExitDirection (v->GetRootExitDirection ());
-        }
+      std::sort (exits.begin (), exits.end ());
+      exits.erase (std::unique (exits.begin (), exits.end ()), exits.end ());
     }
   else 
     {
@@ -1141,99 +1883,32 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // (shortest) paths.  So the next hop and outoing interface remain the same
 // (are inherited).
 //
-      w->InheritAllRootExitDirections (v);
+      exits = m_spfState[v].exits;
     }
-//
-// In all cases, we need valid values for the distance metric and a parent.
-//
-  w->SetDistanceFromRoot (distance);
-  w->SetParent (v);
-
-  return 1;
 }
 
 //
 // This method is derived from quagga ospf_get_next_link ()
 //
-// First search the Global Router Link Records of vertex <v> for one
-// representing a point-to point link to vertex <w>.
-//
-// What is done depends on prev_link.  Contrary to appearances, prev_link just
-// acts as a flag here.  If prev_link is NULL, we return the first Global
-// Router Link Record we find that describes a point-to-point link from <v> 
-// to <w>.  If prev_link is not NULL, we return a Global Router Link Record
-// representing a possible *second* link from <v> to <w>.
+// Search the links of vertex <v> for the first one whose link ID is the link
+// state ID of vertex <w>.  The link ID of a link record representing a
+// point-to-point link is set to the router ID of the neighboring router, and
+// the link ID of a link record representing a link to a transit network is
+// set to the link state ID of the network.
 //
-GlobalRoutingLinkRecord*
-GlobalRouteManagerImpl::SPFGetNextLink (
-  SPFVertex* v,
-  SPFVertex* w,
-  GlobalRoutingLinkRecord* prev_link) 
+const GlobalRouteManagerLSDB::Link*
+GlobalRouteManagerImpl::SPFGetLink (uint32_t v, uint32_t w) const
 {
-  NS_LOG_FUNCTION (this << v << w << prev_link);
-
-  bool skip = true;
-  bool found_prev_link = false;
-  GlobalRoutingLinkRecord* l;
-//
-// If prev_link is 0, we are really looking for the first link, not the next 
-// link.
-//
-  if (prev_link == 0)
-    {
-      skip = false;
-      found_prev_link = true;
-    }
-//
-// Iterate through the Global Router Link Records advertised by the vertex
-// <v> looking for records representing the point-to-point links off of this
-// vertex.
-//
-  for (uint32_t i = 0; i < v->GetLSA ()->GetNLinkRecords (); ++i)
+  NS_LOG_FUNCTION (this << v << w);
+  uint32_t id = m_lsdb->GetVertexId (w).Get ();
+  for (uint32_t i = 0; i < m_lsdb->GetNLinks (v); ++i)
     {
-      l = v->GetLSA ()->GetLinkRecord (i);
-//
-// The link ID of a link record representing a point-to-point link is set to
-// the router ID of the neighboring router -- the router to which the link
-// connects from the perspective of <v> in this case.  The vertex ID is also
-// set to the router ID (using the link state advertisement of a router node).
-// We're just checking to see if the link <l> is actually the link from <v> to
-// <w>.
-//
-      if (l->GetLinkId () == w->GetVertexId ()) 
+      const GlobalRouteManagerLSDB::Link &l = m_lsdb->GetLink (v, i);
+      if (l.linkId == id) 
         {
-          if (!found_prev_link)
-            {
-              NS_LOG_LOGIC ("Skipping links before prev_link found");
-              found_prev_link = true;
-              continue;
-            }
-
           NS_LOG_LOGIC ("Found matching link l:  linkId = " <<
-                        l->GetLinkId () << " linkData = " << l->GetLinkData ());
-//
-// If skip is false, don't (not too surprisingly) skip the link found -- it's 
-// the one we're interested in.  That's either because we didn't pass in a 
-// previous link, and we're interested in the first one, or because we've 
-// skipped a previous link and moved forward to the next (which is then the
-// one we want).
-//
-          if (skip == false)
-            {
-              NS_LOG_LOGIC ("Returning the found link");
-              return l;
-            }
-          else
-            {
-//
-// Skip is true and we've found a link from <v> to <w>.  We want the next one.
-// Setting skip to false gets us the next point-to-point global router link
-// record in the LSA from <v>.
-//
-              NS_LOG_LOGIC ("Skipping the found link");
-              skip = false;
-              continue;
-            }
+                        Ipv4Address (l.linkId) << " linkData = " << Ipv4Address (l.linkData));
+          return &l;
         }
     }
   return 0;
@@ -1259,22 +1934,21 @@ bool
 GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
-  GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (root);
-  Ipv4Address myRouterId = rlsa->GetLinkStateId ();
+  uint32_t rootIndex = m_lsdb->GetVertexIndex (root);
   int transits = 0;
-  GlobalRoutingLinkRecord *transitLink = 0;
-  for (uint32_t i = 0; i < rlsa->GetNLinkRecords (); i++)
+  const GlobalRouteManagerLSDB::Link *transitLink = 0;
+  for (uint32_t i = 0; i < m_lsdb->GetNLinks (rootIndex); i++)
     {
-      GlobalRoutingLinkRecord *l = rlsa->GetLinkRecord (i);
-      if (l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+      const GlobalRouteManagerLSDB::Link &l = m_lsdb->GetLink (rootIndex, i);
+      if (l.type == GlobalRoutingLinkRecord::TransitNetwork)
         {
           transits++;
-          transitLink = l;
+          transitLink = &l;
         }
-      else if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+      else if (l.type == GlobalRoutingLinkRecord::PointToPoint)
         {
           transits++;
-          transitLink = l;
+          transitLink = &l;
         }
     }
   if (transits == 0)
@@ -1287,7 +1961,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
     }
   if (transits == 1)
     {
-      if (transitLink->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+      if (transitLink->type == GlobalRoutingLinkRecord::TransitNetwork)
         {
           // Install default route to next hop router
           // What is the next hop?  We need to check all neighbors on the link.
@@ -1298,36 +1972,40 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
           NS_LOG_LOGIC ("TBD: Would have inserted default for transit");
           return false;
         }
-      else if (transitLink->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+      else if (transitLink->type == GlobalRoutingLinkRecord::PointToPoint)
         {
           // Install default route to next hop
           // The link record LinkID is the router ID of the peer.
           // The Link Data is the local IP interface address
-          GlobalRoutingLSA *w_lsa = m_lsdb->GetLSA (transitLink->GetLinkId ());
-          uint32_t nLinkRecords = w_lsa->GetNLinkRecords ();
+          uint32_t w = transitLink->vertex;
+          NS_ASSERT (w != GlobalRouteManagerLSDB::NO_VERTEX);
+          uint32_t nLinkRecords = m_lsdb->GetNLinks (w);
           for (uint32_t j = 0; j < nLinkRecords; ++j)
             {
               //
               // We are only concerned about point-to-point links
               //
-              GlobalRoutingLinkRecord *lr = w_lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+              const GlobalRouteManagerLSDB::Link &lr = m_lsdb->GetLink (w, j);
+              if (lr.type != GlobalRoutingLinkRecord::PointToPoint)
                 {
                   continue;
                 }
               // Find the link record that corresponds to our routerId
-              if (lr->GetLinkId () == myRouterId)
+              if (lr.linkId == root.Get ())
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
+                  Ptr<GlobalRouter> router = GetRouterNode (root)->GetObject<GlobalRouter> ();
                   NS_ASSERT (router);
                   Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
                   NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
-                  NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
-                                lr->GetLinkData () << " via interface " << 
-                                FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  if (IsRouteAllowed (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0")))
+                    {
+                      AddRoute (gr, SPFRoute::NETWORK, Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), Ipv4Address (lr.linkData), 
+                                FindOutgoingInterfaceId (Ipv4Address (transitLink->linkData)));
+                      NS_LOG_LOGIC ("Inserting default route for node " << root << " to next hop " << 
+                                    Ipv4Address (lr.linkData) << " via interface " << 
+                                    FindOutgoingInterfaceId (Ipv4Address (transitLink->linkData)));
+                    }
                   return true;
                 }
             }
@@ -1342,31 +2020,42 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Index the Link State Database, if not done yet, and reset the state of its
+// vertices.  The arrays are kept from one root to the next, so that their
+// vectors are only allocated by the first calculations.
 //
-  m_lsdb->Initialize ();
+  m_lsdb->BuildIndex ();
+  uint32_t v = m_lsdb->GetVertexIndex (root);
+  NS_ASSERT_MSG (v != GlobalRouteManagerLSDB::NO_VERTEX, "No LSA for the root " << root);
+  m_spfState.resize (m_lsdb->GetNVertices ());
+  for (std::vector<SPFState>::iterator i = m_spfState.begin (); i != m_spfState.end (); i++)
+    {
+      i->status = GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED;
+      i->processed = false;
+      i->exits.clear ();
+      i->parents.clear ();
+      i->children.clear ();
+    }
 //
-// The candidate queue is a priority queue of SPFVertex objects, with the top
-// of the queue being the closest vertex in terms of distance from the root
-// of the tree.  Initially, this queue is empty.
+// The candidate queue is a priority queue of vertices, with the top of the
+// queue being the closest vertex in terms of distance from the root of the
+// tree.  Initially, this queue is empty.
 //
-  CandidateQueue candidate;
-  NS_ASSERT (candidate.Size () == 0);
+  m_candidates.clear ();
+  m_candidateOrder = 0;
 //
 // Initialize the shortest-path tree to only contain the router doing the 
 // calculation.  Each router (and corresponding network) is a vertex in the
 // shortest path first (SPF) tree.
-//
-  v = new SPFVertex (m_lsdb->GetLSA (root));
 // 
 // This vertex is the root of the SPF tree and it is distance 0 from the root.
 // We also mark this vertex as being in the SPF tree.
 //
-  m_spfroot= v;
-  v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  m_spfRoot = v;
+  m_spfRootId = root;
+  m_spfState[v].distance = 0;
+  m_spfState[v].status = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1376,10 +2065,10 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (GetRouterNode (root) != 0 && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
-      delete m_spfroot;
+      m_spfRoot = GlobalRouteManagerLSDB::NO_VERTEX;
       return;
     }
 
@@ -1391,15 +2080,14 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
 // RFC2328 16.1. (2). 
 //
-// We examine the Global Router Link Records in the Link State 
-// Advertisements of the current vertex.  If there are any point-to-point
-// links to unexplored adjacent vertices we add them to the tree and update
-// the distance and next hop information on how to get there.  We also add
-// the new vertices to the candidate queue (the priority queue ordered by
-// shortest path).  If the new vertices represent shorter paths, we use them
-// and update the path cost.
+// We examine the links of the current vertex.  If there are any
+// point-to-point links to unexplored adjacent vertices we add them to the
+// tree and update the distance and next hop information on how to get
+// there.  We also add the new vertices to the candidate queue (the priority
+// queue ordered by shortest path).  If the new vertices represent shorter
+// paths, we use them and update the path cost.
 //
-      SPFNext (v, candidate);
+      SPFNext (v);
 //
 // RFC2328 16.1. (3). 
 //
@@ -1407,33 +2095,26 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // transit vertices) has been completely built and this stage of the
 // procedure terminates. 
 //
-      if (candidate.Size () == 0)
+// Otherwise, choose the vertex belonging to the candidate list that is
+// closest to the root, and add it to the shortest-path tree (removing it
+// from the candidate list in the process).
+//
+      v = SPFPopCandidate ();
+      if (v == GlobalRouteManagerLSDB::NO_VERTEX)
         {
           break;
         }
-//
-// Choose the vertex belonging to the candidate list that is closest to the
-// root, and add it to the shortest-path tree (removing it from the candidate
-// list in the process).
-//
-// Recall that in the previous step, we created SPFVertex structures for each
-// of the routers found in the Global Router Link Records and added tehm to 
-// the candidate list.
-//
-      NS_LOG_LOGIC (candidate);
-      v = candidate.Pop ();
-      NS_LOG_LOGIC ("Popped vertex " << v->GetVertexId ());
+      NS_LOG_LOGIC ("Popped vertex " << m_lsdb->GetVertexId (v));
 //
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      m_spfState[v].status = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
 //
-// The current vertex has a parent pointer.  By calling this rather oddly 
-// named method (blame quagga) we add the current vertex to the list of 
-// children of that parent vertex.  In the next hop calculation called during
-// SPFNext, the parent pointer was set but the vertex has been orphaned up
-// to now.
+// The current vertex has its parents.  By calling this rather oddly named
+// method (blame quagga) we add the current vertex to the list of children of
+// its parents.  In the next hop calculation called during SPFNext, the
+// parents were set but the vertex has been orphaned up to now.
 //
       SPFVertexAddParent (v);
 //
@@ -1443,93 +2124,234 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
 // RFC2328 16.1. (4). 
 //
-// This is the method that actually adds the routes.  It'll walk the list
-// of nodes in the system, looking for the node corresponding to the router
-// ID of the root of the tree -- that is the router we're building the routes
-// for.  It looks for the Ipv4 interface of that node and remembers it.  So
-// we are only actually adding routes to that one node at the root of the SPF 
-// tree.
-//
-// We're going to pop of a pointer to every vertex in the tree except the 
-// root in order of distance from the root.  For each of the vertices, we call
-// SPFIntraAddRouter ().  Down in SPFIntraAddRouter, we look at all of the 
-// point-to-point Global Router Link Records (the links to nodes adjacent to
-// the node represented by the vertex).  We add a route to the IP address 
-// specified by the m_linkData field of each of those link records.  This will
-// be the *local* IP address associated with the interface attached to the 
-// link.  We use the outbound interface and next hop information present in 
-// the vertex <v> which have possibly been inherited from the root.
-//
-// To summarize, we're going to look at the node represented by <v> and loop
-// through its point-to-point links, adding a *host* route to the local IP
-// address (at the <v> side) for each of those links.
-//
-      if (v->GetVertexType () == SPFVertex::VertexRouter)
+// This is the method that actually adds the routes.  It'll look up the
+// node corresponding to the router ID of the root of the tree -- that is the
+// router we're building the routes for.  So we are only actually adding
+// routes to that one node at the root of the SPF tree.
+//
+// We're going to pop every vertex in the tree except the root in order of
+// distance from the root.  For each of the router vertices, we call
+// SPFIntraAddRouter ().  Down in SPFIntraAddRouter, we look at all of the
+// point-to-point links of the vertex (the links to nodes adjacent to the
+// node represented by the vertex).  We add a host route to the *local* IP
+// address of each of those links, using the outbound interfaces and next
+// hops of the exits of the vertex, which have possibly been inherited from
+// the root.
+//
+      if (m_lsdb->GetVertexLSA (v)->GetLSType () == GlobalRoutingLSA::RouterLSA)
         {
           SPFIntraAddRouter (v);
         }
-      else if (v->GetVertexType () == SPFVertex::VertexNetwork)
-        {
-          SPFIntraAddTransit (v);
-        }
       else
         {
-          NS_ASSERT_MSG (0, "illegal SPFVertex type");
+          SPFIntraAddTransit (v);
         }
 //
 // RFC2328 16.1. (5). 
 //
 // Iterate the algorithm by returning to Step 2 until there are no more
 // candidate vertices.
-
-    }  // end for loop
-
-// Second stage of SPF calculation procedure
-  SPFProcessStubs (m_spfroot);
-  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
-    {
-      m_spfroot->ClearVertexProcessed ();
+//
+// When only some destinations are calculated, stop as soon as the vertices
+// advertising them are in the tree.
+//
+      if (m_routeFilter != 0)
+        {
+          m_spfTargets.erase (m_lsdb->GetVertexId (v));
+          if (m_spfTargets.empty ())
+            {
+              NS_LOG_LOGIC ("SPFCalculate truncated after the advertising vertices");
+              m_candidates.clear ();
+              break;
+            }
+        }
+    }  // end for loop
+
+// Second stage of SPF calculation procedure
+  SPFProcessStubs (m_spfRoot);
+//
+// The external routes go through the router advertising them, which is looked
+// up directly instead of searching the whole tree for it.
+//
+  for (uint32_t i = 0; m_routeFilter == 0 && i < m_lsdb->GetNumExtLSAs (); i++)
+    {
       GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
       NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId ());
-      ProcessASExternals (m_spfroot, extlsa);
+      uint32_t index = m_lsdb->GetVertexIndex (extlsa->GetAdvertisingRouter ());
+      if (index != GlobalRouteManagerLSDB::NO_VERTEX &&
+          m_spfState[index].status == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE &&
+          m_lsdb->GetVertexLSA (index)->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          SPFAddASExternal (extlsa, index);
+        }
     }
 
 //
 // We're all done setting the routing information for the node at the root of
-// the SPF tree.  Delete all of the vertices and corresponding resources.  Go
-// possibly do it again for the next router.
+// the SPF tree.  The state of the vertices is kept for the next root.
 //
-  delete m_spfroot;
-  m_spfroot = 0;
+  m_spfRoot = GlobalRouteManagerLSDB::NO_VERTEX;
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root, const DestinationSet_t &destinations,
+                                      const std::set<Ipv4Address> &targets)
+{
+  NS_LOG_FUNCTION (this << root);
+  m_routeFilter = &destinations;
+  m_spfTargets = targets;
+  m_spfTargets.erase (root);
+  SPFCalculate (root);
+  m_routeFilter = 0;
+  m_spfTargets.clear ();
 }
 
 void
-GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa)
+GlobalRouteManagerImpl::SPFCalculate (std::vector<SPFJob> &jobs)
 {
-  NS_LOG_FUNCTION (this << v << extlsa);
-  NS_LOG_LOGIC ("Processing external for destination " << 
-                extlsa->GetLinkStateId () <<
-                ", for router "  << v->GetVertexId () <<
-                ", advertised by " << extlsa->GetAdvertisingRouter ());
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
+  NS_LOG_FUNCTION (this << jobs.size ());
+  UintegerValue threads;
+  g_globalRoutingThreads.GetValue (threads);
+  uint32_t nWorkers = std::min<uint32_t> (threads.Get (), jobs.size ());
+#ifndef HAVE_PTHREAD_H
+  nWorkers = 1;
+#endif
+  if (nWorkers <= 1)
     {
-      GlobalRoutingLSA *rlsa = v->GetLSA ();
-      NS_LOG_LOGIC ("Processing router LSA with id " << rlsa->GetLinkStateId ());
-      if ((rlsa->GetLinkStateId ()) == (extlsa->GetAdvertisingRouter ()))
+      for (std::vector<SPFJob>::const_iterator i = jobs.begin (); i != jobs.end (); i++)
         {
-          NS_LOG_LOGIC ("Found advertising router to destination");
-          SPFAddASExternal (extlsa,v);
+          if (i->destinations.empty ())
+            {
+              SPFCalculate (i->root);
+            }
+          else
+            {
+              SPFCalculate (i->root, i->destinations, i->targets);
+            }
         }
+      return;
     }
-  for (uint32_t i = 0; i < v->GetNChildren (); i++)
+#ifdef HAVE_PTHREAD_H
+//
+// The nodes of the roots are looked up before the threads start, since the
+// worker threads must not touch the node list.  The reference counts of the
+// objects are not thread-safe either: the workers share a map of the nodes
+// which holds no references, and a worker only takes references to the
+// objects aggregated to the nodes of its own roots.
+//
+  for (std::vector<SPFJob>::const_iterator i = jobs.begin (); i != jobs.end (); i++)
+    {
+      GetRouterNode (i->root);
+    }
+  std::map<Ipv4Address, Node *> nodes;
+  for (std::map<Ipv4Address, Ptr<Node> >::const_iterator i = m_routerNodes.begin (); i != m_routerNodes.end (); i++)
+    {
+      nodes.insert (nodes.end (), std::make_pair (i->first, PeekPointer (i->second)));
+    }
+//
+// The state of the SPF calculations is kept by the workers, so they all read
+// the same indexed LSDB.  The workers are all set up before any of them
+// starts, and deleted once all of them are done.
+//
+  m_lsdb->BuildIndex ();
+  std::vector<GlobalRouteManagerImpl *> workers;
+  std::vector<Ptr<SystemThread> > threadList;
+  for (uint32_t i = 0; i < nWorkers; i++)
     {
-      if (!v->GetChild (i)->IsVertexProcessed ())
+      GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl ();
+      delete worker->m_lsdb;
+      worker->m_lsdb = m_lsdb;
+      worker->m_workerNodes = &nodes;
+      worker->m_jobs = &jobs;
+      worker->m_firstJob = i;
+      worker->m_jobStride = nWorkers;
+      workers.push_back (worker);
+      threadList.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFCalculateWorker, worker)));
+    }
+  for (uint32_t i = 0; i < nWorkers; i++)
+    {
+      threadList[i]->Start ();
+    }
+  for (uint32_t i = 0; i < nWorkers; i++)
+    {
+      threadList[i]->Join ();
+    }
+  for (uint32_t i = 0; i < nWorkers; i++)
+    {
+      workers[i]->m_lsdb = 0;
+      delete workers[i];
+    }
+  for (std::vector<SPFJob>::iterator i = jobs.begin (); i != jobs.end (); i++)
+    {
+      Ptr<GlobalRouter> router = GetRouterNode (i->root)->GetObject<GlobalRouter> ();
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      for (std::vector<SPFRoute>::const_iterator j = i->routes.begin (); j != i->routes.end (); j++)
         {
-          NS_LOG_LOGIC ("Vertex's child " << i << " not yet processed, processing...");
-          ProcessASExternals (v->GetChild (i), extlsa);
-          v->GetChild (i)->SetVertexProcessed (true);
+          AddRoute (gr, j->kind, j->dest, j->mask, j->nextHop, j->interface);
         }
+      std::vector<SPFRoute> ().swap (i->routes);
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateWorker (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = m_firstJob; i < m_jobs->size (); i += m_jobStride)
+    {
+      SPFJob &job = (*m_jobs)[i];
+      m_spfRoutes = &job.routes;
+      if (job.destinations.empty ())
+        {
+          SPFCalculate (job.root);
+        }
+      else
+        {
+          SPFCalculate (job.root, job.destinations, job.targets);
+        }
+    }
+  m_spfRoutes = 0;
+}
+
+void
+GlobalRouteManagerImpl::AddRoute (Ptr<Ipv4GlobalRouting> gr, SPFRoute::Kind kind, Ipv4Address dest,
+                                  Ipv4Mask mask, Ipv4Address nextHop, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << gr << kind << dest << mask << nextHop << interface);
+  if (m_spfRoutes != 0)
+    {
+      SPFRoute route;
+      route.kind = kind;
+      route.dest = dest;
+      route.mask = mask;
+      route.nextHop = nextHop;
+      route.interface = interface;
+      m_spfRoutes->push_back (route);
+      return;
+    }
+  switch (kind)
+    {
+    case SPFRoute::HOST:
+      gr->AddHostRouteTo (dest, nextHop, interface);
+      break;
+    case SPFRoute::NETWORK:
+      gr->AddNetworkRouteTo (dest, mask, nextHop, interface);
+      break;
+    case SPFRoute::EXTERNAL:
+      gr->AddASExternalRouteTo (dest, mask, nextHop, interface);
+      break;
+    }
+}
+
+bool
+GlobalRouteManagerImpl::IsRouteAllowed (Ipv4Address network, Ipv4Mask networkMask) const
+{
+  if (m_routeFilter == 0)
+    {
+      return true;
     }
+  return m_routeFilter->find (Destination_t (network, networkMask.Get ())) != m_routeFilter->end ();
 }
 
 //
@@ -1538,79 +2360,59 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
 //
 
 void
-GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v)
+GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, uint32_t v)
 {
   NS_LOG_FUNCTION (this << extlsa << v);
 
-  NS_ASSERT_MSG (m_spfroot, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
+  NS_ASSERT_MSG (m_spfRoot != GlobalRouteManagerLSDB::NO_VERTEX, "GlobalRouteManagerImpl::SPFAddASExternal (): Root not set");
 // Two cases to consider: We are advertising the external ourselves
 // => No need to add anything
 // OR find best path to the advertising router
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v == m_spfRoot)
     {
       NS_LOG_LOGIC ("External is on local host: " 
-                    << v->GetVertexId () << "; returning");
+                    << m_lsdb->GetVertexId (v) << "; returning");
       return;
     }
   NS_LOG_LOGIC ("External is on remote host: " 
                 << extlsa->GetAdvertisingRouter () << "; installing");
 
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = m_spfRootId;
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// Look up the node that has the router ID corresponding to the root vertex.
+// This is the one we're going to write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = GetRouterNode (routerId);
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  if (!IsRouteAllowed (tempip, tempmask))
+    {
+      return;
+    }
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1625,39 +2427,36 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < m_spfState[v].exits.size (); i++)
+    {
+      SPFVertex::NodeExit_t exit = m_spfState[v].exits[i];
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          AddRoute (gr, SPFRoute::EXTERNAL, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1665,58 +2464,58 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
 void
-GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
+GlobalRouteManagerImpl::SPFProcessStubs (uint32_t v)
 {
   NS_LOG_FUNCTION (this << v);
-  NS_LOG_LOGIC ("Processing stubs for " << v->GetVertexId ());
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
+  NS_LOG_LOGIC ("Processing stubs for " << m_lsdb->GetVertexId (v));
+  if (m_lsdb->GetVertexLSA (v)->GetLSType () == GlobalRoutingLSA::RouterLSA)
     {
-      GlobalRoutingLSA *rlsa = v->GetLSA ();
-      NS_LOG_LOGIC ("Processing router LSA with id " << rlsa->GetLinkStateId ());
-      for (uint32_t i = 0; i < rlsa->GetNLinkRecords (); i++)
+      NS_LOG_LOGIC ("Processing router LSA with id " << m_lsdb->GetVertexId (v));
+      for (uint32_t i = 0; i < m_lsdb->GetNLinks (v); i++)
         {
           NS_LOG_LOGIC ("Examining link " << i << " of " << 
-                        v->GetVertexId () << "'s " <<
-                        v->GetLSA ()->GetNLinkRecords () << " link records");
-          GlobalRoutingLinkRecord *l = v->GetLSA ()->GetLinkRecord (i);
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+                        m_lsdb->GetVertexId (v) << "'s " <<
+                        m_lsdb->GetNLinks (v) << " link records");
+          const GlobalRouteManagerLSDB::Link &l = m_lsdb->GetLink (v, i);
+          if (l.type == GlobalRoutingLinkRecord::StubNetwork)
             {
-              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
+              NS_LOG_LOGIC ("Found a Stub record to " << Ipv4Address (l.linkId));
               SPFIntraAddStub (l, v);
               continue;
             }
         }
     }
-  for (uint32_t i = 0; i < v->GetNChildren (); i++)
+  for (uint32_t i = 0; i < m_spfState[v].children.size (); i++)
     {
-      if (!v->GetChild (i)->IsVertexProcessed ())
+      uint32_t child = m_spfState[v].children[i];
+      if (!m_spfState[child].processed)
         {
-          SPFProcessStubs (v->GetChild (i));
-          v->GetChild (i)->SetVertexProcessed (true);
+          SPFProcessStubs (child);
+          m_spfState[child].processed = true;
         }
     }
 }
 
 // RFC2328 16.1. second stage. 
 void
-GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddStub (const GlobalRouteManagerLSDB::Link &l, uint32_t v)
 {
-  NS_LOG_FUNCTION (this << l << v);
+  NS_LOG_FUNCTION (this << &l << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
-                 "GlobalRouteManagerImpl::SPFIntraAddStub (): Root pointer not set");
+  NS_ASSERT_MSG (m_spfRoot != GlobalRouteManagerLSDB::NO_VERTEX, 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): Root not set");
 
   // XXX simplifed logic for the moment.  There are two cases to consider:
   // 1) the stub network is on this router; do nothing for now
   //    (already handled above)
   // 2) the stub network is on a remote router, so I should use the
   // same next hop that I use to get to vertex v
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v == m_spfRoot)
     {
-      NS_LOG_LOGIC ("Stub is on local host: " << v->GetVertexId () << "; returning");
+      NS_LOG_LOGIC ("Stub is on local host: " << m_lsdb->GetVertexId (v) << "; returning");
       return;
     }
-  NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
+  NS_LOG_LOGIC ("Stub is on remote host: " << m_lsdb->GetVertexId (v) << "; installing");
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
@@ -1724,64 +2523,42 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // going to use this ID to discover which node it is that we're actually going
 // to update.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = m_spfRootId;
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// Look up the node that has the router ID corresponding to the root vertex.
+// This is the one we're going to write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = GetRouterNode (routerId);
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  Ipv4Mask tempmask (l.linkData);
+  Ipv4Address tempip (l.linkId);
+  tempip = tempip.CombineMask (tempmask);
+  if (!IsRouteAllowed (tempip, tempmask))
+    {
+      return;
+    }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1796,39 +2573,36 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // which the packets should be send for forwarding.
 //
 
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < m_spfState[v].exits.size (); i++)
+    {
+      SPFVertex::NodeExit_t exit = m_spfState[v].exits[i];
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          AddRoute (gr, SPFRoute::NETWORK, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1850,63 +2624,42 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 // node in order to iterate the interfaces and find the one corresponding to
 // the address in question.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = m_spfRootId;
 //
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// Look up the node that has the router ID corresponding to the root vertex.
+// This is the one we're going to write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = GetRouterNode (routerId);
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return -1;
+    }
 //
 // This is the node we're building the routing table for.  We're going to need
 // the Ipv4 interface to look for the ipv4 interface index.  Since this node
 // is participating in routing IP version 4 packets, it certainly must have 
 // an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1926,12 +2679,12 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 // route.
 //
 void
-GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddRouter (uint32_t v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
-                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
+  NS_ASSERT_MSG (m_spfRoot != GlobalRouteManagerLSDB::NO_VERTEX, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
@@ -1939,64 +2692,35 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // going to use this ID to discover which node it is that we're actually going
 // to update.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = m_spfRootId;
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// Look up the node that has the router ID corresponding to the root vertex.
+// This is the one we're going to write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = GetRouterNode (routerId);
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "GetObject for <Ipv4> interface failed");
 //
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
+// Get the links of the vertex we're adding the routes to.  They are the Global
+// Router Link Records corresponding to links off of that vertex / node.  We're
+// going to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = m_lsdb->GetNLinks (v);
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2005,18 +2729,23 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Node " << node->GetId () <<
+                " found " << nLinkRecords << " link records in LSA with LinkStateId " << m_lsdb->GetVertexId (v));
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      const GlobalRouteManagerLSDB::Link &lr = m_lsdb->GetLink (v, j);
+      if (lr.type != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
+      Ipv4Address linkData (lr.linkData);
+      if (!IsRouteAllowed (linkData, Ipv4Mask::GetOnes ()))
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2030,53 +2759,52 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          continue;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < m_spfState[v].exits.size (); i++)
+        {
+          SPFVertex::NodeExit_t exit = m_spfState[v].exits[i];
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              AddRoute (gr, SPFRoute::HOST, linkData, Ipv4Mask::GetOnes (),
+                        nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " adding host route to " << linkData <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add host route to " << linkData <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
+    }
 //
 // Done adding the routes for the selected node.
 //
-          return;
-        }
-    }
+  return;
 }
+
 void
-GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddTransit (uint32_t v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
-                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
+  NS_ASSERT_MSG (m_spfRoot != GlobalRouteManagerLSDB::NO_VERTEX, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
@@ -2084,99 +2812,73 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 // going to use this ID to discover which node it is that we're actually going
 // to update.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = m_spfRootId;
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// Look up the node that has the router ID corresponding to the root vertex.
+// This is the one we're going to write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = GetRouterNode (routerId);
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
+// adding the routes to, for the network address and mask.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = m_lsdb->GetVertexLSA (v);
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  if (!IsRouteAllowed (tempip, tempmask))
+    {
+      return;
+    }
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < m_spfState[v].exits.size (); i++)
+    {
+      SPFVertex::NodeExit_t exit = m_spfState[v].exits[i];
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          AddRoute (gr, SPFRoute::NETWORK, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -2189,16 +2891,14 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 // already has set and adds itself to that vertex's list of children.
 //
 void
-GlobalRouteManagerImpl::SPFVertexAddParent (SPFVertex* v)
+GlobalRouteManagerImpl::SPFVertexAddParent (uint32_t v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  for (uint32_t i=0;;)
+  const std::vector<uint32_t> &parents = m_spfState[v].parents;
+  for (uint32_t i = 0; i < parents.size (); i++)
     {
-      SPFVertex* parent;
-      // check if all parents of vertex v
-      if ((parent = v->GetParent (i++)) == 0) break;
-      parent->AddChild (v);
+      m_spfState[parents[i]].children.push_back (v);
     }
 }
 
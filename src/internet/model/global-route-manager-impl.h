@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -36,8 +37,8 @@ namespace ns3 {
 
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
-class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -64,6 +65,10 @@ class Ipv4GlobalRouting;
  * SPFVertex objects in the SPF tree, along with the details of the link
  * records that connect them provide the information required to construct the
  * required routes.
+ *
+ * The SPF calculation of GlobalRouteManagerImpl keeps the same information
+ * in arrays indexed by the vertices of the link state database instead of
+ * allocating an SPFVertex per vertex and per root.
  */
 class SPFVertex
 {
@@ -532,9 +537,9 @@ private:
   uint32_t m_distanceFromRoot; //!< Distance from root node
   int32_t m_rootOif; //!< root Output Interface
   Ipv4Address m_nextHop; //!< next hop
-  typedef std::list< NodeExit_t > ListOfNodeExit_t; //!< container of Exit nodes
+  typedef std::vector< NodeExit_t > ListOfNodeExit_t; //!< container of Exit nodes
   ListOfNodeExit_t m_ecmpRootExits; //!< store the multiple root's exits for supporting ECMP
-  typedef std::list<SPFVertex*> ListOfSPFVertex_t; //!< container of SPFVertexes
+  typedef std::vector<SPFVertex*> ListOfSPFVertex_t; //!< container of SPFVertexes
   ListOfSPFVertex_t m_parents; //!< parent list
   ListOfSPFVertex_t m_children; //!< Children list
   bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF computation
@@ -601,8 +606,10 @@ public:
  * @brief Insert an IP address / Link State Advertisement pair into the Link
  * State Database.
  *
- * The IPV4 address and the GlobalRoutingLSA given as parameters are converted
- * to an STL pair and are inserted into the database map.
+ * The GlobalRoutingLSA is appended to the database, which takes its
+ * ownership.  Of several router or network LSAs with the same address, the
+ * first one inserted is kept.  No LSA may be inserted once the database is
+ * indexed.
  *
  * @see GlobalRoutingLSA
  * @see Ipv4Address
@@ -616,7 +623,7 @@ public:
  * @brief Look up the Link State Advertisement associated with the given
  * link state ID (address).
  *
- * The database map is searched for the given IPV4 address and corresponding
+ * The database is searched for the given IPV4 address and corresponding
  * GlobalRoutingLSA is returned.
  *
  * @see GlobalRoutingLSA
@@ -674,13 +681,116 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Get the link state IDs of the router and network Link State
+   * Advertisements.
+   *
+   * @param ids the vector the link state IDs are appended to, in increasing
+   * order
+   */
+  void GetLinkStateIds (std::vector<Ipv4Address> &ids) const;
+
+  /**
+   * @brief A link from a vertex of the SPF calculation.
+   *
+   * This is a link record of a router LSA, or an attached router of a
+   * network LSA, with the addresses kept as 32-bit values so that a link
+   * takes 16 bytes.
+   */
+  struct Link
+  {
+    uint32_t linkId;    //!< the link ID of the link record, or the address of the attached router
+    uint32_t linkData;  //!< the link data of the link record, or 0
+    uint32_t vertex;    //!< the index of the vertex the link leads to, or NO_VERTEX
+    uint16_t metric;    //!< the metric of the link record, or 0
+    uint8_t type;       //!< the GlobalRoutingLinkRecord::LinkType of the link record, or Unknown
+  };
+
+  /// The index of a missing vertex
+  static const uint32_t NO_VERTEX = 0xffffffff;
+
+  /**
+   * @brief Index the router and network LSAs for the SPF calculations.
+   *
+   * The LSAs are numbered in the order of their link state IDs, and the
+   * link records of the router LSAs and the attached routers of the network
+   * LSAs are moved into a single array of Links (in compressed sparse row
+   * form), each with the index of the vertex it leads to.  The LSAs only
+   * keep their header, so the links are only stored once, and the SPF
+   * calculations neither look up the LSAs by address nor walk lists of link
+   * records.  The SPF state is kept in arrays indexed by vertex instead of
+   * in the LSAs, so that several calculations may share the database.
+   *
+   * The index is built once, after the last insertion; until then, the LSAs
+   * are looked up by a linear search.
+   */
+  void BuildIndex ();
+
+  /**
+   * @brief Get the number of indexed vertices.
+   *
+   * @returns the number of router and network LSAs
+   */
+  uint32_t GetNVertices () const;
+
+  /**
+   * @brief Look up the index of a vertex.
+   *
+   * @param addr the link state ID of the LSA of the vertex
+   * @returns the index of the vertex, or NO_VERTEX if there is no such LSA
+   */
+  uint32_t GetVertexIndex (Ipv4Address addr) const;
+
+  /**
+   * @brief Get the link state ID of a vertex.
+   *
+   * @param index the index of the vertex
+   * @returns the link state ID of the LSA of the vertex
+   */
+  Ipv4Address GetVertexId (uint32_t index) const;
+
+  /**
+   * @brief Get the LSA of a vertex.
+   *
+   * Once indexed, the LSA has no link records nor attached routers: they
+   * are the links of the vertex.
+   *
+   * @param index the index of the vertex
+   * @returns the LSA of the vertex
+   */
+  GlobalRoutingLSA* GetVertexLSA (uint32_t index) const;
+
+  /**
+   * @brief Get the number of links of a vertex.
+   *
+   * These are all the link records of a router LSA, or all the attached
+   * routers of a network LSA, in order.
+   *
+   * @param index the index of the vertex
+   * @returns the number of links of the vertex
+   */
+  uint32_t GetNLinks (uint32_t index) const;
+
+  /**
+   * @brief Get a link of a vertex.
+   *
+   * @param index the index of the vertex
+   * @param i the index of the link, less than GetNLinks (index)
+   * @returns the link
+   */
+  const Link& GetLink (uint32_t index, uint32_t i) const;
 
 private:
-  typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
-  typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
+  /// The vertices by the LinkData of the TransitNetwork link records of their LSA
+  typedef std::vector<std::pair<Ipv4Address, uint32_t> > LinkDataIndex_t;
 
-  LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  std::vector<Ipv4Address> m_vertexIds; //!< the link state IDs of the vertices, in increasing order once indexed
+  std::vector<GlobalRoutingLSA*> m_vertexLSAs; //!< the router and network LSAs of the vertices
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  bool m_indexed; //!< true if the vertices are indexed
+  LinkDataIndex_t m_linkDataIndex; //!< the vertices by LinkData, in increasing order
+  std::vector<uint32_t> m_linkOffsets; //!< the offsets of the links of each vertex, and the number of links
+  std::vector<Link> m_links; //!< the links of the vertices
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -735,6 +845,19 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after a change of the topology.
+ *
+ * A new routing database is built and compared with the previous one.  The
+ * routers whose shortest path tree may use a link that has changed have
+ * their SPF recomputed; the others only have their routes to the
+ * destinations that have appeared or disappeared updated.  All the routes
+ * are recomputed if there is no previous routing database, or if the
+ * change cannot be handled incrementally (new routers, changes of the
+ * transit networks or of the external routes).
+ */
+  virtual void UpdateGlobalRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +889,210 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
-  SPFVertex* m_spfroot; //!< the root node
+  /// A destination of the routes: the network address and the bits of its mask
+  typedef std::pair<Ipv4Address, uint32_t> Destination_t;
+  /// A set of destinations
+  typedef std::set<Destination_t> DestinationSet_t;
+  /**
+   * An LSA advertising a destination: its link state ID and the type of the
+   * link record, or TransitNetwork for a network LSA
+   */
+  typedef std::pair<Ipv4Address, GlobalRoutingLinkRecord::LinkType> Advertiser_t;
+  /// The LSAs advertising each destination
+  typedef std::map<Destination_t, std::vector<Advertiser_t> > DestinationMap_t;
+  /// The distance to a vertex which cannot be reached
+  static const uint64_t NO_DISTANCE = 0xffffffffffffffffULL;
+
+  /// A route calculated for the root of the SPF tree
+  struct SPFRoute
+  {
+    /// The kinds of routes
+    enum Kind
+    {
+      HOST,             //!< a host route
+      NETWORK,          //!< a network route
+      EXTERNAL          //!< an AS external route
+    };
+    Kind kind;                  //!< the kind of route
+    Ipv4Address dest;           //!< the destination
+    Ipv4Mask mask;              //!< the destination mask
+    Ipv4Address nextHop;        //!< the next hop
+    uint32_t interface;         //!< the outgoing interface
+  };
+
+  /// The SPF calculation of the routes of a router
+  struct SPFJob
+  {
+    Ipv4Address root;                   //!< the router ID of the root
+    DestinationSet_t destinations;      //!< if not empty, the only destinations to calculate
+    std::set<Ipv4Address> targets;      //!< the vertices advertising the destinations
+    std::vector<SPFRoute> routes;       //!< the routes calculated by a worker thread
+  };
+
+  /// The state of a vertex in the current SPF calculation
+  struct SPFState
+  {
+    GlobalRoutingLSA::SPFStatus status;         //!< whether the vertex is a candidate or in the tree
+    uint32_t distance;                          //!< the distance from the root
+    uint32_t order;                             //!< the order of the candidate entry of the vertex
+    bool processed;                             //!< true once the stubs of the subtree are processed
+    std::vector<SPFVertex::NodeExit_t> exits;   //!< the exits of the root towards the vertex
+    std::vector<uint32_t> parents;              //!< the parents of the vertex in the tree
+    std::vector<uint32_t> children;             //!< the children of the vertex in the tree
+  };
+
+  /**
+   * A candidate vertex of the SPF calculation.  The candidates are popped
+   * in increasing distance, networks first, then in the order they were
+   * pushed; a candidate is pushed again when its distance decreases.
+   */
+  struct SPFCandidate
+  {
+    uint32_t distance;  //!< the distance from the root
+    bool network;       //!< true for a network vertex
+    uint32_t order;     //!< the order of the candidate
+    uint32_t vertex;    //!< the index of the vertex
+  };
+
+  uint32_t m_spfRoot; //!< the index of the root vertex
+  Ipv4Address m_spfRootId; //!< the router ID of the root
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  std::map<Ipv4Address, Ptr<Node> > m_routerNodes; //!< the nodes by router ID
+  const std::map<Ipv4Address, Node *> *m_workerNodes; //!< if not null, the nodes by router ID shared by the worker threads
+  const DestinationSet_t *m_routeFilter; //!< if not null, the only destinations routes are added to
+  std::set<Ipv4Address> m_spfTargets; //!< the vertices a filtered SPF calculation stops after
+  std::vector<SPFRoute> *m_spfRoutes; //!< if not null, where the routes are stored instead of being added
+  std::vector<SPFState> m_spfState; //!< the state of the vertices, reused from one SPF calculation to the next
+  std::vector<SPFCandidate> m_candidates; //!< the heap of candidate vertices
+  uint32_t m_candidateOrder; //!< the order of the next candidate
+  std::vector<SPFVertex::NodeExit_t> m_exits; //!< the exits of an equal cost path being merged
+  std::vector<SPFJob> *m_jobs; //!< the jobs of a worker thread
+  uint32_t m_firstJob; //!< the index of the first job of a worker thread
+  uint32_t m_jobStride; //!< the distance between the jobs of a worker thread
+
+  /**
+   * \brief Find the node of a router
+   *
+   * In a worker thread, the node is found in the map shared by the workers,
+   * which is never updated.
+   *
+   * \param routerId the router ID
+   * \returns the node, or 0 if no node has this router ID
+   */
+  Ptr<Node> GetRouterNode (Ipv4Address routerId);
+
+  /**
+   * \brief Delete the global routes of a node
+   *
+   * \param node the node
+   */
+  void DeleteRoutes (Ptr<Node> node);
+
+  /**
+   * \brief Add a route calculated for the root of the SPF tree
+   *
+   * The route is stored instead if the calculation runs in a worker thread.
+   *
+   * \param gr the routing protocol of the root
+   * \param kind the kind of route
+   * \param dest the destination
+   * \param mask the destination mask
+   * \param nextHop the next hop
+   * \param interface the outgoing interface
+   */
+  void AddRoute (Ptr<Ipv4GlobalRouting> gr, SPFRoute::Kind kind, Ipv4Address dest,
+                 Ipv4Mask mask, Ipv4Address nextHop, uint32_t interface);
+
+  /**
+   * \brief Run SPF calculations
+   *
+   * The calculations run on the worker threads set by the
+   * GlobalRoutingThreads global value, which share the indexed link state
+   * database.  The routes they calculate are then added in the order
+   * of the jobs, so that the routing tables are the same as with a single
+   * thread.
+   *
+   * \param jobs the calculations
+   */
+  void SPFCalculate (std::vector<SPFJob> &jobs);
+
+  /**
+   * \brief Run the SPF calculations of a worker thread
+   */
+  void SPFCalculateWorker (void);
+
+  /**
+   * \brief Test if a route may be added during an SPF calculation
+   *
+   * \param network the destination network
+   * \param networkMask the destination network mask
+   * \returns true unless a route filter excludes the destination
+   */
+  bool IsRouteAllowed (Ipv4Address network, Ipv4Mask networkMask) const;
+
+  /**
+   * \brief Calculate the routes of a router to some destinations only
+   *
+   * The SPF calculation stops as soon as the vertices advertising the
+   * destinations are in the shortest path tree.
+   *
+   * \param root the root node
+   * \param destinations the destinations
+   * \param targets the link state IDs of the vertices advertising the
+   * destinations
+   */
+  void SPFCalculate (Ipv4Address root, const DestinationSet_t &destinations,
+                     const std::set<Ipv4Address> &targets);
+
+  /**
+   * \brief Find the routers whose shortest path tree may use a link
+   *
+   * These are the routers for which the link is on a shortest path to its
+   * end, including the ties.
+   *
+   * \param lsdb the link state database
+   * \param from the index of the vertex at the start of the link
+   * \param to the index of the vertex at the end of the link, or NO_VERTEX
+   * \param metric the link metric
+   * \param distances the distances to the vertices, computed on demand
+   * \param routers the set the routers are added to
+   */
+  void FindRoutersUsingLink (GlobalRouteManagerLSDB *lsdb, uint32_t from,
+                             uint32_t to, uint32_t metric,
+                             std::map<uint32_t, std::vector<uint64_t> > &distances,
+                             std::set<Ipv4Address> &routers);
+
+  /**
+   * \brief Compare the previous link state database with the current one
+   *
+   * \param oldLsdb the previous link state database
+   * \param routers the set the routers whose shortest path tree may have
+   * changed are added to
+   * \param destinations the set the destinations of the link records that
+   * have changed are added to
+   * \returns false if the changes cannot be handled incrementally
+   */
+  bool FindChanges (GlobalRouteManagerLSDB *oldLsdb, std::set<Ipv4Address> &routers,
+                    DestinationSet_t &destinations);
+
+  /**
+   * \brief Find the LSAs advertising each destination
+   *
+   * \param lsdb the link state database
+   * \param destinations the map the LSAs are added to, by destination
+   */
+  void GetDestinations (GlobalRouteManagerLSDB *lsdb, DestinationMap_t &destinations);
+
+  /**
+   * \brief Compute the distances from all the vertices to a vertex
+   *
+   * \param lsdb the link state database
+   * \param to the index of the vertex
+   * \param distances the distances to the vertex, by index of the vertices,
+   * or NO_DISTANCE for the vertices it cannot be reached from
+   */
+  void ComputeDistancesTo (GlobalRouteManagerLSDB *lsdb, uint32_t to,
+                           std::vector<uint64_t> &distances);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -796,21 +1121,13 @@ private:
    * stub link records will exist for point-to-point interfaces and for
    * broadcast interfaces for which no neighboring router can be found
    *
-   * \param v vertex to be processed
-   */
-  void SPFProcessStubs (SPFVertex* v);
-
-  /**
-   * \brief Process Autonomous Systems (AS) External LSA
-   *
-   * \param v vertex to be processed
-   * \param extlsa external LSA
+   * \param v the index of the vertex to be processed
    */
-  void ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa);
+  void SPFProcessStubs (uint32_t v);
 
   /**
-   * \brief Examine the links in v's LSA and update the list of candidates with any
-   *        vertices not already on the list
+   * \brief Examine the links of vertex v and update the list of candidates
+   *        with any vertices not already on the list
    *
    * \internal
    *
@@ -818,34 +1135,56 @@ private:
    * 16.1 (2) for further details.
    *
    * We're passed a parameter \a v that is a vertex which is already in the SPF
-   * tree.  A vertex represents a router node.  We also get a reference to the
-   * SPF candidate queue, which is a priority queue containing the shortest paths
-   * to the networks we know about.
+   * tree.  A vertex represents a router node.  The candidates are kept in
+   * a priority queue containing the shortest paths to the networks we know
+   * about.
    *
-   * We examine the links in v's LSA and update the list of candidates with any
+   * We examine the links of v and update the list of candidates with any
    * vertices not already on the list.  If a lower-cost path is found to a
    * vertex already on the candidate list, store the new (lower) cost.
    *
-   * \param v the vertex
-   * \param candidate the SPF candidate queue
+   * \param v the index of the vertex
+   */
+  void SPFNext (uint32_t v);
+
+  /**
+   * \brief Push a vertex onto the candidate queue, at its current distance
+   *
+   * \param v the index of the vertex
    */
-  void SPFNext (SPFVertex* v, CandidateQueue& candidate);
+  void SPFPushCandidate (uint32_t v);
+
+  /**
+   * \brief Compare two candidates of the SPF calculation
+   *
+   * \param c1 the first candidate
+   * \param c2 the second candidate
+   * \returns true if the first candidate is popped after the second one
+   */
+  static bool SPFCandidateAfter (const SPFCandidate &c1, const SPFCandidate &c2);
+
+  /**
+   * \brief Pop the candidate vertex closest to the root
+   *
+   * \returns the index of the vertex, or NO_VERTEX if there is no candidate
+   */
+  uint32_t SPFPopCandidate (void);
 
   /**
    * \brief Calculate nexthop from root through V (parent) to vertex W (destination)
-   *        with given distance from root->W.
    *
    * This method is derived from quagga ospf_nexthop_calculation() 16.1.1.
-   * For now, this is greatly simplified from the quagga code
+   * For now, this is greatly simplified from the quagga code.  The caller
+   * sets the distance and the parents of W.
    *
-   * \param v the parent
-   * \param w the destination
-   * \param l the link record
-   * \param distance the target distance
-   * \returns 1 on success
+   * \param v the index of the parent
+   * \param w the index of the destination
+   * \param l the link from v to w, for a router v
+   * \param exits the vector the exits of the root towards W are stored in
    */
-  int SPFNexthopCalculation (SPFVertex* v, SPFVertex* w, 
-                             GlobalRoutingLinkRecord* l, uint32_t distance);
+  void SPFNexthopCalculation (uint32_t v, uint32_t w,
+                              const GlobalRouteManagerLSDB::Link* l,
+                              std::vector<SPFVertex::NodeExit_t> &exits);
 
   /**
    * \brief Adds a vertex to the list of children *in* each of its parents
@@ -856,34 +1195,23 @@ private:
    * expect it to add a parent *to* something, it actually adds a vertex
    * to the list of children *in* each of its parents.
    *
-   * Given a pointer to a vertex, it links back to the vertex's parent that it
-   * already has set and adds itself to that vertex's list of children.
-   *
-   * \param v the vertex
+   * \param v the index of the vertex
    */
-  void SPFVertexAddParent (SPFVertex* v);
+  void SPFVertexAddParent (uint32_t v);
 
   /**
    * \brief Search for a link between two vertices.
    *
    * This method is derived from quagga ospf_get_next_link ()
    *
-   * First search the Global Router Link Records of vertex \a v for one
-   * representing a point-to point link to vertex \a w.
-   *
-   * What is done depends on prev_link.  Contrary to appearances, prev_link just
-   * acts as a flag here.  If prev_link is NULL, we return the first Global
-   * Router Link Record we find that describes a point-to-point link from \a v
-   * to \a w.  If prev_link is not NULL, we return a Global Router Link Record
-   * representing a possible *second* link from \a v to \a w.
+   * Search the links of vertex \a v for the first one whose link ID is the
+   * link state ID of vertex \a w.
    *
    * \param v first vertex
    * \param w second vertex
-   * \param prev_link the previous link in the list
-   * \returns the link's record
+   * \returns the link, or 0 if there is none
    */
-  GlobalRoutingLinkRecord* SPFGetNextLink (SPFVertex* v, SPFVertex* w, 
-                                           GlobalRoutingLinkRecord* prev_link);
+  const GlobalRouteManagerLSDB::Link* SPFGetLink (uint32_t v, uint32_t w) const;
 
   /**
    * \brief Add a host route to the routing tables
@@ -895,42 +1223,40 @@ private:
    * tables of the individual nodes.
    *
    * The vertex passed as a parameter has just been added to the SPF tree.
-   * This vertex must have a valid m_root_oid, corresponding to the outgoing
-   * interface on the root router of the tree that is the first hop on the path
-   * to the vertex.  The vertex must also have a next hop address, corresponding
-   * to the next hop on the path to the vertex.  The vertex has an m_lsa field
-   * that has some number of link records.  For each point to point link record,
-   * the m_linkData is the local IP address of the link.  This corresponds to
+   * Its exits are the outgoing interfaces on the root router of the tree
+   * that are the first hop on the paths to the vertex, with the next hop
+   * addresses on these paths.  For each point to point link of the vertex,
+   * the link data is the local IP address of the link.  This corresponds to
    * a destination IP address, reachable from the root, to which we add a host
    * route.
    *
-   * \param v the vertex
+   * \param v the index of the vertex
    *
    */
-  void SPFIntraAddRouter (SPFVertex* v);
+  void SPFIntraAddRouter (uint32_t v);
 
   /**
    * \brief Add a transit to the routing tables
    *
-   * \param v the vertex
+   * \param v the index of the vertex
    */
-  void SPFIntraAddTransit (SPFVertex* v);
+  void SPFIntraAddTransit (uint32_t v);
 
   /**
    * \brief Add a stub to the routing tables
    *
-   * \param l the global routing link record
-   * \param v the vertex
+   * \param l the stub link
+   * \param v the index of the vertex
    */
-  void SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v);
+  void SPFIntraAddStub (const GlobalRouteManagerLSDB::Link &l, uint32_t v);
 
   /**
    * \brief Add an external route to the routing tables
    *
    * \param extlsa the external LSA
-   * \param v the vertex
+   * \param v the index of the vertex
    */
-  void SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v);
+  void SPFAddASExternal (GlobalRoutingLSA *extlsa, uint32_t v);
 
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
@@ -65,6 +65,12 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after a change of the topology, recomputing
+ * only the shortest path trees that may have changed.
+ */
+  static void UpdateGlobalRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
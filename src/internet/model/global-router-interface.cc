@@ -379,6 +379,13 @@ GlobalRoutingLSA::GetAttachedRouter (uint32_t n) const
   return Ipv4Address ("0.0.0.0");
 }
 
+void
+GlobalRoutingLSA::ClearAttachedRouters (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_attachedRouters.clear ();
+}
+
 void
 GlobalRoutingLSA::SetStatus (GlobalRoutingLSA::SPFStatus status)
 {
@@ -470,6 +470,11 @@ public:
  */
   Ipv4Address GetAttachedRouter (uint32_t n) const;
 
+/**
+ * @brief Make the list of attached routers of the NetworkLSA empty.
+ */
+  void ClearAttachedRouters (void);
+
 /**
  * @brief Get the SPF status of the advertisement.
  *
@@ -59,6 +59,13 @@ Icmpv4Header::EnableChecksum (void)
   NS_LOG_FUNCTION (this);
   m_calcChecksum = true;
 }
+bool
+Icmpv4Header::IsCacheable (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // a cached copy would not honour the checksum state set by the caller
+  return !m_calcChecksum;
+}
 TypeId
 Icmpv4Header::GetInstanceTypeId (void) const
 {
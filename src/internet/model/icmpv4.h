@@ -92,6 +92,7 @@ public:
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
   virtual void Print (std::ostream &os) const;
+  virtual bool IsCacheable (void) const;
 
 private:
   uint8_t m_type; //!< ICMP type
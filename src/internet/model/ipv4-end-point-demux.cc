@@ -28,6 +28,32 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
+Ipv4EndPointDemux::FourTuple::FourTuple (Ipv4Address localAddress, uint16_t localPort,
+                                         Ipv4Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress.Get ()),
+    peerAddress (peerAddress.Get ()),
+    localPort (localPort),
+    peerPort (peerPort)
+{
+}
+
+bool
+Ipv4EndPointDemux::FourTuple::operator == (const FourTuple &other) const
+{
+  return localAddress == other.localAddress && peerAddress == other.peerAddress
+         && localPort == other.localPort && peerPort == other.peerPort;
+}
+
+size_t
+Ipv4EndPointDemux::FourTupleHash::operator () (const FourTuple &tuple) const
+{
+  // The peer port and address vary the most between the connections
+  uint64_t hash = tuple.peerAddress;
+  hash = (hash << 16 | tuple.peerPort) * 0x9e3779b97f4a7c15ULL;
+  hash ^= (static_cast<uint64_t> (tuple.localAddress) << 16 | tuple.localPort) * 0xc2b2ae3d27d4eb4fULL;
+  return static_cast<size_t> (hash ^ (hash >> 29));
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
   : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
 {
@@ -40,29 +66,95 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv4EndPointDemux::IsConnected (Ipv4EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return endPoint->GetLocalAddress () != Ipv4Address::GetAny ()
+         && endPoint->GetPeerAddress () != Ipv4Address::GetAny ()
+         && endPoint->GetPeerPort () != 0;
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  m_positions[endPoint] = m_endPoints.insert (m_endPoints.end (), endPoint);
+  m_portUsers[endPoint->GetLocalPort ()]++;
+  endPoint->m_demux = this;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  if (IsConnected (endPoint))
+    {
+      FourTuple tuple (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                       endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      m_connected.insert (std::make_pair (tuple, endPoint));
+    }
+  else
     {
-      if ((*i)->GetLocalPort  () == port) 
+      m_unconnected[endPoint->GetLocalPort ()].push_back (endPoint);
+    }
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  if (IsConnected (endPoint))
+    {
+      FourTuple tuple (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                       endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      std::pair<ConnectedEndPoints::iterator, ConnectedEndPoints::iterator> range = m_connected.equal_range (tuple);
+      for (ConnectedEndPoints::iterator i = range.first; i != range.second; i++)
         {
-          return true;
+          if (i->second == endPoint)
+            {
+              m_connected.erase (i);
+              return;
+            }
         }
     }
-  return false;
+  else
+    {
+      PortEndPoints::iterator port = m_unconnected.find (endPoint->GetLocalPort ());
+      if (port != m_unconnected.end ())
+        {
+          port->second.remove (endPoint);
+          if (port->second.empty ())
+            {
+              m_unconnected.erase (port);
+            }
+        }
+    }
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_portUsers.find (port) != m_portUsers.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       if ((*i)->GetLocalPort () == port &&
@@ -85,10 +177,7 @@ Ipv4EndPointDemux::Allocate (void)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (Ipv4Address::GetAny (), port));
 }
 
 Ipv4EndPoint *
@@ -101,10 +190,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -124,10 +210,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       NS_LOG_WARN ("Duplicated endpoint.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -136,7 +219,29 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
+  endPoint->SetPeer (peerAddress, peerPort);
+
+  // A duplicate has the same four-tuple, hence is in the same table
+  EndPoints candidates;
+  if (IsConnected (endPoint))
+    {
+      FourTuple tuple (localAddress, localPort, peerAddress, peerPort);
+      std::pair<ConnectedEndPoints::iterator, ConnectedEndPoints::iterator> range = m_connected.equal_range (tuple);
+      for (ConnectedEndPoints::iterator i = range.first; i != range.second; i++)
+        {
+          candidates.push_back (i->second);
+        }
+    }
+  else
+    {
+      PortEndPoints::iterator port = m_unconnected.find (localPort);
+      if (port != m_unconnected.end ())
+        {
+          candidates = port->second;
+        }
+    }
+  for (EndPointsI i = candidates.begin (); i != candidates.end (); i++) 
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -145,31 +250,32 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
           ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
         {
           NS_LOG_WARN ("Duplicated endpoint.");
+          delete endPoint;
           return 0;
         }
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
-  endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<Ipv4EndPoint *, EndPointsI>::iterator position = m_positions.find (endPoint);
+  if (position == m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
+    }
+  Unindex (endPoint);
+  std::unordered_map<uint16_t, uint32_t>::iterator users = m_portUsers.find (endPoint->GetLocalPort ());
+  if (--users->second == 0)
+    {
+      m_portUsers.erase (users);
     }
+  m_endPoints.erase (position->second);
+  m_positions.erase (position);
+  endPoint->m_demux = 0;
+  delete endPoint;
 }
 
 /*
@@ -189,6 +295,124 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
   return ret;
 }
 
+void
+Ipv4EndPointDemux::Match (Ipv4EndPoint *endP,
+                          Ipv4Address daddr, uint16_t dport,
+                          Ipv4Address saddr, uint16_t sport,
+                          Ptr<Ipv4Interface> incomingInterface,
+                          EndPoints retval[4])
+{
+  NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
+                                             << " daddr=" << endP->GetLocalAddress ()
+                                             << " sport=" << endP->GetPeerPort ()
+                                             << " saddr=" << endP->GetPeerAddress ());
+
+  if (!endP->IsRxEnabled ())
+    {
+      NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                    << " because endpoint can not receive packets");
+      return;
+    }
+
+  if (endP->GetLocalPort () != dport) 
+    {
+      NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                                         << " because endpoint dport "
+                                         << endP->GetLocalPort ()
+                                         << " does not match packet dport " << dport);
+      return;
+    }
+  if (endP->GetBoundNetDevice ())
+    {
+      if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+        {
+          NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                                             << " because endpoint is bound to specific device and"
+                                             << endP->GetBoundNetDevice ()
+                                             << " does not match packet device " << incomingInterface->GetDevice ());
+          return;
+        }
+    }
+
+  bool localAddressMatchesExact = false;
+  bool localAddressIsAny = false;
+  bool localAddressIsSubnetAny = false;
+
+  // We have 3 cases:
+  // 1) Exact local / destination address match
+  // 2) Local endpoint bound to Any -> matches anything
+  // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
+
+  if (endP->GetLocalAddress () == daddr)
+    {
+      // Case 1:
+      localAddressMatchesExact = true;
+    }
+  else if (endP->GetLocalAddress () == Ipv4Address::GetAny ())
+    {
+      // Case 2:
+      localAddressIsAny = true;
+    }
+  else
+    {
+      // Case 3:
+      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+        {
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+
+          Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+          if (endP->GetLocalAddress () == addrNetpart)
+            {
+              NS_LOG_LOGIC ("Endpoint is SubnetDirectedAny " << endP->GetLocalAddress () << "/" << addr.GetMask ().GetPrefixLength ());
+
+              Ipv4Address daddrNetPart = daddr.CombineMask (addr.GetMask ());
+              if (addrNetpart == daddrNetPart)
+                {
+                  localAddressIsSubnetAny = true;
+                }
+            }
+        }
+
+      // if no match here, keep looking
+      if (!localAddressIsSubnetAny)
+        return;
+    }
+
+  bool remotePortMatchesExact = endP->GetPeerPort () == sport;
+  bool remotePortMatchesWildCard = endP->GetPeerPort () == 0;
+  bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
+  bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
+
+  // If remote does not match either with exact or wildcard,
+  // skip this one
+  if (!(remotePortMatchesExact || remotePortMatchesWildCard))
+    return;
+  if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+    return;
+
+  bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
+
+  if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
+    { // All 4 match - this is the case of an open TCP connection, for example.
+      NS_LOG_LOGIC ("Found an endpoint for case 4, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
+      retval[3].push_back (endP);
+    }
+  if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
+    { // All but local address - no idea what this case could be.
+      NS_LOG_LOGIC ("Found an endpoint for case 3, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
+      retval[2].push_back (endP);
+    }
+  if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
+    { // Only local port and local address matches exactly - Not yet opened connection
+      NS_LOG_LOGIC ("Found an endpoint for case 2, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
+      retval[1].push_back (endP);
+    }
+  if (localAddressMatchesWildCard && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
+    { // Only local port matches exactly - Endpoint open to "any" connection
+      NS_LOG_LOGIC ("Found an endpoint for case 1, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
+      retval[0].push_back (endP);
+    }
+}
 
 /*
  * If we have an exact match, we return it.
@@ -202,137 +426,59 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
   
-  EndPoints retval1; // Matches exact on local port, wildcards on others
-  EndPoints retval2; // Matches exact on local port/adder, wildcards on others
-  EndPoints retval3; // Matches all but local address
-  EndPoints retval4; // Exact match on all 4
+  // retval[0]: Matches exact on local port, wildcards on others
+  // retval[1]: Matches exact on local port/adder, wildcards on others
+  // retval[2]: Matches all but local address
+  // retval[3]: Exact match on all 4
+  EndPoints retval[4];
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      Ipv4EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
 
-      if (!endP->IsRxEnabled ())
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                        << " because endpoint can not receive packets");
-          continue;
-        }
-
-      if (endP->GetLocalPort () != dport) 
+  // A connected endpoint can only match if its local address is the
+  // destination address, or the subnet-directed address of an address of
+  // the incoming interface, and its peer is the source of the packet.
+  if (!m_connected.empty ())
+    {
+      std::pair<ConnectedEndPoints::iterator, ConnectedEndPoints::iterator> range;
+      range = m_connected.equal_range (FourTuple (daddr, dport, saddr, sport));
+      for (ConnectedEndPoints::iterator i = range.first; i != range.second; i++)
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
+          Match (i->second, daddr, dport, saddr, sport, incomingInterface, retval);
         }
-      if (endP->GetBoundNetDevice ())
+      for (uint32_t j = 0; retval[3].empty () && incomingInterface != 0 && j < incomingInterface->GetNAddresses (); j++)
         {
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (j);
+          Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+          if (addrNetpart == daddr)
             {
-              NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
               continue;
             }
-        }
-
-      bool localAddressMatchesExact = false;
-      bool localAddressIsAny = false;
-      bool localAddressIsSubnetAny = false;
-
-      // We have 3 cases:
-      // 1) Exact local / destination address match
-      // 2) Local endpoint bound to Any -> matches anything
-      // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
-
-      if (endP->GetLocalAddress () == daddr)
-        {
-          // Case 1:
-          localAddressMatchesExact = true;
-        }
-      else if (endP->GetLocalAddress () == Ipv4Address::GetAny ())
-        {
-          // Case 2:
-          localAddressIsAny = true;
-        }
-      else
-        {
-          // Case 3:
-          for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+          range = m_connected.equal_range (FourTuple (addrNetpart, dport, saddr, sport));
+          for (ConnectedEndPoints::iterator i = range.first; i != range.second; i++)
             {
-              Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-
-              Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
-              if (endP->GetLocalAddress () == addrNetpart)
-                {
-                  NS_LOG_LOGIC ("Endpoint is SubnetDirectedAny " << endP->GetLocalAddress () << "/" << addr.GetMask ().GetPrefixLength ());
-
-                  Ipv4Address daddrNetPart = daddr.CombineMask (addr.GetMask ());
-                  if (addrNetpart == daddrNetPart)
-                    {
-                      localAddressIsSubnetAny = true;
-                    }
-                }
+              Match (i->second, daddr, dport, saddr, sport, incomingInterface, retval);
             }
-
-          // if no match here, keep looking
-          if (!localAddressIsSubnetAny)
-            continue;
         }
+    }
 
-      bool remotePortMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePortMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
-
-      // If remote does not match either with exact or wildcard,
-      // skip this one
-      if (!(remotePortMatchesExact || remotePortMatchesWildCard))
-        continue;
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        continue;
-
-      bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
-
-      if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All 4 match - this is the case of an open TCP connection, for example.
-          NS_LOG_LOGIC ("Found an endpoint for case 4, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval4.push_back (endP);
-        }
-      if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All but local address - no idea what this case could be.
-          NS_LOG_LOGIC ("Found an endpoint for case 3, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port and local address matches exactly - Not yet opened connection
-          NS_LOG_LOGIC ("Found an endpoint for case 2, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port matches exactly - Endpoint open to "any" connection
-          NS_LOG_LOGIC ("Found an endpoint for case 1, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval1.push_back (endP);
+  PortEndPoints::iterator port = m_unconnected.find (dport);
+  if (port != m_unconnected.end ())
+    {
+      for (EndPointsI i = port->second.begin (); i != port->second.end (); i++)
+        {
+          Match (*i, daddr, dport, saddr, sport, incomingInterface, retval);
         }
     }
 
   // Here we find the most exact match
-  EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
-
-  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
-  return retval;  // might be empty if no matches
+  EndPoints result;
+  if (!retval[3].empty ()) result.swap (retval[3]);
+  else if (!retval[2].empty ()) result.swap (retval[2]);
+  else if (!retval[1].empty ()) result.swap (retval[1]);
+  else result.swap (retval[0]);
+
+  NS_ABORT_MSG_IF (result.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+  return result;  // might be empty if no matches
 }
 
 Ipv4EndPoint *
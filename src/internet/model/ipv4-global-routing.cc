@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <algorithm>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -28,6 +29,7 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
 #include "ns3/node.h"
+#include "ns3/hash.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
 
@@ -48,6 +50,12 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_randomEcmpRouting),
                    MakeBooleanChecker ())
+    .AddAttribute ("FlowEcmpRouting",
+                   "Set to true if packets are routed among ECMP by a hash of their 5-tuple salted by the node, "
+                   "so that the packets of a flow follow the same path; takes precedence over RandomEcmpRouting",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_flowEcmpRouting),
+                   MakeBooleanChecker ())
     .AddAttribute ("RespondToInterfaceEvents",
                    "Set to true if you want to dynamically recompute the global routes upon Interface notification events (up/down, or add/remove address)",
                    BooleanValue (false),
@@ -59,6 +67,8 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
+    m_flowEcmpRouting (false),
+    m_flowEcmpSalt (0),
     m_respondToInterfaceEvents (false)
 {
   NS_LOG_FUNCTION (this);
@@ -80,6 +90,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_hostTrie.Insert (route);
 }
 
 void 
@@ -90,6 +101,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_hostTrie.Insert (route);
 }
 
 void 
@@ -105,6 +117,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkTrie.Insert (route);
 }
 
 void 
@@ -118,6 +131,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkTrie.Insert (route);
 }
 
 void 
@@ -133,64 +147,221 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_ASexternalTrie.Insert (route);
+}
+
+
+bool
+Ipv4GlobalRouting::IsRouteOnInterface (const Ipv4RoutingTableEntry *route, Ptr<NetDevice> oif) const
+{
+  if (oif != 0 && oif != m_ipv4->GetNetDevice (route->GetInterface ()))
+    {
+      NS_LOG_LOGIC ("Not on requested interface, skipping");
+      return false;
+    }
+  return true;
+}
+
+uint32_t
+Ipv4GlobalRouting::GetFlowHash (const Ipv4Header &header, uint16_t sourcePort, uint16_t destinationPort) const
+{
+  NS_LOG_FUNCTION (this << header << sourcePort << destinationPort);
+
+  /* serialize the 5-tuple and the salt in buf */
+  uint8_t buf[17];
+  header.GetSource ().Serialize (buf);
+  header.GetDestination ().Serialize (buf + 4);
+  buf[8] = header.GetProtocol ();
+  buf[9] = (sourcePort >> 8) & 0xff;
+  buf[10] = sourcePort & 0xff;
+  buf[11] = (destinationPort >> 8) & 0xff;
+  buf[12] = destinationPort & 0xff;
+  buf[13] = (m_flowEcmpSalt >> 24) & 0xff;
+  buf[14] = (m_flowEcmpSalt >> 16) & 0xff;
+  buf[15] = (m_flowEcmpSalt >> 8) & 0xff;
+  buf[16] = m_flowEcmpSalt & 0xff;
+
+  return Hash32 ((char*) buf, 17);
+}
+
+uint32_t
+Ipv4GlobalRouting::SelectEcmpRoute (uint32_t nRoutes, const Ipv4Header &header,
+                                    uint16_t sourcePort, uint16_t destinationPort) const
+{
+  NS_ASSERT (nRoutes > 0);
+  if (nRoutes == 1)
+    {
+      return 0;
+    }
+  // pick up one of the routes by the hash of the flow if flow ECMP routing
+  // is enabled, uniformly at random if random ECMP routing is enabled, or
+  // always select the first route consistently otherwise
+  if (m_flowEcmpRouting)
+    {
+      return GetFlowHash (header, sourcePort, destinationPort) % nRoutes;
+    }
+  if (m_randomEcmpRouting)
+    {
+      return m_rand->GetInteger (0, nRoutes - 1);
+    }
+  return 0;
 }
 
+Ipv4RoutingTableEntry *
+Ipv4GlobalRouting::SelectRoute (const Ipv4RouteTrie::Match matches[], uint32_t nMatches,
+                                const Ipv4Header &header, uint16_t sourcePort,
+                                uint16_t destinationPort, Ptr<NetDevice> oif) const
+{
+  uint32_t nRoutes = 0;
+  for (uint32_t j = 0; j < nMatches; j++)
+    {
+      const Ipv4RouteTrie::Routes &routes = *matches[j].routes;
+      if (oif == 0)
+        {
+          nRoutes += routes.size ();
+          continue;
+        }
+      for (Ipv4RouteTrie::Routes::const_iterator i = routes.begin (); i != routes.end (); i++)
+        {
+          if (IsRouteOnInterface (i->entry, oif))
+            {
+              nRoutes++;
+            }
+        }
+    }
+  if (nRoutes == 0)
+    {
+      return 0;
+    }
+  uint32_t selectIndex = SelectEcmpRoute (nRoutes, header, sourcePort, destinationPort);
+  if (nMatches == 1 && oif == 0)
+    {
+      return (*matches[0].routes)[selectIndex].entry;
+    }
+
+  // Walk the routes of all the prefixes in the order they were added, as
+  // in a merge of their sorted groups.
+  uint32_t next[Ipv4RouteTrie::MAX_MATCHES];
+  std::fill (next, next + nMatches, 0);
+  for (;;)
+    {
+      const Ipv4RouteTrie::Route *first = 0;
+      uint32_t firstMatch = 0;
+      for (uint32_t j = 0; j < nMatches; j++)
+        {
+          const Ipv4RouteTrie::Routes &routes = *matches[j].routes;
+          if (next[j] < routes.size () && (first == 0 || routes[next[j]].order < first->order))
+            {
+              first = &routes[next[j]];
+              firstMatch = j;
+            }
+        }
+      NS_ASSERT (first != 0);
+      next[firstMatch]++;
+      if (!IsRouteOnInterface (first->entry, oif))
+        {
+          continue;
+        }
+      if (selectIndex == 0)
+        {
+          return first->entry;
+        }
+      selectIndex--;
+    }
+}
 
 Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, uint16_t sourcePort, uint16_t destinationPort,
+                                 Ptr<NetDevice> oif)
 {
+  Ipv4Address dest = header.GetDestination ();
   NS_LOG_FUNCTION (this << dest << oif);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
+  Ipv4RoutingTableEntry* route = 0;
+
+  Ipv4RouteTrie::Match matches[Ipv4RouteTrie::MAX_MATCHES];
 
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  // host routes all have a /32 mask
+  if (m_hostTrie.Lookup (dest, matches) > 0)
+    {
+      route = SelectRoute (matches, 1, header, sourcePort, destinationPort, oif);
+      NS_LOG_LOGIC ("Found global host route " << route);
+    }
+  if (route == 0 && m_networkTrie.IsComplete ()) // if no host route is found
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest () == dest)
+      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
+      // All the matching network routes are candidates, whatever their
+      // prefix length, in the order they were added.
+      uint32_t n = m_networkTrie.Lookup (dest, matches);
+      if (n > 0)
         {
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          route = SelectRoute (matches, n, header, sourcePort, destinationPort, oif);
+          NS_LOG_LOGIC ("Found global network route " << route);
         }
     }
-  if (allRoutes.size () == 0) // if no host route is found
+  else if (route == 0) // routes with a non-contiguous mask are not indexed
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
+      uint32_t nRoutes = 0;
       for (NetworkRoutesI j = m_networkRoutes.begin (); 
            j != m_networkRoutes.end (); 
            j++) 
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          if ((*j)->GetDestNetworkMask ().IsMatch (dest, (*j)->GetDestNetwork ())
+              && IsRouteOnInterface (*j, oif))
+            {
+              nRoutes++;
+            }
+        }
+      uint32_t selectIndex = nRoutes > 0 ? SelectEcmpRoute (nRoutes, header, sourcePort, destinationPort) : 0;
+      for (NetworkRoutesI j = m_networkRoutes.begin (); 
+           nRoutes > 0 && j != m_networkRoutes.end (); 
+           j++) 
+        {
+          if ((*j)->GetDestNetworkMask ().IsMatch (dest, (*j)->GetDestNetwork ())
+              && IsRouteOnInterface (*j, oif))
+            {
+              if (selectIndex == 0)
+                {
+                  route = *j;
+                  NS_LOG_LOGIC ("Found global network route " << route);
+                  break;
+                }
+              selectIndex--;
+            }
+        }
+    }
+  if (route == 0 && m_ASexternalTrie.IsComplete ())  // consider external if no host/network found
+    {
+      // the first matching route which was added
+      const Ipv4RouteTrie::Route *first = 0;
+      uint32_t n = m_ASexternalTrie.Lookup (dest, matches);
+      for (uint32_t k = 0; k < n; k++)
+        {
+          const Ipv4RouteTrie::Routes &routes = *matches[k].routes;
+          for (Ipv4RouteTrie::Routes::const_iterator i = routes.begin (); i != routes.end (); i++)
             {
-              if (oif != 0)
+              if (first != 0 && first->order < i->order)
+                {
+                  break;
+                }
+              if (!IsRouteOnInterface (i->entry, oif))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  continue;
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              first = &*i;
+              break;
             }
         }
+      if (first != 0)
+        {
+          NS_LOG_LOGIC ("Found external route" << first->entry);
+          route = first->entry;
+        }
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  else if (route == 0)
     {
       for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
            k != m_ASexternalRoutes.end ();
@@ -201,34 +372,17 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
           if (mask.IsMatch (dest, entry))
             {
               NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              if (!IsRouteOnInterface (*k, oif))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  continue;
                 }
-              allRoutes.push_back (*k);
+              route = *k;
               break;
             }
         }
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+  if (route != 0) // if route(s) is found
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
-      uint32_t selectIndex;
-      if (m_randomEcmpRouting)
-        {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
-        }
-      else 
-        {
-          selectIndex = 0;
-        }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
       // create a Ipv4Route object from the selected routing table entry
       rtentry = Create<Ipv4Route> ();
       rtentry->SetDestination (route->GetDest ());
@@ -319,6 +473,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              m_hostTrie.Remove (*i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +491,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          m_networkTrie.Remove (*j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +508,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          m_ASexternalTrie.Remove (*k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -362,6 +519,83 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+std::vector<Ipv4RoutingTableEntry *>
+Ipv4GlobalRouting::GetRoutesTo (Ipv4Address network, Ipv4Mask networkMask) const
+{
+  NS_LOG_FUNCTION (this << network << networkMask);
+  std::vector<Ipv4RoutingTableEntry *> routes;
+  Ipv4RouteTrie::Match matches[Ipv4RouteTrie::MAX_MATCHES];
+  if (networkMask == Ipv4Mask::GetOnes () && m_hostTrie.Lookup (network, matches) > 0)
+    {
+      const Ipv4RouteTrie::Routes &hostRoutes = *matches[0].routes;
+      for (Ipv4RouteTrie::Routes::const_iterator i = hostRoutes.begin (); i != hostRoutes.end (); i++)
+        {
+          routes.push_back (i->entry);
+        }
+    }
+  if (m_networkTrie.IsComplete ())
+    {
+      uint32_t n = m_networkTrie.Lookup (network, matches);
+      for (uint32_t j = 0; j < n; j++)
+        {
+          if (matches[j].length != networkMask.GetPrefixLength ())
+            {
+              continue;
+            }
+          for (Ipv4RouteTrie::Routes::const_iterator i = matches[j].routes->begin (); i != matches[j].routes->end (); i++)
+            {
+              if (i->entry->GetDestNetwork () == network && i->entry->GetDestNetworkMask () == networkMask)
+                {
+                  routes.push_back (i->entry);
+                }
+            }
+        }
+    }
+  else
+    {
+      for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+        {
+          if ((*j)->GetDestNetwork () == network && (*j)->GetDestNetworkMask () == networkMask)
+            {
+              routes.push_back (*j);
+            }
+        }
+    }
+  return routes;
+}
+
+void
+Ipv4GlobalRouting::RemoveRoutesTo (Ipv4Address network, Ipv4Mask networkMask)
+{
+  NS_LOG_FUNCTION (this << network << networkMask);
+  std::vector<Ipv4RoutingTableEntry *> routes = GetRoutesTo (network, networkMask);
+  uint32_t n = routes.size ();
+  for (HostRoutesI i = m_hostRoutes.begin (); n > 0 && i != m_hostRoutes.end (); )
+    {
+      if (std::find (routes.begin (), routes.end (), *i) == routes.end ())
+        {
+          i++;
+          continue;
+        }
+      m_hostTrie.Remove (*i);
+      delete *i;
+      i = m_hostRoutes.erase (i);
+      n--;
+    }
+  for (NetworkRoutesI j = m_networkRoutes.begin (); n > 0 && j != m_networkRoutes.end (); )
+    {
+      if (std::find (routes.begin (), routes.end (), *j) == routes.end ())
+        {
+          j++;
+          continue;
+        }
+      m_networkTrie.Remove (*j);
+      delete *j;
+      j = m_networkRoutes.erase (j);
+      n--;
+    }
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -392,6 +626,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostTrie.Clear ();
+  m_networkTrie.Clear ();
+  m_ASexternalTrie.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -455,6 +692,17 @@ Ptr<Ipv4Route>
 Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
 {
   NS_LOG_FUNCTION (this << p << &header << oif << &sockerr);
+  // the caller did not tell whether the packet starts with its transport
+  // header, hence the ports are not known
+  return RouteOutputWithPorts (p, header, 0, 0, oif, sockerr);
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::RouteOutputWithPorts (Ptr<Packet> p, const Ipv4Header &header,
+                                         uint16_t sourcePort, uint16_t destinationPort,
+                                         Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
+{
+  NS_LOG_FUNCTION (this << p << &header << sourcePort << destinationPort << oif << &sockerr);
 //
 // First, see if this is a multicast packet we have a route for.  If we
 // have a route, then send the packet down each of the specified interfaces.
@@ -468,7 +716,7 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 // See if this is a unicast packet we have a route for.
 //
   NS_LOG_LOGIC ("Unicast destination- looking up");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif);
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header, sourcePort, destinationPort, oif);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -517,7 +765,15 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, P
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  // a received packet starts with its transport header, unless it is a
+  // fragment
+  uint16_t sourcePort = 0;
+  uint16_t destinationPort = 0;
+  if (m_flowEcmpRouting)
+    {
+      GetTransportPorts (header, p, sourcePort, destinationPort);
+    }
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header, sourcePort, destinationPort);
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
@@ -537,9 +793,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -549,9 +803,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -561,9 +813,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -573,9 +823,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -585,6 +833,14 @@ Ipv4GlobalRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_FUNCTION (this << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  // Salt the flow hash with the node, so that the nodes of a path do not
+  // all split the flows the same way.
+  Ptr<Node> node = m_ipv4->GetObject<Node> ();
+  if (node != 0)
+    {
+      uint32_t id = node->GetId ();
+      m_flowEcmpSalt = Hash32 ((char*) &id, sizeof (id));
+    }
 }
 
 
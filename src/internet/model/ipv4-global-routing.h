@@ -21,6 +21,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +29,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -89,6 +91,9 @@ public:
 
   // These methods inherited from base class
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+  virtual Ptr<Ipv4Route> RouteOutputWithPorts (Ptr<Packet> p, const Ipv4Header &header,
+                                               uint16_t sourcePort, uint16_t destinationPort,
+                                               Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
 
   virtual bool RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
                             UnicastForwardCallback ucb, MulticastForwardCallback mcb,
@@ -218,6 +223,28 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Get the host and network routes to a destination.
+   *
+   * \param network The destination network, or host.
+   * \param networkMask The mask of the destination network, all ones for a
+   * host.
+   * \return The routes to exactly this destination, in the order they were
+   * added.
+   */
+  std::vector<Ipv4RoutingTableEntry *> GetRoutesTo (Ipv4Address network, Ipv4Mask networkMask) const;
+
+  /**
+   * \brief Remove the host and network routes to a destination.
+   *
+   * \param network The destination network, or host.
+   * \param networkMask The mask of the destination network, all ones for a
+   * host.
+   *
+   * \see Ipv4GlobalRouting::GetRoutesTo
+   */
+  void RemoveRoutesTo (Ipv4Address network, Ipv4Mask networkMask);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -234,6 +261,10 @@ protected:
 private:
   /// Set to true if packets are randomly routed among ECMP; set to false for using only one route consistently
   bool m_randomEcmpRouting;
+  /// Set to true if packets are routed among ECMP by the hash of their 5-tuple
+  bool m_flowEcmpRouting;
+  /// The salt of the flow hash, which differs from one node to another
+  uint32_t m_flowEcmpSalt;
   /// Set to true if this interface should respond to interface events by globallly recomputing routes 
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
@@ -262,16 +293,78 @@ private:
 
   /**
    * \brief Lookup in the forwarding table for destination.
-   * \param dest destination address
+   * \param header the header of the packet to route
+   * \param sourcePort the source port of the packet, or 0
+   * \param destinationPort the destination port of the packet, or 0
    * \param oif output interface if any (put 0 otherwise)
    * \return Ipv4Route to route the packet to reach dest address
    */
-  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  Ptr<Ipv4Route> LookupGlobal (const Ipv4Header &header, uint16_t sourcePort, uint16_t destinationPort,
+                               Ptr<NetDevice> oif = 0);
+
+  /**
+   * \brief Check whether a route goes through the requested output interface
+   * \param route the route
+   * \param oif output interface if any (0 otherwise)
+   * \return true if the route can be used
+   */
+  bool IsRouteOnInterface (const Ipv4RoutingTableEntry *route, Ptr<NetDevice> oif) const;
+
+  /**
+   * \brief Choose one of the equal-cost routes of a packet
+   *
+   * The first route is chosen, unless random or flow-hash ECMP routing is
+   * enabled.
+   *
+   * \param nRoutes the number of routes, greater than 0
+   * \param header the header of the packet
+   * \param sourcePort the source port of the packet, or 0
+   * \param destinationPort the destination port of the packet, or 0
+   * \return the index of the chosen route
+   */
+  uint32_t SelectEcmpRoute (uint32_t nRoutes, const Ipv4Header &header,
+                            uint16_t sourcePort, uint16_t destinationPort) const;
+
+  /**
+   * \brief Hash the 5-tuple of a packet with the salt of the node
+   *
+   * The ports are given by the caller, which knows where the transport
+   * header of the packet is, if any: they are 0 when unknown.
+   *
+   * \param header the header of the packet
+   * \param sourcePort the source port of the packet, or 0
+   * \param destinationPort the destination port of the packet, or 0
+   * \return the hash of the flow of the packet
+   */
+  uint32_t GetFlowHash (const Ipv4Header &header, uint16_t sourcePort, uint16_t destinationPort) const;
+
+  /**
+   * \brief Choose one of the routes to the prefixes matching a destination
+   *
+   * The routes of each prefix form its group of equal-cost next hops, kept
+   * by the trie; when several prefixes match, their routes are merged in the
+   * order they were added, without copying them.
+   *
+   * \param matches the prefixes matching the destination
+   * \param nMatches the number of prefixes matching the destination
+   * \param header the header of the packet
+   * \param sourcePort the source port of the packet, or 0
+   * \param destinationPort the destination port of the packet, or 0
+   * \param oif output interface if any (0 otherwise)
+   * \return the chosen route, or 0 if none goes through oif
+   */
+  Ipv4RoutingTableEntry *SelectRoute (const Ipv4RouteTrie::Match matches[], uint32_t nMatches,
+                                      const Ipv4Header &header, uint16_t sourcePort,
+                                      uint16_t destinationPort, Ptr<NetDevice> oif) const;
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  Ipv4RouteTrie m_hostTrie;            //!< Index of the routes to hosts
+  Ipv4RouteTrie m_networkTrie;         //!< Index of the routes to networks
+  Ipv4RouteTrie m_ASexternalTrie;      //!< Index of the external routes
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
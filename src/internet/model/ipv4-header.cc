@@ -52,6 +52,14 @@ Ipv4Header::EnableChecksum (void)
   m_calcChecksum = true;
 }
 
+bool
+Ipv4Header::IsCacheable (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // a cached copy would not honour the checksum state set by the caller
+  return !m_calcChecksum;
+}
+
 void
 Ipv4Header::SetPayloadSize (uint16_t size)
 {
@@ -35,6 +35,8 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segmentation-offload-tag.h"
+#include "ns3/segmentation-offload.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -43,6 +45,9 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "tcp-header.h"
+#include "tcp-l4-protocol.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -130,8 +135,11 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_identificationPurgeSize (64)
 {
   NS_LOG_FUNCTION (this);
+  // The devices supporting segmentation offload split the super-segments
+  SegmentationOffload::SetSegmenter (PROT_NUMBER, MakeCallback (&Ipv4L3Protocol::Segment));
 }
 
 Ipv4L3Protocol::~Ipv4L3Protocol ()
@@ -143,12 +151,16 @@ void
 Ipv4L3Protocol::Insert (Ptr<IpL4Protocol> protocol)
 {
   NS_LOG_FUNCTION (this << protocol);
-  L4ListKey_t key = std::make_pair (protocol->GetProtocolNumber (), -1);
-  if (m_protocols.find (key) != m_protocols.end ())
+  int protocolNumber = protocol->GetProtocolNumber ();
+  if (protocolNumber >= static_cast<int> (m_protocols.size ()))
     {
-      NS_LOG_WARN ("Overwriting default protocol " << int(protocol->GetProtocolNumber ()));
+      m_protocols.resize (protocolNumber + 1);
     }
-  m_protocols[key] = protocol;
+  if (m_protocols[protocolNumber] != 0)
+    {
+      NS_LOG_WARN ("Overwriting default protocol " << protocolNumber);
+    }
+  m_protocols[protocolNumber] = protocol;
 }
 
 void
@@ -157,11 +169,11 @@ Ipv4L3Protocol::Insert (Ptr<IpL4Protocol> protocol, uint32_t interfaceIndex)
   NS_LOG_FUNCTION (this << protocol << interfaceIndex);
 
   L4ListKey_t key = std::make_pair (protocol->GetProtocolNumber (), interfaceIndex);
-  if (m_protocols.find (key) != m_protocols.end ())
+  if (m_interfaceProtocols.find (key) != m_interfaceProtocols.end ())
     {
       NS_LOG_WARN ("Overwriting protocol " << int(protocol->GetProtocolNumber ()) << " on interface " << int(interfaceIndex));
     }
-  m_protocols[key] = protocol;
+  m_interfaceProtocols[key] = protocol;
 }
 
 void
@@ -169,15 +181,14 @@ Ipv4L3Protocol::Remove (Ptr<IpL4Protocol> protocol)
 {
   NS_LOG_FUNCTION (this << protocol);
 
-  L4ListKey_t key = std::make_pair (protocol->GetProtocolNumber (), -1);
-  L4List_t::iterator iter = m_protocols.find (key);
-  if (iter == m_protocols.end ())
+  int protocolNumber = protocol->GetProtocolNumber ();
+  if (protocolNumber >= static_cast<int> (m_protocols.size ()) || m_protocols[protocolNumber] == 0)
     {
-      NS_LOG_WARN ("Trying to remove an non-existent default protocol " << int(protocol->GetProtocolNumber ()));
+      NS_LOG_WARN ("Trying to remove an non-existent default protocol " << protocolNumber);
     }
   else
     {
-      m_protocols.erase (key);
+      m_protocols[protocolNumber] = 0;
     }
 }
 
@@ -187,14 +198,14 @@ Ipv4L3Protocol::Remove (Ptr<IpL4Protocol> protocol, uint32_t interfaceIndex)
   NS_LOG_FUNCTION (this << protocol << interfaceIndex);
 
   L4ListKey_t key = std::make_pair (protocol->GetProtocolNumber (), interfaceIndex);
-  L4List_t::iterator iter = m_protocols.find (key);
-  if (iter == m_protocols.end ())
+  L4List_t::iterator iter = m_interfaceProtocols.find (key);
+  if (iter == m_interfaceProtocols.end ())
     {
       NS_LOG_WARN ("Trying to remove an non-existent protocol " << int(protocol->GetProtocolNumber ()) << " on interface " << int(interfaceIndex));
     }
   else
     {
-      m_protocols.erase (key);
+      m_interfaceProtocols.erase (iter);
     }
 }
 
@@ -211,24 +222,19 @@ Ipv4L3Protocol::GetProtocol (int protocolNumber, int32_t interfaceIndex) const
 {
   NS_LOG_FUNCTION (this << protocolNumber << interfaceIndex);
 
-  L4ListKey_t key;
-  L4List_t::const_iterator i;
-  if (interfaceIndex >= 0)
+  if (interfaceIndex >= 0 && !m_interfaceProtocols.empty ())
     {
       // try the interface-specific protocol.
-      key = std::make_pair (protocolNumber, interfaceIndex);
-      i = m_protocols.find (key);
-      if (i != m_protocols.end ())
+      L4List_t::const_iterator i = m_interfaceProtocols.find (std::make_pair (protocolNumber, interfaceIndex));
+      if (i != m_interfaceProtocols.end ())
         {
           return i->second;
         }
     }
   // try the generic protocol.
-  key = std::make_pair (protocolNumber, -1);
-  i = m_protocols.find (key);
-  if (i != m_protocols.end ())
+  if (protocolNumber >= 0 && protocolNumber < static_cast<int> (m_protocols.size ()))
     {
-      return i->second;
+      return m_protocols[protocolNumber];
     }
 
   return 0;
@@ -307,11 +313,13 @@ void
 Ipv4L3Protocol::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
-  for (L4List_t::iterator i = m_protocols.begin (); i != m_protocols.end (); ++i)
+  m_protocols.clear ();
+  for (L4List_t::iterator i = m_interfaceProtocols.begin (); i != m_interfaceProtocols.end (); ++i)
     {
       i->second = 0;
     }
-  m_protocols.clear ();
+  m_interfaceProtocols.clear ();
+  m_identification.clear ();
 
   for (Ipv4InterfaceList::iterator i = m_interfaces.begin (); i != m_interfaces.end (); ++i)
     {
@@ -779,6 +787,15 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
   // can construct the header here
   Ipv4Header ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment);
 
+  // The wire segments of a super-segment take the identifications following
+  // its own
+  SegmentationOffloadTag offload;
+  if (packet->PeekPacketTag (offload))
+    {
+      uint64_t srcDst = destination.Get () | (static_cast<uint64_t> (source.Get ()) << 32);
+      GetIdentification (std::make_pair (srcDst, protocol)).next += offload.GetSegments () - 1;
+    }
+
   // Handle a few cases:
   // 1) packet is passed in with a route entry
   // 1a) packet is passed in with a route entry but route->GetGateway is not set (e.g., on-demand)
@@ -877,7 +894,12 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
   Ptr<Ipv4Route> newRoute;
   if (m_routingProtocol != 0)
     {
-      newRoute = m_routingProtocol->RouteOutput (packet, ipHeader, oif, errno_);
+      // the packet starts with its transport header
+      uint16_t sourcePort;
+      uint16_t destinationPort;
+      Ipv4RoutingProtocol::GetTransportPorts (ipHeader, packet, sourcePort, destinationPort);
+      newRoute = m_routingProtocol->RouteOutputWithPorts (packet, ipHeader, sourcePort, destinationPort,
+                                                          oif, errno_);
     }
   else
     {
@@ -904,8 +926,50 @@ Ipv4L3Protocol::DecreaseIdentification (Ipv4Address source,
   uint64_t src = source.Get ();
   uint64_t dst = destination.Get ();
   uint64_t srcDst = dst | (src << 32);
-  std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, protocol);
-  m_identification[key]--;
+  IdentificationMap_t::iterator i = m_identification.find (std::make_pair (srcDst, protocol));
+  if (i != m_identification.end ())
+    {
+      i->second.next--;
+    }
+}
+
+size_t
+Ipv4L3Protocol::IdentificationKeyHash::operator () (const IdentificationKey_t &key) const
+{
+  uint64_t hash = (key.first ^ key.second) * 0x9e3779b97f4a7c15ULL;
+  return static_cast<size_t> (hash ^ (hash >> 29));
+}
+
+Ipv4L3Protocol::Identification &
+Ipv4L3Protocol::GetIdentification (const IdentificationKey_t &key)
+{
+  Time now = Simulator::Now ();
+  IdentificationMap_t::iterator i = m_identification.find (key);
+  if (i != m_identification.end ())
+    {
+      i->second.lastUsed = now;
+      return i->second;
+    }
+  if (m_identification.size () >= m_identificationPurgeSize)
+    {
+      for (i = m_identification.begin (); i != m_identification.end (); )
+        {
+          if (now - i->second.lastUsed > m_fragmentExpirationTimeout)
+            {
+              i = m_identification.erase (i);
+            }
+          else
+            {
+              ++i;
+            }
+        }
+      m_identificationPurgeSize = std::max<std::size_t> (64, 2 * m_identification.size ());
+      NS_LOG_LOGIC ("Identification states after purge: " << m_identification.size ());
+    }
+  Identification &identification = m_identification[key];
+  identification.next = 0;
+  identification.lastUsed = now;
+  return identification;
 }
 
 Ipv4Header
@@ -930,13 +994,13 @@ Ipv4L3Protocol::BuildHeader (
   uint64_t src = source.Get ();
   uint64_t dst = destination.Get ();
   uint64_t srcDst = dst | (src << 32);
-  std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, protocol);
+  Identification &identification = GetIdentification (std::make_pair (srcDst, protocol));
 
   if (mayFragment == true)
     {
       ipHeader.SetMayFragment ();
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (identification.next);
+      identification.next++;
     }
   else
     {
@@ -945,8 +1009,8 @@ Ipv4L3Protocol::BuildHeader (
       // identification requirement:
       // >> Originating sources MAY set the IPv4 ID field of atomic datagrams
       //    to any value.
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (identification.next);
+      identification.next++;
     }
   if (Node::ChecksumEnabled ())
     {
@@ -989,21 +1053,41 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   if (outInterface->IsUp ())
     {
       NS_LOG_LOGIC ("Send to " << targetLabel << " " << target);
-      if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+      //
+      // A super-segment is split into its wire segments by the device if it
+      // supports segmentation offload, and here otherwise.  It is never
+      // fragmented.
+      //
+      std::list<Ipv4PayloadHeaderPair> listPackets;
+      SegmentationOffloadTag offload;
+      bool superSegment = packet->PeekPacketTag (offload);
+      if (superSegment && !outInterface->GetDevice ()->SupportsSegmentationOffload ())
         {
-          std::list<Ipv4PayloadHeaderPair> listFragments;
-          DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
-          for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
-            {
-              NS_LOG_LOGIC ("Sending fragment " << *(it->first) );
-              CallTxTrace (it->second, it->first, m_node->GetObject<Ipv4> (), interface);
-              outInterface->Send (it->first, it->second, target);
-            }
+          DoSegmentation (packet, ipHeader, listPackets);
+          superSegment = false;
         }
       else
         {
-          CallTxTrace (ipHeader, packet, m_node->GetObject<Ipv4> (), interface);
-          outInterface->Send (packet, ipHeader, target);
+          listPackets.push_back (Ipv4PayloadHeaderPair (packet, ipHeader));
+        }
+      for (std::list<Ipv4PayloadHeaderPair>::iterator i = listPackets.begin (); i != listPackets.end (); i++)
+        {
+          if (!superSegment && i->first->GetSize () + i->second.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ())
+            {
+              std::list<Ipv4PayloadHeaderPair> listFragments;
+              DoFragmentation (i->first, i->second, outInterface->GetDevice ()->GetMtu (), listFragments);
+              for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
+                {
+                  NS_LOG_LOGIC ("Sending fragment " << *(it->first) );
+                  CallTxTrace (it->second, it->first, m_node->GetObject<Ipv4> (), interface);
+                  outInterface->Send (it->first, it->second, target);
+                }
+            }
+          else
+            {
+              CallTxTrace (i->second, i->first, m_node->GetObject<Ipv4> (), interface);
+              outInterface->Send (i->first, i->second, target);
+            }
         }
     }
 }
@@ -1432,6 +1516,77 @@ Ipv4L3Protocol::RouteInputError (Ptr<const Packet> p, const Ipv4Header & ipHeade
   // \todo Send an ICMP no route.
 }
 
+void
+Ipv4L3Protocol::DoSegmentation (Ptr<const Packet> packet, const Ipv4Header& ipv4Header, std::list<Ipv4PayloadHeaderPair>& listSegments)
+{
+  NS_LOG_FUNCTION (packet << ipv4Header);
+
+  Ptr<Packet> payload = packet->Copy ();
+  SegmentationOffloadTag offload;
+  bool found = payload->RemovePacketTag (offload);
+  NS_ASSERT_MSG (found && ipv4Header.GetProtocol () == TcpL4Protocol::PROT_NUMBER,
+                 "Only the TCP super-segments can be split");
+
+  TcpHeader tcpHeader;
+  if (Node::ChecksumEnabled ())
+    {
+      tcpHeader.EnableChecksums ();
+      tcpHeader.InitializeChecksum (ipv4Header.GetSource (), ipv4Header.GetDestination (), TcpL4Protocol::PROT_NUMBER);
+    }
+  payload->RemoveHeader (tcpHeader);
+
+  uint32_t size = payload->GetSize ();
+  uint16_t identification = ipv4Header.GetIdentification ();
+  for (uint32_t offset = 0; offset < size; offset += offload.GetSegmentSize ())
+    {
+      uint32_t length = std::min<uint32_t> (offload.GetSegmentSize (), size - offset);
+      Ptr<Packet> segment = payload->CreateFragment (offset, length);
+
+      // FIN and PSH are set on the last segment only, CWR on the first one
+      TcpHeader segmentTcpHeader = tcpHeader;
+      segmentTcpHeader.SetSequenceNumber (tcpHeader.GetSequenceNumber () + offset);
+      uint8_t flags = tcpHeader.GetFlags ();
+      if (offset + length < size)
+        {
+          flags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+      if (offset > 0)
+        {
+          flags &= ~TcpHeader::CWR;
+        }
+      segmentTcpHeader.SetFlags (flags);
+      segment->AddHeader (segmentTcpHeader);
+
+      Ipv4Header segmentHeader = ipv4Header;
+      segmentHeader.SetPayloadSize (segment->GetSize ());
+      segmentHeader.SetIdentification (identification++);
+      listSegments.push_back (Ipv4PayloadHeaderPair (segment, segmentHeader));
+    }
+  NS_LOG_LOGIC ("Super-segment split in " << listSegments.size () << " wire segments");
+}
+
+void
+Ipv4L3Protocol::Segment (Ptr<const Packet> packet, std::list<Ptr<Packet> > &segments)
+{
+  NS_LOG_FUNCTION (packet);
+
+  Ptr<Packet> p = packet->Copy ();
+  Ipv4Header ipHeader;
+  if (Node::ChecksumEnabled ())
+    {
+      ipHeader.EnableChecksum ();
+    }
+  p->RemoveHeader (ipHeader);
+
+  std::list<Ipv4PayloadHeaderPair> listSegments;
+  DoSegmentation (p, ipHeader, listSegments);
+  for (std::list<Ipv4PayloadHeaderPair>::iterator i = listSegments.begin (); i != listSegments.end (); i++)
+    {
+      i->first->AddHeader (i->second);
+      segments.push_back (i->first);
+    }
+}
+
 void
 Ipv4L3Protocol::DoFragmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments)
 {
@@ -24,6 +24,7 @@
 #include <list>
 #include <map>
 #include <vector>
+#include <unordered_map>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ptr.h"
@@ -416,6 +417,31 @@ private:
    */
   void DoFragmentation (Ptr<Packet> packet, const Ipv4Header& ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments);
 
+  /**
+   * \brief Split a TCP super-segment into its wire segments
+   *
+   * The wire segments carry the payload of the super-segment, split as its
+   * SegmentationOffloadTag says, with a copy of its TCP and IPv4 headers
+   * updated for each of them, as a Linux NIC doing TCP segmentation offload
+   * builds them.
+   *
+   * \param packet the super-segment, starting with its TCP header
+   * \param ipv4Header the IPv4 header of the super-segment
+   * \param listSegments the list the wire segments are appended to
+   */
+  static void DoSegmentation (Ptr<const Packet> packet, const Ipv4Header& ipv4Header, std::list<Ipv4PayloadHeaderPair>& listSegments);
+
+  /**
+   * \brief Split a TCP super-segment, starting with its IPv4 header, into its
+   * wire segments, with their IPv4 headers
+   *
+   * This is the SegmentationOffload::Segmenter of IPv4.
+   *
+   * \param packet the super-segment
+   * \param segments the list the wire segments are appended to
+   */
+  static void Segment (Ptr<const Packet> packet, std::list<Ptr<Packet> > &segments);
+
   /**
    * \brief Process a packet fragment
    * \param packet the packet
@@ -456,17 +482,68 @@ private:
   typedef std::pair<int, int32_t> L4ListKey_t;
 
   /**
-   * \brief Container of the IPv4 L4 instances.
+   * \brief Container of the IPv4 L4 instances bound to an interface.
    */
   typedef std::map<L4ListKey_t, Ptr<IpL4Protocol> > L4List_t;
 
+  /**
+   * \brief Container of the default IPv4 L4 instances, indexed by protocol
+   * number.
+   */
+  typedef std::vector<Ptr<IpL4Protocol> > L4Array_t;
+
+  /**
+   * \brief Key of the identification state: {src, dst} addresses, protocol
+   */
+  typedef std::pair<uint64_t, uint8_t> IdentificationKey_t;
+
+  /**
+   * \brief Hash function of the identification keys.
+   */
+  struct IdentificationKeyHash
+  {
+    /**
+     * \param key the identification key
+     * \returns the hash of the key
+     */
+    size_t operator () (const IdentificationKey_t &key) const;
+  };
+
+  /**
+   * \brief Identification state of a {src, dst, proto} tuple.
+   */
+  struct Identification
+  {
+    uint16_t next;   //!< Identification of the next packet
+    Time lastUsed;   //!< Time of the last packet
+  };
+
+  /**
+   * \brief Container of the identification states.
+   */
+  typedef std::unordered_map<IdentificationKey_t, Identification, IdentificationKeyHash> IdentificationMap_t;
+
+  /**
+   * \brief Get the identification state of a {src, dst, proto} tuple,
+   * creating it if needed.
+   *
+   * The states not used for longer than the fragment expiration timeout
+   * are purged when the table has doubled since the last purge: a receiver
+   * has dropped the fragments with their identification by then.
+   * \param key the identification key
+   * \returns the identification state
+   */
+  Identification & GetIdentification (const IdentificationKey_t &key);
+
   bool m_ipForward;      //!< Forwarding packets (i.e. router mode) state.
   bool m_weakEsModel;    //!< Weak ES model state
-  L4List_t m_protocols;  //!< List of transport protocol.
+  L4Array_t m_protocols;  //!< Default transport protocols, by protocol number.
+  L4List_t m_interfaceProtocols;  //!< Transport protocols bound to an interface.
   Ipv4InterfaceList m_interfaces; //!< List of IPv4 interfaces.
   Ipv4InterfaceReverseContainer m_reverseInterfacesContainer; //!< Container of NetDevice / Interface index associations.
   uint8_t m_defaultTtl;  //!< Default TTL
-  std::map<std::pair<uint64_t, uint8_t>, uint16_t> m_identification; //!< Identification (for each {src, dst, proto} tuple)
+  IdentificationMap_t m_identification; //!< Identification (for each {src, dst, proto} tuple)
+  std::size_t m_identificationPurgeSize; //!< Size of m_identification triggering a purge
   Ptr<Node> m_node; //!< Node attached to stack.
 
   /// Trace of sent packets
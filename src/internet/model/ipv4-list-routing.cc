@@ -124,6 +124,31 @@ Ipv4ListRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDe
   return 0;
 }
 
+Ptr<Ipv4Route>
+Ipv4ListRouting::RouteOutputWithPorts (Ptr<Packet> p, const Ipv4Header &header,
+                                       uint16_t sourcePort, uint16_t destinationPort,
+                                       Ptr<NetDevice> oif, enum Socket::SocketErrno &sockerr)
+{
+  NS_LOG_FUNCTION (this << p << header.GetDestination () << header.GetSource () << sourcePort << destinationPort << oif << sockerr);
+  Ptr<Ipv4Route> route;
+
+  for (Ipv4RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      NS_LOG_LOGIC ("Checking protocol " << (*i).second->GetInstanceTypeId () << " with priority " << (*i).first);
+      route = (*i).second->RouteOutputWithPorts (p, header, sourcePort, destinationPort, oif, sockerr);
+      if (route)
+        {
+          NS_LOG_LOGIC ("Found route " << route);
+          sockerr = Socket::ERROR_NOTERROR;
+          return route;
+        }
+    }
+  NS_LOG_LOGIC ("Done checking " << GetTypeId ());
+  sockerr = Socket::ERROR_NOROUTETOHOST;
+  return 0;
+}
+
 // Patterned after Linux ip_route_input and ip_route_input_slow
 bool 
 Ipv4ListRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev, 
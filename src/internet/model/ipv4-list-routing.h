@@ -80,6 +80,9 @@ public:
 
   // Below are from Ipv4RoutingProtocol
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+  virtual Ptr<Ipv4Route> RouteOutputWithPorts (Ptr<Packet> p, const Ipv4Header &header,
+                                               uint16_t sourcePort, uint16_t destinationPort,
+                                               Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
 
   virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
                            UnicastForwardCallback ucb, MulticastForwardCallback mcb,
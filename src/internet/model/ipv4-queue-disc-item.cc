@@ -114,7 +114,14 @@ Ipv4QueueDiscItem::GetUint8Value (QueueItem::Uint8Values field, uint8_t& value)
 uint32_t
 Ipv4QueueDiscItem::Hash (uint32_t perturbation) const
 {
-  NS_LOG_FUNCTION (this << perturbation);
+  Hasher hasher;
+  return Hash (hasher, perturbation);
+}
+
+uint32_t
+Ipv4QueueDiscItem::Hash (Hasher &hasher, uint32_t perturbation) const
+{
+  NS_LOG_FUNCTION (this << &hasher << perturbation);
 
   Ipv4Address src = m_header.GetSource ();
   Ipv4Address dest = m_header.GetDestination ();
@@ -159,7 +166,7 @@ Ipv4QueueDiscItem::Hash (uint32_t perturbation) const
 
   // Linux calculates jhash2 (jenkins hash), we calculate murmur3 because it is
   // already available in ns-3
-  uint32_t hash = Hash32 ((char*) buf, 17);
+  uint32_t hash = hasher.clear ().GetHash32 ((char*) buf, 17);
 
   NS_LOG_DEBUG ("Hash value " << hash);
 
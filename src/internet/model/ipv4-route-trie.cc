@@ -0,0 +1,259 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ipv4-route-trie.h"
+#include "ipv4-routing-table-entry.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteTrie");
+
+namespace {
+
+/**
+ * \param length a prefix length
+ * \returns the mask of the prefix
+ */
+inline uint32_t
+PrefixMask (uint8_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+/**
+ * \param value an address
+ * \param position a bit position, from the most significant bit
+ * \returns the bit at the position
+ */
+inline uint32_t
+Bit (uint32_t value, uint8_t position)
+{
+  return (value >> (31 - position)) & 1;
+}
+
+/**
+ * \param mask a network mask
+ * \param length the prefix length of the mask, if contiguous
+ * \returns true if the mask is contiguous
+ */
+bool
+GetPrefixLength (Ipv4Mask mask, uint8_t &length)
+{
+  uint32_t inverse = ~mask.Get ();
+  if ((inverse & (inverse + 1)) != 0)
+    {
+      return false;
+    }
+  length = 0;
+  for (uint32_t m = mask.Get (); m != 0; m <<= 1)
+    {
+      length++;
+    }
+  return true;
+}
+
+} // unnamed namespace
+
+Ipv4RouteTrie::Ipv4RouteTrie ()
+  : m_root (0),
+    m_order (0),
+    m_nUnindexed (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4RouteTrie::~Ipv4RouteTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  Delete (m_root);
+}
+
+Ipv4RouteTrie::Node *
+Ipv4RouteTrie::NewNode (uint32_t prefix, uint8_t length)
+{
+  Node *node = new Node;
+  node->prefix = prefix;
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+void
+Ipv4RouteTrie::Delete (Node *node)
+{
+  if (node != 0)
+    {
+      Delete (node->child[0]);
+      Delete (node->child[1]);
+      delete node;
+    }
+}
+
+void
+Ipv4RouteTrie::Insert (Ipv4RoutingTableEntry *entry, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << entry << metric);
+  uint8_t length;
+  if (!GetPrefixLength (entry->GetDestNetworkMask (), length))
+    {
+      m_nUnindexed++;
+      return;
+    }
+  uint32_t prefix = entry->GetDestNetwork ().Get () & PrefixMask (length);
+  Route route;
+  route.entry = entry;
+  route.metric = metric;
+  route.order = m_order++;
+
+  Node **link = &m_root;
+  while (true)
+    {
+      Node *node = *link;
+      if (node == 0)
+        {
+          node = NewNode (prefix, length);
+          node->routes.push_back (route);
+          *link = node;
+          return;
+        }
+      // length of the prefix common to the route and the node
+      uint8_t common = 0;
+      uint8_t maxCommon = std::min (length, node->length);
+      while (common < maxCommon && Bit (prefix, common) == Bit (node->prefix, common))
+        {
+          common++;
+        }
+      if (common == node->length)
+        {
+          if (length == node->length)
+            {
+              node->routes.push_back (route);
+              return;
+            }
+          link = &node->child[Bit (prefix, node->length)];
+          continue;
+        }
+      // the route diverges from the node prefix, or is a prefix of it
+      Node *split = NewNode (prefix & PrefixMask (common), common);
+      split->child[Bit (node->prefix, common)] = node;
+      if (common == length)
+        {
+          split->routes.push_back (route);
+        }
+      else
+        {
+          Node *leaf = NewNode (prefix, length);
+          leaf->routes.push_back (route);
+          split->child[Bit (prefix, common)] = leaf;
+        }
+      *link = split;
+      return;
+    }
+}
+
+Ipv4RouteTrie::Node *
+Ipv4RouteTrie::Remove (Node *node, uint32_t prefix, uint8_t length, Ipv4RoutingTableEntry *entry)
+{
+  if (node == 0 || node->length > length || (prefix & PrefixMask (node->length)) != node->prefix)
+    {
+      return node;
+    }
+  if (node->length == length)
+    {
+      for (Routes::iterator i = node->routes.begin (); i != node->routes.end (); ++i)
+        {
+          if (i->entry == entry)
+            {
+              node->routes.erase (i);
+              break;
+            }
+        }
+    }
+  else
+    {
+      Node *&child = node->child[Bit (prefix, node->length)];
+      child = Remove (child, prefix, length, entry);
+    }
+  // Nodes without routes are only kept to join two subtries
+  if (!node->routes.empty () || (node->child[0] != 0 && node->child[1] != 0))
+    {
+      return node;
+    }
+  Node *child = node->child[0] != 0 ? node->child[0] : node->child[1];
+  delete node;
+  return child;
+}
+
+void
+Ipv4RouteTrie::Remove (Ipv4RoutingTableEntry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  uint8_t length;
+  if (!GetPrefixLength (entry->GetDestNetworkMask (), length))
+    {
+      NS_ASSERT (m_nUnindexed > 0);
+      m_nUnindexed--;
+      return;
+    }
+  uint32_t prefix = entry->GetDestNetwork ().Get () & PrefixMask (length);
+  m_root = Remove (m_root, prefix, length, entry);
+}
+
+void
+Ipv4RouteTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  Delete (m_root);
+  m_root = 0;
+  m_nUnindexed = 0;
+}
+
+bool
+Ipv4RouteTrie::IsComplete (void) const
+{
+  return m_nUnindexed == 0;
+}
+
+uint32_t
+Ipv4RouteTrie::Lookup (Ipv4Address dest, Match matches[]) const
+{
+  uint32_t address = dest.Get ();
+  uint32_t n = 0;
+  const Node *node = m_root;
+  while (node != 0 && (address & PrefixMask (node->length)) == node->prefix)
+    {
+      if (!node->routes.empty ())
+        {
+          NS_ASSERT (n < MAX_MATCHES);
+          matches[n].length = node->length;
+          matches[n].routes = &node->routes;
+          n++;
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->child[Bit (address, node->length)];
+    }
+  std::reverse (matches, matches + n);
+  return n;
+}
+
+} // namespace ns3
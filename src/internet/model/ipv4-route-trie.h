@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IPV4_ROUTE_TRIE_H
+#define IPV4_ROUTE_TRIE_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Index of IPv4 unicast routes by destination prefix
+ *
+ * A path-compressed binary trie of the destination networks of a set of
+ * Ipv4RoutingTableEntry, used by Ipv4StaticRouting and Ipv4GlobalRouting
+ * to find the routes matching a destination without scanning their route
+ * lists.  The trie does not own the routes, and keeps, for each prefix,
+ * the routes in the order they were inserted, so that the routing
+ * protocols can apply their own selection rules (longest prefix, metric,
+ * ECMP) exactly as they did on their lists.
+ *
+ * Routes with a non-contiguous network mask cannot be indexed by prefix:
+ * they are only counted, and a routing protocol must fall back to its
+ * route list when IsComplete returns false.
+ */
+class Ipv4RouteTrie
+{
+public:
+  /// A route of the trie
+  struct Route
+  {
+    Ipv4RoutingTableEntry *entry;  //!< the route
+    uint32_t metric;               //!< the route metric
+    uint64_t order;                //!< the insertion order of the route
+  };
+  /// The routes to a given prefix, in insertion order
+  typedef std::vector<Route> Routes;
+
+  /// A prefix matching a destination
+  struct Match
+  {
+    uint8_t length;         //!< the prefix length
+    const Routes *routes;   //!< the routes to the prefix
+  };
+
+  /// The maximum number of prefixes matching a destination
+  static const uint32_t MAX_MATCHES = 33;
+
+  Ipv4RouteTrie ();
+  ~Ipv4RouteTrie ();
+
+  /**
+   * \brief Add a route
+   * \param entry the route, which must outlive its presence in the trie
+   * \param metric the route metric
+   */
+  void Insert (Ipv4RoutingTableEntry *entry, uint32_t metric = 0);
+
+  /**
+   * \brief Remove a route
+   * \param entry the route
+   */
+  void Remove (Ipv4RoutingTableEntry *entry);
+
+  /**
+   * \brief Remove all the routes
+   */
+  void Clear (void);
+
+  /**
+   * \returns true if all the routes are indexed, i.e., no route has a
+   * non-contiguous network mask
+   */
+  bool IsComplete (void) const;
+
+  /**
+   * \brief Find the prefixes matching a destination
+   * \param dest the destination
+   * \param matches the array, of MAX_MATCHES elements, the matching
+   *        prefixes which have routes are stored in, longest first
+   * \returns the number of matching prefixes
+   */
+  uint32_t Lookup (Ipv4Address dest, Match matches[]) const;
+
+private:
+  /**
+   * \brief Copy constructor.
+   *
+   * Defined but not implemented to avoid misuse
+   */
+  Ipv4RouteTrie (const Ipv4RouteTrie &);
+
+  /**
+   * \brief Copy constructor.
+   *
+   * Defined but not implemented to avoid misuse
+   * \returns the copied object
+   */
+  Ipv4RouteTrie &operator = (const Ipv4RouteTrie &);
+
+  /// A node of the trie
+  struct Node
+  {
+    uint32_t prefix;    //!< the prefix, with the bits past its length cleared
+    uint8_t length;     //!< the prefix length
+    Node *child[2];     //!< the subtries, by the bit following the prefix
+    Routes routes;      //!< the routes to the prefix
+  };
+
+  /**
+   * \param prefix a prefix
+   * \param length the prefix length
+   * \returns a new leaf
+   */
+  static Node *NewNode (uint32_t prefix, uint8_t length);
+  /**
+   * \brief Remove a route from a subtrie
+   * \param node the subtrie root
+   * \param prefix the route prefix
+   * \param length the route prefix length
+   * \param entry the route
+   * \returns the new subtrie root
+   */
+  static Node *Remove (Node *node, uint32_t prefix, uint8_t length, Ipv4RoutingTableEntry *entry);
+  /**
+   * \brief Delete a subtrie
+   * \param node the subtrie root
+   */
+  static void Delete (Node *node);
+
+  Node *m_root;             //!< the root of the trie
+  uint64_t m_order;         //!< the insertion order of the next route
+  uint32_t m_nUnindexed;    //!< the number of routes with a non-contiguous mask
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_TRIE_H */
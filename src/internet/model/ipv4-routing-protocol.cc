@@ -36,4 +36,31 @@ TypeId Ipv4RoutingProtocol::GetTypeId (void)
   return tid;
 }
 
+Ptr<Ipv4Route>
+Ipv4RoutingProtocol::RouteOutputWithPorts (Ptr<Packet> p, const Ipv4Header &header,
+                                           uint16_t sourcePort, uint16_t destinationPort,
+                                           Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
+{
+  return RouteOutput (p, header, oif, sockerr);
+}
+
+void
+Ipv4RoutingProtocol::GetTransportPorts (const Ipv4Header &header, Ptr<const Packet> p,
+                                        uint16_t &sourcePort, uint16_t &destinationPort)
+{
+  sourcePort = 0;
+  destinationPort = 0;
+  uint8_t prot = header.GetProtocol ();
+  // the source and destination ports are the first four bytes of both the
+  // TCP and the UDP headers
+  if ((prot == 6 || prot == 17) && header.GetFragmentOffset () == 0
+      && p != 0 && p->GetSize () >= 4)
+    {
+      uint8_t ports[4];
+      p->CopyData (ports, 4);
+      sourcePort = (ports[0] << 8) | ports[1];
+      destinationPort = (ports[2] << 8) | ports[3];
+    }
+}
+
 } // namespace ns3
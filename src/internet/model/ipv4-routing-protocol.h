@@ -96,6 +96,43 @@ public:
    */
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr) = 0;
 
+  /**
+   * \brief Query routing cache for an existing route, for an outbound packet
+   * of a TCP or UDP flow
+   *
+   * This lookup is used by the transport protocols which know the ports of
+   * the flow, so that the routing protocol can tell the flows apart even
+   * though the packet, if any, does not start with the transport header.
+   * The default implementation ignores the ports and calls RouteOutput ().
+   *
+   * \param p packet to be routed.  Note that this method may modify the packet.
+   *          Callers may also pass in a null pointer.
+   * \param header input parameter (used to form key to search for the route)
+   * \param sourcePort the source port of the flow
+   * \param destinationPort the destination port of the flow
+   * \param oif Output interface Netdevice.  May be zero, or may be bound via
+   *            socket options to a particular output interface.
+   * \param sockerr Output parameter; socket errno
+   *
+   * \returns a code that indicates what happened in the lookup
+   */
+  virtual Ptr<Ipv4Route> RouteOutputWithPorts (Ptr<Packet> p, const Ipv4Header &header,
+                                               uint16_t sourcePort, uint16_t destinationPort,
+                                               Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+
+  /**
+   * \brief Read the ports of a TCP or UDP packet
+   *
+   * \param header the IPv4 header of the packet
+   * \param p the packet, starting with its transport header, or a null pointer
+   * \param sourcePort the source port, or 0 if the packet is not the first
+   *        fragment of a TCP or UDP packet
+   * \param destinationPort the destination port, or 0 if the packet is not
+   *        the first fragment of a TCP or UDP packet
+   */
+  static void GetTransportPorts (const Ipv4Header &header, Ptr<const Packet> p,
+                                 uint16_t &sourcePort, uint16_t &destinationPort);
+
   /**
    * \brief Route an input packet (to be forwarded or locally delivered)
    *
@@ -26,6 +26,30 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 
+Ipv6EndPointDemux::FourTuple::FourTuple (Ipv6Address localAddress, uint16_t localPort,
+                                         Ipv6Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    peerAddress (peerAddress),
+    localPort (localPort),
+    peerPort (peerPort)
+{
+}
+
+bool Ipv6EndPointDemux::FourTuple::operator == (const FourTuple &other) const
+{
+  return localAddress == other.localAddress && peerAddress == other.peerAddress
+         && localPort == other.localPort && peerPort == other.peerPort;
+}
+
+size_t Ipv6EndPointDemux::FourTupleHash::operator () (const FourTuple &tuple) const
+{
+  Ipv6AddressHash addressHash;
+  uint64_t hash = addressHash (tuple.peerAddress);
+  hash = (hash << 16 ^ tuple.peerPort) * 0x9e3779b97f4a7c15ULL;
+  hash ^= (static_cast<uint64_t> (addressHash (tuple.localAddress)) << 16 ^ tuple.localPort) * 0xc2b2ae3d27d4eb4fULL;
+  return static_cast<size_t> (hash ^ (hash >> 29));
+}
+
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
@@ -40,27 +64,89 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+bool Ipv6EndPointDemux::IsConnected (Ipv6EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  return endPoint->GetLocalAddress () != Ipv6Address::GetAny ()
+         && endPoint->GetPeerAddress () != Ipv6Address::GetAny ()
+         && endPoint->GetPeerPort () != 0;
+}
+
+Ipv6EndPoint* Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  m_positions[endPoint] = m_endPoints.insert (m_endPoints.end (), endPoint);
+  m_portUsers[endPoint->GetLocalPort ()]++;
+  endPoint->m_demux = this;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  if (IsConnected (endPoint))
+    {
+      FourTuple tuple (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                       endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      m_connected.insert (std::make_pair (tuple, endPoint));
+    }
+  else
     {
-      if ((*i)->GetLocalPort  () == port)
+      m_unconnected[endPoint->GetLocalPort ()].push_back (endPoint);
+    }
+}
+
+void Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  if (IsConnected (endPoint))
+    {
+      FourTuple tuple (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                       endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      std::pair<ConnectedEndPoints::iterator, ConnectedEndPoints::iterator> range = m_connected.equal_range (tuple);
+      for (ConnectedEndPoints::iterator i = range.first; i != range.second; i++)
         {
-          return true;
+          if (i->second == endPoint)
+            {
+              m_connected.erase (i);
+              return;
+            }
+        }
+    }
+  else
+    {
+      PortEndPoints::iterator port = m_unconnected.find (endPoint->GetLocalPort ());
+      if (port != m_unconnected.end ())
+        {
+          port->second.remove (endPoint);
+          if (port->second.empty ())
+            {
+              m_unconnected.erase (port);
+            }
         }
     }
-  return false;
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_portUsers.find (port) != m_portUsers.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       if ((*i)->GetLocalPort () == port &&
@@ -82,10 +168,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (Ipv6Address::GetAny (), port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
@@ -97,10 +180,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, uint16_t port)
@@ -118,10 +198,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       NS_LOG_WARN ("Duplicated endpoint.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
@@ -129,7 +206,29 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
+  endPoint->SetPeer (peerAddress, peerPort);
+
+  // A duplicate has the same four-tuple, hence is in the same table
+  EndPoints candidates;
+  if (IsConnected (endPoint))
+    {
+      FourTuple tuple (localAddress, localPort, peerAddress, peerPort);
+      std::pair<ConnectedEndPoints::iterator, ConnectedEndPoints::iterator> range = m_connected.equal_range (tuple);
+      for (ConnectedEndPoints::iterator i = range.first; i != range.second; i++)
+        {
+          candidates.push_back (i->second);
+        }
+    }
+  else
+    {
+      PortEndPoints::iterator port = m_unconnected.find (localPort);
+      if (port != m_unconnected.end ())
+        {
+          candidates = port->second;
+        }
+    }
+  for (EndPointsI i = candidates.begin (); i != candidates.end (); i++)
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -138,29 +237,128 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
           ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
         {
           NS_LOG_WARN ("Duplicated endpoint.");
+          delete endPoint;
           return 0;
         }
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
-  endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<Ipv6EndPoint *, EndPointsI>::iterator position = m_positions.find (endPoint);
+  if (position == m_positions.end ())
     {
-      if (*i == endPoint)
+      return;
+    }
+  Unindex (endPoint);
+  std::unordered_map<uint16_t, uint32_t>::iterator users = m_portUsers.find (endPoint->GetLocalPort ());
+  if (--users->second == 0)
+    {
+      m_portUsers.erase (users);
+    }
+  m_endPoints.erase (position->second);
+  m_positions.erase (position);
+  endPoint->m_demux = 0;
+  delete endPoint;
+}
+
+void Ipv6EndPointDemux::Match (Ipv6EndPoint *endP,
+                               Ipv6Address daddr, uint16_t dport,
+                               Ipv6Address saddr, uint16_t sport,
+                               Ptr<Ipv6Interface> incomingInterface,
+                               EndPoints retval[4])
+{
+  NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
+                                             << " daddr=" << endP->GetLocalAddress ()
+                                             << " sport=" << endP->GetPeerPort ()
+                                             << " saddr=" << endP->GetPeerAddress ());
+
+  if (!endP->IsRxEnabled ())
+    {
+      NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                    << " because endpoint can not receive packets");
+      return;
+    }
+
+  if (endP->GetLocalPort () != dport)
+    {
+      NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                                         << " because endpoint dport "
+                                         << endP->GetLocalPort ()
+                                         << " does not match packet dport " << dport);
+      return;
+    }
+
+  if (endP->GetBoundNetDevice ())
+    {
+      if (!incomingInterface)
         {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
+          return;
         }
+      if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+        {
+          NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                                             << " because endpoint is bound to specific device and"
+                                             << endP->GetBoundNetDevice ()
+                                             << " does not match packet device " << incomingInterface->GetDevice ());
+          return;
+        }
+    }
+
+  /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
+  NS_LOG_DEBUG ("dest addr " << daddr);
+
+  bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
+  bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
+  bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
+
+  /* if no match here, keep looking */
+  if (!(localAddressMatchesExact || localAddressMatchesWildCard))
+    {
+      return;
+    }
+  bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
+  bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
+  bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
+  bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
+
+  /* If remote does not match either with exact or wildcard,i
+     skip this one */
+  if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
+    {
+      return;
+    }
+  if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+    {
+      return;
+    }
+
+  /* Now figure out which return list to add this one to */
+  if (localAddressMatchesWildCard
+      && remotePeerMatchesWildCard
+      && remoteAddressMatchesWildCard)
+    { /* Only local port matches exactly */
+      retval[0].push_back (endP);
+    }
+  if ((localAddressMatchesExact || (localAddressMatchesAllRouters))
+      && remotePeerMatchesWildCard
+      && remoteAddressMatchesWildCard)
+    { /* Only local port and local address matches exactly */
+      retval[1].push_back (endP);
+    }
+  if (localAddressMatchesWildCard
+      && remotePeerMatchesExact
+      && remoteAddressMatchesExact)
+    { /* All but local address */
+      retval[2].push_back (endP);
+    }
+  if (localAddressMatchesExact
+      && remotePeerMatchesExact
+      && remoteAddressMatchesExact)
+    { /* All 4 match */
+      retval[3].push_back (endP);
     }
 }
 
@@ -175,117 +373,43 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
 
-  EndPoints retval1; /* Matches exact on local port, wildcards on others */
-  EndPoints retval2; /* Matches exact on local port/adder, wildcards on others */
-  EndPoints retval3; /* Matches all but local address */
-  EndPoints retval4; /* Exact match on all 4 */
+  /* retval[0]: Matches exact on local port, wildcards on others */
+  /* retval[1]: Matches exact on local port/adder, wildcards on others */
+  /* retval[2]: Matches all but local address */
+  /* retval[3]: Exact match on all 4 */
+  EndPoints retval[4];
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      Ipv6EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
 
-      if (!endP->IsRxEnabled ())
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                        << " because endpoint can not receive packets");
-          continue;
-        }
-
-      if (endP->GetLocalPort () != dport)
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
-
-      if (endP->GetBoundNetDevice ())
+  /* A connected endpoint can only match if its four-tuple is the one of the packet */
+  if (!m_connected.empty ())
+    {
+      std::pair<ConnectedEndPoints::iterator, ConnectedEndPoints::iterator> range;
+      range = m_connected.equal_range (FourTuple (daddr, dport, saddr, sport));
+      for (ConnectedEndPoints::iterator i = range.first; i != range.second; i++)
         {
-          if (!incomingInterface)
-            {
-              continue;
-            }
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
-            {
-              NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
-              continue;
-            }
+          Match (i->second, daddr, dport, saddr, sport, incomingInterface, retval);
         }
+    }
 
-      /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-      NS_LOG_DEBUG ("dest addr " << daddr);
-
-      bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
-      bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
-
-      /* if no match here, keep looking */
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-          continue;
-        }
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
-
-      /* If remote does not match either with exact or wildcard,i
-         skip this one */
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-          continue;
-        }
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+  PortEndPoints::iterator port = m_unconnected.find (dport);
+  if (port != m_unconnected.end ())
+    {
+      for (EndPointsI i = port->second.begin (); i != port->second.end (); i++)
         {
-          continue;
-        }
-
-      /* Now figure out which return list to add this one to */
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (localAddressMatchesAllRouters))
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All but local address */
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All 4 match */
-          retval4.push_back (endP);
+          Match (*i, daddr, dport, saddr, sport, incomingInterface, retval);
         }
     }
 
   // Here we find the most exact match
-  EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
-
-  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
-  return retval;  // might be empty if no matches
+  EndPoints result;
+  if (!retval[3].empty ()) result.swap (retval[3]);
+  else if (!retval[2].empty ()) result.swap (retval[2]);
+  else if (!retval[1].empty ()) result.swap (retval[1]);
+  else result.swap (retval[0]);
+
+  NS_ABORT_MSG_IF (result.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+  return result;  // might be empty if no matches
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +35,11 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints connected to a peer (with a local address, a peer address
+ * and a peer port) are indexed by their four-tuple, and the other ones by
+ * their local port, so that a lookup only considers the endpoints which
+ * may match the packet.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +159,103 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief The four-tuple of an endpoint connected to a peer.
+   */
+  struct FourTuple
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    FourTuple (Ipv6Address localAddress, uint16_t localPort,
+               Ipv6Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Comparison operator.
+     * \param other the other four-tuple
+     * \returns true if the four-tuples are equal
+     */
+    bool operator == (const FourTuple &other) const;
+
+    Ipv6Address localAddress;   //!< local address
+    Ipv6Address peerAddress;    //!< peer address
+    uint16_t localPort;         //!< local port
+    uint16_t peerPort;          //!< peer port
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \param tuple the four-tuple
+     * \returns the hash of the four-tuple
+     */
+    size_t operator () (const FourTuple &tuple) const;
+  };
+
+  /**
+   * \brief Container of the endpoints connected to a peer, by four-tuple.
+   */
+  typedef std::unordered_multimap<FourTuple, Ipv6EndPoint *, FourTupleHash> ConnectedEndPoints;
+
+  /**
+   * \brief Container of the other endpoints, by local port.
+   */
+  typedef std::unordered_map<uint16_t, EndPoints> PortEndPoints;
+
+  /**
+   * \param endPoint an endpoint
+   * \returns true if the endpoint is connected to a peer, i.e., it has a
+   *          local address, a peer address and a peer port
+   */
+  static bool IsConnected (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add a new endpoint to the demux.
+   * \param endPoint the endpoint
+   * \returns the endpoint
+   */
+  Ipv6EndPoint* Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add an endpoint to the lookup tables.
+   * \param endPoint the endpoint
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the lookup tables, before its addresses
+   * or ports change.
+   * \param endPoint the endpoint
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Check how an endpoint matches a packet.
+   * \param endP the endpoint
+   * \param daddr destination address to test
+   * \param dport destination port to test
+   * \param saddr source address to test
+   * \param sport source port to test
+   * \param incomingInterface the incoming interface
+   * \param retval the lists of the endpoints matching exactly on local
+   *        port, on local port and address, on all but local address,
+   *        and on all 4, the endpoint is added to
+   */
+  void Match (Ipv6EndPoint *endP,
+              Ipv6Address daddr, uint16_t dport,
+              Ipv6Address saddr, uint16_t sport,
+              Ptr<Ipv6Interface> incomingInterface,
+              EndPoints retval[4]);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -178,6 +281,26 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The positions of the end points in m_endPoints.
+   */
+  std::unordered_map<Ipv6EndPoint *, EndPointsI> m_positions;
+
+  /**
+   * \brief The end points connected to a peer.
+   */
+  ConnectedEndPoints m_connected;
+
+  /**
+   * \brief The other end points.
+   */
+  PortEndPoints m_unconnected;
+
+  /**
+   * \brief The number of end points using each local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_portUsers;
 };
 
 } /* namespace ns3 */
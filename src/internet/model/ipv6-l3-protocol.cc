@@ -91,6 +91,13 @@ TypeId Ipv6L3Protocol::GetTypeId ()
                    BooleanValue (true),
                    MakeBooleanAccessor (&Ipv6L3Protocol::m_strongEndSystemModel),
                    MakeBooleanChecker ())
+    .AddAttribute ("RouteCacheSize",
+                   "The maximum number of unicast destinations whose route is cached, "
+                   "0 to disable the cache.  The routing protocol must flush the cache "
+                   "when its routes change (see FlushRouteCache).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv6L3Protocol::m_routeCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("Tx",
                      "Send IPv6 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv6L3Protocol::m_txTrace),
@@ -176,6 +183,7 @@ void Ipv6L3Protocol::DoDispose ()
   m_node = 0;
   m_routingProtocol = 0;
   m_pmtuCache = 0;
+  m_routeCache.clear ();
   Object::DoDispose ();
 }
 
@@ -184,6 +192,7 @@ void Ipv6L3Protocol::SetRoutingProtocol (Ptr<Ipv6RoutingProtocol> routingProtoco
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv6 (this);
+  FlushRouteCache ();
 }
 
 Ptr<Ipv6RoutingProtocol> Ipv6L3Protocol::GetRoutingProtocol () const
@@ -422,6 +431,7 @@ bool Ipv6L3Protocol::AddAddress (uint32_t i, Ipv6InterfaceAddress address)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
     }
+  FlushRouteCache ();
   return ret;
 }
 
@@ -451,6 +461,7 @@ bool Ipv6L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
         }
+      FlushRouteCache ();
       return true;
     }
   return false;
@@ -474,6 +485,7 @@ Ipv6L3Protocol::RemoveAddress (uint32_t i, Ipv6Address address)
     {
       m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
     }
+    FlushRouteCache ();
     return true;
   }
   return false;
@@ -513,6 +525,22 @@ void Ipv6L3Protocol::SetPmtu (Ipv6Address dst, uint32_t pmtu)
   m_pmtuCache->SetPmtu (dst, pmtu);
 }
 
+void Ipv6L3Protocol::FlushRouteCache ()
+{
+  NS_LOG_FUNCTION (this);
+  m_routeCache.clear ();
+}
+
+void Ipv6L3Protocol::CacheRoute (Ipv6Address dst, Ptr<Ipv6Route> route)
+{
+  NS_LOG_FUNCTION (this << dst << route);
+  if (m_routeCache.size () >= m_routeCacheSize)
+    {
+      m_routeCache.clear ();
+    }
+  m_routeCache[dst] = route;
+}
+
 
 bool Ipv6L3Protocol::IsUp (uint32_t i) const
 {
@@ -539,6 +567,7 @@ void Ipv6L3Protocol::SetUp (uint32_t i)
         {
           m_routingProtocol->NotifyInterfaceUp (i);
         }
+      FlushRouteCache ();
     }
   else
     {
@@ -557,6 +586,7 @@ void Ipv6L3Protocol::SetDown (uint32_t i)
     {
       m_routingProtocol->NotifyInterfaceDown (i);
     }
+  FlushRouteCache ();
 }
 
 void Ipv6L3Protocol::SetupLoopback ()
@@ -925,7 +955,22 @@ void Ipv6L3Protocol::Send (Ptr<Packet> packet, Ipv6Address source, Ipv6Address d
       oif = GetNetDevice (index);
     }
 
-  newRoute = m_routingProtocol->RouteOutput (packet, hdr, oif, err);
+  // The routes of the unicast destinations which do not depend on an
+  // interface may be cached
+  bool cacheable = m_routeCacheSize > 0 && oif == 0 && !destination.IsMulticast ();
+  RouteCache::const_iterator cached = cacheable ? m_routeCache.find (destination) : m_routeCache.end ();
+  if (cached != m_routeCache.end ())
+    {
+      newRoute = cached->second;
+    }
+  else
+    {
+      newRoute = m_routingProtocol->RouteOutput (packet, hdr, oif, err);
+      if (newRoute && cacheable)
+        {
+          CacheRoute (destination, newRoute);
+        }
+    }
 
   if (newRoute)
     {
@@ -1082,8 +1127,20 @@ void Ipv6L3Protocol::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16
         }
     }
 
-  if (!m_routingProtocol->RouteInput (packet, hdr, device,
-                                      MakeCallback (&Ipv6L3Protocol::IpForward, this),
+  // The forwarded unicast packets may use, or fill, the route cache
+  Ipv6RoutingProtocol::UnicastForwardCallback ucb = MakeCallback (&Ipv6L3Protocol::IpForward, this);
+  if (m_routeCacheSize > 0 && !hdr.GetDestinationAddress ().IsMulticast () && IsForwarding (interface))
+    {
+      RouteCache::const_iterator cached = m_routeCache.find (hdr.GetDestinationAddress ());
+      if (cached != m_routeCache.end ())
+        {
+          IpForward (device, cached->second, packet, hdr);
+          return;
+        }
+      ucb = MakeCallback (&Ipv6L3Protocol::CacheRouteAndForward, this);
+    }
+
+  if (!m_routingProtocol->RouteInput (packet, hdr, device, ucb,
                                       MakeCallback (&Ipv6L3Protocol::IpMulticastForward, this),
                                       MakeCallback (&Ipv6L3Protocol::LocalDeliver, this),
                                       MakeCallback (&Ipv6L3Protocol::RouteInputError, this)))
@@ -1306,6 +1363,13 @@ void Ipv6L3Protocol::IpForward (Ptr<const NetDevice> idev, Ptr<Ipv6Route> rtentr
   SendRealOut (rtentry, packet, ipHeader);
 }
 
+void Ipv6L3Protocol::CacheRouteAndForward (Ptr<const NetDevice> idev, Ptr<Ipv6Route> rtentry, Ptr<const Packet> p, const Ipv6Header& header)
+{
+  NS_LOG_FUNCTION (this << idev << rtentry << p << header);
+  CacheRoute (header.GetDestinationAddress (), rtentry);
+  IpForward (idev, rtentry, p, header);
+}
+
 void Ipv6L3Protocol::IpMulticastForward (Ptr<const NetDevice> idev, Ptr<Ipv6MulticastRoute> mrtentry, Ptr<const Packet> p, const Ipv6Header& header)
 {
   NS_LOG_FUNCTION (this << mrtentry << p << header);
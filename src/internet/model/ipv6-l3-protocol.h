@@ -22,6 +22,7 @@
 #define IPV6_L3_PROTOCOL_H
 
 #include <list>
+#include <unordered_map>
 
 #include "ns3/traced-callback.h"
 #include "ns3/net-device.h"
@@ -274,6 +275,15 @@ public:
    */
   virtual void SetPmtu (Ipv6Address dst, uint32_t pmtu);
 
+  /**
+   * \brief Flush the cache of the routes to the destinations.
+   *
+   * The cache is flushed on the interface and address changes.  A routing
+   * protocol enabled with the RouteCacheSize attribute must call this
+   * method whenever its routes change; Ipv6StaticRouting and RipNg do.
+   */
+  void FlushRouteCache (void);
+
   /**
    * \brief Is specified interface up ?
    * \param i interface index
@@ -508,6 +518,11 @@ private:
    */
   typedef std::list< Ptr<Ipv6AutoconfiguredPrefix> >::iterator Ipv6AutoconfiguredPrefixListI;
 
+  /**
+   * \brief Container of the cached routes, by destination.
+   */
+  typedef std::unordered_map<Ipv6Address, Ptr<Ipv6Route>, Ipv6AddressHash> RouteCache;
+
   /**
    * \brief Make a copy of the packet, add the header and invoke the TX trace callback
    * \param ipHeader the IP header that will be added to the packet
@@ -593,6 +608,22 @@ private:
    */
   void IpForward (Ptr<const NetDevice> idev, Ptr<Ipv6Route> rtentry, Ptr<const Packet> p, const Ipv6Header& header);
 
+  /**
+   * \brief Cache the route of a forwarded packet, and forward it.
+   * \param idev Pointer to ingress network device
+   * \param rtentry route
+   * \param p packet to forward
+   * \param header IPv6 header to add to the packet
+   */
+  void CacheRouteAndForward (Ptr<const NetDevice> idev, Ptr<Ipv6Route> rtentry, Ptr<const Packet> p, const Ipv6Header& header);
+
+  /**
+   * \brief Cache the route to a destination.
+   * \param dst the destination
+   * \param route the route
+   */
+  void CacheRoute (Ipv6Address dst, Ptr<Ipv6Route> route);
+
   /**
    * \brief Forward a multicast packet.
    * \param idev Pointer to ingress network device
@@ -686,6 +717,16 @@ private:
    */
   Ptr<Ipv6PmtuCache> m_pmtuCache;
 
+  /**
+   * \brief Maximum number of cached routes, 0 if the cache is disabled.
+   */
+  uint32_t m_routeCacheSize;
+
+  /**
+   * \brief The routes to the recent unicast destinations.
+   */
+  RouteCache m_routeCache;
+
   /**
    * \brief List of transport protocol.
    */
@@ -113,7 +113,14 @@ Ipv6QueueDiscItem::GetUint8Value (QueueItem::Uint8Values field, uint8_t& value)
 uint32_t
 Ipv6QueueDiscItem::Hash (uint32_t perturbation) const
 {
-  NS_LOG_FUNCTION (this << perturbation);
+  Hasher hasher;
+  return Hash (hasher, perturbation);
+}
+
+uint32_t
+Ipv6QueueDiscItem::Hash (Hasher &hasher, uint32_t perturbation) const
+{
+  NS_LOG_FUNCTION (this << &hasher << perturbation);
 
   Ipv6Address src = m_header.GetSourceAddress ();
   Ipv6Address dest = m_header.GetDestinationAddress ();
@@ -157,7 +164,7 @@ Ipv6QueueDiscItem::Hash (uint32_t perturbation) const
 
   // Linux calculates jhash2 (jenkins hash), we calculate murmur3 because it is
   // already available in ns-3
-  uint32_t hash = Hash32 ((char*) buf, 41);
+  uint32_t hash = hasher.clear ().GetHash32 ((char*) buf, 41);
 
   NS_LOG_DEBUG ("Found Ipv6 packet; hash of the five tuple " << hash);
 
@@ -0,0 +1,314 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <algorithm>
+#include <cstring>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ipv6-route-trie.h"
+#include "ipv6-routing-table-entry.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv6RouteTrie");
+
+namespace {
+
+/**
+ * \param address an address
+ * \param position a bit position, from the most significant bit
+ * \returns the bit at the position
+ */
+inline uint8_t
+Bit (const uint8_t address[16], uint8_t position)
+{
+  return (address[position >> 3] >> (7 - (position & 7))) & 1;
+}
+
+/**
+ * \param a an address
+ * \param b another address
+ * \param length a prefix length
+ * \returns true if the addresses share their first length bits
+ */
+inline bool
+IsPrefixMatch (const uint8_t a[16], const uint8_t b[16], uint8_t length)
+{
+  uint8_t bytes = length >> 3;
+  if (std::memcmp (a, b, bytes) != 0)
+    {
+      return false;
+    }
+  uint8_t bits = length & 7;
+  return bits == 0 || ((a[bytes] ^ b[bytes]) & (0xff << (8 - bits)) & 0xff) == 0;
+}
+
+/**
+ * \brief Clear the bits of an address past a prefix length
+ * \param address the address
+ * \param length the prefix length
+ * \param prefix the resulting prefix
+ */
+inline void
+ApplyPrefix (const uint8_t address[16], uint8_t length, uint8_t prefix[16])
+{
+  std::memset (prefix, 0, 16);
+  uint8_t bytes = length >> 3;
+  std::memcpy (prefix, address, bytes);
+  uint8_t bits = length & 7;
+  if (bits != 0)
+    {
+      prefix[bytes] = address[bytes] & (0xff << (8 - bits));
+    }
+}
+
+/**
+ * \param prefix a network prefix
+ * \param length the length of the prefix, if it can be indexed
+ * \returns true if the prefix mask is contiguous and its length is the
+ *          prefix length
+ */
+bool
+GetPrefixLength (Ipv6Prefix prefix, uint8_t &length)
+{
+  uint8_t mask[16];
+  prefix.GetBytes (mask);
+  length = 0;
+  uint8_t i = 0;
+  while (i < 16 && mask[i] == 0xff)
+    {
+      length += 8;
+      i++;
+    }
+  if (i < 16)
+    {
+      uint8_t inverse = ~mask[i];
+      if ((inverse & (inverse + 1)) != 0)
+        {
+          return false;
+        }
+      for (uint8_t m = mask[i]; m != 0; m <<= 1)
+        {
+          length++;
+        }
+      while (++i < 16)
+        {
+          if (mask[i] != 0)
+            {
+              return false;
+            }
+        }
+    }
+  return length == prefix.GetPrefixLength ();
+}
+
+} // unnamed namespace
+
+Ipv6RouteTrie::Ipv6RouteTrie ()
+  : m_root (0),
+    m_order (0),
+    m_nUnindexed (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv6RouteTrie::~Ipv6RouteTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  Delete (m_root);
+}
+
+Ipv6RouteTrie::Node *
+Ipv6RouteTrie::NewNode (const uint8_t prefix[16], uint8_t length)
+{
+  Node *node = new Node;
+  ApplyPrefix (prefix, length, node->prefix);
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+void
+Ipv6RouteTrie::Delete (Node *node)
+{
+  if (node != 0)
+    {
+      Delete (node->child[0]);
+      Delete (node->child[1]);
+      delete node;
+    }
+}
+
+void
+Ipv6RouteTrie::Insert (Ipv6RoutingTableEntry *entry, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << entry << metric);
+  uint8_t length;
+  if (!GetPrefixLength (entry->GetDestNetworkPrefix (), length))
+    {
+      m_nUnindexed++;
+      return;
+    }
+  uint8_t network[16];
+  entry->GetDestNetwork ().GetBytes (network);
+  uint8_t prefix[16];
+  ApplyPrefix (network, length, prefix);
+  Route route;
+  route.entry = entry;
+  route.metric = metric;
+  route.order = m_order++;
+
+  Node **link = &m_root;
+  while (true)
+    {
+      Node *node = *link;
+      if (node == 0)
+        {
+          node = NewNode (prefix, length);
+          node->routes.push_back (route);
+          *link = node;
+          return;
+        }
+      // length of the prefix common to the route and the node
+      uint8_t common = 0;
+      uint8_t maxCommon = std::min (length, node->length);
+      while (common < maxCommon && Bit (prefix, common) == Bit (node->prefix, common))
+        {
+          common++;
+        }
+      if (common == node->length)
+        {
+          if (length == node->length)
+            {
+              node->routes.push_back (route);
+              return;
+            }
+          link = &node->child[Bit (prefix, node->length)];
+          continue;
+        }
+      // the route diverges from the node prefix, or is a prefix of it
+      Node *split = NewNode (prefix, common);
+      split->child[Bit (node->prefix, common)] = node;
+      if (common == length)
+        {
+          split->routes.push_back (route);
+        }
+      else
+        {
+          Node *leaf = NewNode (prefix, length);
+          leaf->routes.push_back (route);
+          split->child[Bit (prefix, common)] = leaf;
+        }
+      *link = split;
+      return;
+    }
+}
+
+Ipv6RouteTrie::Node *
+Ipv6RouteTrie::Remove (Node *node, const uint8_t prefix[16], uint8_t length, Ipv6RoutingTableEntry *entry)
+{
+  if (node == 0 || node->length > length || !IsPrefixMatch (prefix, node->prefix, node->length))
+    {
+      return node;
+    }
+  if (node->length == length)
+    {
+      for (Routes::iterator i = node->routes.begin (); i != node->routes.end (); ++i)
+        {
+          if (i->entry == entry)
+            {
+              node->routes.erase (i);
+              break;
+            }
+        }
+    }
+  else
+    {
+      Node *&child = node->child[Bit (prefix, node->length)];
+      child = Remove (child, prefix, length, entry);
+    }
+  // Nodes without routes are only kept to join two subtries
+  if (!node->routes.empty () || (node->child[0] != 0 && node->child[1] != 0))
+    {
+      return node;
+    }
+  Node *child = node->child[0] != 0 ? node->child[0] : node->child[1];
+  delete node;
+  return child;
+}
+
+void
+Ipv6RouteTrie::Remove (Ipv6RoutingTableEntry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  uint8_t length;
+  if (!GetPrefixLength (entry->GetDestNetworkPrefix (), length))
+    {
+      NS_ASSERT (m_nUnindexed > 0);
+      m_nUnindexed--;
+      return;
+    }
+  uint8_t network[16];
+  entry->GetDestNetwork ().GetBytes (network);
+  uint8_t prefix[16];
+  ApplyPrefix (network, length, prefix);
+  m_root = Remove (m_root, prefix, length, entry);
+}
+
+void
+Ipv6RouteTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  Delete (m_root);
+  m_root = 0;
+  m_nUnindexed = 0;
+}
+
+bool
+Ipv6RouteTrie::IsComplete (void) const
+{
+  return m_nUnindexed == 0;
+}
+
+uint32_t
+Ipv6RouteTrie::Lookup (Ipv6Address dest, Match matches[]) const
+{
+  uint8_t address[16];
+  dest.GetBytes (address);
+  uint32_t n = 0;
+  const Node *node = m_root;
+  while (node != 0 && IsPrefixMatch (address, node->prefix, node->length))
+    {
+      if (!node->routes.empty ())
+        {
+          NS_ASSERT (n < MAX_MATCHES);
+          matches[n].length = node->length;
+          matches[n].routes = &node->routes;
+          n++;
+        }
+      if (node->length == 128)
+        {
+          break;
+        }
+      node = node->child[Bit (address, node->length)];
+    }
+  std::reverse (matches, matches + n);
+  return n;
+}
+
+} // namespace ns3
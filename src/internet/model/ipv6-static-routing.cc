@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 
 #include "ipv6-static-routing.h"
+#include "ipv6-l3-protocol.h"
 #include "ipv6-routing-table-entry.h"
 
 namespace ns3 {
@@ -152,6 +153,8 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_networkTrie.Insert (route, metric);
+  FlushRouteCache ();
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -165,6 +168,8 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_networkTrie.Insert (route, metric);
+  FlushRouteCache ();
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface, uint32_t metric)
@@ -173,6 +178,8 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_networkTrie.Insert (route, metric);
+  FlushRouteCache ();
 }
 
 void Ipv6StaticRouting::SetDefaultRoute (Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -197,6 +204,8 @@ void Ipv6StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   Ipv6Prefix networkMask = Ipv6Prefix (8);
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkMask, outputInterface);
   m_networkRoutes.push_back (std::make_pair (route, 0));
+  m_networkTrie.Insert (route, 0);
+  FlushRouteCache ();
 }
 
 uint32_t Ipv6StaticRouting::GetNMulticastRoutes () const
@@ -300,65 +309,126 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
       return rtentry;
     }
 
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+  if (m_networkTrie.IsComplete ())
     {
-      Ipv6RoutingTableEntry* j = it->first;
-      uint32_t metric = it->second;
-      Ipv6Prefix mask = j->GetDestNetworkPrefix ();
-      uint16_t maskLen = mask.GetPrefixLength ();
-      Ipv6Address entry = j->GetDestNetwork ();
-
-      NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen << ", metric " << metric);
-
-      if (mask.IsMatch (dst, entry))
+      // The longest matching prefix with a route on the requested
+      // interface wins.  Among its routes, the first one wins for a /128
+      // prefix, and the last one with the lowest metric otherwise.
+      Ipv6RouteTrie::Match matches[Ipv6RouteTrie::MAX_MATCHES];
+      uint32_t n = m_networkTrie.Lookup (dst, matches);
+      Ipv6RoutingTableEntry *route = 0;
+      for (uint32_t k = 0; k < n && route == 0; k++)
         {
-          NS_LOG_LOGIC ("Found global network route " << *j << ", mask length " << maskLen << ", metric " << metric);
-
-          /* if interface is given, check the route will output on this interface */
-          if (!interface || interface == m_ipv6->GetNetDevice (j->GetInterface ()))
+          shortestMetric = 0xffffffff;
+          const Ipv6RouteTrie::Routes &routes = *matches[k].routes;
+          for (Ipv6RouteTrie::Routes::const_iterator i = routes.begin (); i != routes.end (); i++)
             {
-              if (maskLen < longestMask)
-                {
-                  NS_LOG_LOGIC ("Previous match longer, skipping");
-                  continue;
-                }
+              NS_LOG_LOGIC ("Found global network route " << *i->entry << ", mask length " << uint32_t (matches[k].length) << ", metric " << i->metric);
 
-              if (maskLen > longestMask)
+              /* if interface is given, check the route will output on this interface */
+              if (interface && interface != m_ipv6->GetNetDevice (i->entry->GetInterface ()))
                 {
-                  shortestMetric = 0xffffffff;
+                  continue;
                 }
-
-              longestMask = maskLen;
-              if (metric > shortestMetric)
+              if (i->metric > shortestMetric)
                 {
                   NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
                   continue;
                 }
-
-              shortestMetric = metric;
-              Ipv6RoutingTableEntry* route = j;
-              uint32_t interfaceIdx = route->GetInterface ();
-              rtentry = Create<Ipv6Route> ();
-
-              if (route->GetGateway ().IsAny ())
+              shortestMetric = i->metric;
+              route = i->entry;
+              if (matches[k].length == 128)
                 {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-                }
-              else if (route->GetDest ().IsAny ()) /* default route */
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
-                }
-              else
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
+                  break;
                 }
+            }
+        }
+      if (route != 0)
+        {
+          uint32_t interfaceIdx = route->GetInterface ();
+          rtentry = Create<Ipv6Route> ();
+
+          if (route->GetGateway ().IsAny ())
+            {
+              rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+            }
+          else if (route->GetDest ().IsAny ()) /* default route */
+            {
+              rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
+            }
+          else
+            {
+              rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
+            }
+
+          rtentry->SetDestination (route->GetDest ());
+          rtentry->SetGateway (route->GetGateway ());
+          rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+        }
+    }
+  else
+    {
+      // routes whose prefix cannot be indexed are only in the list
+      for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+        {
+          Ipv6RoutingTableEntry* j = it->first;
+          uint32_t metric = it->second;
+          Ipv6Prefix mask = j->GetDestNetworkPrefix ();
+          uint16_t maskLen = mask.GetPrefixLength ();
+          Ipv6Address entry = j->GetDestNetwork ();
 
-              rtentry->SetDestination (route->GetDest ());
-              rtentry->SetGateway (route->GetGateway ());
-              rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
-              if (maskLen == 128)
+          NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen << ", metric " << metric);
+
+          if (mask.IsMatch (dst, entry))
+            {
+              NS_LOG_LOGIC ("Found global network route " << *j << ", mask length " << maskLen << ", metric " << metric);
+
+              /* if interface is given, check the route will output on this interface */
+              if (!interface || interface == m_ipv6->GetNetDevice (j->GetInterface ()))
                 {
-                  break;
+                  if (maskLen < longestMask)
+                    {
+                      NS_LOG_LOGIC ("Previous match longer, skipping");
+                      continue;
+                    }
+
+                  if (maskLen > longestMask)
+                    {
+                      shortestMetric = 0xffffffff;
+                    }
+
+                  longestMask = maskLen;
+                  if (metric > shortestMetric)
+                    {
+                      NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+                      continue;
+                    }
+
+                  shortestMetric = metric;
+                  Ipv6RoutingTableEntry* route = j;
+                  uint32_t interfaceIdx = route->GetInterface ();
+                  rtentry = Create<Ipv6Route> ();
+
+                  if (route->GetGateway ().IsAny ())
+                    {
+                      rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+                    }
+                  else if (route->GetDest ().IsAny ()) /* default route */
+                    {
+                      rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
+                    }
+                  else
+                    {
+                      rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
+                    }
+
+                  rtentry->SetDestination (route->GetDest ());
+                  rtentry->SetGateway (route->GetGateway ());
+                  rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+                  if (maskLen == 128)
+                    {
+                      break;
+                    }
                 }
             }
         }
@@ -371,6 +441,16 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
   return rtentry;
 }
 
+void Ipv6StaticRouting::FlushRouteCache ()
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Ipv6L3Protocol> ipv6 = m_ipv6 ? m_ipv6->GetObject<Ipv6L3Protocol> () : 0;
+  if (ipv6)
+    {
+      ipv6->FlushRouteCache ();
+    }
+}
+
 void Ipv6StaticRouting::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -380,6 +460,7 @@ void Ipv6StaticRouting::DoDispose ()
       delete j->first;
     }
   m_networkRoutes.clear ();
+  m_networkTrie.Clear ();
 
   for (MulticastRoutesI i = m_multicastRoutes.begin (); i != m_multicastRoutes.end (); i = m_multicastRoutes.erase (i))
     {
@@ -528,8 +609,10 @@ void Ipv6StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
+          m_networkTrie.Remove (it->first);
           delete it->first;
           m_networkRoutes.erase (it);
+          FlushRouteCache ();
           return;
         }
       tmp++;
@@ -547,8 +630,10 @@ void Ipv6StaticRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefix, uin
       if (network == rtentry->GetDest () && rtentry->GetInterface () == ifIndex
           && rtentry->GetPrefixToUse () == prefixToUse)
         {
+          m_networkTrie.Remove (it->first);
           delete it->first;
           m_networkRoutes.erase (it);
+          FlushRouteCache ();
           return;
         }
     }
@@ -672,8 +757,10 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
+          m_networkTrie.Remove (it->first);
           delete it->first;
           it = m_networkRoutes.erase (it);
+          FlushRouteCache ();
         }
       else
         {
@@ -717,8 +804,10 @@ void Ipv6StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAd
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkPrefix () == networkMask)
         {
+          m_networkTrie.Remove (it->first);
           delete it->first;
           it = m_networkRoutes.erase (it);
+          FlushRouteCache ();
         }
       else
         {
@@ -761,8 +850,10 @@ void Ipv6StaticRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv
 
           if (dst == entry && prefix == mask && rtentry->GetInterface () == interface)
             {
+              m_networkTrie.Remove (j->first);
               delete j->first;
               j = m_networkRoutes.erase (j);
+              FlushRouteCache ();
             }
           else
             {
@@ -30,6 +30,7 @@
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/ipv6-route-trie.h"
 
 namespace ns3 {
 
@@ -281,11 +282,21 @@ private:
    */
   Ptr<Ipv6MulticastRoute> LookupStatic (Ipv6Address origin, Ipv6Address group, uint32_t ifIndex);
 
+  /**
+   * \brief Flush the route cache of the Ipv6L3Protocol after a route change.
+   */
+  void FlushRouteCache (void);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the index of the forwarding table for network.
+   */
+  Ipv6RouteTrie m_networkTrie;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -34,6 +34,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/ipv6-packet-info-tag.h"
 #include "ns3/simulator.h"
+#include "ipv6-l3-protocol.h"
 
 #define RIPNG_ALL_NODE "ff02::9"
 #define RIPNG_PORT 521
@@ -648,6 +649,7 @@ void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ip
   route->SetRouteChanged (true);
 
   m_routes.push_back (std::make_pair (route, EventId ()));
+  FlushRouteCache ();
 }
 
 void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface)
@@ -660,6 +662,7 @@ void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, ui
   route->SetRouteChanged (true);
 
   m_routes.push_back (std::make_pair (route, EventId ()));
+  FlushRouteCache ();
 }
 
 void RipNg::InvalidateRoute (RipNgRoutingTableEntry *route)
@@ -678,6 +681,7 @@ void RipNg::InvalidateRoute (RipNgRoutingTableEntry *route)
               it->second.Cancel ();
             }
           it->second = Simulator::Schedule (m_garbageCollectionDelay, &RipNg::DeleteRoute, this, route);
+          FlushRouteCache ();
           return;
         }
     }
@@ -694,12 +698,23 @@ void RipNg::DeleteRoute (RipNgRoutingTableEntry *route)
         {
           delete route;
           m_routes.erase (it);
+          FlushRouteCache ();
           return;
         }
     }
   NS_ABORT_MSG ("Ripng::DeleteRoute - cannot find the route to delete");
 }
 
+void RipNg::FlushRouteCache ()
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Ipv6L3Protocol> ipv6 = m_ipv6 ? m_ipv6->GetObject<Ipv6L3Protocol> () : 0;
+  if (ipv6)
+    {
+      ipv6->FlushRouteCache ();
+    }
+}
+
 
 void RipNg::Receive (Ptr<Socket> socket)
 {
@@ -1072,6 +1087,7 @@ void RipNg::HandleResponses (RipNgHeader hdr, Ipv6Address senderAddress, uint32_
 
   if (changed)
     {
+      FlushRouteCache ();
       SendTriggeredRouteUpdate ();
     }
 }
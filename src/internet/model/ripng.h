@@ -377,6 +377,11 @@ private:
    */
   void DeleteRoute (RipNgRoutingTableEntry *route);
 
+  /**
+   * \brief Flush the route cache of the Ipv6L3Protocol after a route change.
+   */
+  void FlushRouteCache (void);
+
   Routes m_routes; //!<  the forwarding table for network.
   Ptr<Ipv6> m_ipv6; //!< IPv6 reference
   Time m_startupDelay; //!< Random delay before protocol startup.
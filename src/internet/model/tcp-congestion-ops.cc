@@ -80,6 +80,12 @@ TcpCongestionOps::HasCongControl () const
   return false;
 }
 
+bool
+TcpCongestionOps::IsStateless () const
+{
+  return false;
+}
+
 void
 TcpCongestionOps::CongControl (Ptr<TcpSocketState> tcb,
                                const TcpRateOps::TcpRateConnection &rc,
@@ -258,6 +264,13 @@ TcpNewReno::ReduceCwnd (Ptr<TcpSocketState> tcb)
   tcb->m_cWnd = std::max (tcb->m_cWnd.Get () / 2, tcb->m_segmentSize);
 }
 
+bool
+TcpNewReno::IsStateless () const
+{
+  // The subclasses may keep a state
+  return GetInstanceTypeId () == TcpNewReno::GetTypeId ();
+}
+
 Ptr<TcpCongestionOps>
 TcpNewReno::Fork ()
 {
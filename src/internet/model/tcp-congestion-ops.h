@@ -174,6 +174,18 @@ public:
    */
   virtual bool HasCongControl () const;
 
+  /**
+   * \brief Returns true when the algorithm keeps no per-connection state
+   *
+   * \return true if one instance of the algorithm can serve several sockets
+   *
+   * All the state of a stateless algorithm is kept in the TcpSocketState of
+   * the connection, and the algorithm has no attribute: its instance is then
+   * shared by the sockets created by a TcpL4Protocol, and by the sockets
+   * forked from them, instead of being copied for each of them.
+   */
+  virtual bool IsStateless () const;
+
   /**
    * \brief Called when packets are delivered to update cwnd and pacing rate
    *
@@ -244,6 +256,7 @@ public:
   virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
                                 uint32_t bytesInFlight);
   virtual void ReduceCwnd (Ptr<TcpSocketState> tcb);
+  virtual bool IsStateless () const;
   virtual Ptr<TcpCongestionOps> Fork ();
 
 protected:
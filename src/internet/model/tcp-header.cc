@@ -85,6 +85,13 @@ TcpHeader::EnableChecksums (void)
   m_calcChecksum = true;
 }
 
+bool
+TcpHeader::IsCacheable (void) const
+{
+  // a cached copy would not honour the checksum state set by the caller
+  return !m_calcChecksum;
+}
+
 void
 TcpHeader::SetSourcePort (uint16_t port)
 {
@@ -36,6 +36,7 @@
 #include "ipv6-end-point-demux.h"
 #include "ipv4-end-point.h"
 #include "ipv6-end-point.h"
+#include "timer-wheel.h"
 #include "ipv4-l3-protocol.h"
 #include "ipv6-l3-protocol.h"
 #include "ipv6-routing-protocol.h"
@@ -90,6 +91,12 @@ TcpL4Protocol::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
                    MakeObjectVectorChecker<TcpSocketBase> ())
+    .AddAttribute ("UseTimerWheel",
+                   "Arm the timers of the sockets on the TimerWheel of the node "
+                   "instead of scheduling a simulator event for each of them.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpL4Protocol::m_useTimerWheel),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -161,6 +168,8 @@ TcpL4Protocol::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_sockets.clear ();
+  m_sharedCongestion = 0;
+  m_sharedRecovery = 0;
 
   if (m_endPoints != 0)
     {
@@ -199,14 +208,50 @@ TcpL4Protocol::CreateSocket (TypeId congestionTypeId, TypeId recoveryTypeId)
 
   Ptr<RttEstimator> rtt = rttFactory.Create<RttEstimator> ();
   Ptr<TcpSocketBase> socket = CreateObject<TcpSocketBase> ();
-  Ptr<TcpCongestionOps> algo = congestionAlgorithmFactory.Create<TcpCongestionOps> ();
-  Ptr<TcpRecoveryOps> recovery = recoveryAlgorithmFactory.Create<TcpRecoveryOps> ();
+  Ptr<TcpCongestionOps> algo;
+  Ptr<TcpRecoveryOps> recovery;
+
+  // The stateless algorithms are instantiated once, and shared by the sockets
+  if (m_sharedCongestion != 0 && m_sharedCongestion->GetInstanceTypeId () == congestionTypeId)
+    {
+      algo = m_sharedCongestion;
+    }
+  else
+    {
+      algo = congestionAlgorithmFactory.Create<TcpCongestionOps> ();
+      if (algo->IsStateless ())
+        {
+          m_sharedCongestion = algo;
+        }
+    }
+  if (m_sharedRecovery != 0 && m_sharedRecovery->GetInstanceTypeId () == recoveryTypeId)
+    {
+      recovery = m_sharedRecovery;
+    }
+  else
+    {
+      recovery = recoveryAlgorithmFactory.Create<TcpRecoveryOps> ();
+      if (recovery->IsStateless ())
+        {
+          m_sharedRecovery = recovery;
+        }
+    }
 
   socket->SetNode (m_node);
   socket->SetTcp (this);
   socket->SetRtt (rtt);
   socket->SetCongestionControlAlgorithm (algo);
   socket->SetRecoveryAlgorithm (recovery);
+  if (m_useTimerWheel)
+    {
+      Ptr<TimerWheel> wheel = m_node->GetObject<TimerWheel> ();
+      if (wheel == 0)
+        {
+          wheel = CreateObject<TimerWheel> ();
+          m_node->AggregateObject (wheel);
+        }
+      socket->SetTimerWheel (wheel);
+    }
 
   m_sockets.push_back (socket);
   return socket;
@@ -587,7 +632,10 @@ TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
       Ptr<Ipv4Route> route;
       if (ipv4->GetRoutingProtocol () != 0)
         {
-          route = ipv4->GetRoutingProtocol ()->RouteOutput (packet, header, oif, errno_);
+          route = ipv4->GetRoutingProtocol ()->RouteOutputWithPorts (packet, header,
+                                                                     outgoing.GetSourcePort (),
+                                                                     outgoing.GetDestinationPort (),
+                                                                     oif, errno_);
         }
       else
         {
@@ -38,6 +38,8 @@ class Ipv4EndPointDemux;
 class Ipv6EndPointDemux;
 class Ipv4Interface;
 class TcpSocketBase;
+class TcpCongestionOps;
+class TcpRecoveryOps;
 class Ipv4EndPoint;
 class Ipv6EndPoint;
 class NetDevice;
@@ -321,6 +323,9 @@ private:
   TypeId m_congestionTypeId;       //!< The socket TypeId
   TypeId m_recoveryTypeId;         //!< The recovery TypeId
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
+  Ptr<TcpCongestionOps> m_sharedCongestion; //!< stateless congestion control shared by the sockets
+  Ptr<TcpRecoveryOps> m_sharedRecovery;     //!< stateless recovery shared by the sockets
+  bool m_useTimerWheel {false};    //!< Arm the socket timers on the TimerWheel of the node
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
 
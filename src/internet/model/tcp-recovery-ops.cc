@@ -62,6 +62,12 @@ TcpRecoveryOps::UpdateBytesSent (uint32_t bytesSent)
   NS_LOG_FUNCTION (this << bytesSent);
 }
 
+bool
+TcpRecoveryOps::IsStateless () const
+{
+  return false;
+}
+
 // Classic recovery
 
 NS_OBJECT_ENSURE_REGISTERED (TcpClassicRecovery);
@@ -130,6 +136,13 @@ TcpClassicRecovery::GetName () const
   return "TcpClassicRecovery";
 }
 
+bool
+TcpClassicRecovery::IsStateless () const
+{
+  // The subclasses may keep a state
+  return GetInstanceTypeId () == TcpClassicRecovery::GetTypeId ();
+}
+
 Ptr<TcpRecoveryOps>
 TcpClassicRecovery::Fork ()
 {
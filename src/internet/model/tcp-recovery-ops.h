@@ -134,6 +134,15 @@ public:
    */
   virtual void UpdateBytesSent (uint32_t bytesSent);
 
+  /**
+   * \brief Returns true when the algorithm keeps no per-connection state
+   *
+   * \return true if one instance of the algorithm can serve several sockets
+   *
+   * \see TcpCongestionOps::IsStateless
+   */
+  virtual bool IsStateless () const;
+
   /**
    * \brief Copy the recovery algorithm across socket
    *
@@ -190,6 +199,8 @@ public:
 
   virtual void ExitRecovery (Ptr<TcpSocketState> tcb) override;
 
+  virtual bool IsStateless () const override;
+
   virtual Ptr<TcpRecoveryOps> Fork () override;
 };
 
@@ -53,6 +53,11 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * The segments are stored in a map indexed by their first sequence number,
+ * and they never overlap: Add looks up the neighbours of a new segment
+ * instead of walking the buffer from its head, so that inserting a segment
+ * costs O(log n) however much the data is reordered.
+ *
  * SACK list
  * ---------
  *
@@ -43,6 +43,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
 #include "ns3/object.h"
+#include "ns3/segmentation-offload-tag.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
 #include "ipv4-end-point.h"
@@ -69,6 +70,95 @@ NS_LOG_COMPONENT_DEFINE ("TcpSocketBase");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpSocketBase);
 
+/**
+ * \ingroup tcp
+ *
+ * \brief Accessor of a trace source of TcpSocketBase which chains a trace
+ * source of its TcpSocketState
+ *
+ * The trace source of the TcpSocketState is connected to the one of the
+ * socket when a first callback is connected to the latter, so that the
+ * sockets which are not traced do not hold a chain of callbacks.
+ */
+template <typename SOURCE>
+class TcbTraceAccessor : public TraceSourceAccessor
+{
+public:
+  /**
+   * \brief Constructor
+   * \param source the trace source of the socket
+   * \param trace the TcpSocketBase::TcbTrace chained by the trace source
+   */
+  TcbTraceAccessor (SOURCE TcpSocketBase::*source, uint32_t trace)
+    : m_source (source),
+      m_trace (trace)
+  {
+  }
+
+  virtual bool ConnectWithoutContext (ObjectBase *obj, const CallbackBase &cb) const
+  {
+    TcpSocketBase *p = dynamic_cast<TcpSocketBase *> (obj);
+    if (p == 0)
+      {
+        return false;
+      }
+    p->ChainTcbTrace (m_trace);
+    (p->*m_source).ConnectWithoutContext (cb);
+    return true;
+  }
+
+  virtual bool Connect (ObjectBase *obj, std::string context, const CallbackBase &cb) const
+  {
+    TcpSocketBase *p = dynamic_cast<TcpSocketBase *> (obj);
+    if (p == 0)
+      {
+        return false;
+      }
+    p->ChainTcbTrace (m_trace);
+    (p->*m_source).Connect (cb, context);
+    return true;
+  }
+
+  virtual bool DisconnectWithoutContext (ObjectBase *obj, const CallbackBase &cb) const
+  {
+    TcpSocketBase *p = dynamic_cast<TcpSocketBase *> (obj);
+    if (p == 0)
+      {
+        return false;
+      }
+    (p->*m_source).DisconnectWithoutContext (cb);
+    return true;
+  }
+
+  virtual bool Disconnect (ObjectBase *obj, std::string context, const CallbackBase &cb) const
+  {
+    TcpSocketBase *p = dynamic_cast<TcpSocketBase *> (obj);
+    if (p == 0)
+      {
+        return false;
+      }
+    (p->*m_source).Disconnect (cb, context);
+    return true;
+  }
+
+private:
+  SOURCE TcpSocketBase::*m_source; //!< the trace source of the socket
+  uint32_t m_trace;                //!< the TcpSocketBase::TcbTrace chained
+};
+
+/**
+ * \brief Create a TcbTraceAccessor
+ * \param source the trace source of the socket
+ * \param trace the TcpSocketBase::TcbTrace chained by the trace source
+ * \return the accessor
+ */
+template <typename SOURCE>
+static Ptr<const TraceSourceAccessor>
+MakeTcbTraceAccessor (SOURCE TcpSocketBase::*source, uint32_t trace)
+{
+  return Ptr<const TraceSourceAccessor> (new TcbTraceAccessor<SOURCE> (source, trace), false);
+}
+
 TypeId
 TcpSocketBase::GetTypeId (void)
 {
@@ -142,6 +232,14 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("TsoMaxSegments",
+                   "Maximum number of segments of new data handed to the IPv4 "
+                   "layer as one super-segment, which is split into segments "
+                   "by the devices supporting segmentation offload, or by the "
+                   "IPv4 layer (1 disables it)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_tsoMaxSegments),
+                   MakeUintegerChecker<uint32_t> (1, 64))
     .AddAttribute ("UseEcn", "Parameter to set ECN functionality",
                    EnumValue (TcpSocketState::Off),
                    MakeEnumAccessor (&TcpSocketBase::SetUseEcn),
@@ -154,15 +252,15 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TracedValueCallback::Time")
     .AddTraceSource ("RTT",
                      "Last RTT sample",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_lastRttTrace),
+                     MakeTcbTraceAccessor (&TcpSocketBase::m_lastRttTrace, TCB_TRACE_RTT),
                      "ns3::TracedValueCallback::Time")
     .AddTraceSource ("NextTxSequence",
                      "Next sequence number to send (SND.NXT)",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_nextTxSequenceTrace),
+                     MakeTcbTraceAccessor (&TcpSocketBase::m_nextTxSequenceTrace, TCB_TRACE_NEXT_TX_SEQUENCE),
                      "ns3::SequenceNumber32TracedValueCallback")
     .AddTraceSource ("HighestSequence",
                      "Highest sequence number ever sent in socket's life time",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_highTxMarkTrace),
+                     MakeTcbTraceAccessor (&TcpSocketBase::m_highTxMarkTrace, TCB_TRACE_HIGHEST_SEQUENCE),
                      "ns3::TracedValueCallback::SequenceNumber32")
     .AddTraceSource ("State",
                      "TCP state",
@@ -170,11 +268,11 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TcpStatesTracedValueCallback")
     .AddTraceSource ("CongState",
                      "TCP Congestion machine state",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_congStateTrace),
+                     MakeTcbTraceAccessor (&TcpSocketBase::m_congStateTrace, TCB_TRACE_CONG_STATE),
                      "ns3::TcpSocketState::TcpCongStatesTracedValueCallback")
     .AddTraceSource ("EcnState",
                      "Trace ECN state change of socket",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_ecnStateTrace),
+                     MakeTcbTraceAccessor (&TcpSocketBase::m_ecnStateTrace, TCB_TRACE_ECN_STATE),
                      "ns3::TcpSocketState::EcnStatesTracedValueCallback")
     .AddTraceSource ("AdvWND",
                      "Advertised Window Size",
@@ -186,7 +284,7 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("BytesInFlight",
                      "Socket estimation of bytes in flight",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_bytesInFlightTrace),
+                     MakeTcbTraceAccessor (&TcpSocketBase::m_bytesInFlightTrace, TCB_TRACE_BYTES_IN_FLIGHT),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("HighestRxSequence",
                      "Highest sequence number received from peer",
@@ -198,15 +296,15 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TracedValueCallback::SequenceNumber32")
     .AddTraceSource ("CongestionWindow",
                      "The TCP connection's congestion window",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_cWndTrace),
+                     MakeTcbTraceAccessor (&TcpSocketBase::m_cWndTrace, TCB_TRACE_CWND),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("CongestionWindowInflated",
                      "The TCP connection's congestion window inflates as in older RFC",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_cWndInflTrace),
+                     MakeTcbTraceAccessor (&TcpSocketBase::m_cWndInflTrace, TCB_TRACE_CWND_INFL),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("SlowStartThreshold",
                      "TCP slow start threshold (bytes)",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_ssThTrace),
+                     MakeTcbTraceAccessor (&TcpSocketBase::m_ssThTrace, TCB_TRACE_SSTHRESH),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("Tx",
                      "Send tcp packet to IP protocol",
@@ -252,44 +350,6 @@ TcpSocketBase::TcpSocketBase (void)
   m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
 
   m_tcb->m_sendEmptyPacketCallback = MakeCallback (&TcpSocketBase::SendEmptyPacket, this);
-
-  bool ok;
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindow",
-                                          MakeCallback (&TcpSocketBase::UpdateCwnd, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindowInflated",
-                                          MakeCallback (&TcpSocketBase::UpdateCwndInfl, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("SlowStartThreshold",
-                                          MakeCallback (&TcpSocketBase::UpdateSsThresh, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongState",
-                                          MakeCallback (&TcpSocketBase::UpdateCongState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("EcnState",
-                                          MakeCallback (&TcpSocketBase::UpdateEcnState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("NextTxSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateNextTxSequence, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateHighTxMark, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("BytesInFlight",
-                                          MakeCallback (&TcpSocketBase::UpdateBytesInFlight, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("RTT",
-                                          MakeCallback (&TcpSocketBase::UpdateRtt, this));
-  NS_ASSERT (ok == true);
 }
 
 TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
@@ -335,6 +395,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_tsoMaxSegments (sock.m_tsoMaxSegments),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
@@ -364,16 +425,19 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
 
   m_tcb->m_currentPacingRate = m_tcb->m_maxPacingRate;
   m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
+  SetTimerWheel (sock.m_retxEvent.GetWheel ());
 
   if (sock.m_congestionControl)
     {
-      m_congestionControl = sock.m_congestionControl->Fork ();
+      m_congestionControl = sock.m_congestionControl->IsStateless ()
+        ? sock.m_congestionControl : sock.m_congestionControl->Fork ();
       m_congestionControl->Init (m_tcb);
     }
 
   if (sock.m_recoveryOps)
     {
-      m_recoveryOps = sock.m_recoveryOps->Fork ();
+      m_recoveryOps = sock.m_recoveryOps->IsStateless ()
+        ? sock.m_recoveryOps : sock.m_recoveryOps->Fork ();
     }
 
   m_rateOps = CreateObject <TcpRateLinux> ();
@@ -381,44 +445,6 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     {
       m_tcb->m_sendEmptyPacketCallback = MakeCallback (&TcpSocketBase::SendEmptyPacket, this);
     }
-
-  bool ok;
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindow",
-                                          MakeCallback (&TcpSocketBase::UpdateCwnd, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindowInflated",
-                                          MakeCallback (&TcpSocketBase::UpdateCwndInfl, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("SlowStartThreshold",
-                                          MakeCallback (&TcpSocketBase::UpdateSsThresh, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongState",
-                                          MakeCallback (&TcpSocketBase::UpdateCongState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("EcnState",
-                                          MakeCallback (&TcpSocketBase::UpdateEcnState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("NextTxSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateNextTxSequence, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateHighTxMark, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("BytesInFlight",
-                                          MakeCallback (&TcpSocketBase::UpdateBytesInFlight, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("RTT",
-                                          MakeCallback (&TcpSocketBase::UpdateRtt, this));
-  NS_ASSERT (ok == true);
 }
 
 TcpSocketBase::~TcpSocketBase (void)
@@ -471,6 +497,16 @@ TcpSocketBase::SetRtt (Ptr<RttEstimator> rtt)
   m_rtt = rtt;
 }
 
+void
+TcpSocketBase::SetTimerWheel (Ptr<TimerWheel> wheel)
+{
+  NS_LOG_FUNCTION (this << wheel);
+  m_retxEvent.SetWheel (wheel);
+  m_lastAckEvent.SetWheel (wheel);
+  m_delAckEvent.SetWheel (wheel);
+  m_timewaitEvent.SetWheel (wheel);
+}
+
 /* Inherit from Socket class: Returns error code */
 enum Socket::SocketErrno
 TcpSocketBase::GetErrno (void) const
@@ -1352,7 +1388,7 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
     { // Zero window: Enter persist state to send 1 byte to probe
       NS_LOG_LOGIC (this << " Enter zerowindow persist state");
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                    (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
       m_retxEvent.Cancel ();
       NS_LOG_LOGIC ("Schedule persist timeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
@@ -2476,7 +2512,7 @@ TcpSocketBase::DoPeerClose (void)
     {
       NS_LOG_LOGIC ("TcpSocketBase " << this << " scheduling LATO1");
       Time lastRto = m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4);
-      m_lastAckEvent = Simulator::Schedule (lastRto, &TcpSocketBase::LastAckTimeout, this);
+      m_lastAckEvent.Schedule (lastRto, MakeCallback (&TcpSocketBase::LastAckTimeout, this));
     }
 }
 
@@ -2492,7 +2528,7 @@ TcpSocketBase::Destroy (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2508,7 +2544,7 @@ TcpSocketBase::Destroy6 (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2634,7 +2670,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
       NS_LOG_LOGIC ("Schedule retransmission timeout at time "
                     << Simulator::Now ().GetSeconds () << " to expire at time "
                     << (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
+      m_retxEvent.Schedule (m_rto, MakeCallback (&TcpSocketBase::SendEmptyPacket, this).Bind (flags));
     }
 }
 
@@ -2688,7 +2724,9 @@ TcpSocketBase::SetupEndpoint ()
   Socket::SocketErrno errno_;
   Ptr<Ipv4Route> route;
   Ptr<NetDevice> oif = m_boundnetdevice;
-  route = ipv4->GetRoutingProtocol ()->RouteOutput (Ptr<Packet> (), header, oif, errno_);
+  route = ipv4->GetRoutingProtocol ()->RouteOutputWithPorts (Ptr<Packet> (), header,
+                                                             m_endPoint->GetLocalPort (),
+                                                             m_endPoint->GetPeerPort (), oif, errno_);
   if (route == 0)
     {
       NS_LOG_LOGIC ("Route to " << m_endPoint->GetPeerAddress () << " does not exist");
@@ -2967,6 +3005,13 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   header.SetWindowSize (AdvertisedWindowSize ());
   AddOptions (header);
 
+  if (sz > m_tcb->m_segmentSize)
+    {
+      // A super-segment, split into segments of SegmentSize bytes on the wire
+      uint16_t segments = static_cast<uint16_t> ((sz + m_tcb->m_segmentSize - 1) / m_tcb->m_segmentSize);
+      p->AddPacketTag (SegmentationOffloadTag (segments, static_cast<uint16_t> (m_tcb->m_segmentSize)));
+    }
+
   if (m_retxEvent.IsExpired ())
     {
       // Schedules retransmit timeout. m_rto should be already doubled.
@@ -2974,7 +3019,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       NS_LOG_LOGIC (this << " SendDataPacket Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      m_retxEvent.Schedule (m_rto, MakeCallback (&TcpSocketBase::ReTxTimeout, this));
     }
 
   m_txTrace (p, header, this);
@@ -3015,6 +3060,23 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   return sz;
 }
 
+uint32_t
+TcpSocketBase::MaxSegmentSize (const SequenceNumber32 &seq) const
+{
+  // Only new data is sent as super-segments, and only over IPv4: the
+  // retransmissions keep the granularity of the scoreboard
+  if (m_tsoMaxSegments == 1 || m_endPoint == nullptr || seq != m_tcb->m_highTxMark)
+    {
+      return m_tcb->m_segmentSize;
+    }
+  // The IPv4 total length must fit the super-segment with its largest
+  // IPv4 and TCP headers
+  static const uint32_t maxPayload = 65535 - 60 - 60;
+  return std::max (m_tcb->m_segmentSize,
+                   std::min (m_tcb->m_segmentSize * m_tsoMaxSegments,
+                             maxPayload - maxPayload % m_tcb->m_segmentSize));
+}
+
 void
 TcpSocketBase::UpdateRttHistory (const SequenceNumber32 &seq, uint32_t sz,
                                  bool isRetransmission)
@@ -3028,7 +3090,8 @@ TcpSocketBase::UpdateRttHistory (const SequenceNumber32 &seq, uint32_t sz,
     }
   else
     { // This is a retransmit, find in list and mark as re-tx
-      for (std::deque<RttHistory>::iterator i = m_history.begin (); i != m_history.end (); ++i)
+      for (std::vector<RttHistory>::iterator i = m_history.begin () + m_historyHead;
+           i != m_history.end (); ++i)
         {
           if ((seq >= i->seq) && (seq < (i->seq + SequenceNumber32 (i->count))))
             { // Found it
@@ -3123,7 +3186,7 @@ TcpSocketBase::SendPendingData (bool withAck)
               break;
             }
 
-          uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
+          uint32_t s = std::min (availableWindow, MaxSegmentSize (next));
 
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
@@ -3331,7 +3394,10 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      // A super-segment counts as the segments it stands for
+      SegmentationOffloadTag offload;
+      m_delAckCount += p->PeekPacketTag (offload) ? offload.GetSegments () : 1;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
@@ -3355,10 +3421,10 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
       else if (m_delAckEvent.IsExpired ())
         {
           m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_DELAYED_ACK);
-          m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
-                                               &TcpSocketBase::DelAckTimeout, this);
+          m_delAckEvent.Schedule (m_delAckTimeout,
+                                  MakeCallback (&TcpSocketBase::DelAckTimeout, this));
           NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
-                        (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
+                        (Simulator::Now () + m_delAckEvent.GetDelayLeft ()).GetSeconds ());
         }
     }
 }
@@ -3379,9 +3445,9 @@ TcpSocketBase::EstimateRtt (const TcpHeader& tcpHeader)
   // An ack has been received, calculate rtt and log this measurement
   // Note we use a linear search (O(n)) for this since for the common
   // case the ack'ed packet will be at the head of the list
-  if (!m_history.empty ())
+  if (m_historyHead < m_history.size ())
     {
-      RttHistory& h = m_history.front ();
+      RttHistory& h = m_history[m_historyHead];
       if (!h.retx && ackSeq >= (h.seq + SequenceNumber32 (h.count)))
         { // Ok to use this sample
           if (m_timestampEnabled && tcpHeader.HasOption (TcpOption::TS))
@@ -3398,14 +3464,24 @@ TcpSocketBase::EstimateRtt (const TcpHeader& tcpHeader)
     }
 
   // Now delete all ack history with seq <= ack
-  while (!m_history.empty ())
+  while (m_historyHead < m_history.size ())
     {
-      RttHistory& h = m_history.front ();
+      RttHistory& h = m_history[m_historyHead];
       if ((h.seq + SequenceNumber32 (h.count)) > ackSeq)
         {
           break;                                                              // Done removing
         }
-      m_history.pop_front (); // Remove
+      m_historyHead++; // Remove
+    }
+  if (m_historyHead == m_history.size ())
+    {
+      m_history.clear ();
+      m_historyHead = 0;
+    }
+  else if (m_historyHead >= 64 && 2 * m_historyHead >= m_history.size ())
+    { // Reclaim the room of the removed entries
+      m_history.erase (m_history.begin (), m_history.begin () + m_historyHead);
+      m_historyHead = 0;
     }
 
   if (!m.IsZero ())
@@ -3433,7 +3509,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
   if (m_state != SYN_RCVD && resetRTO)
     { // Set RTO unless the ACK is received in SYN_RCVD state
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                    (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
       m_retxEvent.Cancel ();
       // On receiving a "New" ack we restart retransmission timer .. RFC 6298
       // RFC 6298, clause 2.4
@@ -3442,7 +3518,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
       NS_LOG_LOGIC (this << " Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      m_retxEvent.Schedule (m_rto, MakeCallback (&TcpSocketBase::ReTxTimeout, this));
     }
 
   // Note the highest ACK and tell app to send more
@@ -3460,7 +3536,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
   if (m_txBuffer->Size () == 0 && m_state != FIN_WAIT_1 && m_state != CLOSING)
     { // No retransmit timer if no data to retransmit
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                    (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
       m_retxEvent.Cancel ();
     }
 }
@@ -3566,6 +3642,7 @@ TcpSocketBase::ReTxTimeout ()
 
   // Empty RTT history
   m_history.clear ();
+  m_historyHead = 0;
 
   // Please don't reset highTxMark, it is used for retransmission detection
 
@@ -3744,8 +3821,8 @@ TcpSocketBase::TimeWait ()
     }
   // Move from TIME_WAIT to CLOSED after 2*MSL. Max segment lifetime is 2 min
   // according to RFC793, p.28
-  m_timewaitEvent = Simulator::Schedule (Seconds (2 * m_msl),
-                                         &TcpSocketBase::CloseAndNotify, this);
+  m_timewaitEvent.Schedule (Seconds (2 * m_msl),
+                            MakeCallback (&TcpSocketBase::CloseAndNotify, this));
 }
 
 /* Below are the attribute get/set functions */
@@ -4184,6 +4261,61 @@ TcpSocketBase::SetRetxThresh (uint32_t retxThresh)
   m_txBuffer->SetDupAckThresh (retxThresh);
 }
 
+void
+TcpSocketBase::ChainTcbTrace (uint32_t trace)
+{
+  NS_LOG_FUNCTION (this << trace);
+  if (m_chainedTcbTraces & (1 << trace))
+    {
+      return;
+    }
+  m_chainedTcbTraces |= (1 << trace);
+
+  bool ok = false;
+  switch (trace)
+    {
+    case TCB_TRACE_CWND:
+      ok = m_tcb->TraceConnectWithoutContext ("CongestionWindow",
+                                              MakeCallback (&TcpSocketBase::UpdateCwnd, this));
+      break;
+    case TCB_TRACE_CWND_INFL:
+      ok = m_tcb->TraceConnectWithoutContext ("CongestionWindowInflated",
+                                              MakeCallback (&TcpSocketBase::UpdateCwndInfl, this));
+      break;
+    case TCB_TRACE_SSTHRESH:
+      ok = m_tcb->TraceConnectWithoutContext ("SlowStartThreshold",
+                                              MakeCallback (&TcpSocketBase::UpdateSsThresh, this));
+      break;
+    case TCB_TRACE_CONG_STATE:
+      ok = m_tcb->TraceConnectWithoutContext ("CongState",
+                                              MakeCallback (&TcpSocketBase::UpdateCongState, this));
+      break;
+    case TCB_TRACE_ECN_STATE:
+      ok = m_tcb->TraceConnectWithoutContext ("EcnState",
+                                              MakeCallback (&TcpSocketBase::UpdateEcnState, this));
+      break;
+    case TCB_TRACE_NEXT_TX_SEQUENCE:
+      ok = m_tcb->TraceConnectWithoutContext ("NextTxSequence",
+                                              MakeCallback (&TcpSocketBase::UpdateNextTxSequence, this));
+      break;
+    case TCB_TRACE_HIGHEST_SEQUENCE:
+      ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
+                                              MakeCallback (&TcpSocketBase::UpdateHighTxMark, this));
+      break;
+    case TCB_TRACE_BYTES_IN_FLIGHT:
+      ok = m_tcb->TraceConnectWithoutContext ("BytesInFlight",
+                                              MakeCallback (&TcpSocketBase::UpdateBytesInFlight, this));
+      break;
+    case TCB_TRACE_RTT:
+      ok = m_tcb->TraceConnectWithoutContext ("RTT",
+                                              MakeCallback (&TcpSocketBase::UpdateRtt, this));
+      break;
+    default:
+      NS_FATAL_ERROR ("Unknown trace source " << trace);
+    }
+  NS_ASSERT (ok == true);
+}
+
 void
 TcpSocketBase::UpdateCwnd (uint32_t oldValue, uint32_t newValue)
 {
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <queue>
+#include <vector>
 #include "ns3/traced-value.h"
 #include "ns3/tcp-socket.h"
 #include "ns3/ipv4-header.h"
@@ -32,6 +33,7 @@
 #include "ns3/data-rate.h"
 #include "ns3/node.h"
 #include "ns3/tcp-socket-state.h"
+#include "ns3/timer-wheel.h"
 
 namespace ns3 {
 
@@ -269,6 +271,17 @@ public:
    */
   virtual void SetRtt (Ptr<RttEstimator> rtt);
 
+  /**
+   * \brief Set the timer wheel of the node.
+   *
+   * The retransmission, delayed ACK, LAST_ACK and TIME_WAIT timers of the
+   * socket are armed on the wheel instead of scheduling a simulator event
+   * each time. It must be set before the socket is connected.
+   *
+   * \param wheel the timer wheel, or 0 to schedule simulator events
+   */
+  void SetTimerWheel (Ptr<TimerWheel> wheel);
+
   /**
    * \brief Sets the Minimum RTO.
    * \param minRto The minimum RTO.
@@ -986,6 +999,17 @@ protected:
    */
   virtual void EstimateRtt (const TcpHeader& tcpHeader);
 
+  /**
+   * \brief Get the maximum size of the segment to send from a sequence number
+   *
+   * When TsoMaxSegments is greater than 1, the new data sent over IPv4 is
+   * handed to the IPv4 layer as super-segments of several segments.
+   *
+   * \param seq The sequence number of the segment
+   * \return the maximum size of the segment
+   */
+  uint32_t MaxSegmentSize (const SequenceNumber32 &seq) const;
+
   /**
    * \brief Update the RTT history, when we send TCP segments
    *
@@ -1175,13 +1199,42 @@ protected:
    */
   void AddSocketTags (const Ptr<Packet> &p) const;
 
+  /// Trace sources of the TcpSocketState chained by those of the socket
+  enum TcbTrace
+  {
+    TCB_TRACE_CWND = 0,         //!< CongestionWindow
+    TCB_TRACE_CWND_INFL,        //!< CongestionWindowInflated
+    TCB_TRACE_SSTHRESH,         //!< SlowStartThreshold
+    TCB_TRACE_CONG_STATE,       //!< CongState
+    TCB_TRACE_ECN_STATE,        //!< EcnState
+    TCB_TRACE_NEXT_TX_SEQUENCE, //!< NextTxSequence
+    TCB_TRACE_HIGHEST_SEQUENCE, //!< HighestSequence
+    TCB_TRACE_BYTES_IN_FLIGHT,  //!< BytesInFlight
+    TCB_TRACE_RTT               //!< RTT
+  };
+
+  /**
+   * \brief Connect a trace source of m_tcb to the socket, if not done yet
+   *
+   * The trace sources of the socket which mirror those of its TcpSocketState
+   * (e.g., CongestionWindow) are chained to them when a first callback is
+   * connected, so that the sockets which are not traced do not hold the
+   * callbacks of the chain.
+   *
+   * \param trace the TcbTrace to chain
+   */
+  void ChainTcbTrace (uint32_t trace);
+
+  template <typename SOURCE>
+  friend class TcbTraceAccessor;
+
 protected:
   // Counters and events
-  EventId           m_retxEvent     {}; //!< Retransmission event
-  EventId           m_lastAckEvent  {}; //!< Last ACK timeout event
-  EventId           m_delAckEvent   {}; //!< Delayed ACK timeout event
+  WheelTimer        m_retxEvent;        //!< Retransmission event
+  WheelTimer        m_lastAckEvent;     //!< Last ACK timeout event
+  WheelTimer        m_delAckEvent;      //!< Delayed ACK timeout event
   EventId           m_persistEvent  {}; //!< Persist event: Send 1 byte to probe for a non-zero Rx window
-  EventId           m_timewaitEvent {}; //!< TIME_WAIT expiration event: Move this socket to CLOSED state
+  WheelTimer        m_timewaitEvent;    //!< TIME_WAIT expiration event: Move this socket to CLOSED state
 
   // ACK management
   uint32_t          m_dupAckCount {0};     //!< Dupack counter
@@ -1205,8 +1258,10 @@ protected:
   Time              m_persistTimeout   {Seconds (0.0)};   //!< Time between sending 1-byte probes
   Time              m_cnTimeout        {Seconds (0.0)};   //!< Timeout for connection retry
 
-  // History of RTT
-  std::deque<RttHistory>      m_history;         //!< List of sent packet
+  // History of RTT, in a vector not allocated until a segment is sent,
+  // whose first m_historyHead entries have been acknowledged
+  std::vector<RttHistory>     m_history;         //!< List of sent packet
+  std::size_t                 m_historyHead {0}; //!< First entry of m_history in use
 
   // Connections to other layers of TCP/IP
   Ipv4EndPoint*       m_endPoint  {nullptr}; //!< the IPv4 endpoint
@@ -1255,6 +1310,9 @@ protected:
   uint32_t               m_retxThresh {3};   //!< Fast Retransmit threshold
   bool                   m_limitedTx  {true}; //!< perform limited transmit
 
+  // Segmentation offload
+  uint32_t m_tsoMaxSegments {1}; //!< Max segments of a super-segment of new data (1 disables TSO)
+
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control information
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
@@ -1264,6 +1322,8 @@ protected:
   // Guesses over the other connection end
   bool m_isFirstPartialAck {true}; //!< First partial ACK during RECOVERY
 
+  uint16_t m_chainedTcbTraces {0}; //!< TcbTrace bits of the trace sources chained to m_tcb
+
   // The following two traces pass a packet with a TCP header
   TracedCallback<Ptr<const Packet>, const TcpHeader&,
                  Ptr<const TcpSocketBase> > m_txTrace; //!< Trace of transmitted packets
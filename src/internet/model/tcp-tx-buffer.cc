@@ -58,7 +58,9 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_highestSack (nullptr, SequenceNumber32 (0)), m_lostFrontier (n), m_nextSegHint (n),
+    m_lostCeiling (n)
 {
 }
 
@@ -81,6 +83,64 @@ TcpTxBuffer::~TcpTxBuffer (void)
     }
 }
 
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::PacketList::insert (iterator pos, TcpTxItem *item)
+{
+  if (pos == begin ())
+    {
+      push_front (item);
+      return begin ();
+    }
+  return m_items.insert (pos, item);
+}
+
+void
+TcpTxBuffer::PacketList::push_front (TcpTxItem *item)
+{
+  if (m_head == 0)
+    {
+      // Make a room as large as the items, so that pushing the items of
+      // another list one by one stays linear
+      std::size_t room = std::max<std::size_t> (m_items.size (), 8);
+      m_items.insert (m_items.begin (), room, nullptr);
+      m_head = room;
+    }
+  m_items[--m_head] = item;
+}
+
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::PacketList::erase (iterator pos)
+{
+  if (pos != begin ())
+    {
+      return m_items.erase (pos);
+    }
+  m_head++;
+  if (m_head == m_items.size ())
+    {
+      m_items.clear ();
+      m_head = 0;
+    }
+  else if (m_head >= 64 && m_head * 2 >= m_items.size ())
+    {
+      // Give the room back when it is as large as the items
+      m_items.erase (m_items.begin (), m_items.begin () + m_head);
+      m_head = 0;
+    }
+  return begin ();
+}
+
+void
+TcpTxBuffer::PacketList::pop_back (void)
+{
+  m_items.pop_back ();
+  if (m_head == m_items.size ())
+    {
+      m_items.clear ();
+      m_head = 0;
+    }
+}
+
 SequenceNumber32
 TcpTxBuffer::HeadSequence (void) const
 {
@@ -160,7 +220,43 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
 
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_highestSack = std::make_pair (nullptr, SequenceNumber32 (0));
+  ResetScoreboardBounds ();
+}
+
+uint32_t
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq) const
+{
+  // The items of the sent list cover contiguous sequence numbers, so that
+  // their first bytes are sorted.
+  uint32_t low = 0;
+  uint32_t high = m_sentList.size ();
+  while (low < high)
+    {
+      uint32_t middle = low + (high - low) / 2;
+      if (m_sentList[middle]->m_startSeq <= seq)
+        {
+          low = middle + 1;
+        }
+      else
+        {
+          high = middle;
+        }
+    }
+  // low is the first item starting after seq
+  if (low > 0 && seq < m_sentList[low - 1]->m_startSeq + m_sentList[low - 1]->m_packet->GetSize ())
+    {
+      return low - 1;
+    }
+  return low;
+}
+
+void
+TcpTxBuffer::ResetScoreboardBounds ()
+{
+  m_lostFrontier = m_firstByteSeq;
+  m_nextSegHint = m_firstByteSeq;
+  m_lostCeiling = m_firstByteSeq + m_sentSize;
 }
 
 bool
@@ -297,13 +393,13 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
+  auto it = m_sentList.begin () + FindSentItem (seq);
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  if (it != m_sentList.end ())
     {
       if ((*it)->m_startSeq == seq)
         {
@@ -326,7 +422,6 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
             {
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
         }
     }
 
@@ -341,26 +436,20 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   return item;
 }
 
-std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
+std::pair <TcpTxItem *, SequenceNumber32>
 TcpTxBuffer::FindHighestSacked () const
 {
   NS_LOG_FUNCTION (this);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
-  auto ret = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
-
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  for (auto it = m_sentList.rbegin (); it != m_sentList.rend (); ++it)
     {
-      const TcpTxItem *item = *it;
-      if (item->m_sacked)
+      if ((*it)->m_sacked)
         {
-          ret = std::make_pair (it, beginOfCurrentPacket);
+          return std::make_pair (*it, (*it)->m_startSeq);
         }
-      beginOfCurrentPacket += item->m_packet->GetSize ();
     }
 
-  return ret;
+  return std::make_pair (nullptr, SequenceNumber32 (0));
 }
 
 
@@ -424,11 +513,21 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
+  if (&list == &m_sentList && seq > listStartFrom)
+    {
+      // Jump to the item holding seq
+      it += FindSentItem (seq);
+      if (it != list.end ())
+        {
+          beginOfCurrentPacket = (*it)->m_startSeq;
+        }
+    }
+
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (&list != &m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -591,19 +690,19 @@ TcpTxBuffer::MergeItems (TcpTxItem *t1, TcpTxItem *t2) const
   // be updated in MarkTransmittedSegment.
   if (! AreEquals (t1->m_retrans, t2->m_retrans))
     {
+      TcpTxBuffer *self = const_cast<TcpTxBuffer*> (this);
       if (t1->m_retrans)
         {
-          TcpTxBuffer *self = const_cast<TcpTxBuffer*> (this);
           self->m_retrans -= t1->m_packet->GetSize ();
           t1->m_retrans = false;
         }
       else
         {
           NS_ASSERT (t2->m_retrans);
-          TcpTxBuffer *self = const_cast<TcpTxBuffer*> (this);
           self->m_retrans -= t2->m_packet->GetSize ();
           t2->m_retrans = false;
         }
+      self->m_nextSegHint = m_firstByteSeq;
     }
 
   if (t1->m_lastSent < t2->m_lastSent)
@@ -732,6 +831,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
           // when adding Reno dupacks in the count.
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
+          ResetScoreboardBounds ();
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
           MarkHeadAsLost ();
@@ -744,7 +844,19 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
 
   if (m_highestSack.second <= m_firstByteSeq)
     {
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+      m_highestSack = std::make_pair (nullptr, SequenceNumber32 (0));
+    }
+  if (m_lostFrontier < m_firstByteSeq)
+    {
+      m_lostFrontier = m_firstByteSeq;
+    }
+  if (m_nextSegHint < m_firstByteSeq)
+    {
+      m_nextSegHint = m_firstByteSeq;
+    }
+  if (m_lostCeiling < m_firstByteSeq)
+    {
+      m_lostCeiling = m_firstByteSeq;
     }
 
   NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << m_lostOut <<
@@ -766,15 +878,21 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return bytesSacked;
         }
 
+      // The items before the one holding the beginning of the block cannot
+      // be sacked by it
+      PacketList::iterator item_it = m_sentList.begin () + FindSentItem ((*option_it).first);
+      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq + m_sentSize;
+      if (item_it != m_sentList.end ())
+        {
+          beginOfCurrentPacket = (*item_it)->m_startSeq;
+        }
+
       while (item_it != m_sentList.end ())
         {
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
@@ -806,10 +924,10 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
                   m_sackedOut += (*item_it)->m_packet->GetSize ();
                   bytesSacked += (*item_it)->m_packet->GetSize ();
 
-                  if (m_highestSack.first == m_sentList.end()
+                  if (m_highestSack.first == nullptr
                       || m_highestSack.second <= beginOfCurrentPacket + pktSize)
                     {
-                      m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
+                      m_highestSack = std::make_pair (*item_it, beginOfCurrentPacket);
                     }
 
                   NS_LOG_INFO ("Received block " << *option_it <<
@@ -839,11 +957,11 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
 
   if (bytesSacked > 0)
     {
-      NS_ASSERT_MSG (m_highestSack.first != m_sentList.end(), "Buffer status: " << *this);
+      NS_ASSERT_MSG (m_highestSack.first != nullptr, "Buffer status: " << *this);
       UpdateLostCount ();
     }
 
-  NS_ASSERT ((*(m_sentList.begin ()))->m_sacked == false);
+  NS_ASSERT (m_sentList.empty () || m_sentList.front ()->m_sacked == false);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
   //NS_ASSERT (list.size () == 0 || modified);   // Assert for duplicated SACK or
                                                  // impossiblity to map the option into the sent blocks
@@ -856,21 +974,22 @@ TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
   uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
-  if (m_highestSack.first == m_sentList.end ())
+  if (m_highestSack.first == nullptr)
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from the latest sent item");
+                   ", no item is sacked");
     }
   else
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
+                   ", will start from item " << *m_highestSack.first);
     }
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  uint32_t highest = m_highestSack.first == nullptr ? 0 : FindSentItem (m_highestSack.second);
+  SequenceNumber32 lostUpTo = m_lostFrontier;
+  for (uint32_t i = highest; i > 0; --i)
     {
-      TcpTxItem *item = *it;
+      TcpTxItem *item = m_sentList[i];
       if (item->m_sacked)
         {
           sacked++;
@@ -878,13 +997,21 @@ TcpTxBuffer::UpdateLostCount ()
 
       if (sacked >= m_dupAckThresh)
         {
+          if (item->m_startSeq < m_lostFrontier)
+            {
+              // This item and the ones before are already sacked or lost
+              break;
+            }
+          if (lostUpTo < item->m_startSeq + item->m_packet->GetSize ())
+            {
+              lostUpTo = item->m_startSeq + item->m_packet->GetSize ();
+            }
           if (!item->m_sacked && !item->m_lost)
             {
               item->m_lost = true;
               m_lostOut += item->m_packet->GetSize ();
             }
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
     }
 
   if (sacked >= m_dupAckThresh)
@@ -895,6 +1022,15 @@ TcpTxBuffer::UpdateLostCount ()
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
         }
+      m_lostFrontier = lostUpTo;
+      if (m_lostCeiling < lostUpTo)
+        {
+          m_lostCeiling = lostUpTo;
+        }
+      if (m_lostCeiling < item->m_startSeq + item->m_packet->GetSize ())
+        {
+          m_lostCeiling = item->m_startSeq + item->m_packet->GetSize ();
+        }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
   ConsistencyCheck ();
@@ -905,7 +1041,6 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
   PacketList::const_iterator it;
 
   if (seq >= m_highestSack.second)
@@ -913,12 +1048,11 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Start from the item holding seq, the first item starting after seq
+  // being the one to check
+  for (it = m_sentList.begin () + FindSentItem (seq); it != m_sentList.end (); ++it)
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
+      if ((*it)->m_startSeq >= seq)
         {
           if ((*it)->m_lost == true)
             {
@@ -932,8 +1066,6 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
               return false;
             }
         }
-
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
     }
 
   return false;
@@ -961,15 +1093,36 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
   TcpTxItem *item;
   SequenceNumber32 seqPerRule3;
   bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The items before the hint are retransmitted or sacked
+  it = m_sentList.begin () + FindSentItem (m_nextSegHint);
+  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq + m_sentSize;
+  if (it != m_sentList.end ())
+    {
+      beginOfCurrentPkt = (*it)->m_startSeq;
+    }
+  bool hintUpdated = false;
+
+  for (; it != m_sentList.end (); ++it)
     {
       item = *it;
 
+      // No item is lost from here: rule 1 can not be met, and rule 3
+      // would return the candidate already saved
+      if (beginOfCurrentPkt >= m_lostCeiling && hintUpdated
+          && (!isRecovery || seqPerRule3.GetValue () != 0))
+        {
+          break;
+        }
+
       // Condition 1.a , 1.b , and 1.c
       if (item->m_retrans == false && item->m_sacked == false)
         {
+          if (!hintUpdated)
+            {
+              m_nextSegHint = beginOfCurrentPkt;
+              hintUpdated = true;
+            }
           if (item->m_lost)
             {
               NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
@@ -987,6 +1140,10 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
       // Nothing found, iterate
       beginOfCurrentPkt += item->m_packet->GetSize ();
     }
+  if (!hintUpdated)
+    {
+      m_nextSegHint = beginOfCurrentPkt;
+    }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
    *     exists available unsent data and the receiver's advertised
@@ -1170,7 +1327,7 @@ TcpTxBuffer::IsLostRFC (const SequenceNumber32 &seq, const PacketList::const_ite
 
       beginOfCurrentPacket += current->GetSize ();
     }
-  if (it == m_highestSack.first)
+  if (m_highestSack.first == nullptr)
     {
       NS_LOG_INFO ("seq=" << seq << " is not lost because there are no sacked segment ahead " << m_highestSack.second);
     }
@@ -1188,7 +1345,8 @@ TcpTxBuffer::ResetRenoSack ()
       (*it)->m_sacked = false;
     }
 
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_highestSack = std::make_pair (nullptr, SequenceNumber32 (0));
+  ResetScoreboardBounds ();
 }
 
 void
@@ -1210,7 +1368,8 @@ TcpTxBuffer::ResetSentList ()
   m_lostOut = 0;
   m_retrans = 0;
   m_sackedOut = 0;
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_highestSack = std::make_pair (nullptr, SequenceNumber32 (0));
+  ResetScoreboardBounds ();
 }
 
 void
@@ -1228,6 +1387,16 @@ TcpTxBuffer::ResetLastSegmentSent ()
           m_retrans -= item->m_packet->GetSize ();
         }
       m_appList.insert (m_appList.begin (), item);
+
+      SequenceNumber32 sentEnd = m_firstByteSeq + m_sentSize;
+      if (sentEnd < m_lostFrontier)
+        {
+          m_lostFrontier = sentEnd;
+        }
+      if (sentEnd < m_nextSegHint)
+        {
+          ;
+        }
     }
   ConsistencyCheck ();
 }
@@ -1242,7 +1411,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
     {
       m_sackedOut = 0;
       m_lostOut = m_sentSize;
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+      m_highestSack = std::make_pair (nullptr, SequenceNumber32 (0));
     }
   else
     {
@@ -1274,6 +1443,11 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
       (*it)->m_retrans = false;
     }
 
+  // All the items are now sacked or lost, and none is retransmitted
+  m_lostFrontier = m_firstByteSeq + m_sentSize;
+  m_nextSegHint = m_firstByteSeq;
+  m_lostCeiling = m_firstByteSeq + m_sentSize;
+
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
   ConsistencyCheck ();
@@ -1306,6 +1480,7 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
     {
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      m_nextSegHint = m_firstByteSeq;
     }
   ConsistencyCheck ();
 }
@@ -1335,6 +1510,13 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+
+      // The head is now a candidate for NextSeg
+      m_nextSegHint = m_firstByteSeq;
+      if (m_lostCeiling < m_firstByteSeq + m_sentList.front ()->m_packet->GetSize ())
+        {
+          m_lostCeiling = m_firstByteSeq + m_sentList.front ()->m_packet->GetSize ();
+        }
     }
   ConsistencyCheck ();
 }
@@ -1361,7 +1543,7 @@ TcpTxBuffer::AddRenoSack (void)
     {
       (*it)->m_sacked = true;
       m_sackedOut += (*it)->m_packet->GetSize ();
-      m_highestSack = std::make_pair (it, (*it)->m_startSeq);
+      m_highestSack = std::make_pair (*it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
   else
@@ -1401,6 +1583,12 @@ TcpTxBuffer::ConsistencyCheck () const
         {
           retrans += (*it)->m_packet->GetSize ();
         }
+      NS_ASSERT_MSG ((*it)->m_startSeq >= m_lostFrontier || (*it)->m_sacked || (*it)->m_lost,
+                     "Item " << **it << " before the lost frontier " << m_lostFrontier);
+      NS_ASSERT_MSG ((*it)->m_startSeq >= m_nextSegHint || (*it)->m_sacked || (*it)->m_retrans,
+                     "Item " << **it << " before the NextSeg hint " << m_nextSegHint);
+      NS_ASSERT_MSG ((*it)->m_startSeq < m_lostCeiling || !(*it)->m_lost,
+                     "Item " << **it << " after the lost ceiling " << m_lostCeiling);
     }
 
   NS_ASSERT_MSG (sacked == m_sackedOut, "Counted SACK: " << sacked <<
@@ -22,12 +22,16 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <vector>
+#include <iterator>
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
 #include "ns3/tcp-option-sack.h"
 #include "ns3/tcp-tx-item.h"
 
+class TcpTxBufferScoreboardTestCase;
+
 namespace ns3 {
 class Packet;
 
@@ -55,6 +59,11 @@ class Packet;
  * are not transmitted yet as segments. To discover how the chunks are managed
  * and retrieved from these lists, check CopyFromSequence documentation.
  *
+ * Both lists are double-ended queues of items, i.e., ring buffers of segments:
+ * the items of the SentList cover contiguous sequence numbers, so that the
+ * item holding a sequence number is found by a binary search instead of a
+ * walk from the head of the list.
+ *
  * The head of the data is represented by m_firstByteSeq, and it is returned by
  * HeadSequence(). The last byte is returned by TailSequence(). In this class,
  * we also store the size (in bytes) of the packets inside the SentList in the
@@ -90,6 +99,14 @@ class Packet;
  * segments that can be lost (\see UpdateLostCount), and we set the flags
  * accordingly.
  *
+ * Three bounds of the scoreboard avoid walking again the part of the SentList
+ * whose state is settled: all the items before the lost frontier are sacked
+ * or lost, so that UpdateLostCount stops there; all the items before the
+ * NextSeg hint are retransmitted or sacked, so that NextSeg starts there;
+ * and no item after the lost ceiling is lost, so that NextSeg stops there
+ * once it has a candidate for its third rule. The methods which clear the
+ * corresponding flags move the bounds back.
+ *
  * Management of bytes in flight
  * -----------------------------
  *
@@ -383,8 +400,88 @@ public:
 
 private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
-
-  typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  /**
+   * \brief TcpTxBufferScoreboardTestCase test case.
+   * \relates TcpTxBufferScoreboardTestCase
+   */
+  friend class ::TcpTxBufferScoreboardTestCase;
+
+  /**
+   * \brief Container for data stored in the buffer
+   *
+   * A vector of items with a free room at its front, so that removing the
+   * first item, as DiscardUpTo and GetNewSegment do, and inserting an item
+   * at the front are constant-time, while the items can be accessed by
+   * index for the binary search of FindSentItem. Unlike a deque, it does
+   * not allocate memory while it has never been used, which matters for
+   * the sockets of a simulation with many connections.
+   */
+  class PacketList
+  {
+  public:
+    typedef std::vector<TcpTxItem*>::iterator iterator;                  //!< iterator
+    typedef std::vector<TcpTxItem*>::const_iterator const_iterator;      //!< const iterator
+    typedef std::reverse_iterator<iterator> reverse_iterator;             //!< reverse iterator
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator; //!< const reverse iterator
+
+    /** \return an iterator to the first item */
+    iterator begin (void) { return m_items.begin () + m_head; }
+    /** \return an iterator past the last item */
+    iterator end (void) { return m_items.end (); }
+    /** \return a const iterator to the first item */
+    const_iterator begin (void) const { return m_items.begin () + m_head; }
+    /** \return a const iterator past the last item */
+    const_iterator end (void) const { return m_items.end (); }
+    /** \return a reverse iterator to the last item */
+    reverse_iterator rbegin (void) { return reverse_iterator (end ()); }
+    /** \return a reverse iterator before the first item */
+    reverse_iterator rend (void) { return reverse_iterator (begin ()); }
+    /** \return a const reverse iterator to the last item */
+    const_reverse_iterator rbegin (void) const { return const_reverse_iterator (end ()); }
+    /** \return a const reverse iterator before the first item */
+    const_reverse_iterator rend (void) const { return const_reverse_iterator (begin ()); }
+
+    /** \return true if there are no items */
+    bool empty (void) const { return m_head == m_items.size (); }
+    /** \return the number of items */
+    std::size_t size (void) const { return m_items.size () - m_head; }
+    /** \return the first item */
+    TcpTxItem *front (void) const { return m_items[m_head]; }
+    /** \return the last item */
+    TcpTxItem *back (void) const { return m_items.back (); }
+    /**
+     * \param i the index of an item
+     * \return the item
+     */
+    TcpTxItem *operator[] (std::size_t i) const { return m_items[m_head + i]; }
+
+    /**
+     * \brief Insert an item
+     * \param pos the position of the item
+     * \param item the item
+     * \return an iterator to the item inserted
+     */
+    iterator insert (iterator pos, TcpTxItem *item);
+    /**
+     * \brief Insert an item before the first one
+     * \param item the item
+     */
+    void push_front (TcpTxItem *item);
+    /**
+     * \brief Remove an item
+     * \param pos the position of the item
+     * \return an iterator to the item following the removed one
+     */
+    iterator erase (iterator pos);
+    /**
+     * \brief Remove the last item
+     */
+    void pop_back (void);
+
+  private:
+    std::vector<TcpTxItem*> m_items; //!< the items, after a free room
+    std::size_t m_head {0};          //!< the size of the free room
+  };
 
   /**
    * \brief Update the lost count
@@ -569,10 +666,25 @@ private:
 
   /**
    * \brief Find the highest SACK byte
-   * \return a pair with the highest byte and an iterator inside m_sentList
+   * \return a pair with the highest sacked item (or nullptr) and its first byte
+   */
+  std::pair <TcpTxItem *, SequenceNumber32> FindHighestSacked () const;
+
+  /**
+   * \brief Find an item of the sent list by binary search
+   * \param seq a sequence number
+   * \return the index in m_sentList of the item holding seq: 0 if seq is
+   * before the head, and the size of the list if seq is after the last
+   * byte sent
+   */
+  uint32_t FindSentItem (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Move the lost frontier and the NextSeg hint back to the head,
+   * and the lost ceiling to the last byte sent, after the flags of the items
+   * have been changed in bulk
    */
-  std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
-  FindHighestSacked () const;
+  void ResetScoreboardBounds ();
 
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
@@ -581,7 +693,10 @@ private:
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
-  std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
+  std::pair <TcpTxItem *, SequenceNumber32> m_highestSack; //!< Highest SACK item and its first byte
+  SequenceNumber32 m_lostFrontier; //!< All the sent items before it are sacked or lost
+  mutable SequenceNumber32 m_nextSegHint; //!< All the sent items before it are retransmitted or sacked
+  SequenceNumber32 m_lostCeiling; //!< No sent item starting at or after it is lost
 
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
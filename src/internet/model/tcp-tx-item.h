@@ -23,6 +23,8 @@
 #include "ns3/nstime.h"
 #include "ns3/sequence-number.h"
 
+class TcpTxBufferScoreboardTestCase;
+
 namespace ns3 {
 /**
  * \ingroup tcp
@@ -102,6 +104,11 @@ private:
   // Only TcpTxBuffer is allower to touch this part of the TcpTxItem, to manage
   // its internal lists and counters
   friend class TcpTxBuffer;
+  /**
+   * \brief TcpTxBufferScoreboardTestCase test case.
+   * \relates TcpTxBufferScoreboardTestCase
+   */
+  friend class ::TcpTxBufferScoreboardTestCase;
 
   SequenceNumber32 m_startSeq {0};   //!< Sequence number of the item (if transmitted)
   Ptr<Packet> m_packet {nullptr};    //!< Application packet (can be null)
@@ -0,0 +1,453 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "timer-wheel.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimerWheel");
+
+NS_OBJECT_ENSURE_REGISTERED (TimerWheel);
+
+namespace {
+
+/// Number of bits of the slot number of the first level
+const uint32_t WHEEL_FIRST_BITS = 8;
+/// Number of bits of the slot number of the upper levels
+const uint32_t WHEEL_UPPER_BITS = 6;
+/// Number of ticks covered by the first level
+const uint64_t WHEEL_FIRST_SPAN = 1ULL << WHEEL_FIRST_BITS;
+/// Number of ticks covered by the first two levels
+const uint64_t WHEEL_SECOND_SPAN = 1ULL << (WHEEL_FIRST_BITS + WHEEL_UPPER_BITS);
+/// Number of ticks covered by the three levels
+const uint64_t WHEEL_THIRD_SPAN = 1ULL << (WHEEL_FIRST_BITS + 2 * WHEEL_UPPER_BITS);
+/// Mask of the slot number of the first level
+const uint64_t WHEEL_FIRST_MASK = WHEEL_FIRST_SPAN - 1;
+/// Mask of the slot number of the upper levels
+const uint64_t WHEEL_UPPER_MASK = (1ULL << WHEEL_UPPER_BITS) - 1;
+
+} // anonymous namespace
+
+TypeId
+TimerWheel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TimerWheel")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TimerWheel> ()
+    .AddAttribute ("Granularity",
+                   "Duration of a slot of the first level of the wheel. "
+                   "It must not be changed while timers are armed.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&TimerWheel::m_granularity),
+                   MakeTimeChecker (TimeStep (1)))
+  ;
+  return tid;
+}
+
+TimerWheel::TimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+  m_levels[0].resize (WHEEL_FIRST_SPAN);
+  m_levels[1].resize (WHEEL_UPPER_MASK + 1);
+  m_levels[2].resize (WHEEL_UPPER_MASK + 1);
+}
+
+TimerWheel::~TimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TimerWheel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  std::vector<Slot *> slots;
+  for (uint32_t level = 0; level < 3; level++)
+    {
+      for (Slot &slot : m_levels[level])
+        {
+          slots.push_back (&slot);
+        }
+    }
+  slots.push_back (&m_overflow);
+  slots.push_back (&m_expiring);
+  for (Slot *slot : slots)
+    {
+      while (slot->head != nullptr)
+        {
+          WheelTimer *timer = slot->head;
+          Unlink (timer);
+          timer->m_running = false;
+        }
+    }
+  m_nTimers = 0;
+  Object::DoDispose ();
+}
+
+uint32_t
+TimerWheel::GetNTimers (void) const
+{
+  return m_nTimers;
+}
+
+uint64_t
+TimerWheel::GetNEvents (void) const
+{
+  return m_nEvents;
+}
+
+uint64_t
+TimerWheel::GetTick (const Time &time) const
+{
+  return static_cast<uint64_t> (time.GetTimeStep () / m_granularity.GetTimeStep ());
+}
+
+TimerWheel::Slot *
+TimerWheel::GetSlot (WheelTimer *timer)
+{
+  NS_ASSERT (timer->m_tick >= m_currentTick);
+  uint64_t delta = timer->m_tick - m_currentTick;
+  if (delta < WHEEL_FIRST_SPAN)
+    {
+      return &m_levels[0][timer->m_tick & WHEEL_FIRST_MASK];
+    }
+  else if (delta < WHEEL_SECOND_SPAN)
+    {
+      return &m_levels[1][(timer->m_tick >> WHEEL_FIRST_BITS) & WHEEL_UPPER_MASK];
+    }
+  else if (delta < WHEEL_THIRD_SPAN)
+    {
+      return &m_levels[2][(timer->m_tick >> (WHEEL_FIRST_BITS + WHEEL_UPPER_BITS)) & WHEEL_UPPER_MASK];
+    }
+  return &m_overflow;
+}
+
+void
+TimerWheel::Link (Slot *slot, WheelTimer *timer)
+{
+  timer->m_slot = slot;
+  timer->m_prev = slot->tail;
+  timer->m_next = nullptr;
+  if (slot->tail != nullptr)
+    {
+      slot->tail->m_next = timer;
+    }
+  else
+    {
+      slot->head = timer;
+    }
+  slot->tail = timer;
+}
+
+void
+TimerWheel::Unlink (WheelTimer *timer)
+{
+  Slot *slot = timer->m_slot;
+  if (timer->m_prev != nullptr)
+    {
+      timer->m_prev->m_next = timer->m_next;
+    }
+  else
+    {
+      slot->head = timer->m_next;
+    }
+  if (timer->m_next != nullptr)
+    {
+      timer->m_next->m_prev = timer->m_prev;
+    }
+  else
+    {
+      slot->tail = timer->m_prev;
+    }
+  timer->m_slot = nullptr;
+  timer->m_prev = nullptr;
+  timer->m_next = nullptr;
+}
+
+void
+TimerWheel::Cascade (Slot *slot)
+{
+  WheelTimer *timer = slot->head;
+  slot->head = nullptr;
+  slot->tail = nullptr;
+  while (timer != nullptr)
+    {
+      WheelTimer *next = timer->m_next;
+      Link (GetSlot (timer), timer);
+      timer = next;
+    }
+}
+
+void
+TimerWheel::Advance (uint64_t tick)
+{
+  while (m_currentTick < tick)
+    {
+      // Jump to the next slot of the second level, if the tick is beyond it
+      uint64_t next = (m_currentTick | WHEEL_FIRST_MASK) + 1;
+      if (next > tick)
+        {
+          m_currentTick = tick;
+          break;
+        }
+      m_currentTick = next;
+      if ((next & (WHEEL_SECOND_SPAN - 1)) == 0)
+        {
+          Cascade (&m_overflow);
+          Cascade (&m_levels[2][(next >> (WHEEL_FIRST_BITS + WHEEL_UPPER_BITS)) & WHEEL_UPPER_MASK]);
+        }
+      Cascade (&m_levels[1][(next >> WHEEL_FIRST_BITS) & WHEEL_UPPER_MASK]);
+    }
+}
+
+void
+TimerWheel::UpdateNextExpiry (const Slot &slot, Time &next, bool &found)
+{
+  for (WheelTimer *timer = slot.head; timer != nullptr; timer = timer->m_next)
+    {
+      if (!found || timer->m_expiry < next)
+        {
+          next = timer->m_expiry;
+          found = true;
+        }
+    }
+}
+
+Time
+TimerWheel::GetNextExpiry (void) const
+{
+  NS_ASSERT (m_nTimers > 0);
+  Time next;
+  bool found = false;
+
+  // Each slot of the first level holds a single tick, from the current one
+  for (uint64_t tick = m_currentTick; tick < m_currentTick + WHEEL_FIRST_SPAN; tick++)
+    {
+      const Slot &slot = m_levels[0][tick & WHEEL_FIRST_MASK];
+      if (slot.head != nullptr)
+        {
+          UpdateNextExpiry (slot, next, found);
+          break;
+        }
+    }
+
+  // The slots of the upper levels hold the ticks of the following ranges,
+  // which may start before the earliest timer found so far
+  uint32_t bits = WHEEL_FIRST_BITS;
+  for (uint32_t level = 1; level < 3; level++)
+    {
+      uint64_t range = m_currentTick >> bits;
+      for (uint64_t i = 1; i <= WHEEL_UPPER_MASK + 1; i++)
+        {
+          if (found && GetTick (next) < ((range + i) << bits))
+            {
+              break;
+            }
+          const Slot &slot = m_levels[level][(range + i) & WHEEL_UPPER_MASK];
+          if (slot.head != nullptr)
+            {
+              UpdateNextExpiry (slot, next, found);
+              break;
+            }
+        }
+      bits += WHEEL_UPPER_BITS;
+    }
+
+  UpdateNextExpiry (m_overflow, next, found);
+  NS_ASSERT (found);
+  return next;
+}
+
+void
+TimerWheel::ScheduleEvent (const Time &time)
+{
+  NS_LOG_FUNCTION (this << time);
+  m_event.Cancel ();
+  m_event = Simulator::Schedule (time - Simulator::Now (), &TimerWheel::Expire, this);
+  m_eventTime = time;
+  m_nEvents++;
+}
+
+void
+TimerWheel::Add (WheelTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer << timer->m_expiry);
+  Time now = Simulator::Now ();
+  NS_ASSERT (timer->m_expiry >= now);
+  if (m_nTimers == 0)
+    {
+      m_currentTick = GetTick (now);
+    }
+  else
+    {
+      Advance (GetTick (now));
+    }
+  timer->m_tick = GetTick (timer->m_expiry);
+  timer->m_sequence = m_sequence++;
+  timer->m_running = true;
+  Link (GetSlot (timer), timer);
+  m_nTimers++;
+
+  // The event is left pending when its timer is cancelled, and Expire
+  // schedules the next one after running the timers
+  if (!m_expiringNow && (!m_event.IsRunning () || timer->m_expiry < m_eventTime))
+    {
+      ScheduleEvent (timer->m_expiry);
+    }
+}
+
+void
+TimerWheel::Remove (WheelTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+  NS_ASSERT (m_nTimers > 0);
+  Unlink (timer);
+  timer->m_running = false;
+  m_nTimers--;
+}
+
+void
+TimerWheel::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  uint64_t tick = GetTick (now);
+  Advance (tick);
+
+  // Run the timers expiring now in the order in which they were armed; a
+  // timer can be cancelled or re-armed by the function of a previous one
+  std::vector<WheelTimer *> expired;
+  Slot *slot = &m_levels[0][tick & WHEEL_FIRST_MASK];
+  for (WheelTimer *timer = slot->head; timer != nullptr; timer = timer->m_next)
+    {
+      if (timer->m_expiry <= now)
+        {
+          expired.push_back (timer);
+        }
+    }
+  std::sort (expired.begin (), expired.end (),
+             [] (const WheelTimer *a, const WheelTimer *b)
+             { return a->m_sequence < b->m_sequence; });
+  for (WheelTimer *timer : expired)
+    {
+      Unlink (timer);
+      Link (&m_expiring, timer);
+    }
+
+  m_expiringNow = true;
+  while (m_expiring.head != nullptr)
+    {
+      WheelTimer *timer = m_expiring.head;
+      Callback<void> function = timer->m_function;
+      Remove (timer);
+      function ();
+    }
+  m_expiringNow = false;
+
+  if (m_nTimers > 0)
+    {
+      ScheduleEvent (GetNextExpiry ());
+    }
+}
+
+WheelTimer::WheelTimer ()
+{
+}
+
+WheelTimer::~WheelTimer ()
+{
+  Cancel ();
+}
+
+void
+WheelTimer::SetWheel (Ptr<TimerWheel> wheel)
+{
+  NS_ASSERT_MSG (IsExpired (), "Cannot change the wheel of a running timer");
+  m_wheel = wheel;
+}
+
+Ptr<TimerWheel>
+WheelTimer::GetWheel (void) const
+{
+  return m_wheel;
+}
+
+void
+WheelTimer::Schedule (const Time &delay, const Callback<void> &function)
+{
+  Cancel ();
+  m_function = function;
+  if (m_wheel != nullptr)
+    {
+      m_expiry = Simulator::Now () + delay;
+      m_wheel->Add (this);
+    }
+  else
+    {
+      m_event = Simulator::Schedule (delay, &WheelTimer::Expire, this);
+    }
+}
+
+void
+WheelTimer::Cancel (void)
+{
+  if (m_running)
+    {
+      m_wheel->Remove (this);
+    }
+  m_event.Cancel ();
+}
+
+bool
+WheelTimer::IsRunning (void) const
+{
+  return !IsExpired ();
+}
+
+bool
+WheelTimer::IsExpired (void) const
+{
+  if (m_wheel != nullptr)
+    {
+      return !m_running;
+    }
+  return m_event.IsExpired ();
+}
+
+Time
+WheelTimer::GetDelayLeft (void) const
+{
+  if (m_wheel != nullptr)
+    {
+      return m_running ? m_expiry - Simulator::Now () : Time (0);
+    }
+  return Simulator::GetDelayLeft (m_event);
+}
+
+void
+WheelTimer::Expire (void)
+{
+  Callback<void> function = m_function;
+  function ();
+}
+
+} // namespace ns3
@@ -0,0 +1,277 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+class WheelTimer;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Per-node service holding the timers of the transport protocols
+ *
+ * The timers of a transport protocol are re-armed on almost every segment
+ * received (e.g., the retransmission timer of TCP on every new ACK), so with
+ * one simulator event per timer, many concurrent flows spend their time
+ * cancelling and scheduling events in the global scheduler.
+ *
+ * The TimerWheel, aggregated to a node, keeps the WheelTimer objects of all
+ * the protocols of the node in a hierarchical timing wheel: a level of 256
+ * slots of Granularity, and two levels of 64 slots covering respectively
+ * 256 and 16384 slots of the level below; the timers farther in the future
+ * are kept in an overflow list. Arming, re-arming or cancelling a timer only
+ * links or unlinks it from a slot. A single simulator event is pending for
+ * the whole wheel, at the expiration time of its earliest timer: it is
+ * rescheduled only when a timer is armed earlier than it, and is left
+ * pending when its timer is cancelled.
+ *
+ * The slots only index the timers: a timer expires at the exact time it
+ * was armed for, not at the boundary of its slot. The timers expiring at
+ * the same time are run in the order in which they were armed.
+ */
+class TimerWheel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TimerWheel ();
+  virtual ~TimerWheel ();
+
+  /**
+   * \brief Get the number of timers armed on the wheel
+   * \return the number of timers armed on the wheel
+   */
+  uint32_t GetNTimers (void) const;
+
+  /**
+   * \brief Get the number of simulator events scheduled by the wheel
+   * \return the number of simulator events scheduled by the wheel
+   */
+  uint64_t GetNEvents (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  friend class WheelTimer;
+
+  /// Timers of a slot, in a doubly-linked list through the timers
+  struct Slot
+  {
+    WheelTimer *head {nullptr}; //!< first timer of the slot
+    WheelTimer *tail {nullptr}; //!< last timer of the slot
+  };
+
+  /**
+   * \brief Arm a timer
+   * \param timer the timer, with its expiration time set
+   */
+  void Add (WheelTimer *timer);
+
+  /**
+   * \brief Disarm a timer
+   * \param timer the timer
+   */
+  void Remove (WheelTimer *timer);
+
+  /**
+   * \brief Get the tick of a time
+   * \param time the time
+   * \return the slot number of the time, counted from time zero
+   */
+  uint64_t GetTick (const Time &time) const;
+
+  /**
+   * \brief Get the slot of a timer, according to the current tick
+   * \param timer the timer
+   * \return the slot where the timer has to be linked
+   */
+  Slot *GetSlot (WheelTimer *timer);
+
+  /**
+   * \brief Link a timer at the end of a slot
+   * \param slot the slot
+   * \param timer the timer
+   */
+  static void Link (Slot *slot, WheelTimer *timer);
+
+  /**
+   * \brief Unlink a timer from its slot
+   * \param timer the timer
+   */
+  static void Unlink (WheelTimer *timer);
+
+  /**
+   * \brief Relink the timers of a slot according to the current tick
+   * \param slot the slot
+   */
+  void Cascade (Slot *slot);
+
+  /**
+   * \brief Move the current tick, cascading the slots of the upper levels
+   * \param tick the new current tick, not after the tick of any timer
+   */
+  void Advance (uint64_t tick);
+
+  /**
+   * \brief Get the expiration time of the earliest timer
+   * \return the expiration time of the earliest timer
+   */
+  Time GetNextExpiry (void) const;
+
+  /**
+   * \brief Get the expiration time of the earliest timer of a slot
+   * \param slot the slot
+   * \param [in,out] next the earliest expiration time found so far
+   * \param [in,out] found whether an expiration time was found so far
+   */
+  static void UpdateNextExpiry (const Slot &slot, Time &next, bool &found);
+
+  /**
+   * \brief Schedule the simulator event of the wheel at a time
+   * \param time the time
+   */
+  void ScheduleEvent (const Time &time);
+
+  /**
+   * \brief Run the timers expiring now, and schedule the next event
+   */
+  void Expire (void);
+
+  Time m_granularity;               //!< duration of a slot of the first level
+  int64_t m_granularitySteps {1};   //!< duration of a slot, in time steps
+  std::vector<Slot> m_levels[3];    //!< slots of the levels of the wheel
+  Slot m_overflow;                  //!< timers beyond the last level
+  Slot m_expiring;                  //!< timers being run by Expire
+  uint64_t m_currentTick {0};       //!< tick of the first slot of the first level
+  uint32_t m_nTimers {0};           //!< number of timers armed
+  uint64_t m_sequence {0};          //!< arming order of the timers
+  bool m_expiringNow {false};       //!< whether Expire is running
+  EventId m_event;                  //!< the simulator event of the wheel
+  Time m_eventTime;                 //!< the time of the simulator event
+  uint64_t m_nEvents {0};           //!< number of simulator events scheduled
+};
+
+/**
+ * \ingroup internet
+ *
+ * \brief A timer of a transport protocol
+ *
+ * With a TimerWheel, the timer is armed on the wheel; without one, each
+ * arming of the timer schedules its own simulator event, with the same
+ * semantics as an EventId. The owner of the timer has to outlive it, or to
+ * cancel it before being destroyed; the timer is cancelled when destroyed.
+ */
+class WheelTimer
+{
+public:
+  WheelTimer ();
+  ~WheelTimer ();
+
+  /**
+   * \brief Set the wheel of the timer
+   *
+   * The timer must not be running.
+   *
+   * \param wheel the wheel, or 0 to schedule a simulator event per arming
+   */
+  void SetWheel (Ptr<TimerWheel> wheel);
+
+  /**
+   * \brief Get the wheel of the timer
+   * \return the wheel of the timer, or 0
+   */
+  Ptr<TimerWheel> GetWheel (void) const;
+
+  /**
+   * \brief Arm the timer, cancelling it first if it is running
+   * \param delay the delay after which the timer expires
+   * \param function the function to call when the timer expires
+   */
+  void Schedule (const Time &delay, const Callback<void> &function);
+
+  /**
+   * \brief Cancel the timer, if it is running
+   */
+  void Cancel (void);
+
+  /**
+   * \brief Check if the timer is armed and has not expired yet
+   * \return true if the timer is running
+   */
+  bool IsRunning (void) const;
+
+  /**
+   * \brief Check if the timer has expired, has been cancelled or was never armed
+   * \return true if the timer is not running
+   */
+  bool IsExpired (void) const;
+
+  /**
+   * \brief Get the delay left before the timer expires
+   * \return the delay left, or zero if the timer is not running
+   */
+  Time GetDelayLeft (void) const;
+
+private:
+  friend class TimerWheel;
+
+  /**
+   * \brief Copy constructor, disabled
+   * \param o the timer to copy
+   */
+  WheelTimer (const WheelTimer &o);
+  /**
+   * \brief Assignment operator, disabled
+   * \param o the timer to copy
+   * \return the timer
+   */
+  WheelTimer &operator = (const WheelTimer &o);
+
+  /**
+   * \brief Run the function of the timer
+   */
+  void Expire (void);
+
+  Ptr<TimerWheel> m_wheel;     //!< the wheel of the timer, if any
+  Callback<void> m_function;   //!< the function called on expiration
+  EventId m_event;             //!< the simulator event, without a wheel
+  Time m_expiry;               //!< the expiration time, with a wheel
+  uint64_t m_tick {0};         //!< the tick of the expiration time
+  uint64_t m_sequence {0};     //!< the arming order, on the wheel
+  bool m_running {false};      //!< whether the timer is armed on the wheel
+  TimerWheel::Slot *m_slot {nullptr}; //!< the slot linking the timer
+  WheelTimer *m_prev {nullptr}; //!< the previous timer of the slot
+  WheelTimer *m_next {nullptr}; //!< the next timer of the slot
+};
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_H */
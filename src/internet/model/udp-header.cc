@@ -51,6 +51,13 @@ UdpHeader::EnableChecksums (void)
   m_calcChecksum = true;
 }
 
+bool
+UdpHeader::IsCacheable (void) const
+{
+  // a cached copy would not honour the checksum state set by the caller
+  return !m_calcChecksum;
+}
+
 void 
 UdpHeader::SetDestinationPort (uint16_t port)
 {
@@ -124,6 +124,7 @@ public:
   virtual uint32_t GetSerializedSize (void) const;
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual bool IsCacheable (void) const;
 
   /**
    * \brief Is the UDP checksum correct ?
@@ -618,7 +618,10 @@ UdpSocketImpl::DoSendTo (Ptr<Packet> p, Ipv4Address dest, uint16_t port, uint8_t
       Ptr<Ipv4Route> route;
       Ptr<NetDevice> oif = m_boundnetdevice; //specify non-zero if bound to a specific device
       // TBD-- we could cache the route and just check its validity
-      route = ipv4->GetRoutingProtocol ()->RouteOutput (p, header, oif, errno_); 
+      // The packet does not start with the UDP header yet, hence the ports
+      // are given explicitly
+      route = ipv4->GetRoutingProtocol ()->RouteOutputWithPorts (p, header, m_endPoint->GetLocalPort (), port,
+                                                                 oif, errno_);
       if (route != 0)
         {
           NS_LOG_LOGIC ("Route exists");
@@ -0,0 +1,275 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+#include "ns3/test.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-interface.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux Test: lookups, precedence of the matches and
+ * updates of the endpoints.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Check the result of a lookup.
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \param expected the expected endpoint, or 0
+   */
+  void CheckLookup (Ipv4EndPointDemux &demux,
+                    Ipv4Address daddr, uint16_t dport,
+                    Ipv4Address saddr, uint16_t sport,
+                    Ipv4EndPoint *expected);
+
+  Ptr<Ipv4Interface> m_interface;   //!< the incoming interface
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Check the lookups of Ipv4EndPointDemux")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::CheckLookup (Ipv4EndPointDemux &demux,
+                                        Ipv4Address daddr, uint16_t dport,
+                                        Ipv4Address saddr, uint16_t sport,
+                                        Ipv4EndPoint *expected)
+{
+  Ipv4EndPointDemux::EndPoints found = demux.Lookup (daddr, dport, saddr, sport, m_interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), (expected != 0 ? 1 : 0),
+                         "Unexpected number of endpoints for " << saddr << ":" << sport << " -> " << daddr << ":" << dport);
+  if (expected != 0 && !found.empty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (found.front (), expected,
+                             "Unexpected endpoint for " << saddr << ":" << sport << " -> " << daddr << ":" << dport);
+    }
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  m_interface = CreateObject<Ipv4Interface> ();
+  m_interface->AddAddress (Ipv4InterfaceAddress ("10.0.0.1", "255.255.255.0"));
+  Ipv4EndPointDemux demux;
+
+  // Listeners
+  Ipv4EndPoint *listenerAny = demux.Allocate (0, 1000);
+  Ipv4EndPoint *listenerAddr = demux.Allocate (0, "10.0.0.1", 1000);
+  NS_TEST_ASSERT_MSG_EQ ((demux.Allocate (0, "10.0.0.1", 1000) == 0), true, "Duplicated endpoints must be refused");
+  CheckLookup (demux, "10.0.0.1", 1000, "10.0.0.2", 5000, listenerAddr);
+  CheckLookup (demux, "10.0.0.255", 1000, "10.0.0.2", 5000, listenerAny);
+  CheckLookup (demux, "10.0.0.1", 1001, "10.0.0.2", 5000, 0);
+
+  // Connected endpoints take precedence over the listeners
+  Ipv4EndPoint *connected = demux.Allocate (0, "10.0.0.1", 1000, "10.0.0.2", 5000);
+  NS_TEST_ASSERT_MSG_EQ ((demux.Allocate (0, "10.0.0.1", 1000, "10.0.0.2", 5000) == 0), true, "Duplicated endpoints must be refused");
+  CheckLookup (demux, "10.0.0.1", 1000, "10.0.0.2", 5000, connected);
+  CheckLookup (demux, "10.0.0.1", 1000, "10.0.0.2", 5001, listenerAddr);
+
+  // Subnet-directed endpoint connected to a peer
+  Ipv4EndPoint *subnet = demux.Allocate (0, "10.0.0.0", 1000, "10.0.0.3", 6000);
+  CheckLookup (demux, "10.0.0.255", 1000, "10.0.0.3", 6000, subnet);
+  CheckLookup (demux, "10.0.0.1", 1000, "10.0.0.3", 6000, subnet);
+  CheckLookup (demux, "10.0.0.255", 1000, "10.0.0.4", 6000, listenerAny);
+
+  // Endpoints are found again after their addresses change
+  Ipv4EndPoint *ephemeral = demux.Allocate ();
+  uint16_t port = ephemeral->GetLocalPort ();
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), true, "The ephemeral port must be in use");
+  CheckLookup (demux, "10.0.0.1", port, "10.0.0.4", 7000, ephemeral);
+  ephemeral->SetLocalAddress ("10.0.0.1");
+  ephemeral->SetPeer ("10.0.0.4", 7000);
+  CheckLookup (demux, "10.0.0.1", port, "10.0.0.4", 7000, ephemeral);
+  CheckLookup (demux, "10.0.0.1", port, "10.0.0.4", 7001, 0);
+  ephemeral->SetPeer ("10.0.0.5", 7001);
+  CheckLookup (demux, "10.0.0.1", port, "10.0.0.4", 7000, 0);
+  CheckLookup (demux, "10.0.0.1", port, "10.0.0.5", 7001, ephemeral);
+
+  // Deallocation
+  demux.DeAllocate (connected);
+  CheckLookup (demux, "10.0.0.1", 1000, "10.0.0.2", 5000, listenerAddr);
+  demux.DeAllocate (listenerAddr);
+  CheckLookup (demux, "10.0.0.1", 1000, "10.0.0.2", 5000, listenerAny);
+  demux.DeAllocate (listenerAny);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (1000), true, "The port must still be in use");
+  demux.DeAllocate (subnet);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (1000), false, "The port must not be in use");
+  CheckLookup (demux, "10.0.0.1", 1000, "10.0.0.2", 5000, 0);
+  demux.DeAllocate (ephemeral);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), false, "The port must not be in use");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().size (), 0, "The demux must be empty");
+
+  // Ephemeral ports are unique
+  std::set<uint16_t> ports;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Ipv4EndPoint *endPoint = demux.Allocate ("10.0.0.1");
+      NS_TEST_ASSERT_MSG_EQ (ports.insert (endPoint->GetLocalPort ()).second, true, "Duplicated ephemeral port");
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (endPoint->GetLocalPort (), 49152, "Ephemeral port out of range");
+    }
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux Test: lookups, precedence of the matches and
+ * updates of the endpoints.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Check the result of a lookup.
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \param expected the expected endpoint, or 0
+   */
+  void CheckLookup (Ipv6EndPointDemux &demux,
+                    Ipv6Address daddr, uint16_t dport,
+                    Ipv6Address saddr, uint16_t sport,
+                    Ipv6EndPoint *expected);
+
+  Ptr<Ipv6Interface> m_interface;   //!< the incoming interface
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Check the lookups of Ipv6EndPointDemux")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::CheckLookup (Ipv6EndPointDemux &demux,
+                                        Ipv6Address daddr, uint16_t dport,
+                                        Ipv6Address saddr, uint16_t sport,
+                                        Ipv6EndPoint *expected)
+{
+  Ipv6EndPointDemux::EndPoints found = demux.Lookup (daddr, dport, saddr, sport, m_interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), (expected != 0 ? 1 : 0),
+                         "Unexpected number of endpoints for " << saddr << ":" << sport << " -> " << daddr << ":" << dport);
+  if (expected != 0 && !found.empty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (found.front (), expected,
+                             "Unexpected endpoint for " << saddr << ":" << sport << " -> " << daddr << ":" << dport);
+    }
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  m_interface = CreateObject<Ipv6Interface> ();
+  Ipv6EndPointDemux demux;
+
+  // Listeners
+  Ipv6EndPoint *listenerAny = demux.Allocate (0, 1000);
+  Ipv6EndPoint *listenerAddr = demux.Allocate (0, "2001::1", 1000);
+  NS_TEST_ASSERT_MSG_EQ ((demux.Allocate (0, "2001::1", 1000) == 0), true, "Duplicated endpoints must be refused");
+  CheckLookup (demux, "2001::1", 1000, "2001::2", 5000, listenerAddr);
+  CheckLookup (demux, "2001::3", 1000, "2001::2", 5000, listenerAny);
+  CheckLookup (demux, "2001::1", 1001, "2001::2", 5000, 0);
+
+  // Connected endpoints take precedence over the listeners
+  Ipv6EndPoint *connected = demux.Allocate (0, "2001::1", 1000, "2001::2", 5000);
+  NS_TEST_ASSERT_MSG_EQ ((demux.Allocate (0, "2001::1", 1000, "2001::2", 5000) == 0), true, "Duplicated endpoints must be refused");
+  CheckLookup (demux, "2001::1", 1000, "2001::2", 5000, connected);
+  CheckLookup (demux, "2001::1", 1000, "2001::2", 5001, listenerAddr);
+
+  // Endpoints are found again after their addresses change
+  Ipv6EndPoint *ephemeral = demux.Allocate ();
+  uint16_t port = ephemeral->GetLocalPort ();
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), true, "The ephemeral port must be in use");
+  CheckLookup (demux, "2001::1", port, "2001::4", 7000, ephemeral);
+  ephemeral->SetLocalAddress ("2001::1");
+  ephemeral->SetPeer ("2001::4", 7000);
+  CheckLookup (demux, "2001::1", port, "2001::4", 7000, ephemeral);
+  CheckLookup (demux, "2001::1", port, "2001::4", 7001, 0);
+  ephemeral->SetPeer ("2001::5", 7001);
+  CheckLookup (demux, "2001::1", port, "2001::4", 7000, 0);
+  CheckLookup (demux, "2001::1", port, "2001::5", 7001, ephemeral);
+
+  // Deallocation
+  demux.DeAllocate (connected);
+  CheckLookup (demux, "2001::1", 1000, "2001::2", 5000, listenerAddr);
+  demux.DeAllocate (listenerAddr);
+  CheckLookup (demux, "2001::1", 1000, "2001::2", 5000, listenerAny);
+  demux.DeAllocate (listenerAny);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (1000), false, "The port must not be in use");
+  CheckLookup (demux, "2001::1", 1000, "2001::2", 5000, 0);
+  demux.DeAllocate (ephemeral);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), false, "The port must not be in use");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetEndPoints ().size (), 0, "The demux must be empty");
+
+  // Ephemeral ports are unique
+  std::set<uint16_t> ports;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Ipv6EndPoint *endPoint = demux.Allocate ("2001::1");
+      NS_TEST_ASSERT_MSG_EQ (ports.insert (endPoint->GetLocalPort ()).second, true, "Duplicated ephemeral port");
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (endPoint->GetLocalPort (), 49152, "Ephemeral port out of range");
+    }
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux and Ipv6EndPointDemux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite endPointDemuxTestSuite; //!< Static variable for test initialization
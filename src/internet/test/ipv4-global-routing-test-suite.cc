@@ -14,6 +14,10 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
 #include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
@@ -41,7 +45,11 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/udp-header.h"
 
 using namespace ns3;
 
@@ -1244,6 +1252,597 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting incremental update test: the routes updated
+ * after interface and metric changes, possibly by several threads, are
+ * checked against the routes computed from scratch by a single thread.
+ */
+class Ipv4GlobalRoutingIncrementalTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param threads The number of threads calculating the routes.
+   */
+  Ipv4GlobalRoutingIncrementalTestCase (uint32_t threads);
+  virtual ~Ipv4GlobalRoutingIncrementalTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// The routes of the nodes, by node, destination and kind of route
+  typedef std::map<std::string, std::string> Routes;
+
+  /**
+   * \brief Get the global routes of the nodes.
+   * \param nodes The nodes.
+   * \returns the routes, with the next hops of each destination in
+   * routing table order.
+   */
+  Routes GetRoutes (NodeContainer nodes);
+
+  /**
+   * \brief Check the routes of the nodes against a full recomputation.
+   * \param nodes The nodes.
+   * \param round The round of changes.
+   */
+  void CheckRoutes (NodeContainer nodes, uint32_t round);
+
+  uint32_t m_threads; //!< The number of threads calculating the routes.
+};
+
+Ipv4GlobalRoutingIncrementalTestCase::Ipv4GlobalRoutingIncrementalTestCase (uint32_t threads)
+  : TestCase ("Check the incremental update of global routes by " + std::to_string (threads) +
+              " thread(s) against a full recomputation"),
+    m_threads (threads)
+{
+}
+
+Ipv4GlobalRoutingIncrementalTestCase::~Ipv4GlobalRoutingIncrementalTestCase ()
+{
+}
+
+Ipv4GlobalRoutingIncrementalTestCase::Routes
+Ipv4GlobalRoutingIncrementalTestCase::GetRoutes (NodeContainer nodes)
+{
+  Routes routes;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> globalRouting = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      for (uint32_t j = 0; j < globalRouting->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry *route = globalRouting->GetRoute (j);
+          std::ostringstream key;
+          key << i << " " << route->GetDest () << "/" << route->GetDestNetworkMask ().GetPrefixLength ()
+              << (route->IsHost () ? " host" : " network");
+          std::ostringstream nextHop;
+          nextHop << " " << route->GetGateway () << "%" << route->GetInterface ();
+          routes[key.str ()] += nextHop.str ();
+        }
+    }
+  return routes;
+}
+
+void
+Ipv4GlobalRoutingIncrementalTestCase::CheckRoutes (NodeContainer nodes, uint32_t round)
+{
+  Routes updated = GetRoutes (nodes);
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (m_threads));
+  Routes computed = GetRoutes (nodes);
+
+  NS_TEST_ASSERT_MSG_EQ (updated.size (), computed.size (), "Unexpected number of destinations in round " << round);
+  for (Routes::const_iterator i = updated.begin (), j = computed.begin (); i != updated.end (); i++, j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (i->first, j->first, "Unexpected destination in round " << round);
+      NS_TEST_ASSERT_MSG_EQ (i->second, j->second, "Unexpected next hops to " << i->first << " in round " << round);
+    }
+}
+
+void
+Ipv4GlobalRoutingIncrementalTestCase::DoRun (void)
+{
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (m_threads));
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+
+  // A ring of routers with a few chords.  The metrics are drawn in a small
+  // range so that many destinations have equal cost paths.
+  const uint32_t nNodes = 12;
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  NetDeviceContainer devices;
+  std::set<std::pair<uint32_t, uint32_t> > links;
+  for (uint32_t i = 0; i < nNodes + 6; i++)
+    {
+      uint32_t a = i < nNodes ? i : rand->GetInteger (0, nNodes - 1);
+      uint32_t b = i < nNodes ? (i + 1) % nNodes : rand->GetInteger (0, nNodes - 1);
+      if (a == b || !links.insert (std::make_pair (std::min (a, b), std::max (a, b))).second)
+        {
+          continue;
+        }
+      NetDeviceContainer linkDevices = devHelper.Install (NodeContainer (nodes.Get (a), nodes.Get (b)));
+      ipv4.Assign (linkDevices);
+      ipv4.NewNetwork ();
+      devices.Add (linkDevices);
+    }
+
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      Ptr<NetDevice> device = devices.Get (i);
+      Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+      ipv4->SetMetric (ipv4->GetInterfaceForDevice (device), rand->GetInteger (1, 3));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  CheckRoutes (nodes, 0);
+
+  for (uint32_t round = 1; round <= 60; round++)
+    {
+      Ptr<NetDevice> device = devices.Get (rand->GetInteger (0, devices.GetN () - 1));
+      Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+      uint32_t interface = ipv4->GetInterfaceForDevice (device);
+      if (rand->GetInteger (0, 2) == 0)
+        {
+          ipv4->SetMetric (interface, rand->GetInteger (1, 3));
+        }
+      else if (ipv4->IsUp (interface))
+        {
+          ipv4->SetDown (interface);
+        }
+      else
+        {
+          ipv4->SetUp (interface);
+        }
+
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      CheckRoutes (nodes, round);
+    }
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting shortest path test: the host routes of a
+ * random point-to-point topology are checked, through interface and metric
+ * changes, against the equal cost next hops of a reference Dijkstra
+ * calculation over the nodes and devices.  A node left with a single link
+ * up is a stub, with a default route instead.
+ */
+class Ipv4GlobalRoutingShortestPathTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingShortestPathTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// A next hop: the gateway and the outgoing interface
+  typedef std::pair<Ipv4Address, uint32_t> NextHop;
+  /// The host and default routes of the nodes, by node and destination
+  typedef std::map<std::pair<uint32_t, Ipv4Address>, std::set<NextHop> > HostRoutes;
+
+  /**
+   * \brief Get the global host and default routes of the nodes.
+   * \param nodes The nodes.
+   * \returns the routes.
+   */
+  HostRoutes GetHostRoutes (NodeContainer nodes);
+
+  /**
+   * \brief Compute the host and default routes of the nodes with a
+   * reference Dijkstra calculation.
+   * \param nodes The nodes.
+   * \param devices The point-to-point devices, in pairs.
+   * \returns the routes.
+   */
+  HostRoutes ComputeHostRoutes (NodeContainer nodes, NetDeviceContainer devices);
+};
+
+Ipv4GlobalRoutingShortestPathTestCase::Ipv4GlobalRoutingShortestPathTestCase ()
+  : TestCase ("Check the global host routes against a reference shortest path calculation")
+{
+}
+
+Ipv4GlobalRoutingShortestPathTestCase::HostRoutes
+Ipv4GlobalRoutingShortestPathTestCase::GetHostRoutes (NodeContainer nodes)
+{
+  HostRoutes routes;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> globalRouting = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      for (uint32_t j = 0; j < globalRouting->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry *route = globalRouting->GetRoute (j);
+          if (route->IsHost () || route->IsDefault ())
+            {
+              routes[std::make_pair (i, route->GetDest ())].insert (NextHop (route->GetGateway (), route->GetInterface ()));
+            }
+        }
+    }
+  return routes;
+}
+
+Ipv4GlobalRoutingShortestPathTestCase::HostRoutes
+Ipv4GlobalRoutingShortestPathTestCase::ComputeHostRoutes (NodeContainer nodes, NetDeviceContainer devices)
+{
+  /// A link usable from a node: the peer node, the cost and the next hop
+  struct Edge
+  {
+    uint32_t peer;      //!< The node at the other end.
+    uint32_t cost;      //!< The metric of the outgoing interface.
+    NextHop nextHop;    //!< The peer address and the outgoing interface.
+  };
+  uint32_t nNodes = nodes.GetN ();
+  std::vector<std::vector<Edge> > edges (nNodes);
+  // The addresses of the interfaces on the links up at both ends
+  std::vector<std::vector<Ipv4Address> > addresses (nNodes);
+  for (uint32_t i = 0; i < devices.GetN (); i += 2)
+    {
+      Ptr<NetDevice> device[2] = { devices.Get (i), devices.Get (i + 1) };
+      Ptr<Ipv4> ipv4[2];
+      uint32_t interface[2];
+      bool up = true;
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          ipv4[k] = device[k]->GetNode ()->GetObject<Ipv4> ();
+          interface[k] = ipv4[k]->GetInterfaceForDevice (device[k]);
+          up = up && ipv4[k]->IsUp (interface[k]);
+        }
+      if (!up)
+        {
+          continue;
+        }
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          Edge edge;
+          edge.peer = device[1 - k]->GetNode ()->GetId ();
+          edge.cost = ipv4[k]->GetMetric (interface[k]);
+          edge.nextHop = NextHop (ipv4[1 - k]->GetAddress (interface[1 - k], 0).GetLocal (), interface[k]);
+          edges[device[k]->GetNode ()->GetId ()].push_back (edge);
+          addresses[device[k]->GetNode ()->GetId ()].push_back (ipv4[k]->GetAddress (interface[k], 0).GetLocal ());
+        }
+    }
+
+  HostRoutes routes;
+  const uint32_t infinity = std::numeric_limits<uint32_t>::max ();
+  for (uint32_t root = 0; root < nNodes; root++)
+    {
+      if (edges[root].size () == 1)
+        {
+          routes[std::make_pair (root, Ipv4Address::GetAny ())].insert (edges[root].front ().nextHop);
+          continue;
+        }
+      std::vector<uint32_t> distance (nNodes, infinity);
+      std::vector<std::set<NextHop> > nextHops (nNodes);
+      std::vector<bool> done (nNodes, false);
+      distance[root] = 0;
+      for (;;)
+        {
+          uint32_t v = nNodes;
+          for (uint32_t i = 0; i < nNodes; i++)
+            {
+              if (!done[i] && distance[i] != infinity && (v == nNodes || distance[i] < distance[v]))
+                {
+                  v = i;
+                }
+            }
+          if (v == nNodes)
+            {
+              break;
+            }
+          done[v] = true;
+          for (std::vector<Edge>::const_iterator e = edges[v].begin (); e != edges[v].end (); e++)
+            {
+              uint32_t d = distance[v] + e->cost;
+              if (d > distance[e->peer])
+                {
+                  continue;
+                }
+              if (d < distance[e->peer])
+                {
+                  distance[e->peer] = d;
+                  nextHops[e->peer].clear ();
+                }
+              if (v == root)
+                {
+                  nextHops[e->peer].insert (e->nextHop);
+                }
+              else
+                {
+                  nextHops[e->peer].insert (nextHops[v].begin (), nextHops[v].end ());
+                }
+            }
+        }
+      for (uint32_t i = 0; i < nNodes; i++)
+        {
+          if (i == root || distance[i] == infinity)
+            {
+              continue;
+            }
+          for (std::vector<Ipv4Address>::const_iterator a = addresses[i].begin (); a != addresses[i].end (); a++)
+            {
+              routes[std::make_pair (root, *a)] = nextHops[i];
+            }
+        }
+    }
+  return routes;
+}
+
+void
+Ipv4GlobalRoutingShortestPathTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (2);
+
+  // A ring of routers with chords, and metrics in a small range so that
+  // many destinations have equal cost paths.
+  const uint32_t nNodes = 16;
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  NetDeviceContainer devices;
+  std::set<std::pair<uint32_t, uint32_t> > links;
+  for (uint32_t i = 0; i < 2 * nNodes; i++)
+    {
+      uint32_t a = i < nNodes ? i : rand->GetInteger (0, nNodes - 1);
+      uint32_t b = i < nNodes ? (i + 1) % nNodes : rand->GetInteger (0, nNodes - 1);
+      if (a == b || !links.insert (std::make_pair (std::min (a, b), std::max (a, b))).second)
+        {
+          continue;
+        }
+      NetDeviceContainer linkDevices = devHelper.Install (NodeContainer (nodes.Get (a), nodes.Get (b)));
+      ipv4.Assign (linkDevices);
+      ipv4.NewNetwork ();
+      devices.Add (linkDevices);
+    }
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      Ptr<NetDevice> device = devices.Get (i);
+      Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+      ipv4->SetMetric (ipv4->GetInterfaceForDevice (device), rand->GetInteger (1, 3));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  for (uint32_t round = 0; round <= 20; round++)
+    {
+      if (round > 0)
+        {
+          Ptr<NetDevice> device = devices.Get (rand->GetInteger (0, devices.GetN () - 1));
+          Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+          uint32_t interface = ipv4->GetInterfaceForDevice (device);
+          if (rand->GetInteger (0, 2) == 0)
+            {
+              ipv4->SetMetric (interface, rand->GetInteger (1, 3));
+            }
+          else if (ipv4->IsUp (interface))
+            {
+              ipv4->SetDown (interface);
+            }
+          else
+            {
+              ipv4->SetUp (interface);
+            }
+          Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+        }
+
+      HostRoutes routes = GetHostRoutes (nodes);
+      HostRoutes expected = ComputeHostRoutes (nodes, devices);
+      NS_TEST_ASSERT_MSG_EQ (routes.size (), expected.size (), "Unexpected number of host routes in round " << round);
+      for (HostRoutes::const_iterator i = routes.begin (), j = expected.begin (); i != routes.end (); i++, j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((i->first == j->first), true, "Unexpected host route to " << i->first.second
+                                 << " on node " << i->first.first << " in round " << round);
+          NS_TEST_ASSERT_MSG_EQ ((i->second == j->second), true, "Unexpected next hops to " << i->first.second
+                                 << " on node " << i->first.first << " in round " << round);
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting flow ECMP test: on a diamond topology, the
+ * packets of a flow always take the same path, and the flows are spread
+ * over both paths.
+ *
+ *        n1
+ *       /  \
+ *     n0    n3 ---- n4
+ *       \  /
+ *        n2
+ */
+class Ipv4GlobalRoutingFlowEcmpTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingFlowEcmpTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Route a UDP packet of a flow out of a node.
+   * \param routing The routing protocol of the node.
+   * \param srcPort The source port of the flow.
+   * \param destPort The destination port of the flow.
+   * \returns the gateway of the route.
+   */
+  Ipv4Address RouteFlow (Ptr<Ipv4GlobalRouting> routing, uint16_t srcPort, uint16_t destPort);
+
+  /**
+   * \brief Forward a UDP packet of a flow received by a node.
+   * \param routing The routing protocol of the node.
+   * \param idev The device the packet is received on.
+   * \param srcPort The source port of the flow.
+   * \param destPort The destination port of the flow.
+   * \returns the gateway of the route.
+   */
+  Ipv4Address ForwardFlow (Ptr<Ipv4GlobalRouting> routing, Ptr<NetDevice> idev,
+                           uint16_t srcPort, uint16_t destPort);
+
+  /**
+   * \brief Record the gateway of a forwarded packet.
+   * \param route The route of the packet.
+   * \param p The packet.
+   * \param header The IPv4 header of the packet.
+   */
+  void Forwarded (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header);
+
+  Ipv4Address m_forwardGateway; //!< The gateway of the last forwarded packet.
+};
+
+Ipv4GlobalRoutingFlowEcmpTestCase::Ipv4GlobalRoutingFlowEcmpTestCase ()
+  : TestCase ("Check that flow ECMP routing keeps the flows on one path")
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingFlowEcmpTestCase::ForwardFlow (Ptr<Ipv4GlobalRouting> routing, Ptr<NetDevice> idev,
+                                                uint16_t srcPort, uint16_t destPort)
+{
+  // a received packet starts with its UDP header
+  Ptr<Packet> p = Create<Packet> (100);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (srcPort);
+  udpHeader.SetDestinationPort (destPort);
+  p->AddHeader (udpHeader);
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.1.1.2"));
+  header.SetDestination (Ipv4Address ("10.1.5.2"));
+  header.SetProtocol (17);
+  m_forwardGateway = Ipv4Address ();
+  routing->RouteInput (p, header, idev,
+                       MakeCallback (&Ipv4GlobalRoutingFlowEcmpTestCase::Forwarded, this),
+                       MakeNullCallback<void, Ptr<Ipv4MulticastRoute>, Ptr<const Packet>, const Ipv4Header &> (),
+                       MakeNullCallback<void, Ptr<const Packet>, const Ipv4Header &, uint32_t> (),
+                       MakeNullCallback<void, Ptr<const Packet>, const Ipv4Header &, Socket::SocketErrno> ());
+  NS_TEST_EXPECT_MSG_EQ (m_forwardGateway.IsInitialized (), true, "The packet was not forwarded");
+  return m_forwardGateway;
+}
+
+void
+Ipv4GlobalRoutingFlowEcmpTestCase::Forwarded (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  m_forwardGateway = route->GetGateway ();
+}
+
+Ipv4Address
+Ipv4GlobalRoutingFlowEcmpTestCase::RouteFlow (Ptr<Ipv4GlobalRouting> routing, uint16_t srcPort, uint16_t destPort)
+{
+  // as UdpSocketImpl, route the payload before adding the UDP header, with
+  // the ports of the flow
+  Ptr<Packet> p = Create<Packet> (100);
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.1.1.1"));
+  header.SetDestination (Ipv4Address ("10.1.5.2"));
+  header.SetProtocol (17);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = routing->RouteOutputWithPorts (p, header, srcPort, destPort, 0, sockerr);
+  NS_TEST_EXPECT_MSG_NE (route, 0, "No route to the destination");
+  return route == 0 ? Ipv4Address () : route->GetGateway ();
+}
+
+void
+Ipv4GlobalRoutingFlowEcmpTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+  // n0-n1, n0-n2, n1-n3, n2-n3, n3-n4
+  uint32_t links[5][2] = { { 0, 1 }, { 0, 2 }, { 1, 3 }, { 2, 3 }, { 3, 4 } };
+  std::vector<NetDeviceContainer> devices;
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer net = simpleHelper.Install (nodes.Get (links[i][0]), channel);
+      net.Add (simpleHelper.Install (nodes.Get (links[i][1]), channel));
+      devices.push_back (net);
+    }
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      std::ostringstream base;
+      base << "10.1." << i + 1 << ".0";
+      ipv4.SetBase (base.str ().c_str (), "255.255.255.252");
+      ipv4.Assign (devices[i]);
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<Ipv4GlobalRouting> routing0 = nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+  NS_TEST_ASSERT_MSG_NE (routing0, 0, "Error-- no Ipv4GlobalRouting object");
+
+  // Without ECMP routing, the first route is always used.
+  std::set<Ipv4Address> gateways;
+  for (uint16_t port = 1000; port < 1064; port++)
+    {
+      gateways.insert (RouteFlow (routing0, port, 9));
+    }
+  NS_TEST_ASSERT_MSG_EQ (gateways.size (), 1, "Only the first route must be used");
+
+  routing0->SetAttribute ("FlowEcmpRouting", BooleanValue (true));
+  gateways.clear ();
+  for (uint16_t port = 1000; port < 1064; port++)
+    {
+      Ipv4Address gateway = RouteFlow (routing0, port, 9);
+      gateways.insert (gateway);
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (RouteFlow (routing0, port, 9), gateway, "The packets of a flow must take the same path");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (gateways.size (), 2, "The flows must be spread over both paths");
+  NS_TEST_ASSERT_MSG_EQ ((gateways.count (Ipv4Address ("10.1.1.2")) == 1 && gateways.count (Ipv4Address ("10.1.2.2")) == 1),
+                         true, "Unexpected gateways");
+
+  // The ports of a forwarded packet are read from its UDP header.
+  gateways.clear ();
+  for (uint16_t port = 1000; port < 1064; port++)
+    {
+      Ipv4Address gateway = ForwardFlow (routing0, devices[0].Get (0), port, 9);
+      gateways.insert (gateway);
+      NS_TEST_ASSERT_MSG_EQ (ForwardFlow (routing0, devices[0].Get (0), port, 9), gateway,
+                             "The packets of a forwarded flow must take the same path");
+    }
+  NS_TEST_ASSERT_MSG_EQ (gateways.size (), 2, "The forwarded flows must be spread over both paths");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1866,10 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingIncrementalTestCase (1), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingIncrementalTestCase (4), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingShortestPathTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingFlowEcmpTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -265,6 +265,54 @@ Ipv4HeaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 Header checksum with the packet header cache Test
+ *
+ * A header whose checksum verification is enabled by the caller must not
+ * be taken from the header cache, where it was parsed without it.
+ */
+class Ipv4HeaderChecksumCacheTest : public TestCase
+{
+public:
+  virtual void DoRun (void);
+  Ipv4HeaderChecksumCacheTest ();
+};
+
+Ipv4HeaderChecksumCacheTest::Ipv4HeaderChecksumCacheTest ()
+  : TestCase ("IPv4 Header checksum with the header cache")
+{
+}
+
+void
+Ipv4HeaderChecksumCacheTest::DoRun (void)
+{
+  Packet::EnableHeaderCache ();
+
+  // the header is serialized without its checksum
+  Ptr<Packet> p = Create<Packet> (100);
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.0.0.1"));
+  header.SetDestination (Ipv4Address ("10.0.0.2"));
+  header.SetPayloadSize (100);
+  p->AddHeader (header);
+
+  Ipv4Header plain;
+  p->PeekHeader (plain);
+  NS_TEST_EXPECT_MSG_EQ (plain.IsChecksumOk (), true, "Checksum must not be verified");
+
+  Ipv4Header checked;
+  checked.EnableChecksum ();
+  p->PeekHeader (checked);
+  NS_TEST_EXPECT_MSG_EQ (checked.IsChecksumOk (), false, "Checksum must be verified");
+  p->RemoveHeader (checked);
+  NS_TEST_EXPECT_MSG_EQ (checked.IsChecksumOk (), false, "Checksum must be verified");
+
+  Packet::DisableHeaderCache ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -277,6 +325,7 @@ public:
   Ipv4HeaderTestSuite () : TestSuite ("ipv4-header", UNIT)
   {
     AddTestCase (new Ipv4HeaderTest, TestCase::QUICK);
+    AddTestCase (new Ipv4HeaderChecksumCacheTest, TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <list>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-route-trie.h"
+#include "ns3/ipv4-routing-table-entry.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4RouteTrie Test: the matches of the trie are checked against a
+ * linear scan of the routes, while routes are added and removed.
+ */
+class Ipv4RouteTrieTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieTestCase ();
+  virtual ~Ipv4RouteTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Check the matches of a destination against a linear scan.
+   * \param dest the destination
+   */
+  void CheckLookup (Ipv4Address dest);
+
+  Ipv4RouteTrie m_trie;                             //!< the trie under test
+  std::list<Ipv4RoutingTableEntry *> m_routes;      //!< the routes, in insertion order
+};
+
+Ipv4RouteTrieTestCase::Ipv4RouteTrieTestCase ()
+  : TestCase ("Check the Ipv4RouteTrie matches against a linear scan")
+{
+}
+
+Ipv4RouteTrieTestCase::~Ipv4RouteTrieTestCase ()
+{
+  for (std::list<Ipv4RoutingTableEntry *>::iterator i = m_routes.begin (); i != m_routes.end (); i++)
+    {
+      delete *i;
+    }
+}
+
+void
+Ipv4RouteTrieTestCase::CheckLookup (Ipv4Address dest)
+{
+  Ipv4RouteTrie::Match matches[Ipv4RouteTrie::MAX_MATCHES];
+  uint32_t n = m_trie.Lookup (dest, matches);
+
+  // the matching routes, longest prefix first, in insertion order
+  std::vector<Ipv4RoutingTableEntry *> expected;
+  for (int length = 32; length >= 0; length--)
+    {
+      for (std::list<Ipv4RoutingTableEntry *>::iterator i = m_routes.begin (); i != m_routes.end (); i++)
+        {
+          Ipv4Mask mask = (*i)->GetDestNetworkMask ();
+          if (mask.GetPrefixLength () == length && mask.IsMatch (dest, (*i)->GetDestNetwork ()))
+            {
+              expected.push_back (*i);
+            }
+        }
+    }
+
+  std::vector<Ipv4RoutingTableEntry *> found;
+  int previous = 33;
+  for (uint32_t j = 0; j < n; j++)
+    {
+      NS_TEST_ASSERT_MSG_LT (matches[j].length, previous, "Matches must be sorted by decreasing length");
+      previous = matches[j].length;
+      uint64_t order = 0;
+      for (Ipv4RouteTrie::Routes::const_iterator i = matches[j].routes->begin (); i != matches[j].routes->end (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (i->entry->GetDestNetworkMask ().GetPrefixLength (), matches[j].length, "Unexpected prefix length");
+          NS_TEST_ASSERT_MSG_EQ ((i == matches[j].routes->begin () || i->order > order), true, "Routes must be in insertion order");
+          order = i->order;
+          found.push_back (i->entry);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (found.size (), expected.size (), "Unexpected number of routes for " << dest);
+  for (uint32_t j = 0; j < found.size (); j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (found[j], expected[j], "Unexpected route for " << dest);
+    }
+}
+
+void
+Ipv4RouteTrieTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+
+  // Prefixes are drawn in a small part of the address space so that they
+  // nest and share their nodes.
+  for (uint32_t round = 0; round < 1000; round++)
+    {
+      if (m_routes.size () > 0 && rand->GetInteger (0, 2) == 0)
+        {
+          std::list<Ipv4RoutingTableEntry *>::iterator i = m_routes.begin ();
+          std::advance (i, rand->GetInteger (0, m_routes.size () - 1));
+          m_trie.Remove (*i);
+          delete *i;
+          m_routes.erase (i);
+        }
+      else
+        {
+          uint32_t length = rand->GetInteger (0, 32);
+          Ipv4Mask mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+          Ipv4Address network (0x0a000000 | rand->GetInteger (0, 0xfff) << 12 | rand->GetInteger (0, 0xfff));
+          Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+          *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network, mask, round % 4);
+          m_routes.push_back (route);
+          m_trie.Insert (route, round % 3);
+        }
+      Ipv4Address dest (0x0a000000 | rand->GetInteger (0, 0xfff) << 12 | rand->GetInteger (0, 0xfff));
+      CheckLookup (dest);
+      CheckLookup (m_routes.empty () ? dest : m_routes.back ()->GetDestNetwork ());
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (m_trie.IsComplete (), true, "Contiguous masks must be indexed");
+  Ipv4RoutingTableEntry nonContiguous = Ipv4RoutingTableEntry::CreateNetworkRouteTo ("10.0.0.0", "255.0.255.0", 1);
+  m_trie.Insert (&nonContiguous);
+  NS_TEST_ASSERT_MSG_EQ (m_trie.IsComplete (), false, "Non-contiguous masks cannot be indexed");
+  m_trie.Remove (&nonContiguous);
+  NS_TEST_ASSERT_MSG_EQ (m_trie.IsComplete (), true, "Contiguous masks must be indexed");
+
+  for (std::list<Ipv4RoutingTableEntry *>::iterator i = m_routes.begin (); i != m_routes.end (); i = m_routes.erase (i))
+    {
+      m_trie.Remove (*i);
+      delete *i;
+    }
+  Ipv4RouteTrie::Match matches[Ipv4RouteTrie::MAX_MATCHES];
+  NS_TEST_ASSERT_MSG_EQ (m_trie.Lookup ("10.0.0.1", matches), 0, "Trie must be empty");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4RouteTrie TestSuite
+ */
+class Ipv4RouteTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteTrieTestSuite ();
+};
+
+Ipv4RouteTrieTestSuite::Ipv4RouteTrieTestSuite ()
+  : TestSuite ("ipv4-route-trie", UNIT)
+{
+  AddTestCase (new Ipv4RouteTrieTestCase, TestCase::QUICK);
+}
+
+static Ipv4RouteTrieTestSuite ipv4RouteTrieTestSuite; //!< Static variable for test initialization
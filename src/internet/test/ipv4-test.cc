@@ -29,6 +29,7 @@
 #include "ns3/arp-l3-protocol.h"
 #include "ns3/ipv4-interface.h"
 #include "ns3/loopback-net-device.h"
+#include "ns3/icmpv4-l4-protocol.h"
 
 using namespace ns3;
 
@@ -45,6 +46,26 @@ public:
   virtual ~Ipv4L3ProtocolTestCase ();
   virtual void  DoRun (void);
 
+private:
+  /**
+   * \brief Check the dispatch of the packets to the L4 protocols.
+   * \param ipv4 the IPv4 stack
+   */
+  void CheckProtocolDispatch (Ptr<Ipv4L3Protocol> ipv4);
+
+  /**
+   * \brief Build the headers of packets to many destinations.
+   * \param ipv4 the IPv4 stack
+   * \param first the first destination
+   * \param n the number of destinations
+   */
+  void BuildHeaders (Ptr<Ipv4L3Protocol> ipv4, uint32_t first, uint32_t n);
+
+  /**
+   * \brief Check that the identification states are purged once unused.
+   * \param ipv4 the IPv4 stack
+   */
+  void CheckIdentificationPurged (Ptr<Ipv4L3Protocol> ipv4);
 };
 
 Ipv4L3ProtocolTestCase::Ipv4L3ProtocolTestCase () :
@@ -55,6 +76,49 @@ Ipv4L3ProtocolTestCase::Ipv4L3ProtocolTestCase () :
 Ipv4L3ProtocolTestCase::~Ipv4L3ProtocolTestCase ()
 {
 }
+
+void
+Ipv4L3ProtocolTestCase::CheckProtocolDispatch (Ptr<Ipv4L3Protocol> ipv4)
+{
+  Ptr<IpL4Protocol> generic = CreateObject<Icmpv4L4Protocol> ();
+  Ptr<IpL4Protocol> bound = CreateObject<Icmpv4L4Protocol> ();
+  int protocolNumber = Icmpv4L4Protocol::PROT_NUMBER;
+
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetProtocol (protocolNumber), 0, "Protocol found before insertion");
+  ipv4->Insert (generic);
+  ipv4->Insert (bound, 3);
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetProtocol (protocolNumber), generic, "Generic protocol not found");
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetProtocol (protocolNumber, 3), bound, "Protocol of interface 3 not found");
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetProtocol (protocolNumber, 2), generic, "Generic protocol not used on interface 2");
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetProtocol (17), 0, "Protocol 17 found");
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetProtocol (255, 3), 0, "Protocol 255 found");
+
+  ipv4->Remove (bound, 3);
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetProtocol (protocolNumber, 3), generic, "Generic protocol not used on interface 3");
+  ipv4->Remove (generic);
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetProtocol (protocolNumber), 0, "Protocol found after removal");
+}
+
+void
+Ipv4L3ProtocolTestCase::BuildHeaders (Ptr<Ipv4L3Protocol> ipv4, uint32_t first, uint32_t n)
+{
+  for (uint32_t i = first; i < first + n; i++)
+    {
+      Ipv4Header header = ipv4->BuildHeader (Ipv4Address ("10.0.0.1"), Ipv4Address (0x0b000000 + i),
+                                             17, 100, 64, 0, true);
+      NS_TEST_EXPECT_MSG_EQ (header.GetIdentification (), 0, "Wrong identification of a new destination");
+    }
+}
+
+void
+Ipv4L3ProtocolTestCase::CheckIdentificationPurged (Ptr<Ipv4L3Protocol> ipv4)
+{
+  // The destinations of the first batch have expired when the second batch
+  // fills the table
+  BuildHeaders (ipv4, 1000, 1000);
+  NS_TEST_EXPECT_MSG_LT (ipv4->m_identification.size (), 1500, "Unused identification states not purged");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (ipv4->m_identification.size (), 1000, "Used identification states purged");
+}
 void
 Ipv4L3ProtocolTestCase::DoRun (void)
 {
@@ -131,6 +195,27 @@ Ipv4L3ProtocolTestCase::DoRun (void)
   num = interface->GetNAddresses ();
   NS_TEST_ASSERT_MSG_EQ (num, 1, "Should find 1 addresses??");
 
+  CheckProtocolDispatch (ipv4);
+
+  /* Test the identification of the packets */
+  Ipv4Header header = ipv4->BuildHeader (Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.0.2"),
+                                         17, 100, 64, 0, true);
+  NS_TEST_ASSERT_MSG_EQ (header.GetIdentification (), 0, "Wrong first identification");
+  header = ipv4->BuildHeader (Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.0.2"),
+                              17, 100, 64, 0, true);
+  NS_TEST_ASSERT_MSG_EQ (header.GetIdentification (), 1, "Wrong second identification");
+  ipv4->DecreaseIdentification (Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.0.2"), 17);
+  header = ipv4->BuildHeader (Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.0.2"),
+                              17, 100, 64, 0, true);
+  NS_TEST_ASSERT_MSG_EQ (header.GetIdentification (), 1, "Identification not decreased");
+  header = ipv4->BuildHeader (Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.0.2"),
+                              6, 100, 64, 0, true);
+  NS_TEST_ASSERT_MSG_EQ (header.GetIdentification (), 0, "Identification shared by two protocols");
+
+  BuildHeaders (ipv4, 0, 1000);
+  Simulator::Schedule (Seconds (60), &Ipv4L3ProtocolTestCase::CheckIdentificationPurged, this, ipv4);
+  Simulator::Run ();
+
   Simulator::Destroy ();
 }
 
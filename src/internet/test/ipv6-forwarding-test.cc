@@ -27,6 +27,7 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 
 #include "ns3/log.h"
 #include "ns3/node.h"
@@ -205,6 +206,27 @@ Ipv6ForwardingTest::DoRun (void)
 
   m_receivedPacket->RemoveAllByteTags ();
 
+  // Route cache test: the routes are cached by the first packet
+  ipv6->SetAttribute ("RouteCacheSize", UintegerValue (16));
+  ipv6->SetAttribute ("SendIcmpv6Redirect", BooleanValue (false));
+  txNode->GetObject<Ipv6> ()->SetAttribute ("RouteCacheSize", UintegerValue (16));
+  SendData (txSocket, "2001:1::2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv6 Forwarding with route cache");
+  SendData (txSocket, "2001:1::2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv6 Forwarding with a cached route");
+
+  // A route added, or an interface set down, must flush the cache
+  Ptr<Ipv6StaticRouting> fwStaticRouting = Ipv6RoutingHelper::GetRouting <Ipv6StaticRouting> (ipv6->GetRoutingProtocol ());
+  fwStaticRouting->AddHostRouteTo (Ipv6Address ("2001:1::2"), Ipv6Address ("2001:2::2"), ipv6->GetInterfaceForDevice (net2.Get (0)));
+  SendData (txSocket, "2001:1::2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 0, "IPv6 Forwarding after a route change");
+  fwStaticRouting->RemoveRoute (fwStaticRouting->GetNRoutes () - 1);
+  SendData (txSocket, "2001:1::2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv6 Forwarding after a route removal");
+  ipv6->SetDown (ipv6->GetInterfaceForDevice (net1.Get (1)));
+  SendData (txSocket, "2001:1::2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 0, "IPv6 Forwarding after an interface down");
+
   Simulator::Destroy ();
 
 }
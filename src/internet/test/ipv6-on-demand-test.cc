@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/pointer.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/icmpv6-l4-protocol.h"
+#include "ns3/ipv6-extension-demux.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ipv6OnDemandTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the installation of the IPv6 stack on demand: the stack is
+ * installed on the nodes whose interfaces are configured by
+ * Ipv6AddressHelper, with the configuration of the InternetStackHelper,
+ * and carries packets.
+ */
+class Ipv6OnDemandTestCase : public TestCase
+{
+public:
+  Ipv6OnDemandTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Receive the packets of a socket
+   * \param socket the socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  /**
+   * \brief Send a packet
+   * \param socket the socket
+   */
+  void Send (Ptr<Socket> socket);
+
+  uint32_t m_received; //!< bytes received
+};
+
+Ipv6OnDemandTestCase::Ipv6OnDemandTestCase ()
+  : TestCase ("Check the installation of the IPv6 stack on demand"),
+    m_received (0)
+{
+}
+
+void
+Ipv6OnDemandTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()) != nullptr)
+    {
+      m_received += p->GetSize ();
+    }
+}
+
+void
+Ipv6OnDemandTestCase::Send (Ptr<Socket> socket)
+{
+  socket->Send (Create<Packet> (100));
+}
+
+void
+Ipv6OnDemandTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  NodeContainer pair (nodes.Get (0), nodes.Get (1));
+  SimpleNetDeviceHelper simpleHelper;
+  NetDeviceContainer devices = simpleHelper.Install (pair);
+  NetDeviceContainer isolated = simpleHelper.Install (nodes.Get (2));
+
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstallOnDemand (true);
+  internet.SetIpv6NsRsJitter (false);
+  internet.Install (nodes);
+  // A configuration change after Install does not apply to the nodes
+  internet.SetIpv6NsRsJitter (true);
+
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_ASSERT_MSG_NE (nodes.Get (i)->GetObject<Ipv4> (), 0, "IPv4 stack not installed");
+      NS_TEST_ASSERT_MSG_EQ (nodes.Get (i)->GetObject<Ipv6> (), 0, "IPv6 stack installed");
+    }
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (devices);
+  ipv4.Assign (isolated);
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  Ipv6InterfaceContainer interfaces = ipv6.Assign (devices);
+
+  for (uint32_t i = 0; i < pair.GetN (); i++)
+    {
+      Ptr<Node> node = pair.Get (i);
+      NS_TEST_ASSERT_MSG_NE (node->GetObject<Ipv6> (), 0, "IPv6 stack not installed on demand");
+      NS_TEST_ASSERT_MSG_NE (node->GetObject<Ipv6ExtensionDemux> (), 0, "IPv6 extensions not registered");
+      PointerValue jitter;
+      node->GetObject<Icmpv6L4Protocol> ()->GetAttribute ("SolicitationJitter", jitter);
+      NS_TEST_ASSERT_MSG_NE (jitter.Get<ConstantRandomVariable> (), 0,
+                             "IPv6 stack not installed with the configuration of the helper");
+    }
+  NS_TEST_ASSERT_MSG_EQ (nodes.Get (2)->GetObject<Ipv6> (), 0, "IPv6 stack installed on an unused node");
+  // The stack is installed only once
+  InternetStackHelper::InstallIpv6OnDemand (nodes.Get (0));
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 1234));
+  sink->SetRecvCallback (MakeCallback (&Ipv6OnDemandTestCase::Receive, this));
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  source->Connect (Inet6SocketAddress (interfaces.GetAddress (1, 1), 1234));
+  // Send after the Duplicate Address Detection
+  Simulator::Schedule (Seconds (2), &Ipv6OnDemandTestCase::Send, this, source);
+
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, 100, "Packet not received over the IPv6 stack installed on demand");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for the installation of the IPv6 stack on demand
+ */
+class Ipv6OnDemandTestSuite : public TestSuite
+{
+public:
+  Ipv6OnDemandTestSuite ()
+    : TestSuite ("ipv6-on-demand", UNIT)
+  {
+    AddTestCase (new Ipv6OnDemandTestCase, TestCase::QUICK);
+  }
+};
+
+static Ipv6OnDemandTestSuite g_ipv6OnDemandTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <list>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv6-route-trie.h"
+#include "ns3/ipv6-routing-table-entry.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6RouteTrie Test: the matches of the trie are checked against a
+ * linear scan of the routes, while routes are added and removed.
+ */
+class Ipv6RouteTrieTestCase : public TestCase
+{
+public:
+  Ipv6RouteTrieTestCase ();
+  virtual ~Ipv6RouteTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Draw an address in a small part of the address space, so that
+   * the prefixes nest and share their nodes.
+   * \returns the address
+   */
+  Ipv6Address GetRandomAddress (void);
+
+  /**
+   * \brief Check the matches of a destination against a linear scan.
+   * \param dest the destination
+   */
+  void CheckLookup (Ipv6Address dest);
+
+  Ptr<UniformRandomVariable> m_rand;               //!< the random addresses
+  Ipv6RouteTrie m_trie;                             //!< the trie under test
+  std::list<Ipv6RoutingTableEntry *> m_routes;      //!< the routes, in insertion order
+};
+
+Ipv6RouteTrieTestCase::Ipv6RouteTrieTestCase ()
+  : TestCase ("Check the Ipv6RouteTrie matches against a linear scan")
+{
+}
+
+Ipv6RouteTrieTestCase::~Ipv6RouteTrieTestCase ()
+{
+  for (std::list<Ipv6RoutingTableEntry *>::iterator i = m_routes.begin (); i != m_routes.end (); i++)
+    {
+      delete *i;
+    }
+}
+
+Ipv6Address
+Ipv6RouteTrieTestCase::GetRandomAddress (void)
+{
+  uint8_t address[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+  for (uint32_t i = 4; i < 16; i++)
+    {
+      address[i] = m_rand->GetInteger (0, 3) << 6;
+    }
+  return Ipv6Address (address);
+}
+
+void
+Ipv6RouteTrieTestCase::CheckLookup (Ipv6Address dest)
+{
+  Ipv6RouteTrie::Match matches[Ipv6RouteTrie::MAX_MATCHES];
+  uint32_t n = m_trie.Lookup (dest, matches);
+
+  // the matching routes, longest prefix first, in insertion order
+  std::vector<Ipv6RoutingTableEntry *> expected;
+  for (int length = 128; length >= 0; length--)
+    {
+      for (std::list<Ipv6RoutingTableEntry *>::iterator i = m_routes.begin (); i != m_routes.end (); i++)
+        {
+          Ipv6Prefix mask = (*i)->GetDestNetworkPrefix ();
+          if (mask.GetPrefixLength () == length && mask.IsMatch (dest, (*i)->GetDestNetwork ()))
+            {
+              expected.push_back (*i);
+            }
+        }
+    }
+
+  std::vector<Ipv6RoutingTableEntry *> found;
+  int previous = 129;
+  for (uint32_t j = 0; j < n; j++)
+    {
+      NS_TEST_ASSERT_MSG_LT (matches[j].length, previous, "Matches must be sorted by decreasing length");
+      previous = matches[j].length;
+      uint64_t order = 0;
+      for (Ipv6RouteTrie::Routes::const_iterator i = matches[j].routes->begin (); i != matches[j].routes->end (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (i->entry->GetDestNetworkPrefix ().GetPrefixLength (), matches[j].length, "Unexpected prefix length");
+          NS_TEST_ASSERT_MSG_EQ ((i == matches[j].routes->begin () || i->order > order), true, "Routes must be in insertion order");
+          order = i->order;
+          found.push_back (i->entry);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (found.size (), expected.size (), "Unexpected number of routes for " << dest);
+  for (uint32_t j = 0; j < found.size (); j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (found[j], expected[j], "Unexpected route for " << dest);
+    }
+}
+
+void
+Ipv6RouteTrieTestCase::DoRun (void)
+{
+  m_rand = CreateObject<UniformRandomVariable> ();
+  m_rand->SetStream (1);
+
+  for (uint32_t round = 0; round < 1000; round++)
+    {
+      if (m_routes.size () > 0 && m_rand->GetInteger (0, 2) == 0)
+        {
+          std::list<Ipv6RoutingTableEntry *>::iterator i = m_routes.begin ();
+          std::advance (i, m_rand->GetInteger (0, m_routes.size () - 1));
+          m_trie.Remove (*i);
+          delete *i;
+          m_routes.erase (i);
+        }
+      else
+        {
+          Ipv6Prefix mask (m_rand->GetInteger (0, 128));
+          Ipv6Address network = GetRandomAddress ().CombinePrefix (mask);
+          Ipv6RoutingTableEntry *route = new Ipv6RoutingTableEntry ();
+          *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, mask, round % 4);
+          m_routes.push_back (route);
+          m_trie.Insert (route, round % 3);
+        }
+      Ipv6Address dest = GetRandomAddress ();
+      CheckLookup (dest);
+      CheckLookup (m_routes.empty () ? dest : m_routes.back ()->GetDestNetwork ());
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (m_trie.IsComplete (), true, "Contiguous masks must be indexed");
+  Ipv6RoutingTableEntry nonContiguous = Ipv6RoutingTableEntry::CreateNetworkRouteTo ("2001:db8::", "ffff:0:ffff::", 1);
+  m_trie.Insert (&nonContiguous);
+  NS_TEST_ASSERT_MSG_EQ (m_trie.IsComplete (), false, "Non-contiguous masks cannot be indexed");
+  m_trie.Remove (&nonContiguous);
+  NS_TEST_ASSERT_MSG_EQ (m_trie.IsComplete (), true, "Contiguous masks must be indexed");
+  Ipv6RoutingTableEntry inconsistent = Ipv6RoutingTableEntry::CreateNetworkRouteTo ("2001:db8::", Ipv6Prefix ("ffff::", 32), 1);
+  m_trie.Insert (&inconsistent);
+  NS_TEST_ASSERT_MSG_EQ (m_trie.IsComplete (), false, "Masks shorter than their prefix length cannot be indexed");
+  m_trie.Remove (&inconsistent);
+  NS_TEST_ASSERT_MSG_EQ (m_trie.IsComplete (), true, "Contiguous masks must be indexed");
+
+  for (std::list<Ipv6RoutingTableEntry *>::iterator i = m_routes.begin (); i != m_routes.end (); i = m_routes.erase (i))
+    {
+      m_trie.Remove (*i);
+      delete *i;
+    }
+  Ipv6RouteTrie::Match matches[Ipv6RouteTrie::MAX_MATCHES];
+  NS_TEST_ASSERT_MSG_EQ (m_trie.Lookup ("2001:db8::1", matches), 0, "Trie must be empty");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6RouteTrie TestSuite
+ */
+class Ipv6RouteTrieTestSuite : public TestSuite
+{
+public:
+  Ipv6RouteTrieTestSuite ();
+};
+
+Ipv6RouteTrieTestSuite::Ipv6RouteTrieTestSuite ()
+  : TestSuite ("ipv6-route-trie", UNIT)
+{
+  AddTestCase (new Ipv6RouteTrieTestCase, TestCase::QUICK);
+}
+
+static Ipv6RouteTrieTestSuite ipv6RouteTrieTestSuite; //!< Static variable for test initialization
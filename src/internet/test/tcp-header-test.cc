@@ -23,6 +23,7 @@
 #include "ns3/core-module.h"
 #include "ns3/tcp-header.h"
 #include "ns3/buffer.h"
+#include "ns3/packet.h"
 #include "ns3/tcp-option-rfc793.h"
 
 using namespace ns3;
@@ -420,6 +421,69 @@ TcpHeaderFlagsToString::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (str, target, "str " << str <<  " does not equal target " << target);
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP header checksum with the packet header cache test.
+ *
+ * A header whose checksum verification is enabled by the caller must not
+ * be taken from the header cache, where it was parsed without it.
+ */
+class TcpHeaderChecksumCacheTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param name Test description.
+   */
+  TcpHeaderChecksumCacheTestCase (std::string name);
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpHeaderChecksumCacheTestCase::TcpHeaderChecksumCacheTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+TcpHeaderChecksumCacheTestCase::DoRun (void)
+{
+  Ipv4Address source ("10.0.0.1");
+  Ipv4Address destination ("10.0.0.2");
+  Packet::EnableHeaderCache ();
+
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader header;
+  header.SetSourcePort (49153);
+  header.SetDestinationPort (80);
+  header.SetSequenceNumber (SequenceNumber32 (1000));
+  header.EnableChecksums ();
+  header.InitializeChecksum (source, destination, 6);
+  p->AddHeader (header);
+
+  TcpHeader plain;
+  p->PeekHeader (plain);
+  NS_TEST_ASSERT_MSG_EQ (plain.GetSourcePort (), 49153, "Unexpected source port");
+
+  TcpHeader checked;
+  checked.EnableChecksums ();
+  checked.InitializeChecksum (source, destination, 6);
+  p->PeekHeader (checked);
+  NS_TEST_ASSERT_MSG_EQ (checked.IsChecksumOk (), true, "Checksum must be verified");
+
+  TcpHeader wrong;
+  wrong.EnableChecksums ();
+  wrong.InitializeChecksum (source, Ipv4Address ("10.0.0.3"), 6);
+  p->PeekHeader (wrong);
+  NS_TEST_ASSERT_MSG_EQ (wrong.IsChecksumOk (), false, "Checksum must be verified");
+  p->RemoveHeader (wrong);
+  NS_TEST_ASSERT_MSG_EQ (wrong.IsChecksumOk (), false, "Checksum must be verified");
+
+  Packet::DisableHeaderCache ();
+}
 
 /**
  * \ingroup internet-test
@@ -436,6 +500,7 @@ public:
     AddTestCase (new TcpHeaderGetSetTestCase ("GetSet test cases"), TestCase::QUICK);
     AddTestCase (new TcpHeaderWithRFC793OptionTestCase ("Test for options in RFC 793"), TestCase::QUICK);
     AddTestCase (new TcpHeaderFlagsToString ("Test flags to string function"), TestCase::QUICK);
+    AddTestCase (new TcpHeaderChecksumCacheTestCase ("Test checksum with the header cache"), TestCase::QUICK);
   }
 
 };
@@ -21,6 +21,8 @@
 
 #include "ns3/tcp-rx-buffer.h"
 
+#include <vector>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("TcpRxBufferTestSuite");
@@ -44,6 +46,11 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+
+  /**
+   * \brief Test the reassembly of reordered and overlapping segments.
+   */
+  void TestReordering ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +62,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestReordering ();
 }
 
 void
@@ -338,6 +346,74 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestReordering ()
+{
+  const uint32_t segmentSize = 100;
+  const uint32_t segments = 20;
+  const uint32_t dataSize = segmentSize * segments;
+  std::vector<uint8_t> data (dataSize);
+  for (uint32_t i = 0; i < dataSize; ++i)
+    {
+      data[i] = static_cast<uint8_t> (i % 251);
+    }
+
+  TcpRxBuffer rxBuf;
+  rxBuf.SetMaxBufferSize (dataSize);
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  TcpHeader h;
+
+  // Receive the odd segments in reverse order, then segments overlapping
+  // two of them, some of them twice, and finally the even segments.
+  std::vector<std::pair<uint32_t, uint32_t> > chunks;
+  for (int32_t i = segments - 1; i > 0; i -= 2)
+    {
+      chunks.push_back (std::make_pair (i * segmentSize, segmentSize));
+    }
+  for (uint32_t i = 1; i + 1 < segments; i += 4)
+    {
+      chunks.push_back (std::make_pair (i * segmentSize + 50, 2 * segmentSize));
+      chunks.push_back (std::make_pair (i * segmentSize + 50, 2 * segmentSize));
+    }
+  for (uint32_t i = 0; i < segments; i += 2)
+    {
+      chunks.push_back (std::make_pair (i * segmentSize, segmentSize));
+    }
+
+  for (auto chunk : chunks)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (1 + chunk.first));
+      rxBuf.Add (Create<Packet> (&data[chunk.first], chunk.second), h);
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (rxBuf.Size (), dataSize,
+                                   "Overlapping bytes stored twice");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1 + dataSize),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), dataSize,
+                         "Buffer size differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), dataSize,
+                         "Available bytes differ from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0,
+                         "SACK list should contain no element");
+
+  // Extract the data in chunks which do not match the segments
+  std::vector<uint8_t> received;
+  Ptr<Packet> p;
+  while ((p = rxBuf.Extract (150)) != nullptr)
+    {
+      uint32_t offset = received.size ();
+      received.resize (offset + p->GetSize ());
+      p->CopyData (&received[offset], p->GetSize ());
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Buffer should be empty");
+  NS_TEST_ASSERT_MSG_EQ (received.size (), dataSize,
+                         "Extracted size differs from expected");
+  NS_TEST_ASSERT_MSG_EQ ((received == data), true,
+                         "Extracted data differ from the data sent");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
@@ -0,0 +1,312 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/data-rate.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-highspeed.h"
+#include "ns3/tcp-recovery-ops.h"
+#include "ns3/tcp-prr-recovery.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpSocketFootprintTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check which congestion control and recovery algorithms are shared
+ * by the sockets.
+ */
+class TcpStatelessOpsTestCase : public TestCase
+{
+public:
+  TcpStatelessOpsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpStatelessOpsTestCase::TcpStatelessOpsTestCase ()
+  : TestCase ("Check the stateless TCP algorithms")
+{
+}
+
+void
+TcpStatelessOpsTestCase::DoRun (void)
+{
+  Ptr<TcpCongestionOps> newReno = CreateObject<TcpNewReno> ();
+  NS_TEST_ASSERT_MSG_EQ (newReno->IsStateless (), true, "TcpNewReno keeps a state");
+  NS_TEST_ASSERT_MSG_EQ (newReno->Fork ()->IsStateless (), true, "Forked TcpNewReno keeps a state");
+  // The subclasses of a stateless algorithm are not stateless
+  Ptr<TcpCongestionOps> highSpeed = CreateObject<TcpHighSpeed> ();
+  NS_TEST_ASSERT_MSG_EQ (highSpeed->IsStateless (), false, "TcpHighSpeed is stateless");
+
+  Ptr<TcpRecoveryOps> classic = CreateObject<TcpClassicRecovery> ();
+  NS_TEST_ASSERT_MSG_EQ (classic->IsStateless (), true, "TcpClassicRecovery keeps a state");
+  Ptr<TcpRecoveryOps> prr = CreateObject<TcpPrrRecovery> ();
+  NS_TEST_ASSERT_MSG_EQ (prr->IsStateless (), false, "TcpPrrRecovery is stateless");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the trace sources of TcpSocketBase chained to its
+ * TcpSocketState fire once connected, and that connecting them does not
+ * change a transfer.
+ */
+class TcpLazyTraceTestCase : public TestCase
+{
+public:
+  TcpLazyTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run a bulk transfer
+   * \param traced whether the trace sources of the sockets are connected
+   * \return the time of the last byte received
+   */
+  Time RunTransfer (bool traced);
+
+  /**
+   * \brief Fill the Tx buffer of the sender
+   * \param socket the sender socket
+   * \param available the space in the Tx buffer
+   */
+  void SendData (Ptr<Socket> socket, uint32_t available);
+
+  /**
+   * \brief Accept the connection of the sender
+   * \param socket the socket of the connection
+   * \param from the address of the sender
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+
+  /**
+   * \brief Read the data received
+   * \param socket the receiver socket
+   */
+  void ReceiveData (Ptr<Socket> socket);
+
+  /**
+   * \brief Trace the congestion window of the sender
+   * \param oldValue the previous value
+   * \param newValue the new value
+   */
+  void CwndTrace (uint32_t oldValue, uint32_t newValue);
+
+  /**
+   * \brief Trace the RTT of the sender
+   * \param oldValue the previous value
+   * \param newValue the new value
+   */
+  void RttTrace (Time oldValue, Time newValue);
+
+  /**
+   * \brief Trace the next sequence number sent by the receiver
+   * \param oldValue the previous value
+   * \param newValue the new value
+   */
+  void AcceptedTxTrace (SequenceNumber32 oldValue, SequenceNumber32 newValue);
+
+  uint32_t m_totalBytes;    //!< bytes to transfer
+  uint32_t m_sent;          //!< bytes given to the sender socket
+  uint32_t m_received;      //!< bytes received
+  Time m_lastReceived;      //!< time of the last byte received
+  bool m_traced;            //!< whether the trace sources are connected
+  uint32_t m_cwndChanges;   //!< changes of the congestion window of the sender
+  uint32_t m_maxCwnd;       //!< largest congestion window of the sender
+  uint32_t m_rttSamples;    //!< RTT samples of the sender
+  uint32_t m_acceptedTxChanges; //!< changes of the next sequence number of the receiver
+};
+
+TcpLazyTraceTestCase::TcpLazyTraceTestCase ()
+  : TestCase ("Check the trace sources chained to the TcpSocketState"),
+    m_totalBytes (200000),
+    m_sent (0),
+    m_received (0),
+    m_traced (false),
+    m_cwndChanges (0),
+    m_maxCwnd (0),
+    m_rttSamples (0),
+    m_acceptedTxChanges (0)
+{
+}
+
+void
+TcpLazyTraceTestCase::SendData (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_sent < m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (m_totalBytes - m_sent, socket->GetTxAvailable ());
+      int sent = socket->Send (Create<Packet> (size));
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sent += sent;
+    }
+  if (m_sent == m_totalBytes)
+    {
+      socket->Close ();
+    }
+}
+
+void
+TcpLazyTraceTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpLazyTraceTestCase::ReceiveData, this));
+  if (m_traced)
+    {
+      // The accepted socket, forked from the listening one, chains its own
+      // TcpSocketState
+      socket->TraceConnectWithoutContext ("NextTxSequence",
+                                          MakeCallback (&TcpLazyTraceTestCase::AcceptedTxTrace, this));
+    }
+}
+
+void
+TcpLazyTraceTestCase::ReceiveData (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()) != nullptr)
+    {
+      if (p->GetSize () > 0)
+        {
+          m_received += p->GetSize ();
+          m_lastReceived = Simulator::Now ();
+        }
+    }
+  if (m_received == m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      // Answer, then close
+      socket->Send (Create<Packet> (1000));
+      socket->Close ();
+    }
+}
+
+void
+TcpLazyTraceTestCase::CwndTrace (uint32_t oldValue, uint32_t newValue)
+{
+  m_cwndChanges++;
+  m_maxCwnd = std::max (m_maxCwnd, newValue);
+}
+
+void
+TcpLazyTraceTestCase::RttTrace (Time oldValue, Time newValue)
+{
+  NS_TEST_ASSERT_MSG_GT (newValue, Time (0), "Null RTT sample");
+  m_rttSamples++;
+}
+
+void
+TcpLazyTraceTestCase::AcceptedTxTrace (SequenceNumber32 oldValue, SequenceNumber32 newValue)
+{
+  m_acceptedTxChanges++;
+}
+
+Time
+TcpLazyTraceTestCase::RunTransfer (bool traced)
+{
+  m_sent = 0;
+  m_received = 0;
+  m_lastReceived = Time (0);
+  m_traced = traced;
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  simpleHelper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  // Both transfers draw the same random values
+  internet.AssignStreams (nodes, 0);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  sink->Listen ();
+  sink->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                           MakeCallback (&TcpLazyTraceTestCase::Accept, this));
+
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  source->SetSendCallback (MakeCallback (&TcpLazyTraceTestCase::SendData, this));
+  if (traced)
+    {
+      bool ok = source->TraceConnectWithoutContext ("CongestionWindow",
+                                                    MakeCallback (&TcpLazyTraceTestCase::CwndTrace, this));
+      NS_TEST_EXPECT_MSG_EQ (ok, true, "CongestionWindow not connected");
+      ok = source->TraceConnectWithoutContext ("RTT", MakeCallback (&TcpLazyTraceTestCase::RttTrace, this));
+      NS_TEST_EXPECT_MSG_EQ (ok, true, "RTT not connected");
+    }
+  source->Connect (InetSocketAddress (interfaces.GetAddress (1), 5000));
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, m_totalBytes, "Transfer incomplete");
+  return m_lastReceived;
+}
+
+void
+TcpLazyTraceTestCase::DoRun (void)
+{
+  Time untraced = RunTransfer (false);
+  NS_TEST_ASSERT_MSG_EQ (m_cwndChanges, 0, "Trace fired without being connected");
+  Time traced = RunTransfer (true);
+
+  NS_TEST_ASSERT_MSG_EQ (traced, untraced, "Tracing changed the transfer time");
+  NS_TEST_ASSERT_MSG_GT (m_cwndChanges, 0, "CongestionWindow of the sender not traced");
+  NS_TEST_ASSERT_MSG_GT (m_maxCwnd, 10 * 536, "Congestion window of the sender did not grow");
+  NS_TEST_ASSERT_MSG_GT (m_rttSamples, 0, "RTT of the sender not traced");
+  NS_TEST_ASSERT_MSG_GT (m_acceptedTxChanges, 0, "NextTxSequence of the receiver not traced");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for the footprint reductions of TcpSocketBase
+ */
+class TcpSocketFootprintTestSuite : public TestSuite
+{
+public:
+  TcpSocketFootprintTestSuite ()
+    : TestSuite ("tcp-socket-footprint", UNIT)
+  {
+    AddTestCase (new TcpStatelessOpsTestCase, TestCase::QUICK);
+    AddTestCase (new TcpLazyTraceTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpSocketFootprintTestSuite g_tcpSocketFootprintTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,324 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/error-model.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/segmentation-offload-tag.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpTsoTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A SimpleNetDevice not supporting segmentation offload
+ */
+class TcpTsoNoOffloadNetDevice : public SimpleNetDevice
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual bool SupportsSegmentationOffload (void) const;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TcpTsoNoOffloadNetDevice);
+
+TypeId
+TcpTsoNoOffloadNetDevice::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpTsoNoOffloadNetDevice")
+    .SetParent<SimpleNetDevice> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpTsoNoOffloadNetDevice> ()
+  ;
+  return tid;
+}
+
+bool
+TcpTsoNoOffloadNetDevice::SupportsSegmentationOffload (void) const
+{
+  return false;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the TCP super-segments keep the transfer time of a bulk
+ * transfer while reducing the number of packets through the IPv4 layer.
+ *
+ * The super-segments are split into their wire segments by the devices
+ * supporting segmentation offload, and by the IPv4 layer otherwise, so that
+ * the receiver only gets segments fitting in the MTU.
+ */
+class TcpTsoTestCase : public TestCase
+{
+public:
+  TcpTsoTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Results of a transfer
+  struct Transfer
+  {
+    uint32_t received;      //!< bytes received
+    Time lastReceived;      //!< time of the last byte received
+    uint32_t devicePackets; //!< packets sent to the device of the sender
+    uint32_t superSegments; //!< super-segments among them
+    uint32_t rxPackets;     //!< packets received by the IPv4 layer of the receiver
+    uint32_t rxMaxSize;     //!< size of the largest of them
+  };
+
+  /**
+   * \brief Run a bulk transfer
+   * \param tsoMaxSegments the TsoMaxSegments attribute of the sender
+   * \param offload whether the devices support segmentation offload
+   * \return the results of the transfer
+   */
+  Transfer RunTransfer (uint32_t tsoMaxSegments, bool offload);
+
+  /**
+   * \brief Fill the Tx buffer of the sender
+   * \param socket the sender socket
+   * \param available the space in the Tx buffer
+   */
+  void SendData (Ptr<Socket> socket, uint32_t available);
+
+  /**
+   * \brief Accept the connection of the sender
+   * \param socket the socket of the connection
+   * \param from the address of the sender
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+
+  /**
+   * \brief Read the data received
+   * \param socket the receiver socket
+   */
+  void ReceiveData (Ptr<Socket> socket);
+
+  /**
+   * \brief Count the packets sent by the IPv4 layer to the device
+   * \param packet the packet
+   * \param ipv4 the IPv4 protocol
+   * \param interface the IPv4 interface
+   */
+  void Ipv4Tx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  /**
+   * \brief Count the packets received by the IPv4 layer from the device
+   * \param packet the packet
+   * \param ipv4 the IPv4 protocol
+   * \param interface the IPv4 interface
+   */
+  void Ipv4Rx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  uint32_t m_totalBytes; //!< bytes to transfer
+  uint32_t m_sent;       //!< bytes given to the sender socket
+  Transfer m_transfer;   //!< results of the current transfer
+};
+
+TcpTsoTestCase::TcpTsoTestCase ()
+  : TestCase ("Check the transfer time and the packets of TCP super-segments"),
+    m_totalBytes (2000000),
+    m_sent (0)
+{
+}
+
+void
+TcpTsoTestCase::SendData (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_sent < m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (m_totalBytes - m_sent, socket->GetTxAvailable ());
+      int sent = socket->Send (Create<Packet> (size));
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sent += sent;
+    }
+  if (m_sent == m_totalBytes)
+    {
+      socket->Close ();
+    }
+}
+
+void
+TcpTsoTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpTsoTestCase::ReceiveData, this));
+}
+
+void
+TcpTsoTestCase::ReceiveData (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()) != nullptr)
+    {
+      if (p->GetSize () > 0)
+        {
+          m_transfer.received += p->GetSize ();
+          m_transfer.lastReceived = Simulator::Now ();
+        }
+    }
+}
+
+void
+TcpTsoTestCase::Ipv4Tx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  m_transfer.devicePackets++;
+  SegmentationOffloadTag offload;
+  if (packet->PeekPacketTag (offload))
+    {
+      m_transfer.superSegments++;
+    }
+}
+
+void
+TcpTsoTestCase::Ipv4Rx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  m_transfer.rxPackets++;
+  m_transfer.rxMaxSize = std::max (m_transfer.rxMaxSize, packet->GetSize ());
+}
+
+TcpTsoTestCase::Transfer
+TcpTsoTestCase::RunTransfer (uint32_t tsoMaxSegments, bool offload)
+{
+  m_sent = 0;
+  m_transfer = Transfer ();
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  ObjectFactory deviceFactory (offload ? "ns3::SimpleNetDevice" : "ns3::TcpTsoNoOffloadNetDevice");
+  deviceFactory.Set ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = deviceFactory.Create<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetMtu (1500);
+      nodes.Get (i)->AddDevice (device);
+      device->SetChannel (channel);
+      // The queue counts a super-segment as one packet: it is large enough
+      // for the transfers to lose no packet, whatever their segments
+      Ptr<Queue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+      queue->SetMaxSize (QueueSize ("100000p"));
+      device->SetQueue (queue);
+      Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
+      ndqi->GetTxQueue (0)->ConnectQueueTraces (queue);
+      device->AggregateObject (ndqi);
+      devices.Add (device);
+    }
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpTsoTestCase::Ipv4Tx, this));
+  nodes.Get (1)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Rx", MakeCallback (&TcpTsoTestCase::Ipv4Rx, this));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  sink->Listen ();
+  sink->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                           MakeCallback (&TcpTsoTestCase::Accept, this));
+
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  source->SetAttribute ("TsoMaxSegments", UintegerValue (tsoMaxSegments));
+  source->SetSendCallback (MakeCallback (&TcpTsoTestCase::SendData, this));
+  source->Connect (InetSocketAddress (interfaces.GetAddress (1), 5000));
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_transfer;
+}
+
+void
+TcpTsoTestCase::DoRun (void)
+{
+  Transfer segments = RunTransfer (1, true);
+  Transfer superSegments = RunTransfer (16, true);
+  Transfer software = RunTransfer (16, false);
+
+  NS_TEST_ASSERT_MSG_EQ (segments.received, m_totalBytes, "Transfer without TSO incomplete");
+  NS_TEST_ASSERT_MSG_EQ (superSegments.received, m_totalBytes, "Transfer with TSO incomplete");
+  NS_TEST_ASSERT_MSG_EQ (software.received, m_totalBytes, "Transfer with software segmentation incomplete");
+  NS_TEST_ASSERT_MSG_EQ (segments.superSegments, 0, "Super-segments sent without TSO");
+  NS_TEST_ASSERT_MSG_GT (superSegments.superSegments, 0, "No super-segment sent with TSO");
+  NS_TEST_ASSERT_MSG_EQ (software.superSegments, 0, "Super-segments sent to a device without offload");
+
+  // The IPv4 layer of the sender handles fewer packets. The ACKs of every
+  // second segment clock the transmissions, so that most super-segments
+  // carry the 2 or 3 segments the congestion window allows per ACK.
+  NS_TEST_ASSERT_MSG_LT (superSegments.devicePackets * 2, segments.devicePackets,
+                         "TSO did not reduce the packets sent to the device");
+
+  // The receiver gets the same wire segments, neither super-segments nor
+  // fragments, at the same times
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (superSegments.rxMaxSize, 1500, "Super-segment received whole");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (software.rxMaxSize, 1500, "Super-segment received whole");
+  NS_TEST_ASSERT_MSG_EQ (superSegments.rxPackets, segments.rxPackets, "TSO changed the wire segments");
+  NS_TEST_ASSERT_MSG_EQ (software.rxPackets, segments.rxPackets, "Super-segment fragmented");
+  NS_TEST_ASSERT_MSG_EQ_TOL (superSegments.lastReceived, segments.lastReceived, MilliSeconds (20),
+                             "TSO changed the transfer time");
+  NS_TEST_ASSERT_MSG_EQ_TOL (software.lastReceived, segments.lastReceived, MilliSeconds (20),
+                             "Software segmentation changed the transfer time");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for the TCP segmentation offload
+ */
+class TcpTsoTestSuite : public TestSuite
+{
+public:
+  TcpTsoTestSuite ()
+    : TestSuite ("tcp-tso", UNIT)
+  {
+    AddTestCase (new TcpTsoTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpTsoTestSuite g_tcpTsoTestSuite; //!< Static variable for test initialization
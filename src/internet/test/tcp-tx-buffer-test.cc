@@ -20,6 +20,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -347,6 +348,409 @@ TcpTxBufferTestCase::DoTeardown ()
 {
 }
 
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The TcpTxBuffer scoreboard Test
+ *
+ * The scoreboard walks of TcpTxBuffer rely on a binary search of the sent
+ * list (FindSentItem) and on three bounds: the lost frontier, the NextSeg
+ * hint and the lost ceiling. The test checks the invariants of the bounds
+ * after every change of the scoreboard, and that the lookups using them
+ * return what a walk of the whole sent list returns, while a random
+ * sequence of transmissions, SACKs, retransmissions, cumulative ACKs and
+ * RTOs is applied to the buffer.
+ */
+class TcpTxBufferScoreboardTestCase : public TestCase
+{
+public:
+  /** \brief Constructor */
+  TcpTxBufferScoreboardTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** \brief Check that the bounds advance on a known scoreboard */
+  void TestBounds ();
+  /** \brief Check the invariants while applying random changes */
+  void TestRandom ();
+
+  /**
+   * \brief Check FindSentItem, the invariants of the bounds, IsLost and NextSeg
+   * \param txBuf the buffer
+   */
+  void CheckScoreboard (TcpTxBuffer &txBuf);
+  /**
+   * \brief Check that walking the whole sent list does not find more lost
+   * items than UpdateLostCount did, starting from the lost frontier
+   * \param txBuf the buffer
+   */
+  void CheckLostCount (TcpTxBuffer &txBuf);
+  /**
+   * \brief Return the first byte of an item of the sent list
+   * \param txBuf the buffer
+   * \param i the index of the item
+   * \return the first byte of the item
+   */
+  static SequenceNumber32 ItemStart (const TcpTxBuffer &txBuf, uint32_t i);
+  /**
+   * \brief Return the byte after an item of the sent list
+   * \param txBuf the buffer
+   * \param i the index of the item
+   * \return the byte after the item
+   */
+  static SequenceNumber32 ItemEnd (const TcpTxBuffer &txBuf, uint32_t i);
+
+  uint32_t m_frontierAdvanced; //!< Checks with the lost frontier past the head
+  uint32_t m_hintAdvanced;     //!< Checks with the NextSeg hint past the head
+  uint32_t m_ceilingLowered;   //!< Checks with the lost ceiling before the last byte sent
+};
+
+TcpTxBufferScoreboardTestCase::TcpTxBufferScoreboardTestCase ()
+  : TestCase ("TcpTxBuffer scoreboard Test"),
+    m_frontierAdvanced (0),
+    m_hintAdvanced (0),
+    m_ceilingLowered (0)
+{
+}
+
+void
+TcpTxBufferScoreboardTestCase::DoRun ()
+{
+  Simulator::Schedule (Seconds (0.0), &TcpTxBufferScoreboardTestCase::TestBounds, this);
+  Simulator::Schedule (Seconds (0.0), &TcpTxBufferScoreboardTestCase::TestRandom, this);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+SequenceNumber32
+TcpTxBufferScoreboardTestCase::ItemStart (const TcpTxBuffer &txBuf, uint32_t i)
+{
+  return txBuf.m_sentList[i]->m_startSeq;
+}
+
+SequenceNumber32
+TcpTxBufferScoreboardTestCase::ItemEnd (const TcpTxBuffer &txBuf, uint32_t i)
+{
+  return txBuf.m_sentList[i]->m_startSeq + txBuf.m_sentList[i]->m_packet->GetSize ();
+}
+
+void
+TcpTxBufferScoreboardTestCase::CheckScoreboard (TcpTxBuffer &txBuf)
+{
+  SequenceNumber32 head = txBuf.HeadSequence ();
+  SequenceNumber32 sentEnd = head + txBuf.m_sentSize;
+  uint32_t n = txBuf.m_sentList.size ();
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf.FindSentItem (sentEnd), n, "Byte after the sent list not found at its end");
+  if (head > SequenceNumber32 (0))
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.FindSentItem (head - 1), 0, "Byte before the head not found at its start");
+    }
+
+  SequenceNumber32 start = head;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      TcpTxItem *item = txBuf.m_sentList[i];
+      SequenceNumber32 end = ItemEnd (txBuf, i);
+      NS_TEST_ASSERT_MSG_EQ (item->m_startSeq, start, "Sent items are not contiguous");
+
+      // FindSentItem finds the item holding any of its bytes
+      NS_TEST_ASSERT_MSG_EQ (txBuf.FindSentItem (start), i, "Wrong item for its first byte " << start);
+      NS_TEST_ASSERT_MSG_EQ (txBuf.FindSentItem (end - 1), i, "Wrong item for its last byte " << end - 1);
+      NS_TEST_ASSERT_MSG_EQ (txBuf.FindSentItem (start + (end - start) / 2), i, "Wrong item for a byte inside it");
+
+      // The invariants of the bounds
+      NS_TEST_ASSERT_MSG_EQ ((start >= txBuf.m_lostFrontier || item->m_sacked || item->m_lost), true,
+                             "Item " << *item << " before the lost frontier " << txBuf.m_lostFrontier <<
+                             " is neither sacked nor lost");
+      NS_TEST_ASSERT_MSG_EQ ((start >= txBuf.m_nextSegHint || item->m_sacked || item->m_retrans), true,
+                             "Item " << *item << " before the NextSeg hint " << txBuf.m_nextSegHint <<
+                             " is neither sacked nor retransmitted");
+      NS_TEST_ASSERT_MSG_EQ ((start < txBuf.m_lostCeiling || !item->m_lost), true,
+                             "Item " << *item << " after the lost ceiling " << txBuf.m_lostCeiling <<
+                             " is lost");
+
+      // IsLost starts from the item holding seq: compare it with a walk of
+      // the whole sent list
+      for (uint32_t k = 0; k < 2; ++k)
+        {
+          SequenceNumber32 seq = k == 0 ? start : start + (end - start) / 2;
+          bool lost = false;
+          if (seq < txBuf.m_highestSack.second)
+            {
+              for (uint32_t j = 0; j < n; ++j)
+                {
+                  TcpTxItem *other = txBuf.m_sentList[j];
+                  if (other->m_startSeq >= seq && (other->m_lost || other->m_sacked))
+                    {
+                      lost = other->m_lost;
+                      break;
+                    }
+                }
+            }
+          NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (seq), lost, "IsLost wrong for " << seq);
+        }
+      start = end;
+    }
+  NS_TEST_ASSERT_MSG_EQ (start, sentEnd, "Sent items do not cover the sent size");
+
+  if (txBuf.m_lostFrontier > head)
+    {
+      m_frontierAdvanced++;
+    }
+  if (txBuf.m_nextSegHint > head)
+    {
+      m_hintAdvanced++;
+    }
+  if (txBuf.m_lostCeiling < sentEnd)
+    {
+      m_ceilingLowered++;
+    }
+
+  // NextSeg starting from the hint and stopping at the lost ceiling returns
+  // what a walk of the whole sent list returns. The bounds are restored
+  // afterwards, so that the ones maintained by the buffer keep being tested.
+  for (uint32_t k = 0; k < 2; ++k)
+    {
+      bool isRecovery = (k == 1);
+      SequenceNumber32 seq;
+      bool found = txBuf.NextSeg (&seq, isRecovery);
+      NS_TEST_ASSERT_MSG_EQ ((txBuf.m_nextSegHint >= head && txBuf.m_nextSegHint <= sentEnd), true,
+                             "NextSeg hint " << txBuf.m_nextSegHint << " out of the sent list");
+
+      SequenceNumber32 hint = txBuf.m_nextSegHint;
+      SequenceNumber32 ceiling = txBuf.m_lostCeiling;
+      txBuf.m_nextSegHint = head;
+      txBuf.m_lostCeiling = sentEnd;
+      SequenceNumber32 expectedSeq;
+      bool expectedFound = txBuf.NextSeg (&expectedSeq, isRecovery);
+      txBuf.m_nextSegHint = hint;
+      txBuf.m_lostCeiling = ceiling;
+
+      NS_TEST_ASSERT_MSG_EQ (found, expectedFound, "NextSeg (" << isRecovery << ") result differs");
+      if (found)
+        {
+          NS_TEST_ASSERT_MSG_EQ (seq, expectedSeq, "NextSeg (" << isRecovery << ") sequence differs");
+        }
+    }
+}
+
+void
+TcpTxBufferScoreboardTestCase::CheckLostCount (TcpTxBuffer &txBuf)
+{
+  if (txBuf.m_highestSack.first == nullptr)
+    {
+      return;
+    }
+  // UpdateLostCount from the head marks no other item as lost. The bounds
+  // are restored afterwards, so that the ones maintained by the buffer keep
+  // being tested.
+  uint32_t lostOut = txBuf.m_lostOut;
+  SequenceNumber32 frontier = txBuf.m_lostFrontier;
+  SequenceNumber32 ceiling = txBuf.m_lostCeiling;
+  txBuf.m_lostFrontier = txBuf.HeadSequence ();
+  txBuf.UpdateLostCount ();
+  NS_TEST_ASSERT_MSG_EQ (txBuf.m_lostOut, lostOut, "Items before the lost frontier were not marked lost");
+  NS_TEST_ASSERT_MSG_EQ ((txBuf.m_lostFrontier <= frontier || frontier == txBuf.HeadSequence () + txBuf.m_sentSize), true,
+                         "Lost frontier " << frontier << " past the lost items up to " << txBuf.m_lostFrontier);
+  txBuf.m_lostFrontier = frontier;
+  txBuf.m_lostCeiling = ceiling;
+}
+
+void
+TcpTxBufferScoreboardTestCase::TestBounds ()
+{
+  TcpTxBuffer txBuf;
+  txBuf.SetHeadSequence (SequenceNumber32 (1));
+  txBuf.SetSegmentSize (1000);
+  txBuf.SetDupAckThresh (3);
+  txBuf.Add (Create<Packet> (10000));
+
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      txBuf.CopyFromSequence (1000, SequenceNumber32 (i * 1000 + 1));
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.m_lostCeiling, SequenceNumber32 (1), "No item is lost");
+
+  // Segments 1001 and 3001 are lost, the segments after 3001 are sacked
+  TcpOptionSack::SackList sackList;
+  sackList.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (2001), SequenceNumber32 (3001)));
+  sackList.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (4001), SequenceNumber32 (7001)));
+  txBuf.Update (sackList);
+  CheckScoreboard (txBuf);
+  CheckLostCount (txBuf);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 3000, "Segments 1, 1001 and 3001 must be lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.m_lostFrontier, SequenceNumber32 (5001), "Lost frontier must skip the settled items");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.m_lostCeiling, SequenceNumber32 (5001), "Lost ceiling must follow the settled items");
+
+  // Retransmitting the lost segments moves the hint past them
+  SequenceNumber32 seq;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&seq, true), true, "A lost segment must be found");
+      txBuf.CopyFromSequence (1000, seq);
+      CheckScoreboard (txBuf);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 3000, "Lost segments must be retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&seq, true), true, "A segment must be found by rule 3");
+  NS_TEST_ASSERT_MSG_EQ (seq, SequenceNumber32 (7001), "Rule 3 must return the first unsacked segment");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.m_nextSegHint, SequenceNumber32 (7001), "NextSeg hint must skip the retransmitted items");
+
+  // A cumulative ACK moves the bounds with the head
+  txBuf.DiscardUpTo (SequenceNumber32 (7001));
+  CheckScoreboard (txBuf);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.m_lostFrontier, SequenceNumber32 (7001), "Lost frontier must follow the head");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.m_nextSegHint, SequenceNumber32 (7001), "NextSeg hint must follow the head");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.m_lostCeiling, SequenceNumber32 (7001), "Lost ceiling must follow the head");
+
+  // An RTO marks everything lost, and the hint goes back to the head
+  txBuf.NextSeg (&seq, true);
+  txBuf.CopyFromSequence (1000, seq);
+  CheckScoreboard (txBuf);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.m_nextSegHint, SequenceNumber32 (8001), "NextSeg hint must skip the retransmitted items");
+  txBuf.SetSentListLost ();
+  CheckScoreboard (txBuf);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.m_nextSegHint, SequenceNumber32 (7001), "NextSeg hint must go back to the head");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&seq, false), true, "A lost segment must be found");
+  NS_TEST_ASSERT_MSG_EQ (seq, SequenceNumber32 (7001), "The head must be retransmitted first");
+}
+
+void
+TcpTxBufferScoreboardTestCase::TestRandom ()
+{
+  const uint32_t segmentSize = 1000;
+  TcpTxBuffer txBuf;
+  txBuf.SetHeadSequence (SequenceNumber32 (1));
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (3);
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+
+  for (uint32_t step = 0; step < 5000; ++step)
+    {
+      SequenceNumber32 head = txBuf.HeadSequence ();
+      SequenceNumber32 sentEnd = head + txBuf.m_sentSize;
+      uint32_t n = txBuf.m_sentList.size ();
+      uint32_t op = rand->GetInteger (0, 19);
+
+      // The application is often limited, so that NextSeg also returns
+      // retransmissions per its third rule
+      if (txBuf.SizeFromSequence (sentEnd) < 4 * segmentSize && rand->GetInteger (0, 7) == 0)
+        {
+          txBuf.Add (Create<Packet> (20 * segmentSize));
+        }
+
+      if (op < 6 || n < 2)
+        {
+          // Transmission of new data, of various sizes
+          if (txBuf.m_sentSize < 50 * segmentSize)
+            {
+              txBuf.CopyFromSequence (rand->GetInteger (segmentSize / 4, segmentSize), sentEnd);
+            }
+        }
+      else if (op < 11)
+        {
+          // A SACK option of up to three blocks over whole items, never
+          // covering the head
+          TcpOptionSack::SackList sackList;
+          uint32_t blocks = rand->GetInteger (1, 3);
+          for (uint32_t b = 0; b < blocks; ++b)
+            {
+              uint32_t first = rand->GetInteger (1, n - 1);
+              uint32_t last = std::min (n - 1, first + rand->GetInteger (0, 3));
+              sackList.push_back (TcpOptionSack::SackBlock (ItemStart (txBuf, first),
+                                                            ItemEnd (txBuf, last)));
+            }
+          if (txBuf.Update (sackList) > 0)
+            {
+              CheckLostCount (txBuf);
+            }
+        }
+      else if (op < 15)
+        {
+          // The retransmission, or transmission, chosen by NextSeg, or the
+          // retransmission of the head, as on a timeout. The buffer merges
+          // the retransmitted items only if they are both lost or not lost,
+          // so a retransmission covers one item, or two alike.
+          SequenceNumber32 seq = head;
+          if (rand->GetInteger (0, 3) == 0 || txBuf.NextSeg (&seq, rand->GetInteger (0, 1) == 1))
+            {
+              uint32_t size = segmentSize;
+              uint32_t i = txBuf.FindSentItem (seq);
+              if (i < n)
+                {
+                  size = ItemEnd (txBuf, i) - seq;
+                  if (i + 1 < n && rand->GetInteger (0, 1) == 1
+                      && !txBuf.m_sentList[i + 1]->m_sacked
+                      && txBuf.m_sentList[i + 1]->m_lost == txBuf.m_sentList[i]->m_lost)
+                    {
+                      size = ItemEnd (txBuf, i + 1) - seq;
+                    }
+                }
+              txBuf.CopyFromSequence (size, seq);
+            }
+        }
+      else if (op < 18)
+        {
+          // A cumulative ACK, ending inside an item or at its end, and
+          // covering the sacked items after it
+          uint32_t i = rand->GetInteger (0, std::min (n - 1, 5u));
+          SequenceNumber32 ack = ItemEnd (txBuf, i);
+          if (rand->GetInteger (0, 3) == 0 && !txBuf.m_sentList[i]->m_sacked)
+            {
+              ack = ItemStart (txBuf, i) + rand->GetInteger (1, ItemEnd (txBuf, i) - ItemStart (txBuf, i));
+            }
+          for (uint32_t j = i + 1; j < n && ack == ItemStart (txBuf, j) && txBuf.m_sentList[j]->m_sacked; ++j)
+            {
+              ack = ItemEnd (txBuf, j);
+            }
+          txBuf.DiscardUpTo (ack);
+        }
+      else if (op < 19)
+        {
+          // Changes of the flags in bulk
+          switch (rand->GetInteger (0, 4))
+            {
+            case 0:
+              txBuf.SetSentListLost (rand->GetInteger (0, 1) == 1);
+              break;
+            case 1:
+              txBuf.MarkHeadAsLost ();
+              break;
+            case 2:
+              txBuf.DeleteRetransmittedFlagFromHead ();
+              break;
+            case 3:
+              // Only done when the last segment could not be sent
+              if (!txBuf.m_sentList.back ()->m_sacked && !txBuf.m_sentList.back ()->m_lost)
+                {
+                  txBuf.ResetLastSegmentSent ();
+                  txBuf.CopyFromSequence (segmentSize, head + txBuf.m_sentSize);
+                }
+              break;
+            default:
+              txBuf.ResetSentList ();
+              break;
+            }
+        }
+      else
+        {
+          // Everything is acknowledged
+          txBuf.DiscardUpTo (sentEnd);
+        }
+
+      CheckScoreboard (txBuf);
+    }
+
+  NS_TEST_ASSERT_MSG_GT (m_frontierAdvanced, 0, "The lost frontier never left the head");
+  NS_TEST_ASSERT_MSG_GT (m_hintAdvanced, 0, "The NextSeg hint never left the head");
+  NS_TEST_ASSERT_MSG_GT (m_ceilingLowered, 0, "The lost ceiling never left the last byte sent");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -360,6 +764,7 @@ public:
     : TestSuite ("tcp-tx-buffer", UNIT)
   {
     AddTestCase (new TcpTxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpTxBufferScoreboardTestCase, TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,379 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <utility>
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/data-rate.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/timer-wheel.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TimerWheelTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the timers of a TimerWheel expire at the same times and
+ * in the same order as timers scheduling a simulator event each.
+ *
+ * The functions of the timers re-arm or cancel random timers, with delays
+ * spanning all the levels of the wheel and many ties.
+ */
+class TimerWheelExpiryTestCase : public TestCase
+{
+public:
+  TimerWheelExpiryTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Expirations of the timers: time and timer index
+  typedef std::vector<std::pair<Time, uint32_t> > Expirations;
+
+  /**
+   * \brief Run the timers
+   * \param wheel the wheel of the timers, or 0
+   * \return the expirations of the timers
+   */
+  Expirations RunTimers (Ptr<TimerWheel> wheel);
+
+  /**
+   * \brief Get a random delay
+   * \return the delay
+   */
+  Time GetDelay (void);
+
+  /**
+   * \brief Arm a timer with a random delay
+   * \param index the index of the timer
+   */
+  void Arm (uint32_t index);
+
+  /**
+   * \brief Function of the timers
+   * \param index the index of the timer
+   */
+  void Expire (uint32_t index);
+
+  static const uint32_t N_TIMERS = 100;     //!< number of timers
+  static const uint32_t N_EXPIRATIONS = 5000; //!< expirations after which the timers are not re-armed
+  WheelTimer m_timers[N_TIMERS];            //!< the timers
+  Time m_expiry[N_TIMERS];                  //!< the expiration time of each timer
+  uint32_t m_nArmed {0};                    //!< number of timers armed
+  Ptr<UniformRandomVariable> m_rng;         //!< random actions of the timers
+  Expirations m_expirations;                //!< the expirations of the current run
+};
+
+TimerWheelExpiryTestCase::TimerWheelExpiryTestCase ()
+  : TestCase ("Check the expiration of the timers of a TimerWheel")
+{
+}
+
+Time
+TimerWheelExpiryTestCase::GetDelay (void)
+{
+  double category = m_rng->GetValue ();
+  if (category < 0.1)
+    {
+      return Time (0);
+    }
+  else if (category < 0.4)
+    {
+      return MicroSeconds (m_rng->GetInteger (1, 2000));
+    }
+  else if (category < 0.7)
+    {
+      return MilliSeconds (m_rng->GetInteger (1, 500));
+    }
+  else if (category < 0.9)
+    {
+      return Seconds (m_rng->GetInteger (1, 60));
+    }
+  // Beyond the last level of the wheel, with the default granularity
+  return Seconds (m_rng->GetInteger (1000, 1500));
+}
+
+void
+TimerWheelExpiryTestCase::Arm (uint32_t index)
+{
+  Time delay = GetDelay ();
+  m_expiry[index] = Simulator::Now () + delay;
+  m_timers[index].Schedule (delay, MakeCallback (&TimerWheelExpiryTestCase::Expire, this).Bind (index));
+  m_nArmed++;
+}
+
+void
+TimerWheelExpiryTestCase::Expire (uint32_t index)
+{
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), m_expiry[index], "Timer " << index << " expired at the wrong time");
+  NS_TEST_ASSERT_MSG_EQ (m_timers[index].IsExpired (), true, "Timer " << index << " still running");
+  m_expirations.push_back (std::make_pair (Simulator::Now (), index));
+  if (m_expirations.size () >= N_EXPIRATIONS)
+    {
+      return;
+    }
+
+  Arm (index);
+  uint32_t other = m_rng->GetInteger (0, N_TIMERS - 1);
+  double action = m_rng->GetValue ();
+  if (action < 0.5)
+    {
+      Arm (other);
+    }
+  else if (action < 0.6)
+    {
+      m_timers[other].Cancel ();
+      NS_TEST_ASSERT_MSG_EQ (m_timers[other].IsRunning (), false, "Timer " << other << " not cancelled");
+    }
+  else if (action < 0.7 && m_timers[other].IsExpired ())
+    {
+      Arm (other);
+    }
+}
+
+TimerWheelExpiryTestCase::Expirations
+TimerWheelExpiryTestCase::RunTimers (Ptr<TimerWheel> wheel)
+{
+  m_expirations.clear ();
+  m_nArmed = 0;
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      m_timers[i].SetWheel (wheel);
+    }
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      Arm (i);
+    }
+  Simulator::Run ();
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_timers[i].IsExpired (), true, "Timer " << i << " still running");
+    }
+  Simulator::Destroy ();
+  return m_expirations;
+}
+
+void
+TimerWheelExpiryTestCase::DoRun (void)
+{
+  Expirations events = RunTimers (0);
+
+  Ptr<TimerWheel> wheel = CreateObject<TimerWheel> ();
+  Expirations wheelEvents = RunTimers (wheel);
+  NS_TEST_ASSERT_MSG_EQ (wheel->GetNTimers (), 0, "Timers left on the wheel");
+
+  NS_TEST_ASSERT_MSG_EQ (wheelEvents.size (), events.size (), "Different number of expirations");
+  for (uint32_t i = 0; i < events.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (wheelEvents[i].first, events[i].first, "Expiration " << i << " at a different time");
+      NS_TEST_ASSERT_MSG_EQ (wheelEvents[i].second, events[i].second, "Expiration " << i << " of a different timer");
+    }
+
+  // The wheel schedules fewer simulator events than there are armings
+  NS_TEST_ASSERT_MSG_LT (wheel->GetNEvents (), m_nArmed, "The wheel did not save simulator events");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that a TCP transfer with the socket timers on the TimerWheel
+ * of the nodes behaves as with a simulator event per timer.
+ */
+class TimerWheelTcpTestCase : public TestCase
+{
+public:
+  TimerWheelTcpTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Results of a transfer
+  struct Transfer
+  {
+    uint32_t received;    //!< bytes received
+    Time lastReceived;    //!< time of the last byte received
+    uint64_t wheelEvents; //!< simulator events of the wheel of the receiver
+  };
+
+  /**
+   * \brief Run a bulk transfer
+   * \param useTimerWheel the UseTimerWheel attribute of TcpL4Protocol
+   * \return the results of the transfer
+   */
+  Transfer RunTransfer (bool useTimerWheel);
+
+  /**
+   * \brief Fill the Tx buffer of the sender
+   * \param socket the sender socket
+   * \param available the space in the Tx buffer
+   */
+  void SendData (Ptr<Socket> socket, uint32_t available);
+
+  /**
+   * \brief Accept the connection of the sender
+   * \param socket the socket of the connection
+   * \param from the address of the sender
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+
+  /**
+   * \brief Read the data received
+   * \param socket the receiver socket
+   */
+  void ReceiveData (Ptr<Socket> socket);
+
+  uint32_t m_totalBytes; //!< bytes to transfer
+  uint32_t m_sent;       //!< bytes given to the sender socket
+  Transfer m_transfer;   //!< results of the current transfer
+};
+
+TimerWheelTcpTestCase::TimerWheelTcpTestCase ()
+  : TestCase ("Check a TCP transfer with the socket timers on a TimerWheel"),
+    m_totalBytes (500000),
+    m_sent (0)
+{
+}
+
+void
+TimerWheelTcpTestCase::SendData (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_sent < m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (m_totalBytes - m_sent, socket->GetTxAvailable ());
+      int sent = socket->Send (Create<Packet> (size));
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sent += sent;
+    }
+  if (m_sent == m_totalBytes)
+    {
+      socket->Close ();
+    }
+}
+
+void
+TimerWheelTcpTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TimerWheelTcpTestCase::ReceiveData, this));
+}
+
+void
+TimerWheelTcpTestCase::ReceiveData (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()) != nullptr)
+    {
+      if (p->GetSize () > 0)
+        {
+          m_transfer.received += p->GetSize ();
+          m_transfer.lastReceived = Simulator::Now ();
+        }
+    }
+}
+
+TimerWheelTcpTestCase::Transfer
+TimerWheelTcpTestCase::RunTransfer (bool useTimerWheel)
+{
+  m_sent = 0;
+  m_transfer = Transfer ();
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  simpleHelper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  // Both transfers draw the same random values
+  internet.AssignStreams (nodes, 0);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodes.Get (i)->GetObject<TcpL4Protocol> ()->SetAttribute ("UseTimerWheel", BooleanValue (useTimerWheel));
+    }
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  sink->Listen ();
+  sink->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                           MakeCallback (&TimerWheelTcpTestCase::Accept, this));
+
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  source->SetSendCallback (MakeCallback (&TimerWheelTcpTestCase::SendData, this));
+  source->Connect (InetSocketAddress (interfaces.GetAddress (1), 5000));
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  Ptr<TimerWheel> wheel = nodes.Get (1)->GetObject<TimerWheel> ();
+  m_transfer.wheelEvents = (wheel != 0) ? wheel->GetNEvents () : 0;
+  Simulator::Destroy ();
+  return m_transfer;
+}
+
+void
+TimerWheelTcpTestCase::DoRun (void)
+{
+  Transfer events = RunTransfer (false);
+  Transfer wheel = RunTransfer (true);
+
+  NS_TEST_ASSERT_MSG_EQ (events.received, m_totalBytes, "Transfer without the wheel incomplete");
+  NS_TEST_ASSERT_MSG_EQ (wheel.received, m_totalBytes, "Transfer with the wheel incomplete");
+  NS_TEST_ASSERT_MSG_EQ (events.wheelEvents, 0, "Wheel used without UseTimerWheel");
+  // The accepted socket, forked from the listening one, uses the wheel
+  NS_TEST_ASSERT_MSG_GT (wheel.wheelEvents, 0, "Wheel of the receiver not used");
+  NS_TEST_ASSERT_MSG_EQ (wheel.lastReceived, events.lastReceived, "The wheel changed the transfer time");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for the TimerWheel
+ */
+class TimerWheelTestSuite : public TestSuite
+{
+public:
+  TimerWheelTestSuite ()
+    : TestSuite ("timer-wheel", UNIT)
+  {
+    AddTestCase (new TimerWheelExpiryTestCase, TestCase::QUICK);
+    AddTestCase (new TimerWheelTcpTestCase, TestCase::QUICK);
+  }
+};
+
+static TimerWheelTestSuite g_timerWheelTestSuite; //!< Static variable for test initialization
@@ -141,9 +141,13 @@ SimpleNetDeviceHelper::InstallPriv (Ptr<Node> node, Ptr<SimpleChannel> channel)
   Ptr<Queue<Packet> > queue = m_queueFactory.Create<Queue<Packet> > ();
   device->SetQueue (queue);
   NS_ASSERT_MSG (!m_pointToPointMode || (channel->GetNDevices () <= 2), "Device set to PointToPoint and more than 2 devices on the channel.");
-  // Aggregate a NetDeviceQueueInterface object
+  // Aggregate a NetDeviceQueueInterface object, through which the device
+  // receives the packets dequeued by the queue disc in bursts
   Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
   ndqi->GetTxQueue (0)->ConnectQueueTraces (queue);
+  SimpleNetDevice *rawDevice = PeekPointer (device);
+  ndqi->SetSendBurstCallback ([rawDevice] (const std::vector<Ptr<QueueDiscItem> > &items)
+                              { rawDevice->SendBurst (items); });
   device->AggregateObject (ndqi);
   return device;
 }
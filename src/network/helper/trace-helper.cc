@@ -56,6 +56,21 @@ PcapHelper::CreateFile (
   NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
 
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+
+  Ptr<PcapNgFileWrapper> ngFile = PeekPcapNgFile ();
+  if (ngFile != 0)
+    {
+      std::string name = filename;
+      std::string::size_type dot = name.rfind (".pcap");
+      if (dot != std::string::npos && dot + 5 == name.size ())
+        {
+          name.erase (dot);
+        }
+      file->Init (ngFile, dataLinkType, name, snapLen);
+      NS_ABORT_MSG_IF (file->Fail (), "Unable to add interface " << name << " to pcapng file");
+      return file;
+    }
+
   file->Open (filename, filemode);
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
 
@@ -76,6 +91,44 @@ PcapHelper::CreateFile (
   return file;
 }
 
+Ptr<PcapNgFileWrapper>
+PcapHelper::CreatePcapNgFile (std::string filename, std::ios::openmode filemode)
+{
+  NS_LOG_FUNCTION (filename << filemode);
+
+  Ptr<PcapNgFileWrapper> file = CreateObject<PcapNgFileWrapper> ();
+  file->Open (filename, filemode);
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
+
+  file->Init ();
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Init " << filename);
+  return file;
+}
+
+Ptr<PcapNgFileWrapper> &
+PcapHelper::PeekPcapNgFile (void)
+{
+  static Ptr<PcapNgFileWrapper> file;
+  return file;
+}
+
+void
+PcapHelper::SetPcapNgFile (Ptr<PcapNgFileWrapper> file)
+{
+  NS_LOG_FUNCTION (file);
+  if (file != 0 && PeekPcapNgFile () == 0)
+    {
+      Simulator::ScheduleDestroy (&PcapHelper::SetPcapNgFile, Ptr<PcapNgFileWrapper> (0));
+    }
+  PeekPcapNgFile () = file;
+}
+
+Ptr<PcapNgFileWrapper>
+PcapHelper::GetPcapNgFile (void)
+{
+  return PeekPcapNgFile ();
+}
+
 std::string
 PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -192,6 +245,12 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
 {
   NS_LOG_FUNCTION (filename << filemode);
 
+  Ptr<BinaryTraceFile> binary = PeekBinaryTraceFile ();
+  if (binary != 0)
+    {
+      return Create<OutputStreamWrapper> (binary, filename);
+    }
+
   Ptr<OutputStreamWrapper> StreamWrapper = Create<OutputStreamWrapper> (filename, filemode);
 
   //
@@ -208,6 +267,37 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
   return StreamWrapper;
 }
 
+Ptr<BinaryTraceFile>
+AsciiTraceHelper::CreateBinaryTraceFile (std::string filename, bool withHeaders)
+{
+  NS_LOG_FUNCTION (filename << withHeaders);
+  return Create<BinaryTraceFile> (filename, withHeaders);
+}
+
+Ptr<BinaryTraceFile> &
+AsciiTraceHelper::PeekBinaryTraceFile (void)
+{
+  static Ptr<BinaryTraceFile> file;
+  return file;
+}
+
+void
+AsciiTraceHelper::SetBinaryTraceFile (Ptr<BinaryTraceFile> file)
+{
+  NS_LOG_FUNCTION (file);
+  if (file != 0 && PeekBinaryTraceFile () == 0)
+    {
+      Simulator::ScheduleDestroy (&AsciiTraceHelper::SetBinaryTraceFile, Ptr<BinaryTraceFile> (0));
+    }
+  PeekBinaryTraceFile () = file;
+}
+
+Ptr<BinaryTraceFile>
+AsciiTraceHelper::GetBinaryTraceFile (void)
+{
+  return PeekBinaryTraceFile ();
+}
+
 std::string
 AsciiTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -295,6 +385,24 @@ AsciiTraceHelper::GetFilenameFromInterfacePair (
   return oss.str ();
 }
 
+//
+// When the stream records to a binary trace file, the default sinks below
+// store a binary record instead of printing the packet.
+//
+static bool
+WriteBinary (Ptr<OutputStreamWrapper> stream, BinaryTraceFile::EventType event,
+             std::string const *context, Ptr<const Packet> p)
+{
+  Ptr<BinaryTraceFile> file = stream->GetBinaryTraceFile ();
+  if (file == 0)
+    {
+      return false;
+    }
+  uint32_t contextId = context ? file->GetContextId (*context) : BinaryTraceFile::NO_CONTEXT;
+  file->Write (event, stream->GetBinarySource (), contextId, p);
+  return true;
+}
+
 //
 // One of the basic default trace sink sets.  Enqueue:
 //
@@ -310,6 +418,10 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, BinaryTraceFile::ENQUEUE, 0, p))
+    {
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -317,6 +429,10 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, BinaryTraceFile::ENQUEUE, &context, p))
+    {
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -336,6 +452,10 @@ void
 AsciiTraceHelper::DefaultDropSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, BinaryTraceFile::DROP, 0, p))
+    {
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -343,6 +463,10 @@ void
 AsciiTraceHelper::DefaultDropSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, BinaryTraceFile::DROP, &context, p))
+    {
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -363,6 +487,10 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, BinaryTraceFile::DEQUEUE, 0, p))
+    {
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -370,6 +498,10 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, BinaryTraceFile::DEQUEUE, &context, p))
+    {
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -387,6 +519,10 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, BinaryTraceFile::RECEIVE, 0, p))
+    {
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -394,6 +530,10 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, BinaryTraceFile::RECEIVE, &context, p))
+    {
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
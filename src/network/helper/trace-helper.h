@@ -24,6 +24,7 @@
 #include "ns3/node-container.h"
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
 
 namespace ns3 {
@@ -109,6 +110,38 @@ public:
                                    DataLinkType dataLinkType,
                                    uint32_t snapLen = std::numeric_limits<uint32_t>::max (),
                                    int32_t tzCorrection = 0);
+  /**
+   * @brief Create and initialize a pcapng file able to record the traffic of
+   * many devices.
+   *
+   * @param filename file name
+   * @param filemode file mode
+   * @returns a smart pointer to the pcapng file
+   */
+  Ptr<PcapNgFileWrapper> CreatePcapNgFile (std::string filename,
+                                           std::ios::openmode filemode = std::ios::out);
+
+  /**
+   * @brief Record all the pcap traces subsequently created into a single
+   * pcapng file.
+   *
+   * Once a pcapng file is set, CreateFile () no longer opens one pcap file
+   * per call: it returns a PcapFileWrapper which records its packets on a new
+   * interface of the pcapng file instead, named after the file that would
+   * otherwise have been created.  All the device helpers relying on
+   * CreateFile () (EnablePcap (), EnablePcapAll (), ...) are thus redirected
+   * transparently, which keeps the number of open files constant in large
+   * topologies.  The pcapng file is released on Simulator::Destroy ().
+   *
+   * @param file the pcapng file, or 0 to go back to one pcap file per call
+   */
+  static void SetPcapNgFile (Ptr<PcapNgFileWrapper> file);
+
+  /**
+   * @returns the pcapng file set by SetPcapNgFile (), if any
+   */
+  static Ptr<PcapNgFileWrapper> GetPcapNgFile (void);
+
   /**
    * @brief Hook a trace source to the default trace sink
    * 
@@ -119,6 +152,11 @@ public:
   template <typename T> void HookDefaultSink (Ptr<T> object, std::string traceName, Ptr<PcapFileWrapper> file);
 
 private:
+  /**
+   * @returns a reference to the pcapng file shared by all the helpers
+   */
+  static Ptr<PcapNgFileWrapper> &PeekPcapNgFile (void);
+
   /**
    * The basic default trace sink.
    *
@@ -222,6 +260,39 @@ public:
   Ptr<OutputStreamWrapper> CreateFileStream (std::string filename, 
                                              std::ios::openmode filemode = std::ios::out);
 
+  /**
+   * @brief Create a binary trace file able to record the traces of many
+   * streams.
+   *
+   * @param filename file name
+   * @param withHeaders whether to store the packet headers, needed to
+   * print their headers when converting the traces back to ascii
+   * @returns a smart pointer to the binary trace file
+   */
+  Ptr<BinaryTraceFile> CreateBinaryTraceFile (std::string filename, bool withHeaders = true);
+
+  /**
+   * @brief Record all the ascii traces subsequently created into a single
+   * binary trace file.
+   *
+   * Once a binary trace file is set, CreateFileStream () no longer opens a
+   * text file: the returned stream records to the binary trace file, as a
+   * source named after the file that would otherwise have been created.
+   * The default trace sinks then store compact binary records instead of
+   * printing packets, and whatever else is written to the stream is kept
+   * as text.  The print-binary-trace utility converts the binary trace back
+   * into the usual ascii files.  The binary trace file is released on
+   * Simulator::Destroy ().
+   *
+   * @param file the binary trace file, or 0 to go back to text files
+   */
+  static void SetBinaryTraceFile (Ptr<BinaryTraceFile> file);
+
+  /**
+   * @returns the binary trace file set by SetBinaryTraceFile (), if any
+   */
+  static Ptr<BinaryTraceFile> GetBinaryTraceFile (void);
+
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
    * does not accept nor log a trace context.
@@ -455,6 +526,12 @@ public:
    * @param p the packet
    */
   static void DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> file, std::string context, Ptr<const Packet> p);
+
+private:
+  /**
+   * @returns a reference to the binary trace file shared by all the helpers
+   */
+  static Ptr<BinaryTraceFile> &PeekBinaryTraceFile (void);
 };
 
 template <typename T> void
@@ -43,6 +43,48 @@ static struct Zeroes
   const uint32_t size;  //!< buffer size
 } g_zeroes; //!< Zero-filled buffer
 
+/**
+ * \ingroup packet
+ * \brief One's complement sum of the little-endian 16-bit words of a
+ * contiguous area, as if it started at an even offset (RFC 1071).
+ *
+ * The area is summed 8 bytes at a time into a 64-bit accumulator, deferring
+ * the end-around carries to a final fold.  A trailing odd byte is the low
+ * byte of its word.
+ *
+ * \param data the start of the area
+ * \param size the size of the area
+ * \returns the folded 16-bit sum, zero only if all bytes are zero
+ */
+static uint32_t
+OnesComplementSum (const uint8_t *data, uint32_t size)
+{
+  uint64_t sum = 0;
+  while (size >= 8)
+    {
+      sum += data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t> (data[3]) << 24);
+      sum += data[4] | (data[5] << 8) | (data[6] << 16) | (static_cast<uint32_t> (data[7]) << 24);
+      data += 8;
+      size -= 8;
+    }
+  while (size >= 2)
+    {
+      sum += data[0] | (data[1] << 8);
+      data += 2;
+      size -= 2;
+    }
+  if (size)
+    {
+      sum += data[0];
+    }
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return static_cast<uint32_t> (sum);
+}
+
 }
 
 namespace ns3 {
@@ -1140,14 +1182,35 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
-  /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  /*
+   * See RFC 1071 to understand this code.  The bytes are summed as the
+   * little-endian 16-bit words ReadU16 would return, one contiguous area
+   * at a time: the bytes before the zero area and those after it.  The sum
+   * of an area starting at an odd offset is byte-swapped, as its bytes
+   * belong to the other half of their words.
+   */
+  uint64_t sum = initialChecksum;
+  uint32_t end = m_current + size;
+  if (m_current < m_zeroStart)
+    {
+      uint32_t areaEnd = std::min (end, m_zeroStart);
+      sum += OnesComplementSum (m_data + m_current, areaEnd - m_current);
+    }
+  if (end > m_zeroEnd)
+    {
+      uint32_t areaStart = std::max (m_current, m_zeroEnd);
+      uint32_t partial = OnesComplementSum (m_data + areaStart - (m_zeroEnd - m_zeroStart),
+                                            end - areaStart);
+      if ((areaStart - m_current) & 1)
+        {
+          partial = ((partial & 0xff) << 8) | (partial >> 8);
+        }
+      sum += partial;
+    }
+  m_current = end;
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
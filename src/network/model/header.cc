@@ -42,6 +42,12 @@ Header::GetTypeId (void)
   return tid;
 }
 
+bool
+Header::IsCacheable (void) const
+{
+  return true;
+}
+
 std::ostream & operator << (std::ostream &os, const Header &header)
 {
   header.Print (os);
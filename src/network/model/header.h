@@ -101,6 +101,18 @@ public:
    * i.e.: (field1 val1 field2 val2 field3 val3) field4 val4 field5 val5
    */
   virtual void Print (std::ostream &os) const = 0;
+  /**
+   * \returns true if a packet may return a copy of this header from its
+   *          header cache, false if it must deserialize the header.
+   *
+   * A cache hit replaces the whole header with the copy first parsed, so
+   * headers whose deserialization depends on state set by the caller
+   * beforehand (e.g., checksum verification) must return false while that
+   * state is set.  The default implementation returns true.
+   *
+   * \sa Packet::EnableHeaderCache
+   */
+  virtual bool IsCacheable (void) const;
 };
 
 
@@ -359,6 +359,14 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \return true if this interface accepts the super-segments larger than
+   * its MTU (see SegmentationOffloadTag) and transmits their wire segments
+   * (see SegmentationOffload), false otherwise. The default implementation
+   * returns false.
+   */
+  virtual bool SupportsSegmentationOffload (void) const;
+
 };
 
 } // namespace ns3
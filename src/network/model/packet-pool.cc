@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "packet-pool.h"
+#include "packet.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketPool");
+
+PacketPool::PacketPool (uint32_t maxPackets)
+  : m_maxPackets (maxPackets),
+    m_nAllocated (0),
+    m_nRecycled (0)
+{
+  NS_LOG_FUNCTION (this << maxPackets);
+}
+
+PacketPool::~PacketPool ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Packet *>::iterator i = m_free.begin (); i != m_free.end (); ++i)
+    {
+      delete *i;
+    }
+}
+
+Ptr<Packet>
+PacketPool::Allocate (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  if (m_free.empty ())
+    {
+      m_nAllocated++;
+      Ptr<Packet> packet = Create<Packet> (size);
+      packet->m_pool = this;
+      return packet;
+    }
+  m_nRecycled++;
+  Packet *packet = m_free.back ();
+  m_free.pop_back ();
+  packet->Reinitialize (size);
+  packet->m_pool = this;
+  // The reference count of a recycled packet dropped to zero.
+  return Ptr<Packet> (packet, true);
+}
+
+Ptr<Packet>
+PacketPool::Copy (const Packet &packet)
+{
+  NS_LOG_FUNCTION (this << &packet);
+  if (m_free.empty ())
+    {
+      m_nAllocated++;
+      Ptr<Packet> copy = Ptr<Packet> (new Packet (packet), false);
+      copy->m_pool = this;
+      return copy;
+    }
+  m_nRecycled++;
+  Packet *copy = m_free.back ();
+  m_free.pop_back ();
+  *copy = packet;
+  copy->m_pool = this;
+  return Ptr<Packet> (copy, true);
+}
+
+void
+PacketPool::Reserve (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  n = std::min (n, m_maxPackets);
+  m_free.reserve (n);
+  while (m_free.size () < n)
+    {
+      // The private constructor does not use up a packet uid: the packet
+      // gets one when it is allocated.
+      Ptr<Packet> packet = Ptr<Packet> (new Packet (Buffer (), ByteTagList (), PacketTagList (),
+                                                    PacketMetadata (0, 0)), false);
+      packet->m_pool = this;
+      m_nAllocated++;
+      // Dropping the last reference hands the packet to the pool.
+    }
+}
+
+uint32_t
+PacketPool::GetNPackets (void) const
+{
+  return m_free.size ();
+}
+
+uint64_t
+PacketPool::GetNAllocated (void) const
+{
+  return m_nAllocated;
+}
+
+uint64_t
+PacketPool::GetNRecycled (void) const
+{
+  return m_nRecycled;
+}
+
+void
+PacketPool::Recycle (Packet *packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  if (m_free.size () < m_maxPackets)
+    {
+      m_free.push_back (packet);
+    }
+  else
+    {
+      delete packet;
+    }
+}
+
+} // namespace ns3
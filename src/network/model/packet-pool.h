@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup packet
+ * \brief A pool of packets recycled once they are no longer referenced
+ *
+ * Applications which generate packets at a high rate can allocate them
+ * from a pool rather than with Create<Packet>: the Packet objects are
+ * handed back to the pool when their last reference goes away, and the
+ * next call to Allocate reuses them instead of going through the heap.
+ * A packet allocated from a pool is in every other respect a new packet:
+ * it has a new uid, a zero-filled payload, no tags and no metadata.
+ * Its copies (see Packet::Copy), which the protocol stacks make on
+ * the way, are allocated from the same pool; its fragments are regular
+ * packets.
+ *
+ * The packets which are in use keep their pool alive.
+ */
+class PacketPool : public SimpleRefCount<PacketPool>
+{
+public:
+  /**
+   * \brief Constructor
+   * \param maxPackets the maximum number of unused packets kept by the pool
+   */
+  PacketPool (uint32_t maxPackets);
+  ~PacketPool ();
+
+  /**
+   * \brief Allocate a packet with a zero-filled payload
+   *
+   * The packet is a recycled one if the pool has any, a new one otherwise.
+   *
+   * \param size the size of the zero-filled payload
+   * \returns the packet
+   */
+  Ptr<Packet> Allocate (uint32_t size);
+
+  /**
+   * \brief Pre-allocate packets, up to the maximum number of unused packets
+   * \param n the number of unused packets the pool should hold
+   */
+  void Reserve (uint32_t n);
+
+  /**
+   * \returns the number of unused packets held by the pool
+   */
+  uint32_t GetNPackets (void) const;
+
+  /**
+   * \returns the number of packets the pool allocated on the heap
+   */
+  uint64_t GetNAllocated (void) const;
+
+  /**
+   * \returns the number of times the pool returned a recycled packet
+   */
+  uint64_t GetNRecycled (void) const;
+
+private:
+  friend class Packet;
+  friend struct PacketDeleter;
+
+  /**
+   * \brief Copy a packet allocated from this pool
+   * \param packet the packet
+   * \returns the copy
+   */
+  Ptr<Packet> Copy (const Packet &packet);
+
+  /**
+   * \brief Hand back a packet which is no longer referenced
+   * \param packet the packet
+   */
+  void Recycle (Packet *packet);
+
+  uint32_t m_maxPackets;          //!< the maximum number of unused packets
+  std::vector<Packet *> m_free;   //!< the unused packets
+  uint64_t m_nAllocated;          //!< the number of packets allocated on the heap
+  uint64_t m_nRecycled;           //!< the number of recycled packets returned
+};
+
+} // namespace ns3
+
+#endif /* PACKET_POOL_H */
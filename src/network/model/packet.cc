@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "packet.h"
+#include "packet-pool.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -29,6 +30,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
 uint32_t Packet::m_globalUid = 0;
+bool Packet::m_headerCacheEnabled = false;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -120,6 +122,10 @@ PacketTagIterator::Item::GetTag (Tag &tag) const
 Ptr<Packet> 
 Packet::Copy (void) const
 {
+  if (m_pool != 0)
+    {
+      return m_pool->Copy (*this);
+    }
   // we need to invoke the copy constructor directly
   // rather than calling Create because the copy constructor
   // is private.
@@ -146,12 +152,18 @@ Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
-    m_metadata (o.m_metadata)
+    m_metadata (o.m_metadata),
+    m_headerCache (o.m_headerCache),
+    m_pool (0)
 {
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
 }
 
+Packet::~Packet ()
+{
+}
+
 Packet &
 Packet::operator = (const Packet &o)
 {
@@ -163,6 +175,7 @@ Packet::operator = (const Packet &o)
   m_byteTagList = o.m_byteTagList;
   m_packetTagList = o.m_packetTagList;
   m_metadata = o.m_metadata;
+  m_headerCache = o.m_headerCache;
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
     : m_nixVector = 0;
   return *this;
@@ -183,6 +196,18 @@ Packet::Packet (uint32_t size)
 {
   m_globalUid++;
 }
+void
+Packet::Reinitialize (uint32_t size)
+{
+  m_buffer = Buffer (size);
+  m_byteTagList.RemoveAll ();
+  m_packetTagList.RemoveAll ();
+  m_metadata = PacketMetadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size);
+  m_nixVector = 0;
+  m_headerCache = 0;
+  m_globalUid++;
+}
+
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
     m_byteTagList (),
@@ -223,6 +248,20 @@ Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList,
 {
 }
 
+void
+PacketDeleter::Delete (Packet *packet)
+{
+  if (packet->m_pool == 0)
+    {
+      delete packet;
+      return;
+    }
+  // The packet no longer keeps its pool alive once it is back in it.
+  Ptr<PacketPool> pool = packet->m_pool;
+  packet->m_pool = 0;
+  pool->Recycle (packet);
+}
+
 Ptr<Packet>
 Packet::CreateFragment (uint32_t start, uint32_t length) const
 {
@@ -257,6 +296,10 @@ Packet::AddHeader (const Header &header)
 {
   uint32_t size = header.GetSerializedSize ();
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+  if (m_headerCache)
+    {
+      InvalidateHeaderCache (m_buffer.GetSize ());
+    }
   m_buffer.AddAtStart (size);
   m_byteTagList.Adjust (size);
   m_byteTagList.AddAtStart (size);
@@ -286,6 +329,48 @@ Packet::RemoveHeader (Header &header)
   m_metadata.RemoveHeader (header, deserialized);
   return deserialized;
 }
+void
+Packet::RemoveCachedHeader (const Header &header, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+  m_buffer.RemoveAtStart (size);
+  m_byteTagList.Adjust (-size);
+  m_metadata.RemoveHeader (header, size);
+}
+void
+Packet::InvalidateHeaderCache (uint32_t size)
+{
+  //
+  // The copies of the headers that started beyond the current start of
+  // the packet are about to be overwritten.  The list is shared with other
+  // packets, so the entries kept are relinked rather than unlinked.
+  //
+  CachedHeaderBase *e = PeekPointer (m_headerCache);
+  while (e != 0 && e->m_offset <= size)
+    {
+      e = PeekPointer (e->m_next);
+    }
+  if (e == 0)
+    {
+      return;
+    }
+  CachedHeaderBase *kept[HEADER_CACHE_MAX];
+  uint32_t n = 0;
+  for (e = PeekPointer (m_headerCache); e != 0 && n < HEADER_CACHE_MAX; e = PeekPointer (e->m_next))
+    {
+      if (e->m_offset <= size)
+        {
+          kept[n++] = e;
+        }
+    }
+  Ptr<CachedHeaderBase> list = 0;
+  while (n > 0)
+    {
+      n--;
+      list = kept[n]->m_next == list ? Ptr<CachedHeaderBase> (kept[n]) : kept[n]->Relink (list);
+    }
+  m_headerCache = list;
+}
 uint32_t
 Packet::PeekHeader (Header &header) const
 {
@@ -307,6 +392,7 @@ void
 Packet::AddTrailer (const Trailer &trailer)
 {
   uint32_t size = trailer.GetSerializedSize ();
+  m_headerCache = 0;
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << size);
   m_byteTagList.AddAtEnd (GetSize ());
   m_buffer.AddAtEnd (size);
@@ -318,6 +404,7 @@ uint32_t
 Packet::RemoveTrailer (Trailer &trailer)
 {
   uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
+  m_headerCache = 0;
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtEnd (deserialized);
   m_metadata.RemoveTrailer (trailer, deserialized);
@@ -335,6 +422,7 @@ void
 Packet::AddAtEnd (Ptr<const Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet << packet->GetSize ());
+  m_headerCache = 0;
   m_byteTagList.AddAtEnd (GetSize ());
   ByteTagList copy = packet->m_byteTagList;
   copy.AddAtStart (0);
@@ -347,6 +435,7 @@ void
 Packet::AddPaddingAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  m_headerCache = 0;
   m_byteTagList.AddAtEnd (GetSize ());
   m_buffer.AddAtEnd (size);
   m_metadata.AddPaddingAtEnd (size);
@@ -355,6 +444,7 @@ void
 Packet::RemoveAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  m_headerCache = 0;
   m_buffer.RemoveAtEnd (size);
   m_metadata.RemoveAtEnd (size);
 }
@@ -582,6 +672,31 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableHeaderCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_headerCacheEnabled = true;
+}
+
+void
+Packet::DisableHeaderCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_headerCacheEnabled = false;
+}
+
+Packet::CachedHeaderBase::CachedHeaderBase (uint32_t offset, uint32_t size, Ptr<CachedHeaderBase> next)
+  : m_offset (offset),
+    m_size (size),
+    m_next (next)
+{
+}
+
+Packet::CachedHeaderBase::~CachedHeaderBase ()
+{
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
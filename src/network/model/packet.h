@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <typeinfo>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -39,6 +40,24 @@ namespace ns3 {
 
 // Forward declaration
 class Address;
+class Packet;
+class PacketPool;
+
+/**
+ * \ingroup packet
+ * \brief Deleter of the packets, see SimpleRefCount
+ *
+ * The packets allocated by a PacketPool are handed back to their pool
+ * rather than deleted.
+ */
+struct PacketDeleter
+{
+  /**
+   * \brief Delete or recycle a packet which is no longer referenced
+   * \param packet the packet
+   */
+  static void Delete (Packet *packet);
+};
   
 /**
  * \ingroup network
@@ -228,7 +247,7 @@ private:
  * The performance aspects copy-on-write semantics of the
  * Packet API are discussed in \ref packetperf
  */
-class Packet : public SimpleRefCount<Packet>
+class Packet : public SimpleRefCount<Packet, empty, PacketDeleter>
 {
 public:
 
@@ -248,6 +267,10 @@ public:
    * \return the copied object
    */
   Packet &operator = (const Packet &o);
+  /**
+   * \brief Destructor
+   */
+  ~Packet ();
   /**
    * \brief Create a packet with a zero-filled payload.
    *
@@ -356,6 +379,37 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header, uint32_t size) const;
+  /**
+   * \brief Remove the header from the internal buffer, taking it from the
+   * header cache if it is enabled and holds it.
+   *
+   * This overload is selected for all concrete header types and behaves
+   * as RemoveHeader (Header &) when the cache is disabled.
+   *
+   * \tparam T \explicit the header type
+   * \param header a reference to the header to remove from the internal buffer.
+   * \returns the number of bytes removed from the packet.
+   *
+   * \sa EnableHeaderCache
+   */
+  template <typename T>
+  uint32_t RemoveHeader (T &header);
+  /**
+   * \brief Read the header without removing it, taking it from the header
+   * cache if it is enabled and holds it.  Otherwise the header is
+   * deserialized and, if the cache is enabled, a copy is recorded.
+   *
+   * This overload is selected for all concrete header types and behaves
+   * as PeekHeader (Header &) when the cache is disabled.
+   *
+   * \tparam T \explicit the header type
+   * \param header a reference to the header to read from the internal buffer.
+   * \returns the number of bytes read from the packet.
+   *
+   * \sa EnableHeaderCache
+   */
+  template <typename T>
+  uint32_t PeekHeader (T &header) const;
   /**
    * \brief Add trailer to this packet.
    *
@@ -449,7 +503,8 @@ public:
    *
    * The returns packet will behave like an independent copy of
    * the original packet, even though they both share the
-   * same datasets internally.
+   * same datasets internally. The copy of a packet allocated
+   * by a PacketPool is allocated by the same pool.
    */
   Ptr<Packet> Copy (void) const;
 
@@ -530,6 +585,37 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the per-packet cache of parsed headers.
+   *
+   * Along a forwarding path the same headers are peeked and removed many
+   * times (IP and transport headers by the L3 protocols, the queue disc
+   * classifiers, the flow monitor, ...), each time deserializing them
+   * from the buffer.  With the header cache, every packet keeps copies of
+   * the headers peeked at, keyed by header type and by the offset of the
+   * header from the end of the packet, and PeekHeader and RemoveHeader
+   * return those copies instead of parsing again.  Copies of a packet
+   * share its cache.  The copies are dropped when the bytes they describe
+   * are overwritten by AddHeader or when the end of the packet changes.
+   *
+   * Only the RemoveHeader and PeekHeader overloads taking a concrete
+   * header type use the cache; the overloads taking a Header reference or
+   * a size do not.  A cached header is returned as it was first parsed, so
+   * the cache is skipped for the headers whose Header::IsCacheable returns
+   * false, such as the IPv4, ICMPv4, TCP and UDP headers whose checksum
+   * was enabled by the caller.
+   *
+   * Like EnablePrinting, this method should be invoked during the
+   * simulation setup, before any packet is created.
+   */
+  static void EnableHeaderCache (void);
+  /**
+   * \brief Disable the per-packet cache of parsed headers.
+   *
+   * Headers already cached stay attached to their packets and are kept
+   * consistent, so the cache can be enabled again later.
+   */
+  static void DisableHeaderCache (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -779,6 +865,98 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Base class of the header copies held by the header cache.
+   *
+   * The cache of a packet is an immutable list of such copies, so that
+   * packet copies can share it and extend it independently.
+   */
+  class CachedHeaderBase : public SimpleRefCount<CachedHeaderBase>
+  {
+public:
+    /**
+     * \param offset distance from the start of the header to the end of the packet
+     * \param size serialized size of the header
+     * \param next the rest of the list
+     */
+    CachedHeaderBase (uint32_t offset, uint32_t size, Ptr<CachedHeaderBase> next);
+    virtual ~CachedHeaderBase ();
+    /**
+     * \param next the rest of the list
+     * \returns a copy of this entry followed by another list
+     */
+    virtual Ptr<CachedHeaderBase> Relink (Ptr<CachedHeaderBase> next) const = 0;
+
+    uint32_t m_offset;                 //!< distance from the header start to the packet end
+    uint32_t m_size;                   //!< serialized size of the header
+    Ptr<CachedHeaderBase> m_next;      //!< the rest of the list
+  };
+
+  /**
+   * \brief A header copy held by the header cache.
+   * \tparam T the header type
+   */
+  template <typename T>
+  class CachedHeader : public CachedHeaderBase
+  {
+public:
+    /**
+     * \param header the header
+     * \param offset distance from the start of the header to the end of the packet
+     * \param size serialized size of the header
+     * \param next the rest of the list
+     */
+    CachedHeader (const T &header, uint32_t offset, uint32_t size, Ptr<CachedHeaderBase> next)
+      : CachedHeaderBase (offset, size, next),
+        m_header (header)
+    {
+    }
+    virtual Ptr<CachedHeaderBase> Relink (Ptr<CachedHeaderBase> next) const
+    {
+      return Ptr<CachedHeaderBase> (new CachedHeader<T> (m_header, m_offset, m_size, next), false);
+    }
+
+    T m_header;                        //!< the header copy
+  };
+
+  /// Maximum number of header copies recorded by PeekHeader
+  static const uint32_t HEADER_CACHE_MAX = 8;
+
+  /**
+   * \brief Look up a header at the start of the packet in the header cache.
+   * \tparam T the header type
+   * \param [out] n the number of entries of the cache, if not found
+   * \returns the cached header, or 0
+   */
+  template <typename T>
+  CachedHeader<T> const *FindCachedHeader (uint32_t &n) const;
+
+  /**
+   * \brief Remove a header whose copy was found in the header cache.
+   * \param header the header copy
+   * \param size the serialized size of the header
+   */
+  void RemoveCachedHeader (const Header &header, uint32_t size);
+
+  /**
+   * \brief Drop the header copies overwritten when the packet grows at
+   * its start.
+   * \param size the size of the packet before it grew
+   */
+  void InvalidateHeaderCache (uint32_t size);
+
+  /**
+   * \brief Give a recycled packet the state of a new packet, see PacketPool
+   *
+   * The packet gets a new uid and a zero-filled payload.
+   *
+   * \param size the size of the zero-filled payload
+   */
+  void Reinitialize (uint32_t size);
+
+  friend struct PacketDeleter;
+  friend class PacketPool;
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -787,7 +965,14 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
+  /// Copies of the headers of the packet, see EnableHeaderCache
+  mutable Ptr<CachedHeaderBase> m_headerCache;
+
+  /// The pool the packet is handed back to, if any
+  Ptr<PacketPool> m_pool;
+
   static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static bool m_headerCacheEnabled; //!< Whether the header cache is enabled
 };
 
 /**
@@ -854,6 +1039,65 @@ Packet::GetSize (void) const
   return m_buffer.GetSize ();
 }
 
+template <typename T>
+Packet::CachedHeader<T> const *
+Packet::FindCachedHeader (uint32_t &n) const
+{
+  uint32_t offset = m_buffer.GetSize ();
+  n = 0;
+  for (CachedHeaderBase const *e = PeekPointer (m_headerCache); e != 0; e = PeekPointer (e->m_next))
+    {
+      if (e->m_offset == offset && typeid (*e) == typeid (CachedHeader<T>))
+        {
+          return static_cast<CachedHeader<T> const *> (e);
+        }
+      n++;
+    }
+  return 0;
+}
+
+template <typename T>
+uint32_t
+Packet::RemoveHeader (T &header)
+{
+  if (m_headerCacheEnabled && header.IsCacheable ())
+    {
+      uint32_t n;
+      CachedHeader<T> const *e = FindCachedHeader<T> (n);
+      if (e != 0)
+        {
+          uint32_t size = e->m_size;
+          header = e->m_header;
+          RemoveCachedHeader (header, size);
+          return size;
+        }
+    }
+  return RemoveHeader (static_cast<Header &> (header));
+}
+
+template <typename T>
+uint32_t
+Packet::PeekHeader (T &header) const
+{
+  if (!m_headerCacheEnabled || !header.IsCacheable ())
+    {
+      return PeekHeader (static_cast<Header &> (header));
+    }
+  uint32_t n;
+  CachedHeader<T> const *e = FindCachedHeader<T> (n);
+  if (e != 0)
+    {
+      header = e->m_header;
+      return e->m_size;
+    }
+  uint32_t size = PeekHeader (static_cast<Header &> (header));
+  if (n < HEADER_CACHE_MAX)
+    {
+      m_headerCache = Ptr<CachedHeaderBase> (new CachedHeader<T> (header, m_buffer.GetSize (), size, m_headerCache), false);
+    }
+  return size;
+}
+
 } // namespace ns3
 
 #endif /* PACKET_H */
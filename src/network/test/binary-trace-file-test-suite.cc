@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <sstream>
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/binary-trace-file.h"
+#include "ns3/trace-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("binary-trace-file-test-suite");
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case checking that the AsciiTraceHelper default sinks,
+ * redirected to a binary trace file, can be converted back to the very
+ * text they would have printed.
+ */
+class BinaryTraceFileTestCase : public TestCase
+{
+public:
+  BinaryTraceFileTestCase ();
+  virtual ~BinaryTraceFileTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Fire the same events on a text and a binary stream.
+   * \param text the text stream
+   * \param binary the binary stream
+   */
+  void Fire (Ptr<OutputStreamWrapper> text, Ptr<OutputStreamWrapper> binary);
+
+  std::string m_testFilename; //!< File name
+};
+
+BinaryTraceFileTestCase::BinaryTraceFileTestCase ()
+  : TestCase ("Check to see that binary traces convert back to the ascii traces")
+{
+}
+
+BinaryTraceFileTestCase::~BinaryTraceFileTestCase ()
+{
+}
+
+void
+BinaryTraceFileTestCase::DoSetup (void)
+{
+  m_testFilename = CreateTempDirFilename ("binary-trace.bin");
+}
+
+void
+BinaryTraceFileTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+BinaryTraceFileTestCase::Fire (Ptr<OutputStreamWrapper> text, Ptr<OutputStreamWrapper> binary)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  LlcSnapHeader llc;
+  llc.SetType (0x0800);
+  p->AddHeader (llc);
+  std::string context = "/NodeList/3/DeviceList/1/TxQueue/Enqueue";
+
+  AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (text, p);
+  AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (binary, p);
+  AsciiTraceHelper::DefaultDequeueSinkWithContext (text, context, p);
+  AsciiTraceHelper::DefaultDequeueSinkWithContext (binary, context, p);
+  AsciiTraceHelper::DefaultDropSinkWithoutContext (text, p);
+  AsciiTraceHelper::DefaultDropSinkWithoutContext (binary, p);
+  AsciiTraceHelper::DefaultReceiveSinkWithContext (text, context, p);
+  AsciiTraceHelper::DefaultReceiveSinkWithContext (binary, context, p);
+  *text->GetStream () << "custom line " << 42 << std::endl;
+  *binary->GetStream () << "custom line " << 42 << std::endl;
+}
+
+void
+BinaryTraceFileTestCase::DoRun (void)
+{
+  Packet::EnablePrinting ();
+
+  std::ostringstream expected;
+  Ptr<OutputStreamWrapper> text = Create<OutputStreamWrapper> (&expected);
+
+  AsciiTraceHelper asciiTraceHelper;
+  // A small block size makes the events span several blocks
+  Ptr<BinaryTraceFile> file = Create<BinaryTraceFile> (m_testFilename, true, 3);
+  AsciiTraceHelper::SetBinaryTraceFile (file);
+  Ptr<OutputStreamWrapper> binary = asciiTraceHelper.CreateFileStream ("trace-3-1.tr");
+  NS_TEST_ASSERT_MSG_EQ ((binary->GetBinaryTraceFile () == file), true, "Stream must record to the binary trace file");
+
+  Simulator::Schedule (MilliSeconds (1), &BinaryTraceFileTestCase::Fire, this, text, binary);
+  Simulator::Schedule (Seconds (1.5) + NanoSeconds (1), &BinaryTraceFileTestCase::Fire, this, text, binary);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ ((AsciiTraceHelper::GetBinaryTraceFile () == 0), true, "Binary trace file must be released on Simulator::Destroy");
+  binary = 0;
+  file = 0;
+
+  BinaryTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (m_testFilename), true, "Unable to open " << m_testFilename);
+  NS_TEST_EXPECT_MSG_EQ (reader.HasHeaders (), true, "Headers must be stored");
+
+  std::ostringstream converted;
+  BinaryTraceRecord record;
+  uint32_t n = 0;
+  while (reader.Read (record))
+    {
+      NS_TEST_EXPECT_MSG_EQ (reader.GetSourceName (record.source), "trace-3-1.tr", "Unexpected source");
+      NS_TEST_EXPECT_MSG_EQ (record.node, 3, "Unexpected node");
+      NS_TEST_EXPECT_MSG_EQ (record.device, 1, "Unexpected device");
+      if (record.event != BinaryTraceFile::TEXT)
+        {
+          NS_TEST_EXPECT_MSG_EQ (record.size, 108, "Unexpected packet size");
+        }
+      reader.PrintAscii (record, converted);
+      n++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (reader.Fail (), false, "Binary trace file must be well formed");
+  NS_TEST_EXPECT_MSG_EQ (n, 10, "Unexpected number of records");
+  NS_TEST_EXPECT_MSG_EQ (converted.str (), expected.str (), "Converted traces differ from the ascii traces");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary trace file TestSuite
+ */
+class BinaryTraceFileTestSuite : public TestSuite
+{
+public:
+  BinaryTraceFileTestSuite ();
+};
+
+BinaryTraceFileTestSuite::BinaryTraceFileTestSuite ()
+  : TestSuite ("binary-trace-file", UNIT)
+{
+  AddTestCase (new BinaryTraceFileTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceFileTestSuite binaryTraceFileTestSuite; //!< Static variable for test initialization
@@ -389,6 +389,82 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer::Iterator::CalculateIpChecksum unit tests.
+ */
+class BufferChecksumTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer IP checksum")
+{
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  // Areas of real bytes before and after a zero area, of all parities
+  for (uint32_t before = 0; before < 20; before += 3)
+    {
+      for (uint32_t zeroes = 0; zeroes < 4; zeroes++)
+        {
+          for (uint32_t after = 0; after < 20; after += 5)
+            {
+              Buffer buffer (zeroes);
+              buffer.AddAtStart (before);
+              buffer.AddAtEnd (after);
+              Buffer::Iterator i = buffer.Begin ();
+              for (uint32_t j = 0; j < before; j++)
+                {
+                  i.WriteU8 (0xf1 - 7 * j);
+                }
+              i.Next (zeroes);
+              for (uint32_t j = 0; j < after; j++)
+                {
+                  i.WriteU8 (0x3d + 11 * j);
+                }
+
+              uint32_t total = before + zeroes + after;
+              for (uint32_t start = 0; start < 3 && start <= total; start++)
+                {
+                  uint16_t size = total - start;
+                  // reference: the word by word sum
+                  i = buffer.Begin ();
+                  i.Next (start);
+                  uint32_t sum = 0xfff0;
+                  for (uint32_t j = 0; j < size / 2u; j++)
+                    {
+                      sum += i.ReadU16 ();
+                    }
+                  if (size & 1)
+                    {
+                      sum += i.ReadU8 ();
+                    }
+                  while (sum >> 16)
+                    {
+                      sum = (sum & 0xffff) + (sum >> 16);
+                    }
+                  uint16_t expected = ~sum;
+
+                  i = buffer.Begin ();
+                  i.Next (start);
+                  uint16_t checksum = i.CalculateIpChecksum (size, 0xfff0);
+                  NS_TEST_EXPECT_MSG_EQ (checksum, expected, "Bad checksum with " << before << " bytes, "
+                                         << zeroes << " zeroes and " << after << " bytes from offset " << start);
+                  NS_TEST_EXPECT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), total,
+                                         "The iterator must be advanced");
+                }
+            }
+        }
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -405,6 +481,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
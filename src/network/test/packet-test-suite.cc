@@ -18,9 +18,11 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/packet.h"
+#include "ns3/packet-pool.h"
 #include "ns3/packet-tag-list.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
+#include <algorithm>
 #include <limits>     // std:numeric_limits
 #include <string>
 #include <cstdarg>
@@ -1035,6 +1037,206 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Header counting its deserializations
+ *
+ * \note Class internal to packet-test-suite.cc
+ */
+class CountingHeader : public Header
+{
+public:
+  /**
+   * Constructor
+   * \param value the header value
+   */
+  CountingHeader (uint8_t value = 0) : m_value (value), m_caller (0) {}
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("anon::CountingHeader")
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<CountingHeader> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return 1;
+  }
+  virtual void Serialize (Buffer::Iterator iter) const {
+    iter.WriteU8 (m_value);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator iter) {
+    m_value = iter.ReadU8 ();
+    m_count++;
+    return 1;
+  }
+  virtual void Print (std::ostream &os) const {
+  }
+  virtual bool IsCacheable (void) const {
+    return m_caller == 0;
+  }
+
+  uint8_t m_value;            //!< The header value
+  uint8_t m_caller;           //!< State set by the caller, not serialized
+  static uint32_t m_count;    //!< Number of deserializations
+};
+
+uint32_t CountingHeader::m_count = 0;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Packet header cache Test
+ */
+class PacketHeaderCacheTest : public TestCase
+{
+public:
+  PacketHeaderCacheTest ();
+private:
+  void DoRun (void);
+};
+
+PacketHeaderCacheTest::PacketHeaderCacheTest ()
+  : TestCase ("Packet header cache")
+{
+}
+
+void
+PacketHeaderCacheTest::DoRun (void)
+{
+  Packet::EnableHeaderCache ();
+
+  Ptr<Packet> p = Create<Packet> (10);
+  p->AddHeader (CountingHeader (7));
+  CountingHeader::m_count = 0;
+
+  CountingHeader h;
+  NS_TEST_EXPECT_MSG_EQ (p->PeekHeader (h), 1, "Unexpected header size");
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 7, "Unexpected header value");
+  NS_TEST_EXPECT_MSG_EQ (CountingHeader::m_count, 1, "Header must be parsed");
+  CountingHeader other;
+  p->PeekHeader (other);
+  NS_TEST_EXPECT_MSG_EQ (other.m_value, 7, "Unexpected header value");
+  NS_TEST_EXPECT_MSG_EQ (CountingHeader::m_count, 1, "Parsed header must be cached");
+
+  // copies share the cache, but extend it independently
+  Ptr<Packet> q = p->Copy ();
+  NS_TEST_EXPECT_MSG_EQ (q->RemoveHeader (h), 1, "Unexpected header size");
+  NS_TEST_EXPECT_MSG_EQ (q->GetSize (), 10, "Header must be removed");
+  NS_TEST_EXPECT_MSG_EQ (CountingHeader::m_count, 1, "Parsed header must be cached");
+  q->AddHeader (CountingHeader (9));
+  q->PeekHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 9, "Overwritten header must not be cached");
+  NS_TEST_EXPECT_MSG_EQ (CountingHeader::m_count, 2, "Header must be parsed");
+  p->PeekHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 7, "Unexpected header value");
+  q->PeekHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 9, "Unexpected header value");
+  NS_TEST_EXPECT_MSG_EQ (CountingHeader::m_count, 2, "Parsed headers must be cached");
+
+  // changing the end of the packet drops the cache
+  p->AddPaddingAtEnd (1);
+  p->PeekHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 7, "Unexpected header value");
+  NS_TEST_EXPECT_MSG_EQ (CountingHeader::m_count, 3, "Header must be parsed");
+
+  // headers holding state set by the caller are not taken from the cache
+  CountingHeader stateful;
+  stateful.m_caller = 5;
+  p->PeekHeader (stateful);
+  NS_TEST_EXPECT_MSG_EQ (stateful.m_value, 7, "Unexpected header value");
+  NS_TEST_EXPECT_MSG_EQ (stateful.m_caller, 5, "Caller state must be kept");
+  NS_TEST_EXPECT_MSG_EQ (CountingHeader::m_count, 4, "Header must be parsed");
+  p->RemoveHeader (stateful);
+  NS_TEST_EXPECT_MSG_EQ (stateful.m_caller, 5, "Caller state must be kept");
+  NS_TEST_EXPECT_MSG_EQ (CountingHeader::m_count, 5, "Header must be parsed");
+  p->AddHeader (CountingHeader (7));
+
+  Packet::DisableHeaderCache ();
+  p->PeekHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (CountingHeader::m_count, 6, "Header must be parsed");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Packet pool Test
+ */
+class PacketPoolTest : public TestCase
+{
+public:
+  PacketPoolTest ();
+private:
+  void DoRun (void);
+};
+
+PacketPoolTest::PacketPoolTest ()
+  : TestCase ("Packet pool")
+{
+}
+
+void
+PacketPoolTest::DoRun (void)
+{
+  Ptr<PacketPool> pool = Create<PacketPool> (2);
+  pool->Reserve (3);
+  NS_TEST_EXPECT_MSG_EQ (pool->GetNPackets (), 2, "Pool must not exceed its size");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetNAllocated (), 2, "Unexpected number of allocations");
+
+  Ptr<Packet> p = pool->Allocate (100);
+  uint64_t uid = p->GetUid ();
+  Packet *raw = PeekPointer (p);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 100, "Unexpected packet size");
+  p->AddHeader (CountingHeader (7));
+  p->AddByteTag (ATestTag<1> ());
+  p->AddPacketTag (ATestTag<2> ());
+  Ptr<Packet> copy = p->Copy ();
+  NS_TEST_EXPECT_MSG_EQ (pool->GetNPackets (), 0, "Copies must be allocated from the pool");
+  NS_TEST_EXPECT_MSG_EQ (copy->GetUid (), uid, "Copies must keep the uid");
+  NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), 101, "Unexpected copy size");
+  Ptr<Packet> fragment = p->CreateFragment (0, 10);
+  fragment = 0;
+  NS_TEST_EXPECT_MSG_EQ (pool->GetNPackets (), 0, "Fragments must not be pooled");
+  copy = 0;
+  p = 0;
+  NS_TEST_EXPECT_MSG_EQ (pool->GetNPackets (), 2, "Released packets must be back in the pool");
+
+  // recycled packets are brand new packets
+  p = pool->Allocate (50);
+  NS_TEST_EXPECT_MSG_EQ ((PeekPointer (p) == raw), true, "Packet must be recycled");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetNRecycled (), 3, "Unexpected number of recycled packets");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 50, "Unexpected packet size");
+  NS_TEST_EXPECT_MSG_NE (p->GetUid (), uid, "Recycled packet must get a new uid");
+  NS_TEST_EXPECT_MSG_EQ (p->GetByteTagIterator ().HasNext (), false, "Byte tags must be removed");
+  NS_TEST_EXPECT_MSG_EQ (p->GetPacketTagIterator ().HasNext (), false, "Packet tags must be removed");
+  uint8_t bytes[50];
+  p->CopyData (bytes, 50);
+  NS_TEST_EXPECT_MSG_EQ (std::count (bytes, bytes + 50, 0), 50, "Payload must be zero-filled");
+
+  // packets in use keep the pool alive
+  Ptr<Packet> q = pool->Allocate (10);
+  Ptr<Packet> r = pool->Allocate (10);
+  NS_TEST_EXPECT_MSG_EQ (pool->GetNPackets (), 0, "Pool must be empty");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetNAllocated (), 3, "Empty pool must allocate packets");
+  pool = 0;
+  p = 0;
+  q = 0;
+  r = 0;
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1254,8 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketHeaderCacheTest, TestCase::QUICK);
+  AddTestCase (new PacketPoolTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
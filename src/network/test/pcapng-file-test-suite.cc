@@ -0,0 +1,255 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/pcapng-file.h"
+#include "ns3/pcapng-file-wrapper.h"
+#include "ns3/trace-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("pcapng-file-test-suite");
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case checking that packets of several interfaces written
+ * to a single PcapNgFile are read back on the right interface, with
+ * their timestamps and data.
+ */
+class PcapNgReadWriteTestCase : public TestCase
+{
+public:
+  PcapNgReadWriteTestCase ();
+  virtual ~PcapNgReadWriteTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename; //!< File name
+};
+
+PcapNgReadWriteTestCase::PcapNgReadWriteTestCase ()
+  : TestCase ("Check to see that PcapNgFile writes and reads back multiple interfaces")
+{
+}
+
+PcapNgReadWriteTestCase::~PcapNgReadWriteTestCase ()
+{
+}
+
+void
+PcapNgReadWriteTestCase::DoSetup (void)
+{
+  m_testFilename = CreateTempDirFilename ("pcapng-read-write.pcapng");
+}
+
+void
+PcapNgReadWriteTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+PcapNgReadWriteTestCase::DoRun (void)
+{
+  uint8_t data[100];
+  for (uint32_t i = 0; i < sizeof (data); ++i)
+    {
+      data[i] = i;
+    }
+
+  PcapNgFile f;
+  f.Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ", \"w\") returns error");
+  f.Init ("test");
+  uint32_t if0 = f.AddInterface (1, 65535, "node-0-0", 9);
+  f.Write (if0, 1000000001ULL, data, 61);
+  // interfaces may be described after the first packets
+  uint32_t if1 = f.AddInterface (9, 10, "node-1-0", 12);
+  f.Write (if1, 0x100000002ULL, data, 100);
+  f.Write (if0, 5, data, 3);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Write must not fail");
+  f.Close ();
+
+  NS_TEST_ASSERT_MSG_EQ (if0, 0, "Unexpected first interface id");
+  NS_TEST_ASSERT_MSG_EQ (if1, 1, "Unexpected second interface id");
+
+  f.Open (m_testFilename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ", \"r\") returns error");
+
+  uint8_t buffer[128];
+  uint32_t interfaceId;
+  uint64_t timestamp;
+  uint32_t inclLen;
+  uint32_t origLen;
+  uint32_t readLen;
+
+  f.Read (buffer, sizeof (buffer), interfaceId, timestamp, inclLen, origLen, readLen);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Read must not fail");
+  NS_TEST_EXPECT_MSG_EQ (interfaceId, 0, "Unexpected interface of first packet");
+  NS_TEST_EXPECT_MSG_EQ (timestamp, 1000000001ULL, "Unexpected timestamp of first packet");
+  NS_TEST_EXPECT_MSG_EQ (inclLen, 61, "Unexpected included length of first packet");
+  NS_TEST_EXPECT_MSG_EQ (origLen, 61, "Unexpected original length of first packet");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (buffer, data, readLen), 0, "Unexpected data of first packet");
+  NS_TEST_EXPECT_MSG_EQ (f.GetNInterfaces (), 1, "Only one interface is described yet");
+  NS_TEST_EXPECT_MSG_EQ (f.GetDataLinkType (0), 1, "Unexpected link type of first interface");
+  NS_TEST_EXPECT_MSG_EQ (f.GetInterfaceName (0), "node-0-0", "Unexpected name of first interface");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (f.GetTsResol (0)), 9, "Unexpected resolution of first interface");
+
+  f.Read (buffer, sizeof (buffer), interfaceId, timestamp, inclLen, origLen, readLen);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Read must not fail");
+  NS_TEST_EXPECT_MSG_EQ (interfaceId, 1, "Unexpected interface of second packet");
+  NS_TEST_EXPECT_MSG_EQ (timestamp, 0x100000002ULL, "Unexpected timestamp of second packet");
+  NS_TEST_EXPECT_MSG_EQ (inclLen, 10, "Second packet must be truncated to the snap length");
+  NS_TEST_EXPECT_MSG_EQ (origLen, 100, "Unexpected original length of second packet");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (buffer, data, readLen), 0, "Unexpected data of second packet");
+  NS_TEST_EXPECT_MSG_EQ (f.GetNInterfaces (), 2, "Two interfaces must be described");
+  NS_TEST_EXPECT_MSG_EQ (f.GetDataLinkType (1), 9, "Unexpected link type of second interface");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (f.GetTsResol (1)), 12, "Unexpected resolution of second interface");
+
+  f.Read (buffer, sizeof (buffer), interfaceId, timestamp, inclLen, origLen, readLen);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Read must not fail");
+  NS_TEST_EXPECT_MSG_EQ (interfaceId, 0, "Unexpected interface of third packet");
+  NS_TEST_EXPECT_MSG_EQ (timestamp, 5, "Unexpected timestamp of third packet");
+  NS_TEST_EXPECT_MSG_EQ (readLen, 3, "Unexpected length of third packet");
+
+  f.Read (buffer, sizeof (buffer), interfaceId, timestamp, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (f.Eof (), true, "Expected end of file");
+  f.Close ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case checking that PcapHelper redirects the pcap files it
+ * creates to interfaces of a shared pcapng file.
+ */
+class PcapNgHelperTestCase : public TestCase
+{
+public:
+  PcapNgHelperTestCase ();
+  virtual ~PcapNgHelperTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename; //!< File name
+};
+
+PcapNgHelperTestCase::PcapNgHelperTestCase ()
+  : TestCase ("Check to see that PcapHelper records several pcap traces in one pcapng file")
+{
+}
+
+PcapNgHelperTestCase::~PcapNgHelperTestCase ()
+{
+}
+
+void
+PcapNgHelperTestCase::DoSetup (void)
+{
+  m_testFilename = CreateTempDirFilename ("pcapng-helper.pcapng");
+}
+
+void
+PcapNgHelperTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+PcapNgHelperTestCase::DoRun (void)
+{
+  PcapHelper pcapHelper;
+  PcapHelper::SetPcapNgFile (pcapHelper.CreatePcapNgFile (m_testFilename));
+
+  Ptr<PcapFileWrapper> a = pcapHelper.CreateFile ("trace-0-0.pcap", std::ios::out, PcapHelper::DLT_PPP);
+  Ptr<PcapFileWrapper> b = pcapHelper.CreateFile ("trace-1-0.pcap", std::ios::out, PcapHelper::DLT_EN10MB);
+  a->Write (NanoSeconds (1234567891), Create<Packet> (40));
+  b->Write (NanoSeconds (1234567892), Create<Packet> (1500));
+
+  PcapHelper::SetPcapNgFile (0);
+  a = 0;
+  b = 0;
+
+  Ptr<PcapNgFileWrapper> file = CreateObject<PcapNgFileWrapper> ();
+  file->Open (m_testFilename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Open (" << m_testFilename << ", \"r\") returns error");
+
+  Time t;
+  uint32_t interfaceId;
+  Ptr<Packet> p = file->Read (t, interfaceId);
+  NS_TEST_ASSERT_MSG_NE (p, 0, "Expected a first packet");
+  NS_TEST_EXPECT_MSG_EQ (interfaceId, 0, "Unexpected interface of first packet");
+  NS_TEST_EXPECT_MSG_EQ (t, NanoSeconds (1234567891), "Timestamps must keep the Time resolution");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 40, "Unexpected size of first packet");
+  NS_TEST_EXPECT_MSG_EQ (file->GetInterfaceName (0), "trace-0-0", "Unexpected name of first interface");
+  NS_TEST_EXPECT_MSG_EQ (file->GetDataLinkType (0), PcapHelper::DLT_PPP, "Unexpected link type of first interface");
+
+  p = file->Read (t, interfaceId);
+  NS_TEST_ASSERT_MSG_NE (p, 0, "Expected a second packet");
+  NS_TEST_EXPECT_MSG_EQ (interfaceId, 1, "Unexpected interface of second packet");
+  NS_TEST_EXPECT_MSG_EQ (t, NanoSeconds (1234567892), "Timestamps must keep the Time resolution");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 1500, "Unexpected size of second packet");
+  NS_TEST_EXPECT_MSG_EQ (file->GetInterfaceName (1), "trace-1-0", "Unexpected name of second interface");
+  NS_TEST_EXPECT_MSG_EQ (file->GetDataLinkType (1), PcapHelper::DLT_EN10MB, "Unexpected link type of second interface");
+
+  p = file->Read (t, interfaceId);
+  NS_TEST_EXPECT_MSG_EQ (p, 0, "Expected end of file");
+  file->Close ();
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PCAPNG file utils TestSuite
+ */
+class PcapNgFileTestSuite : public TestSuite
+{
+public:
+  PcapNgFileTestSuite ();
+};
+
+PcapNgFileTestSuite::PcapNgFileTestSuite ()
+  : TestSuite ("pcapng-file", UNIT)
+{
+  AddTestCase (new PcapNgReadWriteTestCase, TestCase::QUICK);
+  AddTestCase (new PcapNgHelperTestCase, TestCase::QUICK);
+}
+
+static PcapNgFileTestSuite pcapNgFileTestSuite; //!< Static variable for test initialization
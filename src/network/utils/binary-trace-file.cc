@@ -0,0 +1,765 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/buffer.h"
+#include "ns3/chunk.h"
+#include "binary-trace-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+const uint32_t MAGIC = 0x6e733362;            /**< Magic number identifying a binary trace file ("ns3b") */
+const uint16_t VERSION_MAJOR = 1;             /**< Major version of the binary trace format */
+const uint16_t VERSION_MINOR = 0;             /**< Minor version of the binary trace format */
+
+const uint32_t FLAG_HEADERS = 1;              /**< Packet headers are stored */
+
+const uint32_t DICTIONARY_BLOCK = 1;          /**< Block of dictionary entries */
+const uint32_t RECORD_BLOCK = 2;              /**< Block of records */
+
+/**
+ * Size of the fixed-size columns of one record: event, time, source,
+ * context, uid, size and data length.
+ */
+const uint32_t RECORD_COLUMNS_SIZE = 1 + 8 + 4 + 4 + 8 + 4 + 4;
+
+/**
+ * \name Header summary item flags
+ *
+ * The header summary of a packet is the list of its metadata items.  Each
+ * item starts with a flags byte: the PacketMetadata::Item::ItemType, plus
+ * ITEM_FRAGMENT for fragments.  Headers and trailers go on with the uint16_t
+ * uid of their TypeId.  Fragments go on with their offset and size,
+ * whole payloads with their size, and whole headers and trailers with their
+ * size and bytes.
+ */
+/**@{*/
+const uint8_t ITEM_TYPE_MASK = 0x03;          /**< PacketMetadata::Item::ItemType */
+const uint8_t ITEM_FRAGMENT = 0x04;           /**< Item is a fragment */
+/**@}*/
+
+/**
+ * Parse the node and device indexes of a dictionary entry.
+ *
+ * Contexts are Config paths such as "/NodeList/1/DeviceList/0/...", and
+ * sources are AsciiTraceHelper file names such as "prefix-1-0.tr".
+ *
+ * \param name the entry name
+ * \param node [out] the node index, or BinaryTraceFile::NO_INDEX
+ * \param device [out] the device index, or BinaryTraceFile::NO_INDEX
+ */
+static void
+ParseIndexes (std::string const &name, uint32_t &node, uint32_t &device)
+{
+  node = BinaryTraceFile::NO_INDEX;
+  device = BinaryTraceFile::NO_INDEX;
+
+  std::string::size_type pos = name.find ("/NodeList/");
+  if (pos != std::string::npos)
+    {
+      char *end;
+      node = std::strtoul (name.c_str () + pos + 10, &end, 10);
+      pos = name.find ("/DeviceList/", pos);
+      if (pos != std::string::npos)
+        {
+          device = std::strtoul (name.c_str () + pos + 12, &end, 10);
+        }
+      return;
+    }
+
+  std::string::size_type dot = name.rfind (".tr");
+  std::string::size_type dash2 = name.rfind ('-', dot);
+  if (dot == std::string::npos || dot + 3 != name.size ()
+      || dash2 == std::string::npos || dash2 == 0)
+    {
+      return;
+    }
+  std::string::size_type dash1 = name.rfind ('-', dash2 - 1);
+  if (dash1 == std::string::npos)
+    {
+      return;
+    }
+  std::string n = name.substr (dash1 + 1, dash2 - dash1 - 1);
+  std::string d = name.substr (dash2 + 1, dot - dash2 - 1);
+  if (n.empty () || d.empty ()
+      || n.find_first_not_of ("0123456789") != std::string::npos
+      || d.find_first_not_of ("0123456789") != std::string::npos)
+    {
+      return;
+    }
+  node = std::strtoul (n.c_str (), 0, 10);
+  device = std::strtoul (d.c_str (), 0, 10);
+}
+
+/**
+ * Append a value to a byte vector
+ * \param v the vector
+ * \param val the value
+ */
+template <typename T>
+static inline void
+AppendValue (std::vector<uint8_t> &v, T val)
+{
+  uint8_t const *p = reinterpret_cast<uint8_t const *> (&val);
+  v.insert (v.end (), p, p + sizeof (T));
+}
+
+/**
+ * Write a column to a stream
+ * \param os the stream
+ * \param column the column
+ */
+template <typename T>
+static inline void
+WriteColumn (std::ostream &os, std::vector<T> const &column)
+{
+  if (!column.empty ())
+    {
+      os.write ((const char *)&column[0], column.size () * sizeof (T));
+    }
+}
+
+BinaryTraceFile::TextBuffer::TextBuffer (BinaryTraceFile *file, uint32_t source)
+  : m_file (file),
+    m_source (source)
+{
+}
+
+BinaryTraceFile::TextBuffer::int_type
+BinaryTraceFile::TextBuffer::overflow (int_type c)
+{
+  if (c != traits_type::eof ())
+    {
+      m_line.push_back (traits_type::to_char_type (c));
+      if (c == '\n')
+        {
+          sync ();
+        }
+    }
+  return traits_type::not_eof (c);
+}
+
+std::streamsize
+BinaryTraceFile::TextBuffer::xsputn (const char *s, std::streamsize n)
+{
+  for (std::streamsize i = 0; i < n; ++i)
+    {
+      overflow (traits_type::to_int_type (s[i]));
+    }
+  return n;
+}
+
+int
+BinaryTraceFile::TextBuffer::sync (void)
+{
+  if (!m_line.empty ())
+    {
+      m_file->WriteText (m_source, m_line);
+      m_line.clear ();
+    }
+  return 0;
+}
+
+BinaryTraceFile::BinaryTraceFile (std::string filename, bool withHeaders, uint32_t blockSize)
+  : m_withHeaders (withHeaders),
+    m_blockSize (blockSize),
+    m_nSources (0),
+    m_nEntries (0)
+{
+  NS_LOG_FUNCTION (this << filename << withHeaders << blockSize);
+  NS_ASSERT (blockSize > 0);
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "BinaryTraceFile: Unable to Open " << filename);
+  FatalImpl::RegisterStream (&m_file);
+
+  m_event.reserve (blockSize);
+  m_time.reserve (blockSize);
+  m_source.reserve (blockSize);
+  m_context.reserve (blockSize);
+  m_uid.reserve (blockSize);
+  m_size.reserve (blockSize);
+  m_length.reserve (blockSize);
+
+  uint32_t magic = MAGIC;
+  uint16_t major = VERSION_MAJOR;
+  uint16_t minor = VERSION_MINOR;
+  uint32_t resolution = Time::GetResolution ();
+  uint32_t flags = withHeaders ? FLAG_HEADERS : 0;
+  m_file.write ((const char *)&magic, sizeof (magic));
+  m_file.write ((const char *)&major, sizeof (major));
+  m_file.write ((const char *)&minor, sizeof (minor));
+  m_file.write ((const char *)&resolution, sizeof (resolution));
+  m_file.write ((const char *)&flags, sizeof (flags));
+}
+
+BinaryTraceFile::~BinaryTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<TextBuffer *>::iterator i = m_textBuffers.begin (); i != m_textBuffers.end (); ++i)
+    {
+      if (*i != 0)
+        {
+          (*i)->pubsync ();
+          delete *i;
+        }
+    }
+  Flush ();
+  FatalImpl::UnregisterStream (&m_file);
+  m_file.close ();
+}
+
+void
+BinaryTraceFile::AddEntry (EntryKind kind, uint32_t id, std::string const &name)
+{
+  NS_LOG_FUNCTION (this << kind << id << name);
+  uint32_t node;
+  uint32_t device;
+  ParseIndexes (name, node, device);
+  AppendValue (m_dictionary, id);
+  AppendValue (m_dictionary, static_cast<uint8_t> (kind));
+  AppendValue (m_dictionary, node);
+  AppendValue (m_dictionary, device);
+  AppendValue (m_dictionary, static_cast<uint32_t> (name.size ()));
+  m_dictionary.insert (m_dictionary.end (), name.begin (), name.end ());
+  m_nEntries++;
+}
+
+uint32_t
+BinaryTraceFile::AddSource (std::string const &name)
+{
+  NS_LOG_FUNCTION (this << name);
+  uint32_t id = m_nSources++;
+  AddEntry (SOURCE, id, name);
+  return id;
+}
+
+uint32_t
+BinaryTraceFile::GetContextId (std::string const &context)
+{
+  std::map<std::string, uint32_t>::iterator it = m_contexts.find (context);
+  if (it != m_contexts.end ())
+    {
+      return it->second;
+    }
+  uint32_t id = m_contexts.size ();
+  m_contexts.insert (std::make_pair (context, id));
+  AddEntry (CONTEXT, id, context);
+  return id;
+}
+
+std::streambuf *
+BinaryTraceFile::GetTextBuffer (uint32_t source)
+{
+  NS_LOG_FUNCTION (this << source);
+  NS_ASSERT (source < m_nSources);
+  if (m_textBuffers.size () <= source)
+    {
+      m_textBuffers.resize (source + 1, 0);
+    }
+  if (m_textBuffers[source] == 0)
+    {
+      m_textBuffers[source] = new TextBuffer (this, source);
+    }
+  return m_textBuffers[source];
+}
+
+void
+BinaryTraceFile::Append (uint8_t event, uint32_t source, uint32_t context, uint64_t uid,
+                         uint32_t size, uint8_t const *data, uint32_t length)
+{
+  m_event.push_back (event);
+  m_time.push_back (Simulator::Now ().GetTimeStep ());
+  m_source.push_back (source);
+  m_context.push_back (context);
+  m_uid.push_back (uid);
+  m_size.push_back (size);
+  m_length.push_back (length);
+  if (data != 0)
+    {
+      m_data.insert (m_data.end (), data, data + length);
+    }
+  if (m_event.size () >= m_blockSize)
+    {
+      Flush ();
+    }
+}
+
+void
+BinaryTraceFile::AppendHeaders (Ptr<const Packet> p)
+{
+  //
+  // Packet::Print only needs the header and trailer bytes, the payload is
+  // described by its size, so the payload bytes are never copied.
+  //
+  PacketMetadata::ItemIterator i = p->BeginItem ();
+  while (i.HasNext ())
+    {
+      PacketMetadata::Item item = i.Next ();
+      uint8_t flags = item.type | (item.isFragment ? ITEM_FRAGMENT : 0);
+      m_data.push_back (flags);
+      if (item.type != PacketMetadata::Item::PAYLOAD)
+        {
+          uint16_t uid = item.tid.GetUid ();
+          if (m_types.size () <= uid)
+            {
+              m_types.resize (uid + 1, false);
+            }
+          if (!m_types[uid])
+            {
+              m_types[uid] = true;
+              AddEntry (TYPE, uid, item.tid.GetName ());
+            }
+          AppendValue (m_data, uid);
+        }
+      if (item.isFragment)
+        {
+          AppendValue (m_data, item.currentTrimedFromStart);
+          AppendValue (m_data, item.currentSize);
+        }
+      else if (item.type == PacketMetadata::Item::PAYLOAD)
+        {
+          AppendValue (m_data, item.currentSize);
+        }
+      else
+        {
+          AppendValue (m_data, item.currentSize);
+          Buffer::Iterator start = item.current;
+          if (item.type == PacketMetadata::Item::TRAILER)
+            {
+              start.Prev (item.currentSize);
+            }
+          std::vector<uint8_t>::size_type offset = m_data.size ();
+          m_data.resize (offset + item.currentSize);
+          start.Read (&m_data[offset], item.currentSize);
+        }
+    }
+}
+
+void
+BinaryTraceFile::Write (EventType event, uint32_t source, uint32_t context, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << event << source << context << p);
+  uint32_t length = 0;
+  if (m_withHeaders)
+    {
+      // the summary is appended in place at the end of the data column
+      std::vector<uint8_t>::size_type offset = m_data.size ();
+      AppendHeaders (p);
+      length = m_data.size () - offset;
+    }
+  Append (event, source, context, p->GetUid (), p->GetSize (), 0, length);
+}
+
+void
+BinaryTraceFile::WriteText (uint32_t source, std::string const &text)
+{
+  NS_LOG_FUNCTION (this << source << text);
+  Append (TEXT, source, NO_CONTEXT, 0, text.size (),
+          reinterpret_cast<uint8_t const *> (text.data ()), text.size ());
+}
+
+void
+BinaryTraceFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  //
+  // Dictionary entries referenced by the records must come first.
+  //
+  if (m_nEntries > 0)
+    {
+      uint32_t type = DICTIONARY_BLOCK;
+      uint32_t length = m_dictionary.size ();
+      m_file.write ((const char *)&type, sizeof (type));
+      m_file.write ((const char *)&m_nEntries, sizeof (m_nEntries));
+      m_file.write ((const char *)&length, sizeof (length));
+      WriteColumn (m_file, m_dictionary);
+      m_dictionary.clear ();
+      m_nEntries = 0;
+    }
+
+  uint32_t count = m_event.size ();
+  if (count > 0)
+    {
+      uint32_t type = RECORD_BLOCK;
+      uint32_t length = count * RECORD_COLUMNS_SIZE + m_data.size ();
+      m_file.write ((const char *)&type, sizeof (type));
+      m_file.write ((const char *)&count, sizeof (count));
+      m_file.write ((const char *)&length, sizeof (length));
+      WriteColumn (m_file, m_event);
+      WriteColumn (m_file, m_time);
+      WriteColumn (m_file, m_source);
+      WriteColumn (m_file, m_context);
+      WriteColumn (m_file, m_uid);
+      WriteColumn (m_file, m_size);
+      WriteColumn (m_file, m_length);
+      WriteColumn (m_file, m_data);
+
+      // clear () keeps the capacity, so steady-state recording does not allocate
+      m_event.clear ();
+      m_time.clear ();
+      m_source.clear ();
+      m_context.clear ();
+      m_uid.clear ();
+      m_size.clear ();
+      m_length.clear ();
+      m_data.clear ();
+    }
+  m_file.flush ();
+}
+
+BinaryTraceReader::BinaryTraceReader ()
+  : m_fail (false),
+    m_resolution (Time::NS),
+    m_withHeaders (false),
+    m_count (0),
+    m_next (0),
+    m_dataOffset (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BinaryTraceReader::~BinaryTraceReader ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+BinaryTraceReader::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.open (filename.c_str (), std::ios::in | std::ios::binary);
+  uint32_t magic = 0;
+  uint16_t major = 0;
+  uint16_t minor = 0;
+  uint32_t resolution = 0;
+  uint32_t flags = 0;
+  m_file.read ((char *)&magic, sizeof (magic));
+  m_file.read ((char *)&major, sizeof (major));
+  m_file.read ((char *)&minor, sizeof (minor));
+  m_file.read ((char *)&resolution, sizeof (resolution));
+  m_file.read ((char *)&flags, sizeof (flags));
+  if (m_file.fail () || magic != MAGIC || major != VERSION_MAJOR
+      || resolution >= Time::LAST)
+    {
+      m_fail = true;
+      return false;
+    }
+  m_resolution = static_cast<Time::Unit> (resolution);
+  m_withHeaders = (flags & FLAG_HEADERS) != 0;
+  return true;
+}
+
+bool
+BinaryTraceReader::Fail (void) const
+{
+  return m_fail;
+}
+
+Time::Unit
+BinaryTraceReader::GetResolution (void) const
+{
+  return m_resolution;
+}
+
+bool
+BinaryTraceReader::HasHeaders (void) const
+{
+  return m_withHeaders;
+}
+
+bool
+BinaryTraceReader::ReadBlock (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
+    {
+      uint32_t type = 0;
+      uint32_t count = 0;
+      uint32_t length = 0;
+      m_file.read ((char *)&type, sizeof (type));
+      m_file.read ((char *)&count, sizeof (count));
+      m_file.read ((char *)&length, sizeof (length));
+      if (m_file.fail ())
+        {
+          // regular end of file
+          return false;
+        }
+      m_block.resize (length);
+      if (length > 0)
+        {
+          m_file.read ((char *)&m_block[0], length);
+        }
+      if (m_file.fail ())
+        {
+          m_fail = true;
+          return false;
+        }
+
+      if (type == DICTIONARY_BLOCK)
+        {
+          uint32_t offset = 0;
+          for (uint32_t i = 0; i < count; ++i)
+            {
+              uint32_t id;
+              uint8_t kind;
+              uint32_t nameLength;
+              Entry entry;
+              if (offset + 17 > length)
+                {
+                  m_fail = true;
+                  return false;
+                }
+              std::memcpy (&id, &m_block[offset], 4);
+              kind = m_block[offset + 4];
+              std::memcpy (&entry.node, &m_block[offset + 5], 4);
+              std::memcpy (&entry.device, &m_block[offset + 9], 4);
+              std::memcpy (&nameLength, &m_block[offset + 13], 4);
+              offset += 17;
+              if (offset + nameLength > length)
+                {
+                  m_fail = true;
+                  return false;
+                }
+              entry.name.assign ((char const *)m_block.data () + offset, nameLength);
+              offset += nameLength;
+              if (kind == 0)
+                {
+                  m_sources[id] = entry;
+                }
+              else if (kind == 1)
+                {
+                  m_contexts[id] = entry;
+                }
+              else
+                {
+                  m_types[id] = entry.name;
+                }
+            }
+        }
+      else if (type == RECORD_BLOCK)
+        {
+          if (static_cast<uint64_t> (count) * RECORD_COLUMNS_SIZE > length)
+            {
+              m_fail = true;
+              return false;
+            }
+          m_count = count;
+          m_next = 0;
+          m_dataOffset = count * RECORD_COLUMNS_SIZE;
+          if (count > 0)
+            {
+              return true;
+            }
+        }
+      // blocks of unknown type are skipped
+    }
+}
+
+bool
+BinaryTraceReader::Read (BinaryTraceRecord &record)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_fail || !m_file.is_open ())
+    {
+      return false;
+    }
+  if (m_next >= m_count && !ReadBlock ())
+    {
+      return false;
+    }
+
+  uint32_t n = m_count;
+  uint32_t i = m_next++;
+  uint8_t const *base = m_block.data ();
+  uint32_t length;
+  record.event = base[i];
+  std::memcpy (&record.timeStep, base + n + 8 * i, 8);
+  std::memcpy (&record.source, base + 9 * n + 4 * i, 4);
+  std::memcpy (&record.context, base + 13 * n + 4 * i, 4);
+  std::memcpy (&record.uid, base + 17 * n + 8 * i, 8);
+  std::memcpy (&record.size, base + 25 * n + 4 * i, 4);
+  std::memcpy (&length, base + 29 * n + 4 * i, 4);
+  if (m_dataOffset + length > m_block.size ())
+    {
+      m_fail = true;
+      return false;
+    }
+  record.data.assign (base + m_dataOffset, base + m_dataOffset + length);
+  m_dataOffset += length;
+
+  //
+  // The context, when there is one, designates the node and device more
+  // precisely than the source.
+  //
+  record.node = BinaryTraceFile::NO_INDEX;
+  record.device = BinaryTraceFile::NO_INDEX;
+  std::map<uint32_t, Entry>::const_iterator it = m_contexts.find (record.context);
+  if (record.context != BinaryTraceFile::NO_CONTEXT && it != m_contexts.end ())
+    {
+      record.node = it->second.node;
+      record.device = it->second.device;
+    }
+  else
+    {
+      it = m_sources.find (record.source);
+      if (it != m_sources.end ())
+        {
+          record.node = it->second.node;
+          record.device = it->second.device;
+        }
+    }
+  return true;
+}
+
+Time
+BinaryTraceReader::GetTime (BinaryTraceRecord const &record) const
+{
+  return Time::FromInteger (record.timeStep, m_resolution);
+}
+
+std::string
+BinaryTraceReader::GetSourceName (uint32_t id) const
+{
+  std::map<uint32_t, Entry>::const_iterator it = m_sources.find (id);
+  if (it == m_sources.end ())
+    {
+      return "";
+    }
+  return it->second.name;
+}
+
+std::string
+BinaryTraceReader::GetContextName (uint32_t id) const
+{
+  std::map<uint32_t, Entry>::const_iterator it = m_contexts.find (id);
+  if (it == m_contexts.end ())
+    {
+      return "";
+    }
+  return it->second.name;
+}
+
+bool
+BinaryTraceReader::PrintHeaders (std::vector<uint8_t> const &data, std::ostream &os) const
+{
+  uint32_t offset = 0;
+  while (offset < data.size ())
+    {
+      uint8_t flags = data[offset++];
+      uint8_t type = flags & ITEM_TYPE_MASK;
+      std::string name = "Payload";
+      if (type != PacketMetadata::Item::PAYLOAD)
+        {
+          uint16_t uid;
+          if (offset + 2 > data.size ())
+            {
+              return false;
+            }
+          std::memcpy (&uid, &data[offset], 2);
+          offset += 2;
+          std::map<uint32_t, std::string>::const_iterator it = m_types.find (uid);
+          if (it == m_types.end ())
+            {
+              return false;
+            }
+          name = it->second;
+        }
+      if (flags & ITEM_FRAGMENT)
+        {
+          uint32_t trimmed;
+          uint32_t size;
+          if (offset + 8 > data.size ())
+            {
+              return false;
+            }
+          std::memcpy (&trimmed, &data[offset], 4);
+          std::memcpy (&size, &data[offset + 4], 4);
+          offset += 8;
+          os << name << " Fragment [" << trimmed << ":" << (trimmed + size) << "]";
+        }
+      else
+        {
+          uint32_t size;
+          if (offset + 4 > data.size ())
+            {
+              return false;
+            }
+          std::memcpy (&size, &data[offset], 4);
+          offset += 4;
+          if (type == PacketMetadata::Item::PAYLOAD)
+            {
+              os << "Payload (size=" << size << ")";
+            }
+          else
+            {
+              if (offset + size > data.size ())
+                {
+                  return false;
+                }
+              os << name << " (";
+              TypeId tid;
+              if (TypeId::LookupByNameFailSafe (name, &tid) && tid.HasConstructor ())
+                {
+                  Chunk *chunk = dynamic_cast<Chunk *> (tid.GetConstructor () ());
+                  NS_ASSERT (chunk != 0);
+                  Buffer buffer;
+                  buffer.AddAtStart (size);
+                  buffer.Begin ().Write (&data[offset], size);
+                  chunk->Deserialize (buffer.Begin (), buffer.End ());
+                  chunk->Print (os);
+                  delete chunk;
+                }
+              os << ")";
+              offset += size;
+            }
+        }
+      if (offset < data.size ())
+        {
+          os << " ";
+        }
+    }
+  return true;
+}
+
+void
+BinaryTraceReader::PrintAscii (BinaryTraceRecord const &record, std::ostream &os) const
+{
+  if (record.event == BinaryTraceFile::TEXT)
+    {
+      os.write ((char const *)record.data.data (), record.data.size ());
+      return;
+    }
+  os << static_cast<char> (record.event) << " " << GetTime (record).GetSeconds () << " ";
+  if (record.context != BinaryTraceFile::NO_CONTEXT)
+    {
+      os << GetContextName (record.context) << " ";
+    }
+  if (!m_withHeaders || !PrintHeaders (record.data, os))
+    {
+      os << "uid=" << record.uid << " size=" << record.size;
+    }
+  os << std::endl;
+}
+
+} // namespace ns3
@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <streambuf>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup network
+ *
+ * \brief Compact binary replacement for the ascii '+ - d r' packet traces.
+ *
+ * The ascii traces print every packet through Packet::Print and ostream
+ * formatting, which is both slow and verbose.  A BinaryTraceFile instead
+ * records, for every event, the event type, the time step, the trace
+ * source (the ascii file the line would have gone to), the optional trace
+ * context, the packet uid and size and a summary of the packet contents
+ * taken from its metadata: the bytes of every header and trailer, and only
+ * the offsets and sizes of the payload, which the ascii traces do not print.
+ *
+ * Records are accumulated in column vectors and written as one block every
+ * "block size" events, so a trace event costs a few appends.  Source and
+ * context strings, and header type names, are interned in a dictionary,
+ * along with the node and device they designate.  BinaryTraceReader reads such files back and can
+ * print each record exactly as the ascii trace sinks would have done.
+ *
+ * Text that does not go through the binary sinks (for example custom trace
+ * sinks writing to OutputStreamWrapper::GetStream ()) is kept as text
+ * records, so no information is lost when the traces are converted back.
+ *
+ * The file is written in the byte order of the writing system.
+ */
+class BinaryTraceFile : public SimpleRefCount<BinaryTraceFile>
+{
+public:
+  /**
+   * \brief Event types, named after the corresponding ascii trace character
+   */
+  enum EventType
+  {
+    TEXT = 0,          //!< free-form text line
+    ENQUEUE = '+',     //!< packet enqueued for transmission
+    DEQUEUE = '-',     //!< packet dequeued for transmission
+    DROP = 'd',        //!< packet dropped
+    RECEIVE = 'r',     //!< packet received
+    TRANSMIT = 't'     //!< packet transmitted
+  };
+
+  /// Identifier of a missing context
+  static const uint32_t NO_CONTEXT = 0xffffffff;
+  /// Node or device index of a dictionary entry that does not designate one
+  static const uint32_t NO_INDEX = 0xffffffff;
+  /// Default number of records per block
+  static const uint32_t BLOCK_SIZE_DEFAULT = 4096;
+
+  /**
+   * Create a binary trace file.
+   *
+   * \param filename file name
+   * \param withHeaders whether to store the packet headers, which is needed
+   * to print them when converting back to ascii.  The packet metadata
+   * must be enabled, see Packet::EnablePrinting ().
+   * \param blockSize number of records buffered before a block is written
+   */
+  BinaryTraceFile (std::string filename, bool withHeaders = true,
+                   uint32_t blockSize = BLOCK_SIZE_DEFAULT);
+  ~BinaryTraceFile ();
+
+  /**
+   * Register a trace source, that is the ascii trace file that records
+   * are meant for.  If the name follows the AsciiTraceHelper
+   * "prefix-node-device.tr" convention, node and device are recorded.
+   *
+   * \param name the name of the source
+   * \returns the source identifier
+   */
+  uint32_t AddSource (std::string const &name);
+
+  /**
+   * Look up or register a trace context.  Node and device indexes are
+   * parsed from "/NodeList/n/DeviceList/d" context paths.
+   *
+   * \param context the trace context
+   * \returns the context identifier
+   */
+  uint32_t GetContextId (std::string const &context);
+
+  /**
+   * Record a packet event at the current simulation time.
+   *
+   * \param event the event type
+   * \param source the source identifier
+   * \param context the context identifier, or NO_CONTEXT
+   * \param p the packet
+   */
+  void Write (EventType event, uint32_t source, uint32_t context, Ptr<const Packet> p);
+
+  /**
+   * Record a line of text at the current simulation time.
+   *
+   * \param source the source identifier
+   * \param text the text, including the trailing newline if any
+   */
+  void WriteText (uint32_t source, std::string const &text);
+
+  /**
+   * \param source the source identifier
+   * \returns a stream buffer turning each line written to it into a text
+   * record of the given source.  The buffer is owned by this file.
+   */
+  std::streambuf *GetTextBuffer (uint32_t source);
+
+  /**
+   * Write the buffered records to the file.
+   */
+  void Flush (void);
+
+private:
+  /// Dictionary entry kinds
+  enum EntryKind
+  {
+    SOURCE = 0,        //!< trace source
+    CONTEXT = 1,       //!< trace context
+    TYPE = 2           //!< header or trailer TypeId
+  };
+
+  /**
+   * \brief Stream buffer turning lines of text into text records
+   */
+  class TextBuffer : public std::streambuf
+  {
+public:
+    /**
+     * \param file the file to write to
+     * \param source the source identifier of the records
+     */
+    TextBuffer (BinaryTraceFile *file, uint32_t source);
+
+protected:
+    virtual int_type overflow (int_type c);
+    virtual std::streamsize xsputn (const char *s, std::streamsize n);
+    virtual int sync (void);
+
+private:
+    BinaryTraceFile *m_file;  //!< the file to write to
+    uint32_t m_source;        //!< the source identifier
+    std::string m_line;       //!< the line being built
+  };
+
+  /**
+   * Add a dictionary entry, written before the next block of records.
+   * \param kind the entry kind
+   * \param id the entry identifier
+   * \param name the entry name
+   */
+  void AddEntry (EntryKind kind, uint32_t id, std::string const &name);
+
+  /**
+   * Append the header summary of a packet to the data column.
+   * \param p the packet
+   */
+  void AppendHeaders (Ptr<const Packet> p);
+
+  /**
+   * Append a record, flushing the block if it is full.
+   * \param event the event type
+   * \param source the source identifier
+   * \param context the context identifier
+   * \param uid the packet uid
+   * \param size the packet size
+   * \param data the record data
+   * \param length the record data length
+   */
+  void Append (uint8_t event, uint32_t source, uint32_t context, uint64_t uid,
+               uint32_t size, uint8_t const *data, uint32_t length);
+
+  std::ofstream m_file;                          //!< the output file
+  bool m_withHeaders;                            //!< whether to store packet headers
+  std::vector<bool> m_types;                     //!< TypeIds in the dictionary, by uid
+  uint32_t m_blockSize;                          //!< records per block
+  uint32_t m_nSources;                           //!< number of sources
+  std::map<std::string, uint32_t> m_contexts;    //!< interned contexts
+  std::vector<TextBuffer *> m_textBuffers;       //!< text buffers, by source
+  uint32_t m_nEntries;                           //!< pending dictionary entries
+  std::vector<uint8_t> m_dictionary;             //!< pending dictionary entries
+  // Columns of the current block
+  std::vector<uint8_t> m_event;                  //!< event column
+  std::vector<int64_t> m_time;                   //!< time step column
+  std::vector<uint32_t> m_source;                //!< source column
+  std::vector<uint32_t> m_context;               //!< context column
+  std::vector<uint64_t> m_uid;                   //!< packet uid column
+  std::vector<uint32_t> m_size;                  //!< packet size column
+  std::vector<uint32_t> m_length;                //!< data length column
+  std::vector<uint8_t> m_data;                   //!< concatenated data
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief A record of a BinaryTraceFile
+ */
+struct BinaryTraceRecord
+{
+  uint8_t event;              //!< event type (see BinaryTraceFile::EventType)
+  int64_t timeStep;           //!< time, in steps of the writer Time resolution
+  uint32_t source;            //!< source identifier
+  uint32_t context;           //!< context identifier
+  uint32_t node;              //!< node index, or BinaryTraceFile::NO_INDEX
+  uint32_t device;            //!< device index, or BinaryTraceFile::NO_INDEX
+  uint64_t uid;               //!< packet uid
+  uint32_t size;              //!< packet size
+  std::vector<uint8_t> data;  //!< header summary, or text
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Reader of the files written by BinaryTraceFile
+ *
+ * The reader decodes one block at a time and hands out its records in
+ * order.  PrintAscii () formats a record the way the AsciiTraceHelper
+ * default sinks do, which makes it possible to convert a binary trace
+ * back into the ascii trace files it replaces.
+ */
+class BinaryTraceReader
+{
+public:
+  BinaryTraceReader ();
+  ~BinaryTraceReader ();
+
+  /**
+   * Open a binary trace file and read its header.
+   * \param filename file name
+   * \returns true on success
+   */
+  bool Open (std::string const &filename);
+
+  /**
+   * Read the next record.
+   * \param record [out] the record
+   * \returns false at the end of the file or on error
+   */
+  bool Read (BinaryTraceRecord &record);
+
+  /**
+   * \returns true if the file header or a block was malformed
+   */
+  bool Fail (void) const;
+
+  /**
+   * \returns the Time resolution of the writer
+   */
+  Time::Unit GetResolution (void) const;
+
+  /**
+   * \returns true if the packet headers were stored
+   */
+  bool HasHeaders (void) const;
+
+  /**
+   * \param record a record
+   * \returns the time of the record
+   */
+  Time GetTime (BinaryTraceRecord const &record) const;
+
+  /**
+   * \param id a source identifier
+   * \returns the name of the source
+   */
+  std::string GetSourceName (uint32_t id) const;
+
+  /**
+   * \param id a context identifier
+   * \returns the context, or an empty string
+   */
+  std::string GetContextName (uint32_t id) const;
+
+  /**
+   * Print a record as the AsciiTraceHelper default sinks would, including
+   * the trailing newline.  The header and trailer types must be registered,
+   * that is the modules defining them must be linked in.
+   *
+   * \param record the record
+   * \param os the output stream
+   */
+  void PrintAscii (BinaryTraceRecord const &record, std::ostream &os) const;
+
+private:
+  /// A dictionary entry
+  struct Entry
+  {
+    std::string name;       //!< source or context name
+    uint32_t node;          //!< node index
+    uint32_t device;        //!< device index
+  };
+
+  /**
+   * Read the next block of the file.
+   * \returns false at the end of the file or on error
+   */
+  bool ReadBlock (void);
+
+  /**
+   * Print a header summary as Packet::Print would.
+   * \param data the header summary
+   * \param os the output stream
+   * \returns false if the summary is malformed
+   */
+  bool PrintHeaders (std::vector<uint8_t> const &data, std::ostream &os) const;
+
+  std::ifstream m_file;                   //!< the input file
+  bool m_fail;                            //!< malformed input seen
+  Time::Unit m_resolution;                //!< writer Time resolution
+  bool m_withHeaders;                     //!< packet headers stored
+  std::map<uint32_t, std::string> m_types; //!< header and trailer type names
+  std::map<uint32_t, Entry> m_sources;    //!< source dictionary
+  std::map<uint32_t, Entry> m_contexts;   //!< context dictionary
+  std::vector<uint8_t> m_block;           //!< current block
+  uint32_t m_count;                       //!< records in the current block
+  uint32_t m_next;                        //!< next record in the current block
+  uint32_t m_dataOffset;                  //!< offset of the next record data
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
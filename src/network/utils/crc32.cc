@@ -27,12 +27,21 @@
  */
 #include <stdint.h>
 
+#if (defined (__i386__) || defined (__amd64__) || defined (__x86_64__)) && defined (__GNUC__) && (__GNUC__ >= 5 || defined (__clang__))
+// The carry-less multiplication kernel is compiled for the PCLMUL
+// instructions whatever the build flags, and is only used when the CPU
+// running the program supports them
+#define CRC32_PCLMUL 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 namespace ns3 {
 
 /**
  * Table of CRC-32 values.
  */
-static uint32_t crc32table[256] = {
+static const uint32_t crc32table[256] = {
 0x00000000,0x77073096,0xEE0E612C,0x990951BA,0x076DC419,0x706AF48F,0xE963A535,0x9E6495A3,
 0x0EDB8832,0x79DCB8A4,0xE0D5E91E,0x97D2D988,0x09B64C2B,0x7EB17CBD,0xE7B82D07,0x90BF1D91,
 0x1DB71064,0x6AB020F2,0xF3B97148,0x84BE41DE,0x1ADAD47D,0x6DDDE4EB,0xF4D4B551,0x83D385C7,
@@ -67,16 +76,192 @@ static uint32_t crc32table[256] = {
 0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D 
 };
 
+/**
+ * Tables of the slice-by-8 algorithm: table[0] is crc32table and
+ * table[k][n] is the CRC-32 register update for byte n followed by k
+ * zero bytes, so that 8 bytes are folded into the register at once.
+ */
+struct Crc32SliceTables
+{
+  Crc32SliceTables ()
+  {
+    for (uint32_t n = 0; n < 256; n++)
+      {
+        table[0][n] = crc32table[n];
+      }
+    for (uint32_t k = 1; k < 8; k++)
+      {
+        for (uint32_t n = 0; n < 256; n++)
+          {
+            uint32_t crc = table[k - 1][n];
+            table[k][n] = (crc >> 8) ^ crc32table[crc & 0xFF];
+          }
+      }
+  }
+  uint32_t table[8][256]; //!< the slice tables
+};
+
+/**
+ * \param p pointer to 4 bytes
+ * \returns the little-endian 32-bit word at p, whatever the host byte order
+ */
+static inline uint32_t
+LoadLe32 (const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t> (p[3]) << 24);
+}
+
+/**
+ * Fold bytes into the CRC-32 register, 8 bytes at a time.
+ * \param crc the CRC-32 register
+ * \param data the bytes
+ * \param length the number of bytes
+ * \returns the CRC-32 register
+ */
+static uint32_t
+Crc32Slice8 (uint32_t crc, const uint8_t *data, int length)
+{
+  static const Crc32SliceTables tables;
+  const uint32_t (*t)[256] = tables.table;
+
+  while (length >= 8)
+    {
+      uint32_t one = crc ^ LoadLe32 (data);
+      uint32_t two = LoadLe32 (data + 4);
+      crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^
+        t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+        t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^
+        t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+      data += 8;
+      length -= 8;
+    }
+  while (length-- > 0)
+    {
+      crc = (crc >> 8) ^ crc32table[(crc & 0xFF) ^ *data++];
+    }
+  return crc;
+}
+
+#ifdef CRC32_PCLMUL
+
+/**
+ * \returns true if the CPU supports the PCLMULQDQ and SSE2 instructions
+ */
+static bool
+Crc32HasPclmul (void)
+{
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid (1, &eax, &ebx, &ecx, &edx) == 0)
+    {
+      return false;
+    }
+  return (ecx & bit_PCLMUL) != 0 && (edx & bit_SSE2) != 0;
+}
+
+/**
+ * Fold bytes into the CRC-32 register with carry-less multiplications, as
+ * described in "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+ * Instruction" (Intel, 2009): four 128-bit lanes are folded 64 bytes at a
+ * time, then folded into one lane, which is reduced to 32 bits with the
+ * Barrett reduction.  The constants are those of the bit-reflected
+ * CRC-32 polynomial.
+ *
+ * \param crc the CRC-32 register
+ * \param data the bytes
+ * \param length the number of bytes: at least 64, and a multiple of 16
+ * \returns the CRC-32 register
+ */
+__attribute__ ((target ("pclmul,sse2")))
+static uint32_t
+Crc32Pclmul (uint32_t crc, const uint8_t *data, int length)
+{
+  const __m128i k1k2 = _mm_set_epi64x (0x01c6e41596, 0x0154442bd4);
+  const __m128i k3k4 = _mm_set_epi64x (0x00ccaa009e, 0x01751997d0);
+  const __m128i k5k0 = _mm_set_epi64x (0, 0x0163cd6124);
+  const __m128i poly = _mm_set_epi64x (0x01f7011641, 0x01db710641);
+  const __m128i mask32 = _mm_setr_epi32 (~0, 0, ~0, 0);
+
+  __m128i x1 = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data));
+  __m128i x2 = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 16));
+  __m128i x3 = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 32));
+  __m128i x4 = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 48));
+  x1 = _mm_xor_si128 (x1, _mm_cvtsi32_si128 (crc));
+  data += 64;
+  length -= 64;
+
+  // Fold the four lanes over the next 64 bytes
+  while (length >= 64)
+    {
+      __m128i y1 = _mm_clmulepi64_si128 (x1, k1k2, 0x00);
+      __m128i y2 = _mm_clmulepi64_si128 (x2, k1k2, 0x00);
+      __m128i y3 = _mm_clmulepi64_si128 (x3, k1k2, 0x00);
+      __m128i y4 = _mm_clmulepi64_si128 (x4, k1k2, 0x00);
+      x1 = _mm_clmulepi64_si128 (x1, k1k2, 0x11);
+      x2 = _mm_clmulepi64_si128 (x2, k1k2, 0x11);
+      x3 = _mm_clmulepi64_si128 (x3, k1k2, 0x11);
+      x4 = _mm_clmulepi64_si128 (x4, k1k2, 0x11);
+      x1 = _mm_xor_si128 (_mm_xor_si128 (x1, y1),
+                          _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data)));
+      x2 = _mm_xor_si128 (_mm_xor_si128 (x2, y2),
+                          _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 16)));
+      x3 = _mm_xor_si128 (_mm_xor_si128 (x3, y3),
+                          _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 32)));
+      x4 = _mm_xor_si128 (_mm_xor_si128 (x4, y4),
+                          _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 48)));
+      data += 64;
+      length -= 64;
+    }
+
+  // Fold the four lanes into one
+  __m128i y = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (_mm_clmulepi64_si128 (x1, k3k4, 0x11), y), x2);
+  y = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (_mm_clmulepi64_si128 (x1, k3k4, 0x11), y), x3);
+  y = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (_mm_clmulepi64_si128 (x1, k3k4, 0x11), y), x4);
+
+  // Fold the lane over the remaining blocks of 16 bytes
+  while (length >= 16)
+    {
+      y = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+      x1 = _mm_xor_si128 (_mm_xor_si128 (_mm_clmulepi64_si128 (x1, k3k4, 0x11), y),
+                          _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data)));
+      data += 16;
+      length -= 16;
+    }
+
+  // Fold 128 bits into 64 bits
+  y = _mm_clmulepi64_si128 (x1, k3k4, 0x10);
+  x1 = _mm_xor_si128 (_mm_srli_si128 (x1, 8), y);
+  y = _mm_srli_si128 (x1, 4);
+  x1 = _mm_xor_si128 (_mm_clmulepi64_si128 (_mm_and_si128 (x1, mask32), k5k0, 0x00), y);
+
+  // Barrett reduction to 32 bits
+  y = _mm_clmulepi64_si128 (_mm_and_si128 (x1, mask32), poly, 0x10);
+  y = _mm_clmulepi64_si128 (_mm_and_si128 (y, mask32), poly, 0x00);
+  x1 = _mm_xor_si128 (x1, y);
+  return _mm_cvtsi128_si32 (_mm_srli_si128 (x1, 4));
+}
+
+#endif /* CRC32_PCLMUL */
+
 uint32_t
 CRC32Calculate (const uint8_t *data, int length)
 {
   uint32_t crc = 0xffffffff;
 
-  while (length--)
+#ifdef CRC32_PCLMUL
+  static const bool pclmul = Crc32HasPclmul ();
+  if (pclmul && length >= 64)
     {
-      crc = (crc >> 8) ^ crc32table[(crc & 0xFF) ^ *data++];
+      int folded = length & ~15;
+      crc = Crc32Pclmul (crc, data, folded);
+      data += folded;
+      length -= folded;
     }
-  return ~crc;
+#endif /* CRC32_PCLMUL */
+
+  return ~Crc32Slice8 (crc, data, length);
 }
 
 } // namespace ns3
@@ -44,6 +44,7 @@ NetDeviceQueue::~NetDeviceQueue ()
   m_queueLimits = 0;
   m_wakeCallback.Nullify ();
   m_device = 0;
+  m_queueRoom = nullptr;
 }
 
 bool
@@ -53,6 +54,22 @@ NetDeviceQueue::IsStopped (void) const
   return m_stoppedByDevice || m_stoppedByQueueLimits;
 }
 
+uint32_t
+NetDeviceQueue::GetBurstLimit (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (IsStopped ())
+    {
+      return 0;
+    }
+  if (m_queueLimits || !m_queueRoom)
+    {
+      return 1;
+    }
+  return std::max (m_queueRoom (), static_cast<uint32_t> (1));
+}
+
 void
 NetDeviceQueue::Start (void)
 {
@@ -91,6 +108,17 @@ NetDeviceQueue::NotifyAggregatedObject (Ptr<NetDeviceQueueInterface> ndqi)
   NS_ABORT_MSG_IF (!m_device, "No NetDevice object was aggregated to the NetDeviceQueueInterface");
 }
 
+QueueSize
+NetDeviceQueue::AddMtuPacket (const QueueSize &size) const
+{
+  if (size.GetUnit () == QueueSizeUnit::PACKETS)
+    {
+      return QueueSize (QueueSizeUnit::PACKETS, size.GetValue () + 1);
+    }
+  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
+  return QueueSize (QueueSizeUnit::BYTES, size.GetValue () + m_device->GetMtu ());
+}
+
 void
 NetDeviceQueue::SetWakeCallback (WakeCallback cb)
 {
@@ -212,6 +240,7 @@ NetDeviceQueueInterface::DoDispose (void)
   NS_LOG_FUNCTION (this);
 
   m_txQueuesVector.clear ();
+  m_sendBurstCallback = nullptr;
   Object::DoDispose ();
 }
 
@@ -255,4 +284,16 @@ NetDeviceQueueInterface::GetSelectQueueCallback (void) const
   return m_selectQueueCallback;
 }
 
+void
+NetDeviceQueueInterface::SetSendBurstCallback (SendBurstCallback cb)
+{
+  m_sendBurstCallback = cb;
+}
+
+NetDeviceQueueInterface::SendBurstCallback
+NetDeviceQueueInterface::GetSendBurstCallback (void) const
+{
+  return m_sendBurstCallback;
+}
+
 } // namespace ns3
@@ -22,17 +22,20 @@
 
 #include <vector>
 #include <functional>
+#include <algorithm>
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/log.h"
 #include "ns3/net-device.h"
+#include "ns3/queue-size.h"
 
 namespace ns3 {
 
 class QueueLimits;
 class NetDeviceQueueInterface;
 class QueueItem;
+class QueueDiscItem;
 
 
 /**
@@ -86,6 +89,19 @@ public:
    */
   bool IsStopped (void) const;
 
+  /**
+   * \brief Get the number of packets that can be sent to the device in a burst.
+   * \return the number of packets the device transmission queue can receive
+   *         before being stopped.
+   *
+   * Called by queue discs to size the bursts of packets they send to devices
+   * supporting bulk transmission. Zero is returned if the queue is stopped,
+   * and one if the room in the device queue is not known in packets or if
+   * the queue is managed by a queue limits object, which decides after each
+   * packet whether to stop the queue.
+   */
+  uint32_t GetBurstLimit (void) const;
+
   /**
    * \brief Notify this NetDeviceQueue that the NetDeviceQueueInterface was
    *        aggregated to an object.
@@ -197,11 +213,19 @@ public:
   void ConnectQueueTraces (Ptr<QueueType> queue);
 
 private:
+  /**
+   * \brief Add the size of a packet as large as the MTU of the device to a size
+   * \param size the size (in packets or bytes) of the device queue
+   * \return the size of the device queue after storing such a packet
+   */
+  QueueSize AddMtuPacket (const QueueSize &size) const;
+
   bool m_stoppedByDevice;         //!< True if the queue has been stopped by the device
   bool m_stoppedByQueueLimits;    //!< True if the queue has been stopped by a queue limits object
   Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
   WakeCallback m_wakeCallback;    //!< Wake callback
   Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
+  std::function<uint32_t (void)> m_queueRoom; //!< Room (in packets) in the device queue
 
   NS_LOG_TEMPLATE_DECLARE;        //!< redefinition of the log component
 };
@@ -282,6 +306,30 @@ public:
    */
   SelectQueueCallback GetSelectQueueCallback (void) const;
 
+  /// Callback invoked to send a burst of packets to the device
+  typedef std::function<void (const std::vector<Ptr<QueueDiscItem> > &)> SendBurstCallback;
+
+  /**
+   * \brief Set the send burst callback.
+   * \param cb the callback to set.
+   *
+   * This method is called by the devices supporting bulk transmission (or by
+   * their helpers) to set the method receiving the bursts of packets dequeued
+   * by the queue disc. The device enqueues all the packets of a burst in its
+   * transmission queue before starting to transmit them.
+   */
+  void SetSendBurstCallback (SendBurstCallback cb);
+
+  /**
+   * \brief Get the send burst callback.
+   * \return the send burst callback, or an empty callback if the device does
+   *         not support bulk transmission.
+   *
+   * Called by the traffic control layer to set the send burst callback of
+   * the root queue disc.
+   */
+  SendBurstCallback GetSendBurstCallback (void) const;
+
 protected:
   /**
    * \brief Dispose of the object
@@ -295,6 +343,7 @@ protected:
 private:
   std::vector< Ptr<NetDeviceQueue> > m_txQueuesVector;   //!< Device transmission queues
   SelectQueueCallback m_selectQueueCallback;   //!< Select queue callback
+  SendBurstCallback m_sendBurstCallback;       //!< Send burst callback
 };
 
 
@@ -317,6 +366,17 @@ NetDeviceQueue::ConnectQueueTraces (Ptr<QueueType> queue)
   queue->TraceConnectWithoutContext ("DropBeforeEnqueue",
                                      MakeCallback (&NetDeviceQueue::PacketDiscarded<QueueType>, this)
                                      .Bind (PeekPointer (queue)));
+
+  QueueType *q = PeekPointer (queue);
+  m_queueRoom = [q] ()
+    {
+      QueueSize maxSize = q->GetMaxSize ();
+      if (maxSize.GetUnit () != QueueSizeUnit::PACKETS)
+        {
+          return static_cast<uint32_t> (1);
+        }
+      return maxSize.GetValue () - std::min (q->GetCurrentSize ().GetValue (), maxSize.GetValue ());
+    };
 }
 
 template <typename QueueType>
@@ -328,13 +388,10 @@ NetDeviceQueue::PacketEnqueued (QueueType* queue, Ptr<const typename QueueType::
   // Inform BQL
   NotifyQueuedBytes (item->GetSize ());
 
-  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
-  Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
-
   // After enqueuing a packet, we need to check whether the queue is able to
   // store another packet. If not, we stop the queue
 
-  if (queue->GetCurrentSize () + p > queue->GetMaxSize ())
+  if (AddMtuPacket (queue->GetCurrentSize ()) > queue->GetMaxSize ())
     {
       NS_LOG_DEBUG ("The device queue is being stopped (" << queue->GetCurrentSize ()
                     << " inside)");
@@ -351,14 +408,11 @@ NetDeviceQueue::PacketDequeued (QueueType* queue, Ptr<const typename QueueType::
   // Inform BQL
   NotifyTransmittedBytes (item->GetSize ());
 
-  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
-  Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
-
   // After dequeuing a packet, if there is room for another packet we
   // call Wake () that ensures that the queue is not stopped and restarts
   // the queue disc if the queue was stopped
 
-  if (queue->GetCurrentSize () + p <= queue->GetMaxSize ())
+  if (AddMtuPacket (queue->GetCurrentSize ()) <= queue->GetMaxSize ())
     {
       Wake ();
     }
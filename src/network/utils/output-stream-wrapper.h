@@ -23,6 +23,7 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
+#include "binary-trace-file.h"
 
 namespace ns3 {
 
@@ -81,6 +82,16 @@ public:
    * \param os output stream
    */
   OutputStreamWrapper (std::ostream* os);
+  /**
+   * Constructor for a stream whose traces are recorded in a binary trace
+   * file, as a source named after the ascii file it replaces.  The stream
+   * returned by GetStream () turns the lines written to it into text
+   * records of that source.
+   *
+   * \param file binary trace file
+   * \param filename name of the ascii trace file replaced
+   */
+  OutputStreamWrapper (Ptr<BinaryTraceFile> file, std::string filename);
   ~OutputStreamWrapper ();
 
   /**
@@ -92,9 +103,22 @@ public:
    */
   std::ostream *GetStream (void);
 
+  /**
+   * \returns the binary trace file this stream records to, or 0 for a
+   * plain text stream
+   */
+  Ptr<BinaryTraceFile> GetBinaryTraceFile (void) const;
+
+  /**
+   * \returns the source identifier of this stream in its binary trace file
+   */
+  uint32_t GetBinarySource (void) const;
+
 private:
   std::ostream *m_ostream; //!< The output stream
   bool m_destroyable; //!< Can be destroyed
+  Ptr<BinaryTraceFile> m_binary; //!< Binary trace file, if any
+  uint32_t m_binarySource; //!< Source identifier in the binary trace file
 };
 
 } // namespace ns3
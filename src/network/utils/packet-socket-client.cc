@@ -27,6 +27,7 @@
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
+#include "ns3/packet-pool.h"
 #include "ns3/uinteger.h"
 #include "ns3/abort.h"
 #include "packet-socket-client.h"
@@ -66,6 +67,13 @@ PacketSocketClient::GetTypeId (void)
                    MakeUintegerAccessor (&PacketSocketClient::SetPriority,
                                          &PacketSocketClient::GetPriority),
                    MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("PacketPoolSize",
+                   "The number of packets allocated in advance and recycled once "
+                   "they are no longer in use. The value zero disables the "
+                   "packet pool.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PacketSocketClient::m_packetPoolSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("Tx", "A packet has been sent",
                      MakeTraceSourceAccessor (&PacketSocketClient::m_txTrace),
                      "ns3::Packet::AddressTracedCallback")
@@ -99,6 +107,7 @@ void
 PacketSocketClient::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_packetPool = 0;
   Application::DoDispose ();
 }
 
@@ -137,6 +146,11 @@ PacketSocketClient::StartApplication (void)
           m_socket->SetPriority (m_priority);
         }
     }
+  if (m_packetPoolSize > 0 && m_packetPool == 0)
+    {
+      m_packetPool = Create<PacketPool> (m_packetPoolSize);
+      m_packetPool->Reserve (m_packetPoolSize);
+    }
 
   m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
   m_sendEvent = Simulator::ScheduleNow (&PacketSocketClient::Send, this);
@@ -156,7 +170,15 @@ PacketSocketClient::Send (void)
   NS_LOG_FUNCTION (this);
   NS_ASSERT (m_sendEvent.IsExpired ());
 
-  Ptr<Packet> p = Create<Packet> (m_size);
+  Ptr<Packet> p;
+  if (m_packetPool != 0)
+    {
+      p = m_packetPool->Allocate (m_size);
+    }
+  else
+    {
+      p = Create<Packet> (m_size);
+    }
 
   std::stringstream peerAddressStringStream;
   peerAddressStringStream << PacketSocketAddress::ConvertFrom (m_peerAddress);
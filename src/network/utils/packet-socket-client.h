@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Socket;
 class Packet;
+class PacketPool;
 
 /**
  * \ingroup socket
@@ -103,6 +104,8 @@ private:
   PacketSocketAddress m_peerAddress; //!< Remote peer address
   bool m_peerAddressSet; //!< Sanity check
   EventId m_sendEvent;   //!< Event to send the next packet
+  uint32_t m_packetPoolSize;     //!< Size of the packet pool (zero to disable it)
+  Ptr<PacketPool> m_packetPool;  //!< Pool the packets are allocated from, if any
 
   /// Traced Callback: sent packets, source address.
   TracedCallback<Ptr<const Packet>, const Address &> m_txTrace;
@@ -52,6 +52,7 @@ PcapFileWrapper::GetTypeId (void)
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_ngInterface (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,6 +67,10 @@ bool
 PcapFileWrapper::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_ngFile)
+    {
+      return m_ngFile->Fail ();
+    }
   return m_file.Fail ();
 }
 
@@ -86,6 +91,10 @@ void
 PcapFileWrapper::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  //
+  // A shared pcapng file is closed when its last user releases it.
+  //
+  m_ngFile = 0;
   m_file.Close ();
 }
 
@@ -115,10 +124,29 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
     } 
 }
 
+void
+PcapFileWrapper::Init (Ptr<PcapNgFileWrapper> file, uint32_t dataLinkType,
+                       std::string const &name, uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (this << file << dataLinkType << name << snapLen);
+  NS_ASSERT (file != 0);
+  if (snapLen == std::numeric_limits<uint32_t>::max ())
+    {
+      snapLen = m_snapLen;
+    }
+  m_ngFile = file;
+  m_ngInterface = file->AddInterface (dataLinkType, name, snapLen);
+}
+
 void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (m_ngFile)
+    {
+      m_ngFile->Write (t, m_ngInterface, p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -139,6 +167,11 @@ void
 PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (m_ngFile)
+    {
+      m_ngFile->Write (t, m_ngInterface, header, p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -159,6 +192,11 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (m_ngFile)
+    {
+      m_ngFile->Write (t, m_ngInterface, buffer, length);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -27,6 +27,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "pcap-file.h"
+#include "pcapng-file-wrapper.h"
 
 namespace ns3 {
 
@@ -109,6 +110,25 @@ public:
              uint32_t snapLen = std::numeric_limits<uint32_t>::max (), 
              int32_t tzCorrection = PcapFile::ZONE_DEFAULT);
 
+  /**
+   * Initialize this wrapper to record its packets on a new interface of a
+   * pcapng file shared with other wrappers, instead of a pcap file of its
+   * own.  No file must have been opened on this wrapper.
+   *
+   * \param file The shared pcapng file.
+   *
+   * \param dataLinkType A data link type as defined in the pcap library.
+   *
+   * \param name The name of the interface in the pcapng file.
+   *
+   * \param snapLen An optional maximum size for packets written to the file.
+   * If not provided, the "CaptureSize" Attribute is used.
+   */
+  void Init (Ptr<PcapNgFileWrapper> file,
+             uint32_t dataLinkType,
+             std::string const &name,
+             uint32_t snapLen = std::numeric_limits<uint32_t>::max ());
+
   /**
    * \brief Write the next packet to file
    * 
@@ -224,6 +244,8 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  Ptr<PcapNgFileWrapper> m_ngFile; //!< Shared pcapng file, if any
+  uint32_t m_ngInterface; //!< Interface of this wrapper in m_ngFile
 };
 
 } // namespace ns3
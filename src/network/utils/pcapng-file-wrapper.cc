@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/buffer.h"
+#include "ns3/header.h"
+#include "pcapng-file-wrapper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFileWrapper");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapNgFileWrapper);
+
+TypeId
+PcapNgFileWrapper::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapNgFileWrapper")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<PcapNgFileWrapper> ()
+    .AddAttribute ("CaptureSize",
+                   "Default maximum length of captured packets of each interface (cf. pcap snaplen)",
+                   UintegerValue (PcapNgFile::SNAPLEN_DEFAULT),
+                   MakeUintegerAccessor (&PcapNgFileWrapper::m_snapLen),
+                   MakeUintegerChecker<uint32_t> (0, PcapNgFile::SNAPLEN_DEFAULT))
+  ;
+  return tid;
+}
+
+PcapNgFileWrapper::PcapNgFileWrapper ()
+  : m_tsUnit (Time::US),
+    m_tsNative (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapNgFileWrapper::~PcapNgFileWrapper ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapNgFileWrapper::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.Fail ();
+}
+
+bool
+PcapNgFileWrapper::Eof (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.Eof ();
+}
+
+void
+PcapNgFileWrapper::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Clear ();
+}
+
+void
+PcapNgFileWrapper::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Close ();
+}
+
+void
+PcapNgFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
+{
+  NS_LOG_FUNCTION (this << filename << mode);
+  m_file.Open (filename, mode);
+}
+
+void
+PcapNgFileWrapper::Init (void)
+{
+  NS_LOG_FUNCTION (this);
+  //
+  // Timestamps are stored in the Time resolution so that they can be taken
+  // verbatim from the Time step count.  pcapng only knows about powers of
+  // ten of one second, so resolutions coarser than that are upgraded.
+  //
+  Time::Unit resolution = Time::GetResolution ();
+  m_tsUnit = resolution < Time::S ? Time::S : resolution;
+  m_tsNative = (m_tsUnit == resolution);
+  m_file.Init ("ns-3");
+}
+
+uint32_t
+PcapNgFileWrapper::AddInterface (uint32_t dataLinkType, std::string const &name, uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << name << snapLen);
+  //
+  // If the user doesn't provide a snaplen, we use the "CaptureSize" Attribute.
+  //
+  if (snapLen == std::numeric_limits<uint32_t>::max ())
+    {
+      snapLen = m_snapLen;
+    }
+  uint8_t tsResol = 3 * (m_tsUnit - Time::S);
+  return m_file.AddInterface (dataLinkType, snapLen, name, tsResol);
+}
+
+uint64_t
+PcapNgFileWrapper::GetTimestamp (Time t) const
+{
+  if (m_tsNative)
+    {
+      return t.GetTimeStep ();
+    }
+  return t.ToInteger (m_tsUnit);
+}
+
+void
+PcapNgFileWrapper::Write (Time t, uint32_t interfaceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << interfaceId << p);
+  m_file.Write (interfaceId, GetTimestamp (t), p);
+}
+
+void
+PcapNgFileWrapper::Write (Time t, uint32_t interfaceId, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << interfaceId << &header << p);
+  m_file.Write (interfaceId, GetTimestamp (t), header, p);
+}
+
+void
+PcapNgFileWrapper::Write (Time t, uint32_t interfaceId, uint8_t const *buffer, uint32_t length)
+{
+  NS_LOG_FUNCTION (this << t << interfaceId << &buffer << length);
+  m_file.Write (interfaceId, GetTimestamp (t), buffer, length);
+}
+
+Ptr<Packet>
+PcapNgFileWrapper::Read (Time &t, uint32_t &interfaceId)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t timestamp;
+  uint32_t inclLen;
+  uint32_t origLen;
+  uint32_t readLen;
+
+  uint32_t maxBytes = 65536;
+  uint8_t datbuf[maxBytes];
+
+  m_file.Read (datbuf, maxBytes, interfaceId, timestamp, inclLen, origLen, readLen);
+
+  if (m_file.Fail ())
+    {
+      return 0;
+    }
+
+  //
+  // if_tsresol is a negative power of 10 unless its most significant bit is
+  // set, in which case it is a negative power of 2.
+  //
+  uint8_t tsResol = interfaceId < m_file.GetNInterfaces () ?
+    m_file.GetTsResol (interfaceId) : PcapNgFile::TSRESOL_DEFAULT;
+  if ((tsResol & 0x80) == 0 && tsResol % 3 == 0 && tsResol <= 15)
+    {
+      t = Time::FromInteger (timestamp, static_cast<Time::Unit> (Time::S + tsResol / 3));
+    }
+  else if (tsResol & 0x80)
+    {
+      t = Seconds (std::ldexp (static_cast<double> (timestamp), -(tsResol & 0x7f)));
+    }
+  else
+    {
+      t = Seconds (static_cast<double> (timestamp) * std::pow (10.0, -tsResol));
+    }
+
+  return Create<Packet> (datbuf, readLen);
+}
+
+uint32_t
+PcapNgFileWrapper::GetNInterfaces (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.GetNInterfaces ();
+}
+
+uint32_t
+PcapNgFileWrapper::GetDataLinkType (uint32_t interfaceId) const
+{
+  NS_LOG_FUNCTION (this << interfaceId);
+  return m_file.GetDataLinkType (interfaceId);
+}
+
+std::string
+PcapNgFileWrapper::GetInterfaceName (uint32_t interfaceId) const
+{
+  NS_LOG_FUNCTION (this << interfaceId);
+  return m_file.GetInterfaceName (interfaceId);
+}
+
+} // namespace ns3
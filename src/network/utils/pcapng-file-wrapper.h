@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_WRAPPER_H
+#define PCAPNG_FILE_WRAPPER_H
+
+#include <limits>
+#include <fstream>
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "pcapng-file.h"
+
+namespace ns3 {
+
+/**
+ * A class that wraps a PcapNgFile as an ns3::Object and provides a
+ * higher-layer ns-3 interface to the low-level public methods of PcapNgFile.
+ *
+ * A single PcapNgFileWrapper is meant to be shared by many trace sources:
+ * every NetDevice gets its own interface (see AddInterface ()) and all the
+ * packets are streamed into the same file.  Timestamps are stored at the
+ * current Time resolution, so no precision is lost when converting them.
+ */
+class PcapNgFileWrapper : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapNgFileWrapper ();
+  ~PcapNgFileWrapper ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+  /**
+   * \return true if the 'eof' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Eof (void) const;
+  /**
+   * Clear all state bits of the underlying iostream.
+   */
+  void Clear (void);
+
+  /**
+   * Create a new pcapng file or open an existing pcapng file.
+   *
+   * \param filename String containing the name of the file.
+   * \param mode the access mode for the file.
+   */
+  void Open (std::string const &filename, std::ios::openmode mode);
+
+  /**
+   * Close the underlying pcapng file.
+   */
+  void Close (void);
+
+  /**
+   * Initialize the pcapng file associated with this wrapper by writing its
+   * section header.  This file must have been previously opened with write
+   * permissions.
+   */
+  void Init (void);
+
+  /**
+   * \brief Describe a new capture interface in the file.
+   *
+   * The timestamp resolution of the interface is the current Time
+   * resolution (or one second, if the Time resolution is coarser).
+   *
+   * \param dataLinkType A data link type as defined in the pcap library.
+   * \param name The name of the interface, usually derived from the device.
+   * \param snapLen An optional maximum size for packets written on this
+   * interface.  If not provided, the "CaptureSize" Attribute is used.
+   * \returns the interface identifier to be used with Write ().
+   */
+  uint32_t AddInterface (uint32_t dataLinkType,
+                         std::string const &name,
+                         uint32_t snapLen = std::numeric_limits<uint32_t>::max ());
+
+  /**
+   * \brief Write the next packet to file
+   *
+   * \param t Packet timestamp as ns3::Time.
+   * \param interfaceId the interface the packet was captured on.
+   * \param p Packet to write to the pcapng file.
+   */
+  void Write (Time t, uint32_t interfaceId, Ptr<const Packet> p);
+
+  /**
+   * \brief Write the provided header along with the packet to the pcapng file.
+   *
+   * \param t Packet timestamp as ns3::Time.
+   * \param interfaceId the interface the packet was captured on.
+   * \param header The Header to prepend to the packet.
+   * \param p Packet to write to the pcapng file.
+   */
+  void Write (Time t, uint32_t interfaceId, const Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Write the provided data buffer to the pcapng file.
+   *
+   * \param t Packet timestamp as ns3::Time.
+   * \param interfaceId the interface the packet was captured on.
+   * \param buffer The buffer to write.
+   * \param length The size of the buffer.
+   */
+  void Write (Time t, uint32_t interfaceId, uint8_t const *buffer, uint32_t length);
+
+  /**
+   * \brief Read the next packet from the file.
+   *
+   * \param t [out] packet timestamp as ns3::Time.
+   * \param interfaceId [out] the interface the packet was captured on.
+   * \returns a pointer to ns3::Packet, or 0 at the end of the file.
+   */
+  Ptr<Packet> Read (Time &t, uint32_t &interfaceId);
+
+  /**
+   * \returns the number of interfaces described in the file so far.
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \param interfaceId the interface identifier
+   * \returns the data link type of the interface
+   */
+  uint32_t GetDataLinkType (uint32_t interfaceId) const;
+
+  /**
+   * \param interfaceId the interface identifier
+   * \returns the name of the interface
+   */
+  std::string GetInterfaceName (uint32_t interfaceId) const;
+
+private:
+  /**
+   * \param t a Time
+   * \returns the timestamp of \p t in units of the interfaces resolution
+   */
+  uint64_t GetTimestamp (Time t) const;
+
+  PcapNgFile m_file;        //!< Pcapng file
+  uint32_t m_snapLen;       //!< max length of saved packets
+  Time::Unit m_tsUnit;      //!< unit of the timestamps written to the file
+  bool m_tsNative;          //!< whether m_tsUnit is the Time resolution
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_WRAPPER_H */
@@ -0,0 +1,561 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/packet.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "pcapng-file.h"
+#include "ns3/log.h"
+#include "ns3/build-profile.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFile");
+
+const uint32_t SHB_TYPE = 0x0a0d0d0a;         /**< Section Header Block type (byte order independent) */
+const uint32_t IDB_TYPE = 0x00000001;         /**< Interface Description Block type */
+const uint32_t SPB_TYPE = 0x00000003;         /**< Simple Packet Block type */
+const uint32_t EPB_TYPE = 0x00000006;         /**< Enhanced Packet Block type */
+
+const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d;         /**< Byte-order magic of the section header */
+const uint32_t SWAPPED_BYTE_ORDER_MAGIC = 0x4d3c2b1a; /**< Looks this way if byte swapping is required */
+
+const uint16_t VERSION_MAJOR = 1;             /**< Major version of supported pcapng file format */
+const uint16_t VERSION_MINOR = 0;             /**< Minor version of supported pcapng file format */
+
+const uint16_t OPT_ENDOFOPT = 0;              /**< End of options */
+const uint16_t OPT_SHB_USERAPPL = 4;          /**< Name of the application that wrote the section */
+const uint16_t OPT_IF_NAME = 2;               /**< Name of the interface */
+const uint16_t OPT_IF_TSRESOL = 9;            /**< Timestamp resolution of the interface */
+
+/** Size of the fixed part of an Enhanced Packet Block, including both length fields */
+const uint32_t EPB_FIXED_SIZE = 32;
+/** Size of block type and both block length fields */
+const uint32_t BLOCK_OVERHEAD = 12;
+
+/**
+ * \param len a length in bytes
+ * \returns the length rounded up to the next multiple of 32 bits
+ */
+static inline uint32_t
+Pad32 (uint32_t len)
+{
+  return (len + 3) & ~3U;
+}
+
+PcapNgFile::PcapNgFile ()
+  : m_file (),
+    m_swapMode (false)
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::RegisterStream (&m_file);
+}
+
+PcapNgFile::~PcapNgFile ()
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::UnregisterStream (&m_file);
+  Close ();
+}
+
+bool
+PcapNgFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.fail ();
+}
+
+bool
+PcapNgFile::Eof (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.eof ();
+}
+
+void
+PcapNgFile::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.clear ();
+}
+
+void
+PcapNgFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.close ();
+}
+
+bool
+PcapNgFile::GetSwapMode (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_swapMode;
+}
+
+uint32_t
+PcapNgFile::GetNInterfaces (void) const
+{
+  return m_interfaces.size ();
+}
+
+uint16_t
+PcapNgFile::GetDataLinkType (uint32_t interfaceId) const
+{
+  NS_ASSERT (interfaceId < m_interfaces.size ());
+  return m_interfaces[interfaceId].m_linkType;
+}
+
+uint32_t
+PcapNgFile::GetSnapLen (uint32_t interfaceId) const
+{
+  NS_ASSERT (interfaceId < m_interfaces.size ());
+  return m_interfaces[interfaceId].m_snapLen;
+}
+
+std::string
+PcapNgFile::GetInterfaceName (uint32_t interfaceId) const
+{
+  NS_ASSERT (interfaceId < m_interfaces.size ());
+  return m_interfaces[interfaceId].m_name;
+}
+
+uint8_t
+PcapNgFile::GetTsResol (uint32_t interfaceId) const
+{
+  NS_ASSERT (interfaceId < m_interfaces.size ());
+  return m_interfaces[interfaceId].m_tsResol;
+}
+
+uint16_t
+PcapNgFile::Fix (uint16_t val) const
+{
+  if (!m_swapMode)
+    {
+      return val;
+    }
+  return ((val >> 8) & 0x00ff) | ((val << 8) & 0xff00);
+}
+
+uint32_t
+PcapNgFile::Fix (uint32_t val) const
+{
+  if (!m_swapMode)
+    {
+      return val;
+    }
+  return ((val >> 24) & 0x000000ff) | ((val >> 8) & 0x0000ff00) | ((val << 8) & 0x00ff0000) | ((val << 24) & 0xff000000);
+}
+
+void
+PcapNgFile::Append (std::vector<uint8_t> &block, uint16_t val)
+{
+  uint8_t const *p = reinterpret_cast<uint8_t const *> (&val);
+  block.insert (block.end (), p, p + sizeof (val));
+}
+
+void
+PcapNgFile::Append (std::vector<uint8_t> &block, uint32_t val)
+{
+  uint8_t const *p = reinterpret_cast<uint8_t const *> (&val);
+  block.insert (block.end (), p, p + sizeof (val));
+}
+
+void
+PcapNgFile::AppendOption (std::vector<uint8_t> &block, uint16_t code,
+                          uint8_t const *value, uint16_t length)
+{
+  Append (block, code);
+  Append (block, length);
+  block.insert (block.end (), value, value + length);
+  block.resize (block.size () + Pad32 (length) - length, 0);
+}
+
+void
+PcapNgFile::WriteBlock (std::vector<uint8_t> &block)
+{
+  NS_LOG_FUNCTION (this << block.size ());
+  NS_ASSERT (block.size () >= 2 * sizeof (uint32_t));
+  NS_ASSERT (block.size () % 4 == 0);
+  //
+  // The block is built with a placeholder for its leading length; the
+  // trailing length is appended here once the total size is known.
+  //
+  uint32_t total = block.size () + sizeof (uint32_t);
+  std::memcpy (&block[sizeof (uint32_t)], &total, sizeof (total));
+  Append (block, total);
+  m_file.write ((const char *)&block[0], block.size ());
+  NS_BUILD_DEBUG (m_file.flush ());
+}
+
+void
+PcapNgFile::Open (std::string const &filename, std::ios::openmode mode)
+{
+  NS_LOG_FUNCTION (this << filename << mode);
+  NS_ASSERT ((mode & std::ios::app) == 0);
+  NS_ASSERT (!m_file.fail ());
+  //
+  // All pcapng files are binary files, so we just do this automatically.
+  //
+  mode |= std::ios::binary;
+
+  m_filename = filename;
+  m_swapMode = false;
+  m_interfaces.clear ();
+  m_file.open (filename.c_str (), mode);
+  if (mode & std::ios::in)
+    {
+      //
+      // A pcapng file must start with a section header.  Reading it sets the
+      // byte order of everything that follows; the fail bit is set if it is
+      // invalid.
+      //
+      uint32_t type = 0;
+      std::vector<uint8_t> body;
+      if (!ReadBlock (type, body) || type != SHB_TYPE)
+        {
+          m_file.setstate (std::ios::failbit);
+          m_file.close ();
+        }
+    }
+}
+
+void
+PcapNgFile::Init (std::string const &userApplication)
+{
+  NS_LOG_FUNCTION (this << userApplication);
+
+  m_swapMode = false;
+  m_interfaces.clear ();
+
+  //
+  // pcapng readers detect the byte order from the byte-order magic, so we
+  // simply write every field in the native byte order of this system.
+  //
+  std::vector<uint8_t> block;
+  Append (block, SHB_TYPE);
+  Append (block, uint32_t (0));
+  Append (block, BYTE_ORDER_MAGIC);
+  Append (block, VERSION_MAJOR);
+  Append (block, VERSION_MINOR);
+  // Section length is not known when streaming: -1
+  Append (block, uint32_t (0xffffffff));
+  Append (block, uint32_t (0xffffffff));
+  if (!userApplication.empty ())
+    {
+      AppendOption (block, OPT_SHB_USERAPPL,
+                    reinterpret_cast<uint8_t const *> (userApplication.data ()),
+                    userApplication.size ());
+      AppendOption (block, OPT_ENDOFOPT, 0, 0);
+    }
+  WriteBlock (block);
+}
+
+uint32_t
+PcapNgFile::AddInterface (uint16_t dataLinkType, uint32_t snapLen, std::string const &name, uint8_t tsResol)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name << static_cast<uint32_t> (tsResol));
+  NS_ASSERT (m_file.good ());
+
+  Interface iface;
+  iface.m_linkType = dataLinkType;
+  iface.m_snapLen = snapLen;
+  iface.m_name = name;
+  iface.m_tsResol = tsResol;
+  m_interfaces.push_back (iface);
+
+  std::vector<uint8_t> block;
+  Append (block, IDB_TYPE);
+  Append (block, uint32_t (0));
+  Append (block, dataLinkType);
+  Append (block, uint16_t (0));
+  Append (block, snapLen);
+  if (!name.empty ())
+    {
+      AppendOption (block, OPT_IF_NAME,
+                    reinterpret_cast<uint8_t const *> (name.data ()), name.size ());
+    }
+  if (tsResol != TSRESOL_DEFAULT)
+    {
+      AppendOption (block, OPT_IF_TSRESOL, &tsResol, sizeof (tsResol));
+    }
+  if (!name.empty () || tsResol != TSRESOL_DEFAULT)
+    {
+      AppendOption (block, OPT_ENDOFOPT, 0, 0);
+    }
+  WriteBlock (block);
+
+  return m_interfaces.size () - 1;
+}
+
+uint32_t
+PcapNgFile::WritePacketHeader (uint32_t interfaceId, uint64_t timestamp, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interfaceId << timestamp << totalLen);
+  NS_ASSERT (m_file.good ());
+  NS_ASSERT_MSG (interfaceId < m_interfaces.size (), "Unknown pcapng interface " << interfaceId);
+
+  uint32_t snapLen = m_interfaces[interfaceId].m_snapLen;
+  uint32_t inclLen = (snapLen != 0 && totalLen > snapLen) ? snapLen : totalLen;
+
+  uint32_t header[7];
+  header[0] = EPB_TYPE;
+  header[1] = EPB_FIXED_SIZE + Pad32 (inclLen);
+  header[2] = interfaceId;
+  header[3] = static_cast<uint32_t> (timestamp >> 32);
+  header[4] = static_cast<uint32_t> (timestamp & 0xffffffff);
+  header[5] = inclLen;
+  header[6] = totalLen;
+  m_file.write ((const char *)header, sizeof (header));
+  return inclLen;
+}
+
+void
+PcapNgFile::WritePacketTrailer (uint32_t inclLen)
+{
+  NS_LOG_FUNCTION (this << inclLen);
+  static const uint8_t zero[4] = { 0, 0, 0, 0 };
+  m_file.write ((const char *)zero, Pad32 (inclLen) - inclLen);
+  uint32_t total = EPB_FIXED_SIZE + Pad32 (inclLen);
+  m_file.write ((const char *)&total, sizeof (total));
+  NS_BUILD_DEBUG (m_file.flush ());
+}
+
+void
+PcapNgFile::Write (uint32_t interfaceId, uint64_t timestamp, uint8_t const * const data, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interfaceId << timestamp << &data << totalLen);
+  uint32_t inclLen = WritePacketHeader (interfaceId, timestamp, totalLen);
+  m_file.write ((const char *)data, inclLen);
+  WritePacketTrailer (inclLen);
+}
+
+void
+PcapNgFile::Write (uint32_t interfaceId, uint64_t timestamp, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interfaceId << timestamp << p);
+  uint32_t inclLen = WritePacketHeader (interfaceId, timestamp, p->GetSize ());
+  p->CopyData (&m_file, inclLen);
+  WritePacketTrailer (inclLen);
+}
+
+void
+PcapNgFile::Write (uint32_t interfaceId, uint64_t timestamp, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interfaceId << timestamp << &header << p);
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t totalSize = headerSize + p->GetSize ();
+  uint32_t inclLen = WritePacketHeader (interfaceId, timestamp, totalSize);
+
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, inclLen);
+  headerBuffer.CopyData (&m_file, toCopy);
+  p->CopyData (&m_file, inclLen - toCopy);
+  WritePacketTrailer (inclLen);
+}
+
+bool
+PcapNgFile::ReadBlock (uint32_t &type, std::vector<uint8_t> &body)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t length = 0;
+  m_file.read ((char *)&type, sizeof (type));
+  m_file.read ((char *)&length, sizeof (length));
+  if (m_file.fail ())
+    {
+      return false;
+    }
+
+  if (type == SHB_TYPE)
+    {
+      //
+      // A new section starts; its byte-order magic tells us whether the
+      // fields of this section (including the length we just read) must be
+      // byte swapped.
+      //
+      uint32_t magic = 0;
+      m_file.read ((char *)&magic, sizeof (magic));
+      if (m_file.fail ()
+          || (magic != BYTE_ORDER_MAGIC && magic != SWAPPED_BYTE_ORDER_MAGIC))
+        {
+          m_file.setstate (std::ios::failbit);
+          return false;
+        }
+      m_swapMode = (magic == SWAPPED_BYTE_ORDER_MAGIC);
+      m_interfaces.clear ();
+      m_file.seekg (-static_cast<std::streamoff> (sizeof (magic)), std::ios::cur);
+    }
+  else
+    {
+      type = Fix (type);
+    }
+
+  length = Fix (length);
+  if (length < BLOCK_OVERHEAD || length % 4 != 0)
+    {
+      m_file.setstate (std::ios::failbit);
+      return false;
+    }
+
+  body.resize (length - BLOCK_OVERHEAD);
+  if (!body.empty ())
+    {
+      m_file.read ((char *)&body[0], body.size ());
+    }
+  uint32_t trailer = 0;
+  m_file.read ((char *)&trailer, sizeof (trailer));
+  if (m_file.fail ())
+    {
+      return false;
+    }
+  if (Fix (trailer) != length)
+    {
+      m_file.setstate (std::ios::failbit);
+      return false;
+    }
+
+  if (type == SHB_TYPE)
+    {
+      uint16_t major = 0;
+      if (body.size () < 16)
+        {
+          m_file.setstate (std::ios::failbit);
+          return false;
+        }
+      std::memcpy (&major, &body[4], sizeof (major));
+      //
+      // We only deal with one major version of the pcapng file format.
+      //
+      if (Fix (major) != VERSION_MAJOR)
+        {
+          m_file.setstate (std::ios::failbit);
+          return false;
+        }
+    }
+  else if (type == IDB_TYPE)
+    {
+      ParseInterface (body);
+    }
+  return true;
+}
+
+void
+PcapNgFile::ParseInterface (std::vector<uint8_t> const &body)
+{
+  NS_LOG_FUNCTION (this << body.size ());
+  if (body.size () < 8)
+    {
+      m_file.setstate (std::ios::failbit);
+      return;
+    }
+
+  Interface iface;
+  uint16_t linkType;
+  uint32_t snapLen;
+  std::memcpy (&linkType, &body[0], sizeof (linkType));
+  std::memcpy (&snapLen, &body[4], sizeof (snapLen));
+  iface.m_linkType = Fix (linkType);
+  iface.m_snapLen = Fix (snapLen);
+  iface.m_tsResol = TSRESOL_DEFAULT;
+
+  uint32_t offset = 8;
+  while (offset + 4 <= body.size ())
+    {
+      uint16_t code;
+      uint16_t length;
+      std::memcpy (&code, &body[offset], sizeof (code));
+      std::memcpy (&length, &body[offset + 2], sizeof (length));
+      code = Fix (code);
+      length = Fix (length);
+      offset += 4;
+      if (code == OPT_ENDOFOPT || offset + length > body.size ())
+        {
+          break;
+        }
+      if (code == OPT_IF_NAME)
+        {
+          iface.m_name.assign ((char const *)&body[offset], length);
+        }
+      else if (code == OPT_IF_TSRESOL && length >= 1)
+        {
+          iface.m_tsResol = body[offset];
+        }
+      offset += Pad32 (length);
+    }
+  m_interfaces.push_back (iface);
+}
+
+void
+PcapNgFile::Read (
+  uint8_t * const data,
+  uint32_t maxBytes,
+  uint32_t &interfaceId,
+  uint64_t &timestamp,
+  uint32_t &inclLen,
+  uint32_t &origLen,
+  uint32_t &readLen)
+{
+  NS_LOG_FUNCTION (this << &data << maxBytes);
+  NS_ASSERT (m_file.good ());
+
+  std::vector<uint8_t> body;
+  uint32_t type = 0;
+  while (ReadBlock (type, body))
+    {
+      uint32_t dataOffset;
+      if (type == EPB_TYPE && body.size () >= EPB_FIXED_SIZE - BLOCK_OVERHEAD)
+        {
+          uint32_t fields[5];
+          std::memcpy (fields, &body[0], sizeof (fields));
+          interfaceId = Fix (fields[0]);
+          timestamp = (static_cast<uint64_t> (Fix (fields[1])) << 32) | Fix (fields[2]);
+          inclLen = Fix (fields[3]);
+          origLen = Fix (fields[4]);
+          dataOffset = sizeof (fields);
+        }
+      else if (type == SPB_TYPE && body.size () >= 4)
+        {
+          uint32_t len;
+          std::memcpy (&len, &body[0], sizeof (len));
+          interfaceId = 0;
+          timestamp = 0;
+          origLen = Fix (len);
+          inclLen = std::min<uint32_t> (origLen, body.size () - 4);
+          dataOffset = 4;
+        }
+      else
+        {
+          continue;
+        }
+
+      if (dataOffset + inclLen > body.size ())
+        {
+          m_file.setstate (std::ios::failbit);
+          return;
+        }
+      readLen = std::min (maxBytes, inclLen);
+      std::memcpy (data, body.data () + dataOffset, readLen);
+      return;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,303 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+
+/**
+ * \brief A class representing a pcapng file
+ *
+ * Unlike a classic pcap file, which carries a single data link type and
+ * snap length in its global header, a pcapng file may describe any number
+ * of capture interfaces through Interface Description Blocks (IDB).  Every
+ * Enhanced Packet Block (EPB) refers to one of those interfaces, so the
+ * traffic of all the devices of a simulation can be recorded into a single
+ * file and processed with a single reader pass.
+ *
+ * Blocks are streamed to the underlying file as soon as they are written;
+ * an interface can be added at any time before its first packet.  Each
+ * interface carries its own timestamp resolution (if_tsresol option), which
+ * allows timestamps to be stored at the native ns-3 Time resolution
+ * (nanoseconds, picoseconds, ...) rather than being rounded to microseconds.
+ *
+ * See https://www.ietf.org/archive/id/draft-tuexen-opsawg-pcapng-05.html
+ */
+class PcapNgFile
+{
+public:
+  static const uint32_t SNAPLEN_DEFAULT = 65535;   /**< Default value for maximum octets to save per packet */
+  static const uint8_t  TSRESOL_DEFAULT = 6;       /**< Default (microsecond) timestamp resolution, as a power of 10 */
+
+  PcapNgFile ();
+  ~PcapNgFile ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+  /**
+   * \return true if the 'eof' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Eof (void) const;
+  /**
+   * Clear all state bits of the underlying iostream.
+   */
+  void Clear (void);
+
+  /**
+   * Create a new pcapng file or open an existing pcapng file.  When the file
+   * is opened for reading, the first Section Header Block is read and
+   * verified, and the file position points to the first block following it.
+   *
+   * The file type is automatically selected as a binary file.
+   *
+   * \param filename String containing the name of the file.
+   * \param mode the access mode for the file.
+   */
+  void Open (std::string const &filename, std::ios::openmode mode);
+
+  /**
+   * Close the underlying file.
+   */
+  void Close (void);
+
+  /**
+   * Initialize the pcapng file associated with this object by writing a
+   * Section Header Block.  This file must have been previously opened with
+   * write permissions.  No interface is described yet; use AddInterface ()
+   * before writing packets.
+   *
+   * \param userApplication An optional string stored in the shb_userappl
+   * option of the section header.
+   */
+  void Init (std::string const &userApplication = "");
+
+  /**
+   * \brief Describe a new capture interface in the current section.
+   *
+   * An Interface Description Block is written immediately to the file.
+   *
+   * \param dataLinkType A data link type as defined in the pcap library
+   * (see PcapHelper::DataLinkType).
+   * \param snapLen Maximum length of packet data stored for this interface.
+   * \param name Interface name stored in the if_name option (may be empty).
+   * \param tsResol Timestamp resolution of this interface, as a (negative)
+   * power of 10 of one second, stored in the if_tsresol option.
+   * \returns the interface identifier to be used with Write ().
+   */
+  uint32_t AddInterface (uint16_t dataLinkType,
+                         uint32_t snapLen = SNAPLEN_DEFAULT,
+                         std::string const &name = "",
+                         uint8_t tsResol = TSRESOL_DEFAULT);
+
+  /**
+   * \returns the number of interfaces described in the current section.
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \param interfaceId the interface identifier
+   * \returns the data link type of the interface
+   */
+  uint16_t GetDataLinkType (uint32_t interfaceId) const;
+
+  /**
+   * \param interfaceId the interface identifier
+   * \returns the snap length of the interface (0 if unlimited)
+   */
+  uint32_t GetSnapLen (uint32_t interfaceId) const;
+
+  /**
+   * \param interfaceId the interface identifier
+   * \returns the name of the interface
+   */
+  std::string GetInterfaceName (uint32_t interfaceId) const;
+
+  /**
+   * \param interfaceId the interface identifier
+   * \returns the timestamp resolution of the interface, as a power of 10
+   */
+  uint8_t GetTsResol (uint32_t interfaceId) const;
+
+  /**
+   * \brief Write next packet to file as an Enhanced Packet Block
+   *
+   * \param interfaceId Interface the packet was captured on
+   * \param timestamp   Packet timestamp, in units of the interface resolution
+   * \param data        Data buffer
+   * \param totalLen    Total packet length
+   */
+  void Write (uint32_t interfaceId, uint64_t timestamp, uint8_t const * const data, uint32_t totalLen);
+
+  /**
+   * \brief Write next packet to file as an Enhanced Packet Block
+   *
+   * \param interfaceId Interface the packet was captured on
+   * \param timestamp   Packet timestamp, in units of the interface resolution
+   * \param p           Packet to write
+   */
+  void Write (uint32_t interfaceId, uint64_t timestamp, Ptr<const Packet> p);
+
+  /**
+   * \brief Write next packet to file as an Enhanced Packet Block
+   *
+   * \param interfaceId Interface the packet was captured on
+   * \param timestamp   Packet timestamp, in units of the interface resolution
+   * \param header      Header to write, in front of packet
+   * \param p           Packet to write
+   */
+  void Write (uint32_t interfaceId, uint64_t timestamp, const Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Read next packet from file
+   *
+   * Section Header and Interface Description Blocks met on the way are
+   * consumed and update the interface table; blocks of unknown type are
+   * skipped.  Simple Packet Blocks are reported on interface 0 with a zero
+   * timestamp.
+   *
+   * \param data        [out] Data buffer
+   * \param maxBytes    Allocated data buffer size
+   * \param interfaceId [out] Interface the packet was captured on
+   * \param timestamp   [out] Packet timestamp, in units of the interface resolution
+   * \param inclLen     [out] Included length
+   * \param origLen     [out] Original length
+   * \param readLen     [out] Number of bytes read
+   */
+  void Read (uint8_t * const data,
+             uint32_t maxBytes,
+             uint32_t &interfaceId,
+             uint64_t &timestamp,
+             uint32_t &inclLen,
+             uint32_t &origLen,
+             uint32_t &readLen);
+
+  /**
+   * \brief Get the swap mode of the current section.
+   *
+   * pcapng files are written in the native byte order of the writing system
+   * and identify it through the byte-order magic of the Section Header
+   * Block.  The reader byte swaps every field if that magic is seen swapped.
+   *
+   * \returns swap mode of the current section
+   */
+  bool GetSwapMode (void) const;
+
+private:
+  /**
+   * \brief Description of a capture interface
+   */
+  struct Interface
+  {
+    uint16_t m_linkType;  //!< data link type
+    uint32_t m_snapLen;   //!< maximum length of saved packets
+    std::string m_name;   //!< if_name option
+    uint8_t m_tsResol;    //!< if_tsresol option
+  };
+
+  /**
+   * \brief Swap a value byte order if the current section requires it
+   * \param val the value
+   * \returns the value with byte order fixed
+   */
+  uint16_t Fix (uint16_t val) const;
+  /**
+   * \brief Swap a value byte order if the current section requires it
+   * \param val the value
+   * \returns the value with byte order fixed
+   */
+  uint32_t Fix (uint32_t val) const;
+
+  /**
+   * \brief Append a value to a block under construction
+   * \param block the block
+   * \param val the value
+   */
+  static void Append (std::vector<uint8_t> &block, uint16_t val);
+  /**
+   * \brief Append a value to a block under construction
+   * \param block the block
+   * \param val the value
+   */
+  static void Append (std::vector<uint8_t> &block, uint32_t val);
+  /**
+   * \brief Append an option, padded to 32 bits, to a block under construction
+   * \param block the block
+   * \param code the option code
+   * \param value the option value
+   * \param length the option length
+   */
+  static void AppendOption (std::vector<uint8_t> &block, uint16_t code,
+                            uint8_t const *value, uint16_t length);
+  /**
+   * \brief Patch the leading and trailing length fields of a block and
+   * write it to the file.
+   * \param block the block
+   */
+  void WriteBlock (std::vector<uint8_t> &block);
+
+  /**
+   * \brief Write the fixed part of an Enhanced Packet Block
+   *
+   * \param interfaceId Interface the packet was captured on
+   * \param timestamp Packet timestamp
+   * \param totalLen total packet length
+   * \returns the length of the packet data to write in the file
+   */
+  uint32_t WritePacketHeader (uint32_t interfaceId, uint64_t timestamp, uint32_t totalLen);
+  /**
+   * \brief Write the padding and trailing length of an Enhanced Packet Block
+   * \param inclLen the length of the packet data written in the file
+   */
+  void WritePacketTrailer (uint32_t inclLen);
+
+  /**
+   * \brief Read the next block of the file
+   *
+   * A Section Header Block resets the byte order and the interface table;
+   * an Interface Description Block adds an entry to the interface table.
+   *
+   * \param type [out] the block type
+   * \param body [out] the block body, between the leading and trailing lengths
+   * \returns true if a valid block was read
+   */
+  bool ReadBlock (uint32_t &type, std::vector<uint8_t> &body);
+  /**
+   * \brief Parse the body of an Interface Description Block
+   * \param body the block body, after the block type and length
+   */
+  void ParseInterface (std::vector<uint8_t> const &body);
+
+  std::string    m_filename;                //!< file name
+  std::fstream   m_file;                    //!< file stream
+  bool           m_swapMode;                //!< swap mode of the current section
+  std::vector<Interface> m_interfaces;      //!< interfaces of the current section
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
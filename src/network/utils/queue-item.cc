@@ -146,4 +146,10 @@ QueueDiscItem::Hash (uint32_t perturbation) const
   return 0;
 }
 
+uint32_t
+QueueDiscItem::Hash (Hasher &hasher, uint32_t perturbation) const
+{
+  return Hash (perturbation);
+}
+
 } // namespace ns3
@@ -24,6 +24,7 @@
 #include "ns3/simple-ref-count.h"
 #include <ns3/address.h>
 #include "ns3/nstime.h"
+#include "ns3/hash.h"
 
 namespace ns3 {
 
@@ -226,6 +227,21 @@ public:
    */
   virtual uint32_t Hash (uint32_t perturbation = 0) const;
 
+  /**
+   * \brief Computes the hash of various fields of the packet header with the
+   * given hasher
+   *
+   * Callers hashing many packets can keep a hasher and pass it to every call
+   * rather than having a hasher constructed for each packet. This method
+   * calls Hash (perturbation); subclasses should redefine it along with that
+   * method.
+   *
+   * \param hasher the hasher, cleared before use
+   * \param perturbation hash perturbation value
+   * \return the hash of various fields of the packet header
+   */
+  virtual uint32_t Hash (Hasher &hasher, uint32_t perturbation) const;
+
 private:
   /**
    * \brief Default constructor
@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "segmentation-offload-tag.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SegmentationOffloadTag");
+
+NS_OBJECT_ENSURE_REGISTERED (SegmentationOffloadTag);
+
+TypeId
+SegmentationOffloadTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SegmentationOffloadTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<SegmentationOffloadTag> ()
+  ;
+  return tid;
+}
+TypeId
+SegmentationOffloadTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+SegmentationOffloadTag::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 4;
+}
+void
+SegmentationOffloadTag::Serialize (TagBuffer buf) const
+{
+  NS_LOG_FUNCTION (this << &buf);
+  buf.WriteU16 (m_segments);
+  buf.WriteU16 (m_segmentSize);
+}
+void
+SegmentationOffloadTag::Deserialize (TagBuffer buf)
+{
+  NS_LOG_FUNCTION (this << &buf);
+  m_segments = buf.ReadU16 ();
+  m_segmentSize = buf.ReadU16 ();
+}
+void
+SegmentationOffloadTag::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "Segments=" << m_segments << " SegmentSize=" << m_segmentSize;
+}
+SegmentationOffloadTag::SegmentationOffloadTag ()
+  : Tag (),
+    m_segments (1),
+    m_segmentSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SegmentationOffloadTag::SegmentationOffloadTag (uint16_t segments, uint16_t segmentSize)
+  : Tag (),
+    m_segments (segments),
+    m_segmentSize (segmentSize)
+{
+  NS_LOG_FUNCTION (this << segments << segmentSize);
+  NS_ASSERT (segments > 0 && segmentSize > 0);
+}
+
+uint16_t
+SegmentationOffloadTag::GetSegments (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_segments;
+}
+
+uint16_t
+SegmentationOffloadTag::GetSegmentSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_segmentSize;
+}
+
+} // namespace ns3
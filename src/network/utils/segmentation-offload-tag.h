@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEGMENTATION_OFFLOAD_TAG_H
+#define SEGMENTATION_OFFLOAD_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Mark a packet as a super-segment standing for several wire segments
+ *
+ * A transport protocol doing segmentation offload hands to the stack one
+ * packet carrying the payload of several segments. The packet goes whole
+ * through the stack down to a NetDevice which supports segmentation offload
+ * (NetDevice::SupportsSegmentationOffload), which transmits the wire
+ * segments split from it by SegmentationOffload::Segment.
+ */
+class SegmentationOffloadTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  SegmentationOffloadTag ();
+
+  /**
+   * Constructs a SegmentationOffloadTag
+   *
+   * \param segments the number of wire segments
+   * \param segmentSize the size of the payload of the wire segments, but
+   * the last one
+   */
+  SegmentationOffloadTag (uint16_t segments, uint16_t segmentSize);
+  /**
+   * \returns the number of wire segments of the packet
+   */
+  uint16_t GetSegments (void) const;
+  /**
+   * \returns the size of the payload of the wire segments, but the last one
+   */
+  uint16_t GetSegmentSize (void) const;
+
+private:
+  uint16_t m_segments;    //!< Number of wire segments
+  uint16_t m_segmentSize; //!< Size of the payload of the wire segments
+};
+
+} // namespace ns3
+
+#endif /* SEGMENTATION_OFFLOAD_TAG_H */
@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <map>
+#include "segmentation-offload.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SegmentationOffload");
+
+/**
+ * \return the functions splitting the super-segments, by protocol number
+ */
+static std::map<uint16_t, SegmentationOffload::Segmenter> &
+GetSegmenters (void)
+{
+  static std::map<uint16_t, SegmentationOffload::Segmenter> segmenters;
+  return segmenters;
+}
+
+SegmentationOffload::Segmenter
+SegmentationOffload::SetSegmenter (uint16_t protocolNumber, Segmenter segmenter)
+{
+  NS_LOG_FUNCTION (protocolNumber);
+  std::map<uint16_t, Segmenter> &segmenters = GetSegmenters ();
+  Segmenter previous;
+  std::map<uint16_t, Segmenter>::iterator i = segmenters.find (protocolNumber);
+  if (i != segmenters.end ())
+    {
+      previous = i->second;
+      segmenters.erase (i);
+    }
+  if (!segmenter.IsNull ())
+    {
+      segmenters.insert (std::make_pair (protocolNumber, segmenter));
+    }
+  return previous;
+}
+
+bool
+SegmentationOffload::Segment (Ptr<const Packet> packet, uint16_t protocolNumber,
+                              std::list<Ptr<Packet> > &segments)
+{
+  NS_LOG_FUNCTION (packet << protocolNumber);
+  std::map<uint16_t, Segmenter> &segmenters = GetSegmenters ();
+  std::map<uint16_t, Segmenter>::const_iterator i = segmenters.find (protocolNumber);
+  if (i == segmenters.end ())
+    {
+      NS_LOG_WARN ("No segmentation offload for protocol " << protocolNumber);
+      return false;
+    }
+  i->second (packet, segments);
+  return true;
+}
+
+} // namespace ns3
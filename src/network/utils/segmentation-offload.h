@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEGMENTATION_OFFLOAD_H
+#define SEGMENTATION_OFFLOAD_H
+
+#include <list>
+#include "ns3/ptr.h"
+#include "ns3/callback.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Split the super-segments into their wire segments
+ *
+ * A NetDevice supporting segmentation offload transmits a super-segment (a
+ * packet with a SegmentationOffloadTag) as the wire segments it stands for.
+ * Splitting a super-segment rewrites the headers of the protocols above the
+ * NetDevice, so the protocols register the function splitting their
+ * super-segments by protocol number, as the Linux protocols register their
+ * GSO callbacks.
+ */
+class SegmentationOffload
+{
+public:
+  /**
+   * Split a super-segment, starting with the header of the protocol, and
+   * append its wire segments, with their headers, to a list.
+   */
+  typedef Callback<void, Ptr<const Packet>, std::list<Ptr<Packet> > &> Segmenter;
+
+  /**
+   * \brief Set the function splitting the super-segments of a protocol
+   *
+   * \param protocolNumber the protocol number, as given to NetDevice::Send
+   * \param segmenter the function, or a null callback to unset it
+   * \return the function previously set, or a null callback
+   */
+  static Segmenter SetSegmenter (uint16_t protocolNumber, Segmenter segmenter);
+
+  /**
+   * \brief Split a super-segment into its wire segments
+   *
+   * \param packet the super-segment, starting with the header of the protocol
+   * \param protocolNumber the protocol number, as given to NetDevice::Send
+   * \param segments the list the wire segments are appended to
+   * \return false if no function splits the super-segments of the protocol
+   */
+  static bool Segment (Ptr<const Packet> packet, uint16_t protocolNumber,
+                       std::list<Ptr<Packet> > &segments);
+};
+
+} // namespace ns3
+
+#endif /* SEGMENTATION_OFFLOAD_H */
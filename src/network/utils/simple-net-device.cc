@@ -30,6 +30,9 @@
 #include "ns3/tag.h"
 #include "ns3/simulator.h"
 #include "ns3/queue.h"
+#include "ns3/queue-item.h"
+#include "segmentation-offload-tag.h"
+#include "segmentation-offload.h"
 
 namespace ns3 {
 
@@ -428,36 +431,18 @@ bool
 SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address& dest, uint16_t protocolNumber)
 {
   NS_LOG_FUNCTION (this << p << source << dest << protocolNumber);
-  if (p->GetSize () > GetMtu ())
+  SegmentationOffloadTag offload;
+  if (p->GetSize () > GetMtu () && !p->PeekPacketTag (offload))
     {
       return false;
     }
-  Ptr<Packet> packet = p->Copy ();
 
-  Mac48Address to = Mac48Address::ConvertFrom (dest);
-  Mac48Address from = Mac48Address::ConvertFrom (source);
-
-  SimpleTag tag;
-  tag.SetSrc (from);
-  tag.SetDst (to);
-  tag.SetProto (protocolNumber);
-
-  p->AddPacketTag (tag);
-
-  if (m_queue->Enqueue (p))
+  if (EnqueuePacket (p, source, dest, protocolNumber))
     {
       //NS_LOG_INFO("simple-netdev: enqueue true");
       if (m_queue->GetNPackets () == 1 && !TransmitCompleteEvent.IsRunning ())
         {
-          p = m_queue->Dequeue ();
-          p->RemovePacketTag (tag);
-          Time txTime = Time (0);
-          if (m_bps > DataRate (0))
-            {
-              txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
-            }
-          m_channel->Send (p, protocolNumber, to, from, this);
-          TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
+          StartTransmission ();
         }
       return true;
     }
@@ -468,18 +453,71 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
   return true;
 }
 
+void
+SimpleNetDevice::SendBurst (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  SegmentationOffloadTag offload;
+  for (const auto &item : items)
+    {
+      Ptr<Packet> p = item->GetPacket ();
+      if (p->GetSize () > GetMtu () && !p->PeekPacketTag (offload))
+        {
+          continue;
+        }
+      EnqueuePacket (p, m_address, item->GetAddress (), item->GetProtocol ());
+    }
+
+  if (m_queue->GetNPackets () > 0 && !TransmitCompleteEvent.IsRunning ())
+    {
+      StartTransmission ();
+    }
+}
+
+bool
+SimpleNetDevice::EnqueuePacket (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << packet << source << dest << protocolNumber);
+
+  SimpleTag tag;
+  tag.SetSrc (Mac48Address::ConvertFrom (source));
+  tag.SetDst (Mac48Address::ConvertFrom (dest));
+  tag.SetProto (protocolNumber);
+  packet->AddPacketTag (tag);
+
+  return m_queue->Enqueue (packet);
+}
+
+void
+SimpleNetDevice::StartTransmission (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Packet> packet = DequeueFrame ();
+  SimpleTag tag;
+  packet->RemovePacketTag (tag);
+  Time txTime = Time (0);
+  if (m_bps > DataRate (0))
+    {
+      txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
+    }
+  m_channel->Send (packet, tag.GetProto (), tag.GetDst (), tag.GetSrc (), this);
+  TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
+}
+
 
 void
 SimpleNetDevice::TransmitComplete ()
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_queue->GetNPackets () == 0)
+  if (!HasPendingFrame ())
     {
       return;
     }
 
-  Ptr<Packet> packet = m_queue->Dequeue ();
+  Ptr<Packet> packet = DequeueFrame ();
 
   SimpleTag tag;
   packet->RemovePacketTag (tag);
@@ -490,7 +528,7 @@ SimpleNetDevice::TransmitComplete ()
 
   m_channel->Send (packet, proto, dst, src, this);
 
-  if (m_queue->GetNPackets ())
+  if (HasPendingFrame ())
     {
       Time txTime = Time (0);
       if (m_bps > DataRate (0))
@@ -540,6 +578,7 @@ SimpleNetDevice::DoDispose (void)
   m_node = 0;
   m_receiveErrorModel = 0;
   m_queue->Flush ();
+  m_txSegments.clear ();
   if (TransmitCompleteEvent.IsRunning ())
     {
       TransmitCompleteEvent.Cancel ();
@@ -562,4 +601,54 @@ SimpleNetDevice::SupportsSendFrom (void) const
   return true;
 }
 
+bool
+SimpleNetDevice::SupportsSegmentationOffload (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+Ptr<Packet>
+SimpleNetDevice::DequeueFrame (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_txSegments.empty ())
+    {
+      Ptr<Packet> packet = m_txSegments.front ();
+      m_txSegments.pop_front ();
+      return packet;
+    }
+
+  Ptr<Packet> packet = m_queue->Dequeue ();
+  SegmentationOffloadTag offload;
+  if (!packet->PeekPacketTag (offload))
+    {
+      return packet;
+    }
+
+  // A super-segment is transmitted as its wire segments, back to back
+  SimpleTag tag;
+  packet->RemovePacketTag (tag);
+  if (!SegmentationOffload::Segment (packet, tag.GetProto (), m_txSegments))
+    {
+      packet->AddPacketTag (tag);
+      return packet;
+    }
+  NS_LOG_LOGIC ("Super-segment split in " << m_txSegments.size () << " wire segments");
+  for (std::list<Ptr<Packet> >::iterator i = m_txSegments.begin (); i != m_txSegments.end (); i++)
+    {
+      (*i)->AddPacketTag (tag);
+    }
+  packet = m_txSegments.front ();
+  m_txSegments.pop_front ();
+  return packet;
+}
+
+bool
+SimpleNetDevice::HasPendingFrame (void) const
+{
+  return !m_txSegments.empty () || m_queue->GetNPackets () > 0;
+}
+
 } // namespace ns3
@@ -22,6 +22,8 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
+#include <list>
 
 #include "ns3/traced-callback.h"
 #include "ns3/net-device.h"
@@ -33,6 +35,7 @@
 namespace ns3 {
 
 template <typename Item> class Queue;
+class QueueDiscItem;
 class SimpleChannel;
 class Node;
 class ErrorModel;
@@ -125,6 +128,17 @@ public:
   virtual bool IsBridge (void) const;
   virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+
+  /**
+   * Send a burst of packets dequeued by a queue disc. All the packets are
+   * placed in the queue before the transmission of the first one starts,
+   * if the device is not transmitting.
+   *
+   * \param items the packets to send, with their destination address and
+   *        protocol number
+   */
+  void SendBurst (const std::vector<Ptr<QueueDiscItem> > &items);
+
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
   virtual bool NeedsArp (void) const;
@@ -134,6 +148,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsSegmentationOffload (void) const;
 
 protected:
   virtual void DoDispose (void);
@@ -164,6 +179,42 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * Place a packet in the queue, tagged with its addresses and protocol
+   * number.
+   * \param packet the packet
+   * \param source the source address
+   * \param dest the destination address
+   * \param protocolNumber the protocol number
+   * \return true if the packet was enqueued
+   */
+  bool EnqueuePacket (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+
+  /**
+   * Send the packet at the head of the queue to the channel, and schedule
+   * the end of its transmission.
+   */
+  void StartTransmission (void);
+
+  /**
+   * Get the next frame to transmit, tagged with its addresses and protocol
+   * number
+   *
+   * The next frame is the next wire segment of the super-segment being
+   * transmitted, if any, or the packet at the head of the queue. A
+   * super-segment dequeued is split in its wire segments, and its first one
+   * is returned.
+   *
+   * \return the frame
+   */
+  Ptr<Packet> DequeueFrame (void);
+
+  /**
+   * \return true if a wire segment or a packet of the queue is waiting to
+   * be transmitted
+   */
+  bool HasPendingFrame (void) const;
+
   bool m_linkUp; //!< Flag indicating whether or not the link is up
 
   /**
@@ -173,6 +224,7 @@ private:
   bool m_pointToPointMode;
 
   Ptr<Queue<Packet> > m_queue; //!< The Queue for outgoing packets.
+  std::list<Ptr<Packet> > m_txSegments; //!< The wire segments of the super-segment being transmitted
   DataRate m_bps; //!< The device nominal Data rate. Zero means infinite
   EventId TransmitCompleteEvent; //!< the Tx Complete event
 
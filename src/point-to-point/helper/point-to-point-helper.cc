@@ -247,11 +247,18 @@ PointToPointHelper::Install (Ptr<Node> a, Ptr<Node> b)
   Ptr<Queue<Packet> > queueB = m_queueFactory.Create<Queue<Packet> > ();
   devB->SetQueue (queueB);
   // Aggregate NetDeviceQueueInterface objects
+  // The devices receive the packets dequeued by the queue discs in bursts
   Ptr<NetDeviceQueueInterface> ndqiA = CreateObject<NetDeviceQueueInterface> ();
   ndqiA->GetTxQueue (0)->ConnectQueueTraces (queueA);
+  PointToPointNetDevice *rawDevA = PeekPointer (devA);
+  ndqiA->SetSendBurstCallback ([rawDevA] (const std::vector<Ptr<QueueDiscItem> > &items)
+                               { rawDevA->SendBurst (items); });
   devA->AggregateObject (ndqiA);
   Ptr<NetDeviceQueueInterface> ndqiB = CreateObject<NetDeviceQueueInterface> ();
   ndqiB->GetTxQueue (0)->ConnectQueueTraces (queueB);
+  PointToPointNetDevice *rawDevB = PeekPointer (devB);
+  ndqiB->SetSendBurstCallback ([rawDevB] (const std::vector<Ptr<QueueDiscItem> > &items)
+                               { rawDevB->SendBurst (items); });
   devB->AggregateObject (ndqiB);
 
   Ptr<PointToPointChannel> channel = 0;
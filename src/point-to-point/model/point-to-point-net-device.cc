@@ -18,6 +18,7 @@
 
 #include "ns3/log.h"
 #include "ns3/queue.h"
+#include "ns3/queue-item.h"
 #include "ns3/simulator.h"
 #include "ns3/mac48-address.h"
 #include "ns3/llc-snap-header.h"
@@ -25,6 +26,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/segmentation-offload-tag.h"
+#include "ns3/segmentation-offload.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -214,6 +217,7 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_txSegments.clear ();
   m_queue = 0;
   NetDevice::DoDispose ();
 }
@@ -281,7 +285,7 @@ PointToPointNetDevice::TransmitComplete (void)
   m_phyTxEndTrace (m_currentPkt);
   m_currentPkt = 0;
 
-  Ptr<Packet> p = m_queue->Dequeue ();
+  Ptr<Packet> p = DequeueFrame ();
   if (p == 0)
     {
       NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
@@ -296,6 +300,46 @@ PointToPointNetDevice::TransmitComplete (void)
   TransmitStart (p);
 }
 
+Ptr<Packet>
+PointToPointNetDevice::DequeueFrame (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_txSegments.empty ())
+    {
+      Ptr<Packet> p = m_txSegments.front ();
+      m_txSegments.pop_front ();
+      return p;
+    }
+
+  Ptr<Packet> p = m_queue->Dequeue ();
+  SegmentationOffloadTag offload;
+  if (p == 0 || !p->PeekPacketTag (offload))
+    {
+      return p;
+    }
+
+  //
+  // A super-segment is transmitted as its wire segments, each with its own
+  // PPP header, the first one now and the others after it, back to back.
+  //
+  PppHeader ppp;
+  p->RemoveHeader (ppp);
+  if (!SegmentationOffload::Segment (p, PppToEther (ppp.GetProtocol ()), m_txSegments))
+    {
+      p->AddHeader (ppp);
+      return p;
+    }
+  NS_LOG_LOGIC ("Super-segment split in " << m_txSegments.size () << " wire segments");
+  for (std::list<Ptr<Packet> >::iterator i = m_txSegments.begin (); i != m_txSegments.end (); i++)
+    {
+      (*i)->AddHeader (ppp);
+    }
+  p = m_txSegments.front ();
+  m_txSegments.pop_front ();
+  return p;
+}
+
 bool
 PointToPointNetDevice::Attach (Ptr<PointToPointChannel> ch)
 {
@@ -541,7 +585,7 @@ PointToPointNetDevice::Send (
       // 
       if (m_txMachineState == READY)
         {
-          packet = m_queue->Dequeue ();
+          packet = DequeueFrame ();
           m_snifferTrace (packet);
           m_promiscSnifferTrace (packet);
           bool ret = TransmitStart (packet);
@@ -556,6 +600,43 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+void
+PointToPointNetDevice::SendBurst (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  for (const auto &item : items)
+    {
+      Ptr<Packet> packet = item->GetPacket ();
+      if (IsLinkUp () == false)
+        {
+          m_macTxDropTrace (packet);
+          continue;
+        }
+      AddHeader (packet, item->GetProtocol ());
+      m_macTxTrace (packet);
+      if (!m_queue->Enqueue (packet))
+        {
+          m_macTxDropTrace (packet);
+        }
+    }
+
+  //
+  // If the channel is ready for transmission, start sending the first packet
+  // of the burst; TransmitComplete sends the following ones.
+  //
+  if (m_txMachineState == READY)
+    {
+      Ptr<Packet> packet = DequeueFrame ();
+      if (packet != 0)
+        {
+          m_snifferTrace (packet);
+          m_promiscSnifferTrace (packet);
+          TransmitStart (packet);
+        }
+    }
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
@@ -605,6 +686,13 @@ PointToPointNetDevice::SupportsSendFrom (void) const
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsSegmentationOffload (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive (Ptr<Packet> p)
 {
@@ -20,6 +20,8 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
+#include <list>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -34,6 +36,7 @@
 namespace ns3 {
 
 template <typename Item> class Queue;
+class QueueDiscItem;
 class PointToPointChannel;
 class ErrorModel;
 
@@ -178,6 +181,17 @@ public:
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
 
+  /**
+   * Send a burst of packets dequeued by a queue disc.
+   *
+   * All the packets are placed in the transmit queue before the transmission
+   * of the first one starts, if the transmitter is idle. A packet that does
+   * not fit in the queue is dropped, as by Send.
+   *
+   * \param items the packets to send, with their protocol number
+   */
+  void SendBurst (const std::vector<Ptr<QueueDiscItem> > &items);
+
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
 
@@ -190,6 +204,12 @@ public:
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
 
+  /**
+   * \return true: a super-segment is transmitted as its wire segments,
+   * back to back
+   */
+  virtual bool SupportsSegmentationOffload (void) const;
+
 protected:
   /**
    * \brief Handler for MPI receive event
@@ -275,6 +295,19 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * Get the next frame to transmit
+   *
+   * The next frame is the next wire segment of the super-segment being
+   * transmitted, if any, or the next packet of the transmit queue. A
+   * super-segment dequeued is split in its wire segments, and its first one
+   * is returned.
+   *
+   * 
+eturns the frame, or 0 if there is none
+   */
+  Ptr<Packet> DequeueFrame (void);
+
   /**
    * \brief Make the link up and running
    *
@@ -456,6 +489,7 @@ private:
   uint32_t m_mtu;
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
+  std::list<Ptr<Packet> > m_txSegments; //!< The wire segments of the super-segment being transmitted
 
   /**
    * \brief PPP to Ethernet protocol number mapping
@@ -24,6 +24,9 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/segmentation-offload-tag.h"
+#include "ns3/segmentation-offload.h"
+#include "ns3/data-rate.h"
 
 using namespace ns3;
 
@@ -94,6 +97,126 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Split a super-segment into segments of payload only
+ * \param packet the super-segment
+ * \param segments the list the segments are appended to
+ */
+static void
+SplitSuperSegment (Ptr<const Packet> packet, std::list<Ptr<Packet> > &segments)
+{
+  SegmentationOffloadTag offload;
+  packet->PeekPacketTag (offload);
+  for (uint32_t offset = 0; offset < packet->GetSize (); offset += offload.GetSegmentSize ())
+    {
+      uint32_t length = std::min<uint32_t> (offload.GetSegmentSize (), packet->GetSize () - offset);
+      Ptr<Packet> segment = packet->CreateFragment (offset, length);
+      segment->RemovePacketTag (offload);
+      segments.push_back (segment);
+    }
+}
+
+/**
+ * \brief Test the transmission of a super-segment
+ *
+ * A packet with a SegmentationOffloadTag must be transmitted as its wire
+ * segments, each with its PPP header, back to back.
+ */
+class PointToPointSegmentationOffloadTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointSegmentationOffloadTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Record the reception of a packet
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  std::vector<Time> m_received;   //!< reception time of the packets
+  std::vector<uint32_t> m_sizes;  //!< size of the packets
+};
+
+PointToPointSegmentationOffloadTest::PointToPointSegmentationOffloadTest ()
+  : TestCase ("PointToPoint super-segment transmission")
+{
+}
+
+bool
+PointToPointSegmentationOffloadTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                              uint16_t protocol, const Address &from)
+{
+  m_received.push_back (Simulator::Now ());
+  m_sizes.push_back (packet->GetSize ());
+  return true;
+}
+
+void
+PointToPointSegmentationOffloadTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointSegmentationOffloadTest::Receive, this));
+
+  NS_TEST_ASSERT_MSG_EQ (devA->SupportsSegmentationOffload (), true,
+                         "PointToPointNetDevice should support segmentation offload");
+
+  // The super-segments of IPv4 are split by the test while it runs
+  SegmentationOffload::Segmenter previous =
+    SegmentationOffload::SetSegmenter (0x800, MakeCallback (&SplitSuperSegment));
+
+  // 4 segments, of 1000 bytes but the last one
+  Ptr<Packet> p = Create<Packet> (3 * 1000 + 500);
+  p->AddPacketTag (SegmentationOffloadTag (4, 1000));
+  devA->Send (p, devA->GetBroadcast (), 0x800);
+  // A packet queued behind the super-segment
+  devA->Send (Create<Packet> (100), devA->GetBroadcast (), 0x800);
+
+  Simulator::Run ();
+  SegmentationOffload::SetSegmenter (0x800, previous);
+
+  // The wire segments carry 2 more bytes (PPP), at 1 us per byte
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), 5, "Super-segment not split in its wire segments");
+  uint32_t sizes[] = { 1000, 1000, 1000, 500, 100 };
+  Time received;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      received += MicroSeconds (sizes[i] + 2);
+      NS_TEST_EXPECT_MSG_EQ (m_sizes[i], sizes[i], "Wrong size of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_received[i], received, NanoSeconds (10),
+                                 "Packet " << i << " received at the wrong time");
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +233,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointSegmentationOffloadTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
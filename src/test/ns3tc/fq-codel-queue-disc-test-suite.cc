@@ -80,6 +80,51 @@ Ipv4TestPacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
   return 0;
 }
 
+/**
+ * Simple test packet filter classifying IPv4 packets by the last byte of
+ * their destination address
+ */
+class Ipv4DestinationTestPacketFilter : public Ipv4PacketFilter {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv4DestinationTestPacketFilter ();
+  virtual ~Ipv4DestinationTestPacketFilter ();
+
+private:
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+};
+
+TypeId
+Ipv4DestinationTestPacketFilter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4DestinationTestPacketFilter")
+    .SetParent<Ipv4PacketFilter> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4DestinationTestPacketFilter> ()
+  ;
+  return tid;
+}
+
+Ipv4DestinationTestPacketFilter::Ipv4DestinationTestPacketFilter ()
+{
+}
+
+Ipv4DestinationTestPacketFilter::~Ipv4DestinationTestPacketFilter ()
+{
+}
+
+int32_t
+Ipv4DestinationTestPacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
+  return ipv4Item->GetHeader ().GetDestination ().Get () & 0xff;
+}
+
 /**
  * This class tests packets for which there is no suitable filter
  */
@@ -513,6 +558,96 @@ FqCoDelQueueDiscUDPFlowsSeparation::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * This class tests the round robin among many flows and the reuse of the
+ * flow queues which become inactive
+ */
+class FqCoDelQueueDiscRoundRobin : public TestCase
+{
+public:
+  FqCoDelQueueDiscRoundRobin ();
+  virtual ~FqCoDelQueueDiscRoundRobin ();
+
+private:
+  virtual void DoRun (void);
+  void AddPacket (Ptr<FqCoDelQueueDisc> queue, Ipv4Header hdr);
+};
+
+FqCoDelQueueDiscRoundRobin::FqCoDelQueueDiscRoundRobin ()
+  : TestCase ("Test round robin among many flows and reuse of the flow queues")
+{
+}
+
+FqCoDelQueueDiscRoundRobin::~FqCoDelQueueDiscRoundRobin ()
+{
+}
+
+void
+FqCoDelQueueDiscRoundRobin::AddPacket (Ptr<FqCoDelQueueDisc> queue, Ipv4Header hdr)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  Address dest;
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+  queue->Enqueue (item);
+}
+
+void
+FqCoDelQueueDiscRoundRobin::DoRun (void)
+{
+  Ptr<FqCoDelQueueDisc> queueDisc = CreateObjectWithAttributes<FqCoDelQueueDisc> ();
+  Ptr<Ipv4DestinationTestPacketFilter> filter = CreateObject<Ipv4DestinationTestPacketFilter> ();
+  queueDisc->AddPacketFilter (filter);
+
+  // Each flow dequeues a packet per round
+  queueDisc->SetQuantum (90);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (100);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetProtocol (7);
+
+  uint32_t flows = 200;
+  for (uint32_t round = 0; round < 2; round++)
+    {
+      for (uint32_t i = 0; i < flows; i++)
+        {
+          hdr.SetDestination (Ipv4Address (0x0a0b0000 + i));
+          AddPacket (queueDisc, hdr);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), flows, "unexpected number of flow queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 2 * flows, "unexpected number of packets in the queue disc");
+
+  for (uint32_t round = 0; round < 2; round++)
+    {
+      for (uint32_t i = 0; i < flows; i++)
+        {
+          Ptr<Ipv4QueueDiscItem> item = DynamicCast<Ipv4QueueDiscItem> (queueDisc->Dequeue ());
+          NS_TEST_ASSERT_MSG_NE (item, 0, "no packet dequeued");
+          NS_TEST_ASSERT_MSG_EQ (item->GetHeader ().GetDestination (), Ipv4Address (0x0a0b0000 + i),
+                                 "packet dequeued from an unexpected flow in round " << round);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->Dequeue (), 0, "packet dequeued from an empty queue disc");
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      Ptr<FqCoDelFlow> flow = StaticCast<FqCoDelFlow> (queueDisc->GetQueueDiscClass (i));
+      NS_TEST_ASSERT_MSG_EQ (flow->GetStatus (), FqCoDelFlow::INACTIVE, "flow " << i << " must be inactive");
+    }
+
+  // The flow queues are reused
+  hdr.SetDestination (Ipv4Address (0x0a0b0000 + 7));
+  AddPacket (queueDisc, hdr);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), flows, "flow queue created again");
+  Ptr<FqCoDelFlow> flow = StaticCast<FqCoDelFlow> (queueDisc->GetQueueDiscClass (7));
+  NS_TEST_ASSERT_MSG_EQ (flow->GetStatus (), FqCoDelFlow::NEW_FLOW, "the flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (flow->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_NE (queueDisc->Dequeue (), 0, "no packet dequeued");
+
+  Simulator::Destroy ();
+}
+
 class FqCoDelQueueDiscTestSuite : public TestSuite
 {
 public:
@@ -527,6 +662,7 @@ FqCoDelQueueDiscTestSuite::FqCoDelQueueDiscTestSuite ()
   AddTestCase (new FqCoDelQueueDiscDeficit, TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscTCPFlowsSeparation, TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscUDPFlowsSeparation, TestCase::QUICK);
+  AddTestCase (new FqCoDelQueueDiscRoundRobin, TestCase::QUICK);
 }
 
 static FqCoDelQueueDiscTestSuite fqCoDelQueueDiscTestSuite;
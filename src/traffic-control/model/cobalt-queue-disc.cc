@@ -34,6 +34,7 @@
 #include "ns3/drop-tail-queue.h"
 #include "ns3/net-device-queue-interface.h"
 #include <climits>
+#include <algorithm>
 
 
 namespace ns3 {
@@ -114,16 +115,6 @@ static inline uint32_t ReciprocalDivide (uint32_t A, uint32_t R)
   return (uint32_t)(((uint64_t)A * R) >> 32);
 }
 
-double min (double x, double y)
-{
-  return (x < y) ? x : y;
-}
-
-double max (double x, double y)
-{
-  return (x > y) ? x : y;
-}
-
 /**
  * Returns the current time translated in CoDel time representation
  * \return the current time
@@ -174,6 +165,9 @@ CobaltQueueDisc::InitializeParams (void)
   m_recInvSqrt = ~0U;
   m_lastUpdateTimeBlue = 0;
   m_dropNext = 0;
+  // the target and the interval are compared with CoDel times on every dequeue
+  m_intervalCoDel = Time2CoDel (m_interval);
+  m_targetCoDel = Time2CoDel (m_target);
 }
 
 bool
@@ -258,7 +252,7 @@ int64_t
 CobaltQueueDisc::ControlLaw (int64_t t)
 {
   NS_LOG_FUNCTION (this);
-  return t + ReciprocalDivide (Time2CoDel (m_interval), m_recInvSqrt);
+  return t + ReciprocalDivide (m_intervalCoDel, m_recInvSqrt);
 }
 
 void
@@ -390,10 +384,10 @@ void CobaltQueueDisc::CobaltQueueFull (int64_t now)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Outside IF block");
-  if (CoDelTimeAfter ((now - m_lastUpdateTimeBlue), Time2CoDel (m_target)))
+  if (CoDelTimeAfter ((now - m_lastUpdateTimeBlue), m_targetCoDel))
     {
       NS_LOG_LOGIC ("inside IF block");
-      m_Pdrop = min (m_Pdrop + m_increment, (double)1.0);
+      m_Pdrop = std::min (m_Pdrop + m_increment, 1.0);
       m_lastUpdateTimeBlue = now;
     }
   m_dropping = true;
@@ -408,9 +402,9 @@ void CobaltQueueDisc::CobaltQueueFull (int64_t now)
 void CobaltQueueDisc::CobaltQueueEmpty (int64_t now)
 {
   NS_LOG_FUNCTION (this);
-  if (m_Pdrop && CoDelTimeAfter ((now - m_lastUpdateTimeBlue), Time2CoDel (m_target)))
+  if (m_Pdrop && CoDelTimeAfter ((now - m_lastUpdateTimeBlue), m_targetCoDel))
     {
-      m_Pdrop = max (m_Pdrop - m_decrement, (double)0.0);
+      m_Pdrop = std::max (m_Pdrop - m_decrement, 0.0);
       m_lastUpdateTimeBlue = now;
     }
   m_dropping = false;
@@ -434,7 +428,7 @@ bool CobaltQueueDisc::CobaltShouldDrop (Ptr<QueueDiscItem> item, int64_t now)
   NS_LOG_INFO ("Sojourn time " << delta.GetSeconds ());
   int64_t sojournTime = Time2CoDel (delta);
   int64_t schedule = now - m_dropNext;
-  bool over_target = CoDelTimeAfter (sojournTime, Time2CoDel (m_target));
+  bool over_target = CoDelTimeAfter (sojournTime, m_targetCoDel);
   bool next_due = m_count && schedule >= 0;
 
   if (over_target)
@@ -460,7 +454,11 @@ bool CobaltQueueDisc::CobaltShouldDrop (Ptr<QueueDiscItem> item, int64_t now)
       /* Check if router and packet, both have ECN enabled. Only if this is true, mark the packet. */
       drop = !(m_useEcn && Mark (item, FORCED_MARK));
 
-      m_count = max (m_count, m_count + 1);
+      // saturating increment
+      if (m_count < UINT_MAX)
+        {
+          m_count++;
+        }
 
       InvSqrt ();
       m_dropNext = ControlLaw (m_dropNext);
@@ -487,7 +485,7 @@ bool CobaltQueueDisc::CobaltShouldDrop (Ptr<QueueDiscItem> item, int64_t now)
   /* Overload the drop_next field as an activity timeout */
   if (!m_count)
     {
-      m_dropNext = now + Time2CoDel (m_interval);
+      m_dropNext = now + m_intervalCoDel;
     }
   else if (schedule > 0 && !drop)
     {
@@ -227,6 +227,8 @@ private:
   Time m_interval;                        //!< 100 ms sliding minimum time window width
   Time m_target;                          //!< 5 ms target queue delay
   bool m_useEcn;                          //!< True if ECN is used (packets are marked instead of being dropped)
+  int64_t m_intervalCoDel;                //!< Interval in CoDel time, set by InitializeParams
+  int64_t m_targetCoDel;                  //!< Target queue delay in CoDel time, set by InitializeParams
 
   // Blue parameters
   // Maintained by Cobalt
@@ -117,6 +117,8 @@ TypeId CoDelQueueDisc::GetTypeId (void)
 
 CoDelQueueDisc::CoDelQueueDisc ()
   : QueueDisc (QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE),
+    m_intervalCoDel (0),
+    m_targetCoDel (0),
     m_count (0),
     m_lastCount (0),
     m_dropping (false),
@@ -195,7 +197,7 @@ CoDelQueueDisc::OkToDrop (Ptr<QueueDiscItem> item, uint32_t now)
   NS_LOG_INFO ("Sojourn time " << delta.ToDouble (Time::MS) << "ms");
   uint32_t sojournTime = Time2CoDel (delta);
 
-  if (CoDelTimeBefore (sojournTime, Time2CoDel (m_target))
+  if (CoDelTimeBefore (sojournTime, m_targetCoDel)
       || GetInternalQueue (0)->GetNBytes () < m_minBytes)
     {
       // went below so we'll stay below for at least q->interval
@@ -210,7 +212,7 @@ CoDelQueueDisc::OkToDrop (Ptr<QueueDiscItem> item, uint32_t now)
        * for at least q->interval we'll say it's ok to drop
        */
       NS_LOG_LOGIC ("Sojourn time has just gone above target from below, need to stay above for at least q->interval before packet can be dropped. ");
-      m_firstAboveTime = now + Time2CoDel (m_interval);
+      m_firstAboveTime = now + m_intervalCoDel;
     }
   else if (CoDelTimeAfter (now, m_firstAboveTime))
     {
@@ -288,7 +290,7 @@ CoDelQueueDisc::DoDequeue (void)
                 {
                   /* schedule the next drop */
                   NS_LOG_LOGIC ("Running ControlLaw for input m_dropNext: " << (double)m_dropNext / 1000000);
-                  m_dropNext = ControlLaw (m_dropNext, Time2CoDel (m_interval), m_recInvSqrt);
+                  m_dropNext = ControlLaw (m_dropNext, m_intervalCoDel, m_recInvSqrt);
                   NS_LOG_LOGIC ("Scheduled next drop at " << (double)m_dropNext / 1000000);
                 }
             }
@@ -323,7 +325,7 @@ CoDelQueueDisc::DoDequeue (void)
            * last cycle is a good starting point to control it now.
            */
           int delta = m_count - m_lastCount;
-          if (delta > 1 && CoDelTimeBefore (now - m_dropNext, 16 * Time2CoDel (m_interval)))
+          if (delta > 1 && CoDelTimeBefore (now - m_dropNext, 16 * m_intervalCoDel))
             {
               m_count = delta;
               m_recInvSqrt = NewtonStep (m_recInvSqrt, m_count);
@@ -335,7 +337,7 @@ CoDelQueueDisc::DoDequeue (void)
             }
           m_lastCount = m_count;
           NS_LOG_LOGIC ("Running ControlLaw for input now: " << (double)now);
-          m_dropNext = ControlLaw (now, Time2CoDel (m_interval), m_recInvSqrt);
+          m_dropNext = ControlLaw (now, m_intervalCoDel, m_recInvSqrt);
           NS_LOG_LOGIC ("Scheduled next drop at " << (double)m_dropNext / 1000000 << " now " << (double)now / 1000000);
         }
     }
@@ -427,6 +429,9 @@ void
 CoDelQueueDisc::InitializeParams (void)
 {
   NS_LOG_FUNCTION (this);
+  // the target and the interval are compared with CoDel times on every dequeue
+  m_intervalCoDel = Time2CoDel (m_interval);
+  m_targetCoDel = Time2CoDel (m_target);
 }
 
 } // namespace ns3
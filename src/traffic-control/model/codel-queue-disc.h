@@ -201,6 +201,8 @@ private:
   uint32_t m_minBytes;                    //!< Minimum bytes in queue to allow a packet drop
   Time m_interval;                        //!< 100 ms sliding minimum time window width
   Time m_target;                          //!< 5 ms target queue delay
+  uint32_t m_intervalCoDel;               //!< Interval in CoDel time, set by InitializeParams
+  uint32_t m_targetCoDel;                 //!< Target queue delay in CoDel time, set by InitializeParams
   TracedValue<uint32_t> m_count;          //!< Number of packets dropped since entering drop state
   TracedValue<uint32_t> m_lastCount;      //!< Last number of packets dropped since entering drop state
   TracedValue<bool> m_dropping;           //!< True if in dropping state
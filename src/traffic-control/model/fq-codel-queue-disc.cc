@@ -44,7 +44,8 @@ TypeId FqCoDelFlow::GetTypeId (void)
 
 FqCoDelFlow::FqCoDelFlow ()
   : m_deficit (0),
-    m_status (INACTIVE)
+    m_status (INACTIVE),
+    m_next (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -89,6 +90,61 @@ FqCoDelFlow::GetStatus (void) const
   return m_status;
 }
 
+FqCoDelQueueDisc::FlowList::FlowList ()
+  : m_head (0),
+    m_tail (0)
+{
+}
+
+bool
+FqCoDelQueueDisc::FlowList::IsEmpty (void) const
+{
+  return m_head == 0;
+}
+
+FqCoDelFlow *
+FqCoDelQueueDisc::FlowList::Front (void) const
+{
+  return m_head;
+}
+
+void
+FqCoDelQueueDisc::FlowList::PushBack (FqCoDelFlow *flow)
+{
+  flow->m_next = 0;
+  if (m_tail != 0)
+    {
+      m_tail->m_next = flow;
+    }
+  else
+    {
+      m_head = flow;
+    }
+  m_tail = flow;
+}
+
+FqCoDelFlow *
+FqCoDelQueueDisc::FlowList::PopFront (void)
+{
+  FqCoDelFlow *flow = m_head;
+  m_head = flow->m_next;
+  if (m_head == 0)
+    {
+      m_tail = 0;
+    }
+  flow->m_next = 0;
+  return flow;
+}
+
+void
+FqCoDelQueueDisc::FlowList::Clear (void)
+{
+  while (!IsEmpty ())
+    {
+      PopFront ();
+    }
+}
+
 
 NS_OBJECT_ENSURE_REGISTERED (FqCoDelQueueDisc);
 
@@ -145,6 +201,16 @@ FqCoDelQueueDisc::~FqCoDelQueueDisc ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+FqCoDelQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_newFlows.Clear ();
+  m_oldFlows.Clear ();
+  m_flowSlots.clear ();
+  QueueDisc::DoDispose ();
+}
+
 void
 FqCoDelQueueDisc::SetQuantum (uint32_t quantum)
 {
@@ -167,7 +233,7 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
   if (GetNPacketFilters () == 0)
     {
-      h = item->Hash (m_perturbation) % m_flows;
+      h = item->Hash (m_hasher, m_perturbation) % m_flows;
     }
   else
     {
@@ -185,33 +251,31 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
         }
     }
 
-  Ptr<FqCoDelFlow> flow;
-  if (m_flowsIndices.find (h) == m_flowsIndices.end ())
+  // The flow queue of a hash value is created on its first packet, and kept
+  FqCoDelFlow *flow = m_flowSlots[h];
+  if (flow == 0)
     {
       NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
-      flow = m_flowFactory.Create<FqCoDelFlow> ();
+      Ptr<FqCoDelFlow> newFlow = m_flowFactory.Create<FqCoDelFlow> ();
       Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
       qd->Initialize ();
-      flow->SetQueueDisc (qd);
-      AddQueueDiscClass (flow);
+      newFlow->SetQueueDisc (qd);
+      AddQueueDiscClass (newFlow);
 
-      m_flowsIndices[h] = GetNQueueDiscClasses () - 1;
-    }
-  else
-    {
-      flow = StaticCast<FqCoDelFlow> (GetQueueDiscClass (m_flowsIndices[h]));
+      flow = PeekPointer (newFlow);
+      m_flowSlots[h] = flow;
     }
 
   if (flow->GetStatus () == FqCoDelFlow::INACTIVE)
     {
       flow->SetStatus (FqCoDelFlow::NEW_FLOW);
       flow->SetDeficit (m_quantum);
-      m_newFlows.push_back (flow);
+      m_newFlows.PushBack (flow);
     }
 
   flow->GetQueueDisc ()->Enqueue (item);
 
-  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h);
 
   if (GetCurrentSize () > GetMaxSize ())
     {
@@ -226,23 +290,22 @@ FqCoDelQueueDisc::DoDequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<FqCoDelFlow> flow;
+  FqCoDelFlow *flow = 0;
   Ptr<QueueDiscItem> item;
 
   do
     {
       bool found = false;
 
-      while (!found && !m_newFlows.empty ())
+      while (!found && !m_newFlows.IsEmpty ())
         {
-          flow = m_newFlows.front ();
+          flow = m_newFlows.Front ();
 
           if (flow->GetDeficit () <= 0)
             {
               flow->IncreaseDeficit (m_quantum);
               flow->SetStatus (FqCoDelFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              m_oldFlows.PushBack (m_newFlows.PopFront ());
             }
           else
             {
@@ -251,15 +314,14 @@ FqCoDelQueueDisc::DoDequeue (void)
             }
         }
 
-      while (!found && !m_oldFlows.empty ())
+      while (!found && !m_oldFlows.IsEmpty ())
         {
-          flow = m_oldFlows.front ();
+          flow = m_oldFlows.Front ();
 
           if (flow->GetDeficit () <= 0)
             {
               flow->IncreaseDeficit (m_quantum);
-              m_oldFlows.push_back (flow);
-              m_oldFlows.pop_front ();
+              m_oldFlows.PushBack (m_oldFlows.PopFront ());
             }
           else
             {
@@ -279,16 +341,15 @@ FqCoDelQueueDisc::DoDequeue (void)
       if (!item)
         {
           NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
-          if (!m_newFlows.empty ())
+          if (!m_newFlows.IsEmpty ())
             {
               flow->SetStatus (FqCoDelFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              m_oldFlows.PushBack (m_newFlows.PopFront ());
             }
           else
             {
               flow->SetStatus (FqCoDelFlow::INACTIVE);
-              m_oldFlows.pop_front ();
+              m_oldFlows.PopFront ();
             }
         }
       else
@@ -353,6 +414,8 @@ FqCoDelQueueDisc::InitializeParams (void)
   m_queueDiscFactory.Set ("MaxSize", QueueSizeValue (GetMaxSize ()));
   m_queueDiscFactory.Set ("Interval", StringValue (m_interval));
   m_queueDiscFactory.Set ("Target", StringValue (m_target));
+
+  m_flowSlots.assign (m_flows, 0);
 }
 
 uint32_t
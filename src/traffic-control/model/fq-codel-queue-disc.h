@@ -24,8 +24,7 @@
 
 #include "ns3/queue-disc.h"
 #include "ns3/object-factory.h"
-#include <list>
-#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -87,8 +86,12 @@ public:
   FlowStatus GetStatus (void) const;
 
 private:
+  /// The lists of flows of FqCoDelQueueDisc are linked through the flows
+  friend class FqCoDelQueueDisc;
+
   int32_t m_deficit;    //!< the deficit for this flow
   FlowStatus m_status;  //!< the status of this flow
+  FqCoDelFlow *m_next;  //!< the next flow in the list of new or old flows
 };
 
 
@@ -130,7 +133,52 @@ public:
   static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
 
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
 private:
+  /**
+   * \brief A FIFO list of flows, linked through the flows themselves so that
+   * moving a flow between the lists of new and old flows allocates no memory.
+   *
+   * The flows are owned by the queue disc, as its classes.
+   */
+  class FlowList
+  {
+  public:
+    FlowList ();
+
+    /**
+     * \return true if the list is empty
+     */
+    bool IsEmpty (void) const;
+    /**
+     * \return the flow at the head of the list
+     */
+    FqCoDelFlow * Front (void) const;
+    /**
+     * \brief Add a flow at the tail of the list
+     * \param flow the flow, which must not be in a list
+     */
+    void PushBack (FqCoDelFlow *flow);
+    /**
+     * \brief Remove the flow at the head of the list
+     * \return the flow removed
+     */
+    FqCoDelFlow * PopFront (void);
+    /**
+     * \brief Remove all the flows
+     */
+    void Clear (void);
+
+  private:
+    FqCoDelFlow *m_head;  //!< the flow at the head of the list
+    FqCoDelFlow *m_tail;  //!< the flow at the tail of the list
+  };
+
   virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
   virtual Ptr<QueueDiscItem> DoDequeue (void);
   virtual bool CheckConfig (void);
@@ -148,11 +196,12 @@ private:
   uint32_t m_flows;          //!< Number of flow queues
   uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
   uint32_t m_perturbation;   //!< hash perturbation value
+  Hasher m_hasher;           //!< hasher of the packets, reused for every packet
 
-  std::list<Ptr<FqCoDelFlow> > m_newFlows;    //!< The list of new flows
-  std::list<Ptr<FqCoDelFlow> > m_oldFlows;    //!< The list of old flows
+  FlowList m_newFlows;    //!< The list of new flows
+  FlowList m_oldFlows;    //!< The list of old flows
 
-  std::map<uint32_t, uint32_t> m_flowsIndices;    //!< Map with the index of class for each flow
+  std::vector<FqCoDelFlow *> m_flowSlots;    //!< The flow of each hash value, once created
 
   ObjectFactory m_flowFactory;         //!< Factory to create a new flow
   ObjectFactory m_queueDiscFactory;    //!< Factory to create a new queue
@@ -177,12 +177,13 @@ PieQueueDisc::InitializeParams (void)
   m_dqStart = 0;
   m_burstState = NO_BURST;
   m_qDelayOld = Time (Seconds (0));
+  m_lowDelay = true;
 }
 
 bool PieQueueDisc::DropEarly (Ptr<QueueDiscItem> item, uint32_t qSize)
 {
   NS_LOG_FUNCTION (this << item << qSize);
-  if (m_burstAllowance.GetSeconds () > 0)
+  if (m_burstAllowance.IsStrictlyPositive ())
     {
       // If there is still burst_allowance left, skip random early drop.
       return false;
@@ -197,23 +198,25 @@ bool PieQueueDisc::DropEarly (Ptr<QueueDiscItem> item, uint32_t qSize)
   double p = m_dropProb;
 
   uint32_t packetSize = item->GetSize ();
+  QueueSizeUnit unit = GetMaxSize ().GetUnit ();
 
-  if (GetMaxSize ().GetUnit () == QueueSizeUnit::BYTES)
+  if (unit == QueueSizeUnit::BYTES)
     {
       p = p * packetSize / m_meanPktSize;
     }
   bool earlyDrop = true;
   double u =  m_uv->GetValue ();
 
-  if ((m_qDelayOld.GetSeconds () < (0.5 * m_qDelayRef.GetSeconds ())) && (m_dropProb < 0.2))
+  // m_lowDelay only changes when CalculateP updates the drop probability
+  if (m_lowDelay)
     {
       return false;
     }
-  else if (GetMaxSize ().GetUnit () == QueueSizeUnit::BYTES && qSize <= 2 * m_meanPktSize)
+  else if (unit == QueueSizeUnit::BYTES && qSize <= 2 * m_meanPktSize)
     {
       return false;
     }
-  else if (GetMaxSize ().GetUnit () == QueueSizeUnit::PACKETS && qSize <= 2)
+  else if (unit == QueueSizeUnit::PACKETS && qSize <= 2)
     {
       return false;
     }
@@ -337,6 +340,7 @@ void PieQueueDisc::CalculateP ()
     }
 
   m_qDelayOld = qDelay;
+  m_lowDelay = (m_qDelayOld.GetSeconds () < (0.5 * m_qDelayRef.GetSeconds ())) && (m_dropProb < 0.2);
   m_rtrsEvent = Simulator::Schedule (m_tUpdate, &PieQueueDisc::CalculateP, this);
 }
 
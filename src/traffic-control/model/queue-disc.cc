@@ -29,6 +29,7 @@
 #include "queue-disc.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/queue.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -320,7 +321,8 @@ TypeId QueueDisc::GetTypeId (void)
 }
 
 QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
-  :  m_nPackets (0),
+  :  m_independentChildren (false),
+     m_nPackets (0),
      m_nBytes (0),
      m_maxSize (QueueSize ("1p")),         // to avoid that setting the mode at construction time is ignored
      m_running (false),
@@ -388,6 +390,8 @@ QueueDisc::DoDispose (void)
   m_classes.clear ();
   m_devQueueIface = 0;
   m_send = nullptr;
+  m_sendBurst = nullptr;
+  m_burst.clear ();
   m_requeued = 0;
   m_internalQueueDbeFunctor = nullptr;
   m_internalQueueDadFunctor = nullptr;
@@ -420,6 +424,12 @@ QueueDisc::DoInitialize (void)
 const QueueDisc::Stats&
 QueueDisc::GetStats (void)
 {
+  if (m_independentChildren)
+    {
+      MergeChildStats ();
+      return m_stats;
+    }
+
   NS_ASSERT (m_stats.nTotalDroppedPackets == m_stats.nTotalDroppedPacketsBeforeEnqueue
              + m_stats.nTotalDroppedPacketsAfterDequeue);
   NS_ASSERT (m_stats.nTotalDroppedBytes == m_stats.nTotalDroppedBytesBeforeEnqueue
@@ -563,6 +573,20 @@ QueueDisc::GetSendCallback (void) const
   return m_send;
 }
 
+void
+QueueDisc::SetSendBurstCallback (SendBurstCallback func)
+{
+  NS_LOG_FUNCTION (this);
+  m_sendBurst = func;
+}
+
+QueueDisc::SendBurstCallback
+QueueDisc::GetSendBurstCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sendBurst;
+}
+
 void
 QueueDisc::SetQuota (const uint32_t quota)
 {
@@ -640,6 +664,27 @@ QueueDisc::AddQueueDiscClass (Ptr<QueueDiscClass> qdClass)
   NS_ABORT_MSG_IF (qdClass->GetQueueDisc ()->GetWakeMode () == WAKE_CHILD,
                    "A queue disc with WAKE_CHILD as wake mode can only be a root queue disc");
 
+  // the children of a queue disc with WAKE_CHILD as wake mode are serviced
+  // independently of each other, hence they only notify their parent to keep
+  // its number of packets and bytes and fire its traces, while the parent
+  // merges their statistics on read
+  if (GetWakeMode () == WAKE_CHILD)
+    {
+      m_independentChildren = true;
+      qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("Enqueue",
+                                         MakeCallback (&QueueDisc::ChildPacketEnqueued, this));
+      qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("Dequeue",
+                                         MakeCallback (&QueueDisc::ChildPacketDequeued, this));
+      qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("DropBeforeEnqueue",
+                                         MakeCallback (&QueueDisc::ChildDroppedBeforeEnqueue, this));
+      qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("DropAfterDequeue",
+                                         MakeCallback (&QueueDisc::ChildDroppedAfterDequeue, this));
+      qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("Mark",
+                                         MakeCallback (&QueueDisc::ChildMarked, this));
+      m_classes.push_back (qdClass);
+      return;
+    }
+
   // set the parent callbacks on the child queue disc, so that it can notify
   // the parent queue disc of packets enqueued, dequeued, dropped, or marked
   qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("Enqueue",
@@ -691,6 +736,58 @@ QueueDisc::GetWakeMode (void) const
   return WAKE_ROOT;
 }
 
+/**
+ * \brief Add the counts of a child queue disc to those of its parent
+ * \param to the counts of the parent, for each reason
+ * \param from the counts of the child, for each reason
+ * \param prefix the prefix of the reasons of the child in the parent
+ */
+template <typename T>
+static void
+MergeReasons (std::map<std::string, T> &to, const std::map<std::string, T> &from, const char* prefix)
+{
+  for (auto &r : from)
+    {
+      to[std::string (prefix).append (r.first)] += r.second;
+    }
+}
+
+void
+QueueDisc::MergeChildStats (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_stats = Stats ();
+  for (auto &c : m_classes)
+    {
+      const Stats &s = c->GetQueueDisc ()->GetStats ();
+      m_stats.nTotalReceivedPackets += s.nTotalReceivedPackets;
+      m_stats.nTotalReceivedBytes += s.nTotalReceivedBytes;
+      m_stats.nTotalSentPackets += s.nTotalSentPackets;
+      m_stats.nTotalSentBytes += s.nTotalSentBytes;
+      m_stats.nTotalEnqueuedPackets += s.nTotalEnqueuedPackets;
+      m_stats.nTotalEnqueuedBytes += s.nTotalEnqueuedBytes;
+      m_stats.nTotalDequeuedPackets += s.nTotalDequeuedPackets;
+      m_stats.nTotalDequeuedBytes += s.nTotalDequeuedBytes;
+      m_stats.nTotalDroppedPackets += s.nTotalDroppedPackets;
+      m_stats.nTotalDroppedPacketsBeforeEnqueue += s.nTotalDroppedPacketsBeforeEnqueue;
+      MergeReasons (m_stats.nDroppedPacketsBeforeEnqueue, s.nDroppedPacketsBeforeEnqueue, CHILD_QUEUE_DISC_DROP);
+      m_stats.nTotalDroppedPacketsAfterDequeue += s.nTotalDroppedPacketsAfterDequeue;
+      MergeReasons (m_stats.nDroppedPacketsAfterDequeue, s.nDroppedPacketsAfterDequeue, CHILD_QUEUE_DISC_DROP);
+      m_stats.nTotalDroppedBytes += s.nTotalDroppedBytes;
+      m_stats.nTotalDroppedBytesBeforeEnqueue += s.nTotalDroppedBytesBeforeEnqueue;
+      MergeReasons (m_stats.nDroppedBytesBeforeEnqueue, s.nDroppedBytesBeforeEnqueue, CHILD_QUEUE_DISC_DROP);
+      m_stats.nTotalDroppedBytesAfterDequeue += s.nTotalDroppedBytesAfterDequeue;
+      MergeReasons (m_stats.nDroppedBytesAfterDequeue, s.nDroppedBytesAfterDequeue, CHILD_QUEUE_DISC_DROP);
+      m_stats.nTotalRequeuedPackets += s.nTotalRequeuedPackets;
+      m_stats.nTotalRequeuedBytes += s.nTotalRequeuedBytes;
+      m_stats.nTotalMarkedPackets += s.nTotalMarkedPackets;
+      MergeReasons (m_stats.nMarkedPackets, s.nMarkedPackets, CHILD_QUEUE_DISC_MARK);
+      m_stats.nTotalMarkedBytes += s.nTotalMarkedBytes;
+      MergeReasons (m_stats.nMarkedBytes, s.nMarkedBytes, CHILD_QUEUE_DISC_MARK);
+    }
+}
+
 void
 QueueDisc::PacketEnqueued (Ptr<const QueueDiscItem> item)
 {
@@ -725,6 +822,56 @@ QueueDisc::PacketDequeued (Ptr<const QueueDiscItem> item)
     }
 }
 
+void
+QueueDisc::ChildPacketEnqueued (Ptr<const QueueDiscItem> item)
+{
+  m_nPackets++;
+  m_nBytes += item->GetSize ();
+
+  NS_LOG_LOGIC ("m_traceEnqueue (p)");
+  m_traceEnqueue (item);
+}
+
+void
+QueueDisc::ChildPacketDequeued (Ptr<const QueueDiscItem> item)
+{
+  m_nPackets--;
+  m_nBytes -= item->GetSize ();
+
+  m_sojourn (Simulator::Now () - item->GetTimeStamp ());
+
+  NS_LOG_LOGIC ("m_traceDequeue (p)");
+  m_traceDequeue (item);
+}
+
+void
+QueueDisc::ChildDroppedBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
+{
+  NS_LOG_FUNCTION (this << item << reason);
+
+  NS_LOG_LOGIC ("m_traceDropBeforeEnqueue (p)");
+  m_traceDrop (item);
+  m_traceDropBeforeEnqueue (item, m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (reason).data ());
+}
+
+void
+QueueDisc::ChildDroppedAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
+{
+  NS_LOG_FUNCTION (this << item << reason);
+
+  NS_LOG_LOGIC ("m_traceDropAfterDequeue (p)");
+  m_traceDrop (item);
+  m_traceDropAfterDequeue (item, m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (reason).data ());
+}
+
+void
+QueueDisc::ChildMarked (Ptr<const QueueDiscItem> item, const char* reason)
+{
+  NS_LOG_FUNCTION (this << item << reason);
+
+  m_traceMark (item, m_childQueueDiscMarkMsg.assign (CHILD_QUEUE_DISC_MARK).append (reason).data ());
+}
+
 void
 QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
 {
@@ -959,13 +1106,24 @@ QueueDisc::Run (void)
   if (RunBegin ())
     {
       uint32_t quota = m_quota;
-      while (Restart ())
+      if (m_sendBurst && m_devQueueIface && m_devQueueIface->GetNTxQueues () == 1)
+        {
+          // Send the packets to the device in bursts, as Linux does with
+          // xmit_more, as long as the device queue has room for them
+          while (RestartBurst (quota))
+            {
+            }
+        }
+      else
         {
-          quota -= 1;
-          if (quota <= 0)
+          while (Restart ())
             {
-              /// \todo netif_schedule (q);
-              break;
+              quota -= 1;
+              if (quota <= 0)
+                {
+                  /// \todo netif_schedule (q);
+                  break;
+                }
             }
         }
       RunEnd ();
@@ -1006,6 +1164,42 @@ QueueDisc::Restart (void)
   return Transmit (item);
 }
 
+bool
+QueueDisc::RestartBurst (uint32_t &quota)
+{
+  NS_LOG_FUNCTION (this << quota);
+  Ptr<NetDeviceQueue> txq = m_devQueueIface->GetTxQueue (0);
+  uint32_t limit = std::min (quota, txq->GetBurstLimit ());
+
+  NS_ASSERT (m_burst.empty ());
+  while (m_burst.size () < limit)
+    {
+      Ptr<QueueDiscItem> item = DequeuePacket ();
+      if (item == 0)
+        {
+          break;
+        }
+      // a single queue device makes no use of the priority tag
+      SocketPriorityTag priorityTag;
+      item->GetPacket ()->RemovePacketTag (priorityTag);
+      m_burst.push_back (item);
+    }
+
+  if (m_burst.empty ())
+    {
+      NS_LOG_LOGIC ("No packet to send");
+      return false;
+    }
+
+  NS_LOG_LOGIC ("Sending a burst of " << m_burst.size () << " packets");
+  quota -= m_burst.size ();
+  m_sendBurst (m_burst);
+  m_burst.clear ();
+
+  // as in Transmit, the packets are assumed to be consumed by the device
+  return quota > 0 && GetNPackets () > 0 && !txq->IsStopped ();
+}
+
 Ptr<QueueDiscItem>
 QueueDisc::DequeuePacket ()
 {
@@ -333,6 +333,10 @@ public:
 
   /**
    * \brief Retrieve all the collected statistics.
+   *
+   * The statistics of a queue disc with wake mode equal to WAKE_CHILD are
+   * merged from those of its children when this method is called.
+   *
    * \return the collected statistics.
    */
   const Stats& GetStats (void);
@@ -372,6 +376,25 @@ public:
    */
   SendCallback GetSendCallback (void) const;
 
+  /// Callback invoked to send a burst of packets to the receiving object when Run is called
+  typedef std::function<void (const std::vector<Ptr<QueueDiscItem> > &)> SendBurstCallback;
+
+  /**
+   * \param func the callback to send a burst of packets to the receiving object.
+   *
+   * Set the callback used by the Run method to send bursts of packets to a
+   * single-queue device supporting bulk transmission. If this callback is
+   * set, the Run method dequeues as many packets as the device queue can
+   * receive (within the quota) and sends them to the device all at once,
+   * rather than one at a time through the send callback.
+   */
+  void SetSendBurstCallback (SendBurstCallback func);
+
+  /**
+   * \return the callback to send a burst of packets to the receiving object.
+   */
+  SendBurstCallback GetSendBurstCallback (void) const;
+
   /**
    * \brief Set the maximum number of dequeue operations following a packet enqueue
    * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -508,6 +531,12 @@ public:
    * a different strategy (e.g., multi-queue aware queue discs such as mq) have
    * to redefine this method.
    *
+   * The children of a queue disc with wake mode equal to WAKE_CHILD are serviced
+   * independently of each other. They notify their parent of the packets they
+   * enqueue, dequeue, drop or mark, so that the parent keeps its number of
+   * packets and bytes and fires its traces, but the parent merges the
+   * statistics of its children on read instead of updating its own.
+   *
    * \return the wake mode adopted by this queue disc.
    */
   virtual WakeMode GetWakeMode (void) const;
@@ -655,6 +684,17 @@ private:
    */
   bool Restart (void);
 
+  /**
+   * Dequeue (by calling DequeuePacket) as many packets as the device queue
+   * can receive, within the given quota, and send them to the device in a
+   * burst (by calling the send burst callback).
+   * \param quota the number of packets that can still be dequeued, decreased
+   *        by the number of packets sent
+   * \return true if the quota is not exhausted, the device queue is not stopped
+   *         and the queue disc is not empty
+   */
+  bool RestartBurst (uint32_t &quota);
+
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
    * \return the requeued packet, if any, or the packet dequeued by the queue disc, otherwise.
@@ -691,11 +731,62 @@ private:
    */
   void PacketDequeued (Ptr<const QueueDiscItem> item);
 
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet enqueue by an independent child (WAKE_CHILD)
+   *
+   *  The number of packets and bytes is updated and the Enqueue trace is
+   *  fired, while the statistics are merged from those of the children on read.
+   *  \param item item that was enqueued
+   */
+  void ChildPacketEnqueued (Ptr<const QueueDiscItem> item);
+
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dequeue by an independent child (WAKE_CHILD)
+   *  \param item item that was dequeued
+   */
+  void ChildPacketDequeued (Ptr<const QueueDiscItem> item);
+
+  /**
+   *  \brief Fire the drop traces when the queue disc is notified of a packet
+   *         dropped before enqueue by an independent child (WAKE_CHILD)
+   *  \param item item that was dropped
+   *  \param reason the reason why the item was dropped
+   */
+  void ChildDroppedBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason);
+
+  /**
+   *  \brief Fire the drop traces when the queue disc is notified of a packet
+   *         dropped after dequeue by an independent child (WAKE_CHILD)
+   *  \param item item that was dropped
+   *  \param reason the reason why the item was dropped
+   */
+  void ChildDroppedAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason);
+
+  /**
+   *  \brief Fire the mark trace when the queue disc is notified of a packet
+   *         marked by an independent child (WAKE_CHILD)
+   *  \param item item that was marked
+   *  \param reason the reason why the item was marked
+   */
+  void ChildMarked (Ptr<const QueueDiscItem> item, const char* reason);
+
+  /**
+   *  \brief Set the statistics of this queue disc to the sum of the
+   *  statistics of its children
+   *
+   *  The reasons for the drops and the marks are prefixed as for the packets
+   *  dropped or marked by a child queue disc that notifies its parent.
+   */
+  void MergeChildStats (void);
+
   static const uint32_t DEFAULT_QUOTA = 64; //!< Default quota (as in /proc/sys/net/core/dev_weight)
 
   std::vector<Ptr<InternalQueue> > m_queues;    //!< Internal queues
   std::vector<Ptr<PacketFilter> > m_filters;    //!< Packet filters
   std::vector<Ptr<QueueDiscClass> > m_classes;  //!< Classes
+  bool m_independentChildren;                   //!< True if the statistics of the classes are merged on read (WAKE_CHILD)
 
   TracedValue<uint32_t> m_nPackets; //!< Number of packets in the queue
   TracedValue<uint32_t> m_nBytes;   //!< Number of bytes in the queue
@@ -706,6 +797,8 @@ private:
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   SendCallback m_send;              //!< Callback used to send a packet to the receiving object
+  SendBurstCallback m_sendBurst;    //!< Callback used to send a burst of packets to the receiving object
+  std::vector<Ptr<QueueDiscItem> > m_burst; //!< The burst being sent (kept to reuse its storage)
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
@@ -633,11 +633,11 @@ RedQueueDisc::Estimator (uint32_t nQueued, uint32_t m, double qAvg, double qW)
 {
   NS_LOG_FUNCTION (this << nQueued << m << qAvg << qW);
 
-  double newAve = qAvg * std::pow (1.0 - qW, m);
+  // m is 1 unless the queue disc was idle, and pow is expensive
+  double newAve = qAvg * (m == 1 ? 1.0 - qW : std::pow (1.0 - qW, m));
   newAve += qW * nQueued;
 
-  Time now = Simulator::Now ();
-  if (m_isAdaptMaxP && now > m_lastSet + m_interval)
+  if (m_isAdaptMaxP && Simulator::Now () > m_lastSet + m_interval)
     {
       UpdateMaxP (newAve);
     }
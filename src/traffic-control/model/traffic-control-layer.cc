@@ -25,6 +25,7 @@
 #include "ns3/socket.h"
 #include "ns3/queue-disc.h"
 #include <tuple>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -71,6 +72,7 @@ TrafficControlLayer::DoDispose (void)
   NS_LOG_FUNCTION (this);
   m_node = 0;
   m_handlers.clear ();
+  m_netDeviceInfos.clear ();
   m_netDevices.clear ();
   Object::DoDispose ();
 }
@@ -120,6 +122,7 @@ TrafficControlLayer::ScanDevices (void)
   NS_ASSERT_MSG (m_node, "Cannot run ScanDevices without an aggregated node");
 
   NS_LOG_DEBUG ("Scanning devices on node " << m_node->GetId ());
+  m_netDeviceInfos.assign (m_node->GetNDevices (), nullptr);
   for (uint32_t i = 0; i < m_node->GetNDevices (); i++)
     {
       NS_LOG_DEBUG ("Scanning devices on node " << m_node->GetId ());
@@ -149,6 +152,12 @@ TrafficControlLayer::ScanDevices (void)
           ndi = m_netDevices.find (dev);
         }
 
+      // the interface index of a device is its (last) index in the list of the node
+      if (ndi != m_netDevices.end ())
+        {
+          m_netDeviceInfos[dev->GetIfIndex ()] = &ndi->second;
+        }
+
       // if a queue disc is installed, set the wake callbacks on netdevice queues
       if (ndi != m_netDevices.end () && ndi->second.m_rootQueueDisc)
         {
@@ -187,12 +196,14 @@ TrafficControlLayer::ScanDevices (void)
             }
 
           // set the NetDeviceQueueInterface object and the SendCallback on the queue discs
-          // into which packets are enqueued and dequeued by calling Run
+          // into which packets are enqueued and dequeued by calling Run, and the
+          // SendBurstCallback if the device supports bulk transmission
           for (auto& q : ndi->second.m_queueDiscsToWake)
             {
               q->SetNetDeviceQueueInterface (ndqi);
               q->SetSendCallback ([dev] (Ptr<QueueDiscItem> item)
                                   { dev->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()); });
+              q->SetSendBurstCallback (ndqi ? ndqi->GetSendBurstCallback () : nullptr);
             }
         }
     }
@@ -257,6 +268,7 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
     {
       q->SetNetDeviceQueueInterface (nullptr);
       q->SetSendCallback (nullptr);
+      q->SetSendBurstCallback (nullptr);
     }
   ndi->second.m_queueDiscsToWake.clear ();
 
@@ -272,6 +284,8 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
   else
     {
       // remove the empty entry
+      std::replace (m_netDeviceInfos.begin (), m_netDeviceInfos.end (), &ndi->second,
+                    static_cast<NetDeviceInfo *> (nullptr));
       m_netDevices.erase (ndi);
     }
 }
@@ -346,13 +360,13 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
   NS_LOG_DEBUG ("Send packet to device " << device << " protocol number " <<
                 item->GetProtocol ());
 
-  Ptr<NetDeviceQueueInterface> devQueueIface;
-  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
-
-  if (ndi != m_netDevices.end ())
+  NetDeviceInfo *ndi = nullptr;
+  uint32_t ifIndex = device->GetIfIndex ();
+  if (ifIndex < m_netDeviceInfos.size ())
     {
-      devQueueIface = ndi->second.m_ndqi;
+      ndi = m_netDeviceInfos[ifIndex];
     }
+  NetDeviceQueueInterface *devQueueIface = (ndi != nullptr ? PeekPointer (ndi->m_ndqi) : nullptr);
 
   // determine the transmission queue of the device where the packet will be enqueued
   std::size_t txq = 0;
@@ -369,7 +383,7 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
 
   NS_ASSERT (!devQueueIface || txq < devQueueIface->GetNTxQueues ());
 
-  if (ndi == m_netDevices.end () || ndi->second.m_rootQueueDisc == 0)
+  if (ndi == nullptr || ndi->m_rootQueueDisc == 0)
     {
       // The device has no attached queue disc, thus add the header to the packet and
       // send it directly to the device if the selected queue is not stopped
@@ -391,7 +405,7 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
       // selected for the packet and try to dequeue packets from such queue disc
       item->SetTxQueueIndex (txq);
 
-      Ptr<QueueDisc> qDisc = ndi->second.m_queueDiscsToWake[txq];
+      const Ptr<QueueDisc> &qDisc = ndi->m_queueDiscsToWake[txq];
       NS_ASSERT (qDisc);
       qDisc->Enqueue (item);
       qDisc->Run ();
@@ -253,6 +253,13 @@ private:
   Ptr<Node> m_node;
   /// Map storing the required information for each device with a queue disc installed
   std::map<Ptr<NetDevice>, NetDeviceInfo> m_netDevices;
+  /**
+   * The entries of the m_netDevices map, indexed by the interface index of
+   * their device (null for the devices without an entry). Set by ScanDevices,
+   * this vector is used to find the information about a device on the
+   * transmission of each packet, while the map is used for configuration.
+   */
+  std::vector<NetDeviceInfo *> m_netDeviceInfos;
   ProtocolHandlerList m_handlers;  //!< List of upper-layer handlers
 };
 
@@ -0,0 +1,215 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/mq-queue-disc.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Mq Queue Disc Test Item
+ */
+class MqQueueDiscTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet stored in this item
+   */
+  MqQueueDiscTestItem (Ptr<Packet> p);
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+};
+
+MqQueueDiscTestItem::MqQueueDiscTestItem (Ptr<Packet> p)
+  : QueueDiscItem (p, Mac48Address (), 0)
+{
+}
+
+void
+MqQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+MqQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the child queue discs of mq notify mq of their packets,
+ * so that mq keeps its counters and fires its traces, and that mq merges
+ * their statistics on read.
+ */
+class MqQueueDiscChildStatsTestCase : public TestCase
+{
+public:
+  MqQueueDiscChildStatsTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Count a packet enqueued in the mq queue disc
+   * \param item the packet
+   */
+  void RootEnqueue (Ptr<const QueueDiscItem> item);
+
+  /**
+   * Count a packet dequeued from the mq queue disc
+   * \param item the packet
+   */
+  void RootDequeue (Ptr<const QueueDiscItem> item);
+
+  /**
+   * Record a packet dropped by the mq queue disc before enqueue
+   * \param item the packet
+   * \param reason the reason why the packet was dropped
+   */
+  void RootDropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason);
+
+  /**
+   * Record the number of packets in the mq queue disc
+   * \param oldValue the previous number of packets
+   * \param newValue the current number of packets
+   */
+  void RootPacketsInQueue (uint32_t oldValue, uint32_t newValue);
+
+  uint32_t m_rootEnqueued;        //!< the packets enqueued in the mq queue disc
+  uint32_t m_rootDequeued;        //!< the packets dequeued from the mq queue disc
+  std::string m_rootDropReason;   //!< the reason of the last drop by the mq queue disc
+  uint32_t m_rootPacketsInQueue;  //!< the last number of packets traced by the mq queue disc
+};
+
+MqQueueDiscChildStatsTestCase::MqQueueDiscChildStatsTestCase ()
+  : TestCase ("Check that mq forwards the traces and merges the statistics of its child queue discs"),
+    m_rootEnqueued (0),
+    m_rootDequeued (0),
+    m_rootPacketsInQueue (0)
+{
+}
+
+void
+MqQueueDiscChildStatsTestCase::RootEnqueue (Ptr<const QueueDiscItem> item)
+{
+  m_rootEnqueued++;
+}
+
+void
+MqQueueDiscChildStatsTestCase::RootDequeue (Ptr<const QueueDiscItem> item)
+{
+  m_rootDequeued++;
+}
+
+void
+MqQueueDiscChildStatsTestCase::RootDropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
+{
+  m_rootDropReason = reason;
+}
+
+void
+MqQueueDiscChildStatsTestCase::RootPacketsInQueue (uint32_t oldValue, uint32_t newValue)
+{
+  m_rootPacketsInQueue = newValue;
+}
+
+void
+MqQueueDiscChildStatsTestCase::DoRun (void)
+{
+  Ptr<MqQueueDisc> root = CreateObject<MqQueueDisc> ();
+  std::vector<Ptr<QueueDisc> > children;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<QueueDisc> child = CreateObject<FifoQueueDisc> ();
+      child->SetMaxSize (QueueSize ("2p"));
+      Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass> ();
+      c->SetQueueDisc (child);
+      root->AddQueueDiscClass (c);
+      children.push_back (child);
+    }
+  root->Initialize ();
+  root->TraceConnectWithoutContext ("Enqueue", MakeCallback (&MqQueueDiscChildStatsTestCase::RootEnqueue, this));
+  root->TraceConnectWithoutContext ("Dequeue", MakeCallback (&MqQueueDiscChildStatsTestCase::RootDequeue, this));
+  root->TraceConnectWithoutContext ("DropBeforeEnqueue",
+                                    MakeCallback (&MqQueueDiscChildStatsTestCase::RootDropBeforeEnqueue, this));
+  root->TraceConnectWithoutContext ("PacketsInQueue",
+                                    MakeCallback (&MqQueueDiscChildStatsTestCase::RootPacketsInQueue, this));
+
+  // the traffic control layer enqueues the packets in the child queue discs
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      children[0]->Enqueue (Create<MqQueueDiscTestItem> (Create<Packet> (100)));
+    }
+  children[1]->Enqueue (Create<MqQueueDiscTestItem> (Create<Packet> (200)));
+  children[1]->Enqueue (Create<MqQueueDiscTestItem> (Create<Packet> (300)));
+  children[1]->Dequeue ();
+
+  std::string reason = std::string (QueueDisc::CHILD_QUEUE_DISC_DROP)
+                       .append (FifoQueueDisc::LIMIT_EXCEEDED_DROP);
+  NS_TEST_EXPECT_MSG_EQ (m_rootEnqueued, 4, "Enqueue trace of mq not fired");
+  NS_TEST_EXPECT_MSG_EQ (m_rootDequeued, 1, "Dequeue trace of mq not fired");
+  NS_TEST_EXPECT_MSG_EQ (m_rootDropReason, reason, "DropBeforeEnqueue trace of mq not fired");
+  NS_TEST_EXPECT_MSG_EQ (m_rootPacketsInQueue, 3, "PacketsInQueue trace of mq not fired");
+  NS_TEST_EXPECT_MSG_EQ (root->GetNPackets (), 3, "Wrong number of packets in mq");
+  NS_TEST_EXPECT_MSG_EQ (root->GetNBytes (), 500, "Wrong number of bytes in mq");
+
+  const QueueDisc::Stats &stats = root->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalReceivedPackets, 5, "Wrong number of packets received by mq");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalEnqueuedPackets, 4, "Wrong number of packets enqueued in mq");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalEnqueuedBytes, 700, "Wrong number of bytes enqueued in mq");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalSentPackets, 1, "Wrong number of packets sent by mq");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalSentBytes, 200, "Wrong number of bytes sent by mq");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalDroppedPackets, 1, "Wrong number of packets dropped by mq");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNDroppedPackets (reason), 1, "Drop reason of the child not merged");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNDroppedBytes (reason), 100, "Drop reason of the child not merged");
+
+  // the statistics are merged anew on every read
+  children[0]->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (root->GetStats ().nTotalDequeuedPackets, 2, "Statistics of mq not updated");
+  NS_TEST_EXPECT_MSG_EQ (root->GetStats ().GetNDroppedPackets (reason), 1, "Drop reason merged twice");
+  NS_TEST_EXPECT_MSG_EQ (root->GetNPackets (), 2, "Wrong number of packets in mq");
+  NS_TEST_EXPECT_MSG_EQ (root->GetNBytes (), 400, "Wrong number of bytes in mq");
+  NS_TEST_EXPECT_MSG_EQ (m_rootPacketsInQueue, 2, "PacketsInQueue trace of mq not fired");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Mq Queue Disc Test Suite
+ */
+static class MqQueueDiscTestSuite : public TestSuite
+{
+public:
+  MqQueueDiscTestSuite ()
+    : TestSuite ("mq-queue-disc", UNIT)
+  {
+    AddTestCase (new MqQueueDiscChildStatsTestCase, TestCase::QUICK);
+  }
+} g_mqQueueDiscTestSuite; ///< the test suite
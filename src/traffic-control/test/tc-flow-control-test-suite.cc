@@ -363,6 +363,129 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that a queue disc sends the packets to a device supporting
+ * bulk transmission in bursts as large as the room in the device queue.
+ */
+class TcBulkDequeueTestCase : public TestCase
+{
+public:
+  TcBulkDequeueTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Instruct a node to send a specified number of packets
+   * \param n the node
+   * \param nPackets the number of packets to send
+   */
+  void SendPackets (Ptr<Node> n, uint16_t nPackets);
+  /**
+   * Record a burst of packets, then send it to the device
+   * \param items the packets of the burst
+   */
+  void SendBurst (const std::vector<Ptr<QueueDiscItem> > &items);
+  /**
+   * Check the number of packets stored in the device queue and in the queue disc
+   * \param dev the device
+   * \param inDevice the expected number of packets stored in the device queue
+   * \param inQueueDisc the expected number of packets stored in the queue disc
+   */
+  void CheckPackets (Ptr<NetDevice> dev, uint32_t inDevice, uint32_t inQueueDisc);
+  NetDeviceQueueInterface::SendBurstCallback m_sendBurst; //!< the send burst callback of the device
+  std::vector<std::size_t> m_bursts;  //!< the size of the bursts sent to the device
+};
+
+TcBulkDequeueTestCase::TcBulkDequeueTestCase ()
+  : TestCase ("Test the bulk dequeue of packets to the device")
+{
+}
+
+void
+TcBulkDequeueTestCase::SendPackets (Ptr<Node> n, uint16_t nPackets)
+{
+  Ptr<TrafficControlLayer> tc = n->GetObject<TrafficControlLayer> ();
+  for (uint16_t i = 0; i < nPackets; i++)
+    {
+      tc->Send (n->GetDevice (0), Create<QueueDiscTestItem> (Create<Packet> (1000)));
+    }
+}
+
+void
+TcBulkDequeueTestCase::SendBurst (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  m_bursts.push_back (items.size ());
+  m_sendBurst (items);
+}
+
+void
+TcBulkDequeueTestCase::CheckPackets (Ptr<NetDevice> dev, uint32_t inDevice, uint32_t inQueueDisc)
+{
+  PointerValue ptr;
+  dev->GetAttributeFailSafe ("TxQueue", ptr);
+  NS_TEST_EXPECT_MSG_EQ (ptr.Get<Queue<Packet> > ()->GetNPackets (), inDevice,
+                         "Unexpected number of packets in the device queue");
+  Ptr<QueueDisc> qdisc = dev->GetNode ()->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (dev);
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), inQueueDisc,
+                         "Unexpected number of packets in the queue disc");
+}
+
+void
+TcBulkDequeueTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer rxDevC = simple.Install (n.Get (1));
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
+  simple.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("5p"));
+  Ptr<NetDevice> txDev;
+  txDev = simple.Install (n.Get (0), DynamicCast<SimpleChannel> (rxDevC.Get (0)->GetChannel ())).Get (0);
+
+  // Record the bursts received by the device
+  Ptr<NetDeviceQueueInterface> ndqi = txDev->GetObject<NetDeviceQueueInterface> ();
+  m_sendBurst = ndqi->GetSendBurstCallback ();
+  NS_TEST_ASSERT_MSG_EQ (bool (m_sendBurst), true, "SimpleNetDevice does not support bulk transmission");
+  ndqi->SetSendBurstCallback ([this] (const std::vector<Ptr<QueueDiscItem> > &items)
+                              { SendBurst (items); });
+
+  TrafficControlHelper tch = TrafficControlHelper::Default ();
+  tch.Install (txDev);
+
+  // Queue 10 packets in the queue disc while the device queue is stopped,
+  // then wake the device queue
+  Simulator::Schedule (MilliSeconds (1), &NetDeviceQueue::Stop, ndqi->GetTxQueue (0));
+  Simulator::Schedule (MilliSeconds (1), &TcBulkDequeueTestCase::SendPackets, this, n.Get (0), 10);
+  Simulator::Schedule (MilliSeconds (2), &TcBulkDequeueTestCase::CheckPackets, this, txDev, 0, 10);
+  Simulator::Schedule (MilliSeconds (2), &NetDeviceQueue::Wake, ndqi->GetTxQueue (0));
+
+  // The queue disc sends a burst of 5 packets, filling the device queue; the
+  // device starts transmitting the first one (which takes 8ms) and the queue
+  // disc sends another packet in the room left
+  Simulator::Schedule (MilliSeconds (3), &TcBulkDequeueTestCase::CheckPackets, this, txDev, 5, 4);
+  Simulator::Schedule (MilliSeconds (11), &TcBulkDequeueTestCase::CheckPackets, this, txDev, 5, 3);
+  Simulator::Schedule (MilliSeconds (100), &TcBulkDequeueTestCase::CheckPackets, this, txDev, 0, 0);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_GT (m_bursts.size (), 1, "No burst sent to the device");
+  NS_TEST_EXPECT_MSG_EQ (m_bursts[0], 5, "The first burst must fill the device queue");
+  std::size_t sent = 0;
+  for (auto size : m_bursts)
+    {
+      sent += size;
+    }
+  NS_TEST_EXPECT_MSG_EQ (sent, 10, "All the packets must be sent to the device");
+  m_sendBurst = nullptr;
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -377,5 +500,6 @@ public:
   {
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS), TestCase::QUICK);
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueTestCase, TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/queue.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Layer Test Item
+ */
+class TcLayerTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet stored in this item
+   */
+  TcLayerTestItem (Ptr<Packet> p);
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+};
+
+TcLayerTestItem::TcLayerTestItem (Ptr<Packet> p)
+  : QueueDiscItem (p, Mac48Address (), 0)
+{
+}
+
+void
+TcLayerTestItem::AddHeader (void)
+{
+}
+
+bool
+TcLayerTestItem::Mark (void)
+{
+  return false;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the traffic control layer of a node with several
+ * devices sends the packets of each device through the queue disc installed
+ * on that device, or directly to the device if it has none.
+ */
+class TcLayerDeviceLookupTestCase : public TestCase
+{
+public:
+  TcLayerDeviceLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Send packets to each device of a node, as many as one plus the index
+   * of the device
+   * \param node the node
+   */
+  void SendPackets (Ptr<Node> node);
+
+  /**
+   * Count a packet enqueued in the queue of a device
+   * \param index the index of the device
+   * \param packet the packet
+   */
+  void DeviceEnqueue (uint32_t index, Ptr<const Packet> packet);
+
+  std::vector<uint32_t> m_deviceEnqueued; //!< the packets enqueued in the queue of each device
+};
+
+TcLayerDeviceLookupTestCase::TcLayerDeviceLookupTestCase ()
+  : TestCase ("Check the lookup of the devices by the traffic control layer")
+{
+}
+
+void
+TcLayerDeviceLookupTestCase::SendPackets (Ptr<Node> node)
+{
+  Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer> ();
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      for (uint32_t j = 0; j <= i; j++)
+        {
+          tc->Send (node->GetDevice (i), Create<TcLayerTestItem> (Create<Packet> (100)));
+        }
+    }
+}
+
+void
+TcLayerDeviceLookupTestCase::DeviceEnqueue (uint32_t index, Ptr<const Packet> packet)
+{
+  m_deviceEnqueued[index]++;
+}
+
+void
+TcLayerDeviceLookupTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  nodes.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  nodes.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NetDeviceContainer rxDevC = simple.Install (nodes.Get (1));
+      devices.Add (simple.Install (nodes.Get (0), DynamicCast<SimpleChannel> (rxDevC.Get (0)->GetChannel ())));
+    }
+
+  // Queue discs on the devices 1 and 3 only
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FifoQueueDisc");
+  QueueDiscContainer qdiscs = tch.Install (devices);
+  Ptr<TrafficControlLayer> tc = nodes.Get (0)->GetObject<TrafficControlLayer> ();
+  tc->DeleteRootQueueDiscOnDevice (devices.Get (0));
+  tc->DeleteRootQueueDiscOnDevice (devices.Get (2));
+
+  m_deviceEnqueued.assign (devices.GetN (), 0);
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      PointerValue ptr;
+      devices.Get (i)->GetAttribute ("TxQueue", ptr);
+      ptr.Get<Queue<Packet> > ()->TraceConnectWithoutContext ("Enqueue",
+        MakeCallback (&TcLayerDeviceLookupTestCase::DeviceEnqueue, this).Bind (i));
+    }
+
+  Simulator::Schedule (MilliSeconds (1), &TcLayerDeviceLookupTestCase::SendPackets, this, nodes.Get (0));
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_deviceEnqueued[i], i + 1, "Packets not sent to device " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (qdiscs.Get (0)->GetStats ().nTotalReceivedPackets, 0,
+                         "Packets received by a deleted queue disc");
+  NS_TEST_EXPECT_MSG_EQ (qdiscs.Get (1)->GetStats ().nTotalReceivedPackets, 2,
+                         "Packets of device 1 not received by its queue disc");
+  NS_TEST_EXPECT_MSG_EQ (qdiscs.Get (2)->GetStats ().nTotalReceivedPackets, 0,
+                         "Packets received by a deleted queue disc");
+  NS_TEST_EXPECT_MSG_EQ (qdiscs.Get (3)->GetStats ().nTotalReceivedPackets, 4,
+                         "Packets of device 3 not received by its queue disc");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Layer Test Suite
+ */
+static class TrafficControlLayerTestSuite : public TestSuite
+{
+public:
+  TrafficControlLayerTestSuite ()
+    : TestSuite ("traffic-control-layer", UNIT)
+  {
+    AddTestCase (new TcLayerDeviceLookupTestCase, TestCase::QUICK);
+  }
+} g_trafficControlLayerTestSuite; ///< the test suite
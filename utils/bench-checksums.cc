@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the CRC-32 (Ethernet FCS) and
+// the Internet checksum (IPv4, TCP, UDP, ICMP) computations, against the
+// byte-at-a-time algorithms they replace, for 'n' packets of 'size' bytes.
+// Sample usage:  ./waf --run 'bench-checksums --n=100000 --size=1500'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/buffer.h"
+#include "ns3/crc32.h"
+#include <iostream>
+#include <vector>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Sink for the computed values, so that they are not optimized out
+static volatile uint32_t g_sink;
+
+/**
+ * Byte-at-a-time CRC-32, as computed by CRC32Calculate before slice-by-8
+ * \param data the data
+ * \param length the data length
+ * \returns the CRC-32
+ */
+static uint32_t
+ByteCrc32 (const uint8_t *data, uint32_t length)
+{
+  static uint32_t table[256];
+  if (table[1] == 0)
+    {
+      for (uint32_t n = 0; n < 256; n++)
+        {
+          uint32_t c = n;
+          for (uint32_t bit = 0; bit < 8; bit++)
+            {
+              c = (c >> 1) ^ (0xedb88320 & -(c & 1));
+            }
+          table[n] = c;
+        }
+    }
+  uint32_t crc = 0xffffffff;
+  while (length--)
+    {
+      crc = (crc >> 8) ^ table[(crc & 0xff) ^ *data++];
+    }
+  return ~crc;
+}
+
+/**
+ * Word-at-a-time Internet checksum, as computed by
+ * Buffer::Iterator::CalculateIpChecksum before it worked on whole areas
+ * \param i the iterator
+ * \param size the number of bytes
+ * \returns the checksum
+ */
+static uint16_t
+WordIpChecksum (Buffer::Iterator i, uint16_t size)
+{
+  uint32_t sum = 0;
+  for (int j = 0; j < size / 2; j++)
+    {
+      sum += i.ReadU16 ();
+    }
+  if (size & 1)
+    {
+      sum += i.ReadU8 ();
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+/// Benchmark parameters
+struct BenchParameters
+{
+  uint32_t n;                   //!< number of packets
+  std::vector<uint8_t> data;    //!< packet bytes
+  Buffer buffer;                //!< packet buffer
+};
+
+static BenchParameters g_bench; //!< the benchmark parameters
+
+/**
+ * Byte-at-a-time CRC-32 benchmark
+ */
+static void
+benchByteCrc32 (void)
+{
+  for (uint32_t i = 0; i < g_bench.n; i++)
+    {
+      g_sink = ByteCrc32 (&g_bench.data[0], g_bench.data.size ());
+    }
+}
+
+/**
+ * CRC32Calculate benchmark
+ */
+static void
+benchCrc32 (void)
+{
+  for (uint32_t i = 0; i < g_bench.n; i++)
+    {
+      g_sink = CRC32Calculate (&g_bench.data[0], g_bench.data.size ());
+    }
+}
+
+/**
+ * Word-at-a-time Internet checksum benchmark
+ */
+static void
+benchWordIpChecksum (void)
+{
+  for (uint32_t i = 0; i < g_bench.n; i++)
+    {
+      g_sink = WordIpChecksum (g_bench.buffer.Begin (), g_bench.buffer.GetSize ());
+    }
+}
+
+/**
+ * CalculateIpChecksum benchmark
+ */
+static void
+benchIpChecksum (void)
+{
+  for (uint32_t i = 0; i < g_bench.n; i++)
+    {
+      g_sink = g_bench.buffer.Begin ().CalculateIpChecksum (g_bench.buffer.GetSize ());
+    }
+}
+
+/**
+ * Run a benchmark several times and print its best throughput.
+ * \param bench the benchmark
+ * \param minIterations the number of runs
+ * \param name the benchmark name
+ */
+static void
+runBench (void (*bench) (void), uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) ();
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  minDelay = std::max (minDelay, static_cast<uint64_t> (1));
+  double mbps = static_cast<double> (g_bench.n) * g_bench.data.size () * 8 / 1000 / minDelay;
+  std::cout << mbps << " Mbit/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t size = 1500;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the CRC-32 and Internet checksum computations");
+  cmd.AddValue ("n", "number of packets", n);
+  cmd.AddValue ("size", "packet size (bytes)", size);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || size == 0 || size > 65535)
+    {
+      std::cerr << "Error-- number of packets must be specified " <<
+        "by command-line argument --n=(number of packets), " <<
+        "and the size must be between 1 and 65535" << std::endl;
+      exit (1);
+    }
+
+  g_bench.n = n;
+  g_bench.data.resize (size);
+  g_bench.buffer.AddAtStart (size);
+  Buffer::Iterator it = g_bench.buffer.Begin ();
+  for (uint32_t i = 0; i < size; i++)
+    {
+      g_bench.data[i] = i * 131 + 7;
+      it.WriteU8 (g_bench.data[i]);
+    }
+
+  if (ByteCrc32 (&g_bench.data[0], size) != CRC32Calculate (&g_bench.data[0], size)
+      || WordIpChecksum (g_bench.buffer.Begin (), size) != g_bench.buffer.Begin ().CalculateIpChecksum (size))
+    {
+      std::cerr << "Error-- mismatch with the reference algorithms" << std::endl;
+      exit (1);
+    }
+
+  std::cout << "Running bench-checksums with n=" << n << " size=" << size << std::endl;
+  runBench (&benchByteCrc32, minIterations, "CRC-32, byte at a time");
+  runBench (&benchCrc32, minIterations, "CRC-32, CRC32Calculate");
+  runBench (&benchWordIpChecksum, minIterations, "Internet checksum, word at a time");
+  runBench (&benchIpChecksum, minIterations, "Internet checksum, CalculateIpChecksum");
+
+  return 0;
+}
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the flow scheduling of FqCoDelQueueDisc at line
+// rate: 'flows' flows keep 'backlog' packets each in the queue disc, which
+// a link of rate 'rate' drains, every packet transmitted being replaced by
+// a packet of the same flow. It reports the packets processed per second
+// of wall clock time, and the heap allocations per packet.
+// Sample usage:  ./waf --run 'bench-fq-codel --flows=1024 --packets=1000000'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+#include <iostream>
+#include <new>
+#include <cstdlib>
+#include <stdlib.h> // for exit ()
+#include <stdint.h>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Calls to operator new
+static uint64_t g_allocations = 0;
+
+void *
+operator new (size_t size)
+{
+  void *p = std::malloc (size);
+  if (p == nullptr)
+    {
+      throw std::bad_alloc ();
+    }
+  g_allocations++;
+  return p;
+}
+
+void *
+operator new[] (size_t size)
+{
+  return operator new (size);
+}
+
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete (void *p, size_t) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete[] (void *p, size_t) noexcept
+{
+  operator delete (p);
+}
+
+/// Benchmark state
+struct BenchState
+{
+  Ptr<FqCoDelQueueDisc> queueDisc;  //!< the queue disc
+  Time txTime;                      //!< transmission time of a packet
+  uint64_t packets;                 //!< packets left to transmit
+  uint64_t transmitted;             //!< packets transmitted
+};
+
+static BenchState g_bench; //!< the benchmark state
+
+/**
+ * Transmit a packet, replace it with a packet of the same flow, and
+ * schedule the next transmission.
+ */
+static void
+transmit (void)
+{
+  Ptr<QueueDiscItem> item = g_bench.queueDisc->Dequeue ();
+  if (item == 0)
+    {
+      return;
+    }
+  g_bench.transmitted++;
+  if (--g_bench.packets > 0)
+    {
+      g_bench.queueDisc->Enqueue (item);
+      Simulator::Schedule (g_bench.txTime, &transmit);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t flows = 1024;
+  uint32_t backlog = 2;
+  uint32_t packetSize = 1500;
+  uint64_t packets = 1000000;
+  DataRate rate ("10Gbps");
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the flow scheduling of FqCoDelQueueDisc");
+  cmd.AddValue ("flows", "number of flows", flows);
+  cmd.AddValue ("backlog", "packets queued per flow", backlog);
+  cmd.AddValue ("packet-size", "size of the IP packets", packetSize);
+  cmd.AddValue ("packets", "number of packets transmitted", packets);
+  cmd.AddValue ("rate", "link rate", rate);
+  cmd.Parse (argc, argv);
+
+  if (flows == 0 || backlog == 0 || packets == 0 || packetSize < 20 || packetSize > 65535
+      || static_cast<uint64_t> (flows) * backlog > 10240)
+    {
+      std::cerr << "Error-- the flows, backlog and packets must be positive, the queue disc "
+                << "must hold the backlog of the flows, and the packet size must be in [20, 65535]"
+                << std::endl;
+      exit (1);
+    }
+
+  std::cout << "Running bench-fq-codel with flows=" << flows << " backlog=" << backlog
+            << " packet-size=" << packetSize << " packets=" << packets
+            << " rate=" << rate << std::endl;
+
+  g_bench.queueDisc = CreateObject<FqCoDelQueueDisc> ();
+  g_bench.queueDisc->SetQuantum (packetSize);
+  g_bench.queueDisc->Initialize ();
+  g_bench.txTime = rate.CalculateBytesTxTime (packetSize);
+  // The packets transmitted before measuring, to reach the steady state
+  uint64_t warmup = 2 * flows * backlog;
+  g_bench.packets = warmup + packets;
+  g_bench.transmitted = 0;
+
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.0.0.1"));
+  header.SetProtocol (17);
+  header.SetPayloadSize (packetSize - 20);
+  for (uint32_t b = 0; b < backlog; b++)
+    {
+      for (uint32_t i = 0; i < flows; i++)
+        {
+          header.SetDestination (Ipv4Address (0x0b000000 + i));
+          g_bench.queueDisc->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (packetSize - 20),
+                                                                  Address (), 0, header));
+        }
+    }
+  Simulator::Schedule (Seconds (0), &transmit);
+  Simulator::Stop (g_bench.txTime * warmup);
+  Simulator::Run ();
+
+  uint64_t transmitted = g_bench.transmitted;
+  uint64_t allocations = g_allocations;
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  uint64_t elapsed = std::max (static_cast<uint64_t> (time.End ()), static_cast<uint64_t> (1));
+  transmitted = g_bench.transmitted - transmitted;
+  allocations = g_allocations - allocations;
+
+  std::cout << static_cast<double> (transmitted) * 1000 / elapsed << " packets/s"
+            << " (" << elapsed << " ms elapsed)\t"
+            << static_cast<double> (allocations) / transmitted << " allocations/packet"
+            << " (" << transmitted << " packets)\t"
+            << "FqCoDelQueueDisc " << flows << " flows"
+            << std::endl;
+
+  g_bench.queueDisc = 0;
+  Simulator::Destroy ();
+  return 0;
+}
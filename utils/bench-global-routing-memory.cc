@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program reports the memory used by the global routing of a grid of
+// 'rows' x 'rows' routers connected by point-to-point links: the heap
+// allocated by the C++ operator new for the link state database, before and
+// after it is indexed, and the peak heap allocated by the shortest path
+// calculation of the first 'roots' routers, besides the routes it adds.
+// Sample usage:  ./waf --run 'bench-global-routing-memory --rows=30 --roots=100'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/global-route-manager-impl.h"
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <stdint.h>
+
+using namespace ns3;
+
+/// Bytes currently allocated with operator new
+static uint64_t g_allocated = 0;
+
+/// Highest number of bytes allocated with operator new since it was reset
+static uint64_t g_peak = 0;
+
+/// Room kept before each allocation for its size
+static const size_t ALLOC_HEADER = alignof (std::max_align_t);
+
+void *
+operator new (size_t size)
+{
+  void *p = std::malloc (size + ALLOC_HEADER);
+  if (p == nullptr)
+    {
+      throw std::bad_alloc ();
+    }
+  *static_cast<size_t *> (p) = size;
+  g_allocated += size;
+  g_peak = std::max (g_peak, g_allocated);
+  return static_cast<char *> (p) + ALLOC_HEADER;
+}
+
+void *
+operator new[] (size_t size)
+{
+  return operator new (size);
+}
+
+void
+operator delete (void *p) noexcept
+{
+  if (p == nullptr)
+    {
+      return;
+    }
+  char *block = static_cast<char *> (p) - ALLOC_HEADER;
+  g_allocated -= *reinterpret_cast<size_t *> (block);
+  std::free (block);
+}
+
+void
+operator delete[] (void *p) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete (void *p, size_t) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete[] (void *p, size_t) noexcept
+{
+  operator delete (p);
+}
+
+/**
+ * Print a memory measure.
+ * \param name the measure name
+ * \param bytes the bytes allocated
+ * \param count the number of items measured
+ * \param unit the name of the items
+ */
+static void
+report (char const *name, uint64_t bytes, uint32_t count, char const *unit)
+{
+  std::cout << bytes << " bytes"
+            << " (" << static_cast<double> (bytes) / count << " bytes/" << unit << ")\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t rows = 20;
+  uint32_t nRoots = 100;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the memory used by the global routing");
+  cmd.AddValue ("rows", "number of rows and columns of the grid of routers", rows);
+  cmd.AddValue ("roots", "number of routers running the shortest path calculation", nRoots);
+  cmd.Parse (argc, argv);
+
+  if (rows < 2 || rows > 128 || nRoots == 0)
+    {
+      std::cerr << "Error-- the number of rows must be between 2 and 128, " <<
+        "and the number of roots must be positive" << std::endl;
+      exit (1);
+    }
+
+  uint32_t nNodes = rows * rows;
+  nRoots = std::min (nRoots, nNodes);
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper p2p;
+  p2p.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  uint32_t nLinks = 0;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      // Link each router to its right and lower neighbours
+      uint32_t neighbours[2] = { (i % rows) + 1 < rows ? i + 1 : nNodes, i + rows };
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          if (neighbours[k] >= nNodes)
+            {
+              continue;
+            }
+          ipv4.Assign (p2p.Install (NodeContainer (nodes.Get (i), nodes.Get (neighbours[k]))));
+          ipv4.NewNetwork ();
+          nLinks++;
+        }
+    }
+
+  std::cout << "Running bench-global-routing-memory with rows=" << rows
+            << " (" << nNodes << " routers, " << nLinks << " links)" << std::endl;
+
+  // The link state database, as built by GlobalRouteManagerImpl
+  std::vector<Ptr<GlobalRouter> > routers;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      routers.push_back (nodes.Get (i)->GetObject<GlobalRouter> ());
+      routers.back ()->DiscoverLSAs ();
+    }
+  uint64_t before = g_allocated;
+  GlobalRouteManagerLSDB *lsdb = new GlobalRouteManagerLSDB ();
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      for (uint32_t j = 0; j < routers[i]->GetNumLSAs (); j++)
+        {
+          GlobalRoutingLSA *lsa = new GlobalRoutingLSA ();
+          routers[i]->GetLSA (j, *lsa);
+          lsdb->Insert (lsa->GetLinkStateId (), lsa);
+        }
+    }
+  report ("link state database, not indexed", g_allocated - before, nNodes, "router");
+  g_peak = g_allocated;
+  lsdb->BuildIndex ();
+  report ("link state database, indexing peak", g_peak - before, nNodes, "router");
+  uint64_t lsdbBytes = g_allocated - before;
+  report ("link state database, indexed", lsdbBytes, nNodes, "router");
+
+  // The shortest path calculation of each root.  The routes added to the
+  // routing table of the root stay allocated, as does the state that the
+  // calculation keeps between roots: it is measured once the calculation and
+  // its database are deleted, and counted in the peak of every root.
+  uint64_t beforeCalculations = g_allocated;
+  GlobalRouteManagerImpl *impl = new GlobalRouteManagerImpl ();
+  impl->DebugUseLsdb (lsdb);
+  uint64_t beforeRoots = g_allocated;
+  std::vector<uint64_t> peaks;
+  std::vector<uint64_t> retained;
+  for (uint32_t i = 0; i < nRoots; i++)
+    {
+      before = g_allocated;
+      g_peak = g_allocated;
+      impl->DebugSPFCalculate (routers[i]->GetRouterId ());
+      peaks.push_back (g_peak - before);
+      retained.push_back (g_allocated - before);
+    }
+  uint64_t afterRoots = g_allocated;
+  delete impl;
+  uint64_t routes = g_allocated + lsdbBytes - beforeCalculations;
+  uint64_t state = afterRoots - beforeRoots - routes;
+  uint64_t maxPeak = 0;
+  uint64_t sumPeak = 0;
+  for (uint32_t i = 0; i < nRoots; i++)
+    {
+      uint64_t peak = i == 0 ? peaks[i] - (retained[i] - state) : peaks[i] - retained[i] + state;
+      maxPeak = std::max (maxPeak, peak);
+      sumPeak += peak;
+    }
+  report ("shortest path calculation, state kept between roots", state, nNodes, "router");
+  report ("shortest path calculation, mean peak besides the routes", sumPeak / nRoots, nNodes, "router");
+  report ("shortest path calculation, max peak besides the routes", maxPeak, nNodes, "router");
+  report ("shortest path calculation, mean routes", routes / nRoots, nNodes, "router");
+
+  Simulator::Destroy ();
+
+  return 0;
+}
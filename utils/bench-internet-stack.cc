@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program reports the time taken by InternetStackHelper::Install to
+// install the internet stack on 'nodes' nodes, and the heap allocated by
+// the C++ operator new for it, per node.
+// Sample usage:  ./waf --run 'bench-internet-stack --nodes=10000 --ipv6OnDemand=1'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include <iostream>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <stdint.h>
+
+using namespace ns3;
+
+/// Bytes currently allocated with operator new
+static uint64_t g_allocated = 0;
+
+/// Room kept before each allocation for its size
+static const size_t ALLOC_HEADER = alignof (std::max_align_t);
+
+void *
+operator new (size_t size)
+{
+  void *p = std::malloc (size + ALLOC_HEADER);
+  if (p == nullptr)
+    {
+      throw std::bad_alloc ();
+    }
+  *static_cast<size_t *> (p) = size;
+  g_allocated += size;
+  return static_cast<char *> (p) + ALLOC_HEADER;
+}
+
+void *
+operator new[] (size_t size)
+{
+  return operator new (size);
+}
+
+void
+operator delete (void *p) noexcept
+{
+  if (p == nullptr)
+    {
+      return;
+    }
+  char *block = static_cast<char *> (p) - ALLOC_HEADER;
+  g_allocated -= *reinterpret_cast<size_t *> (block);
+  std::free (block);
+}
+
+void
+operator delete[] (void *p) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete (void *p, size_t) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete[] (void *p, size_t) noexcept
+{
+  operator delete (p);
+}
+
+/**
+ * Install the internet stack on nodes, and print the time and memory used
+ * per node.
+ * \param nodes the number of nodes
+ * \param ipv6 whether to install the IPv6 stack
+ * \param ipv6OnDemand whether to defer the IPv6 stack until it is used
+ */
+static void
+benchInstall (uint32_t nodes, bool ipv6, bool ipv6OnDemand)
+{
+  NodeContainer c;
+  c.Create (nodes);
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (ipv6);
+  internet.SetIpv6StackInstallOnDemand (ipv6OnDemand);
+
+  uint64_t before = g_allocated;
+  SystemWallClockMs time;
+  time.Start ();
+  internet.Install (c);
+  int64_t elapsed = time.End ();
+
+  std::cout << static_cast<double> (elapsed) * 1000 / nodes << " us/node\t"
+            << static_cast<double> (g_allocated - before) / nodes << " bytes/node"
+            << " (" << nodes << " nodes)\t"
+            << (!ipv6 ? "IPv4" : ipv6OnDemand ? "IPv4+IPv6 on demand" : "IPv4+IPv6")
+            << std::endl;
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nodes = 10000;
+  bool ipv6 = true;
+  bool ipv6OnDemand = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the installation of the internet stack");
+  cmd.AddValue ("nodes", "number of nodes", nodes);
+  cmd.AddValue ("ipv6", "install the IPv6 stack too", ipv6);
+  cmd.AddValue ("ipv6OnDemand", "install the IPv6 stack when first used", ipv6OnDemand);
+  cmd.Parse (argc, argv);
+
+  if (nodes == 0)
+    {
+      std::cerr << "Error-- the number of nodes must be positive" << std::endl;
+      exit (1);
+    }
+
+  std::cout << "Running bench-internet-stack with nodes=" << nodes << std::endl;
+  benchInstall (nodes, ipv6, ipv6OnDemand);
+
+  return 0;
+}
@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the route lookups of a router
+// forwarding 'n' packets, with 'routes' host routes or /24 network routes
+// in Ipv4GlobalRouting or Ipv4StaticRouting, to random destinations.
+// Sample usage:  ./waf --run 'bench-ipv4-routing --n=1000000 --routes=10000'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include <iostream>
+#include <vector>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Number of interfaces of the router
+static const uint32_t N_INTERFACES = 16;
+
+/// Benchmark parameters
+struct BenchParameters
+{
+  uint32_t n;                                 //!< number of packets
+  Ptr<Ipv4RoutingProtocol> routing;           //!< routing protocol under test
+  std::vector<Ipv4Header> headers;            //!< headers of the packets
+};
+
+static BenchParameters g_bench; //!< the benchmark parameters
+
+/**
+ * Route lookup benchmark
+ */
+static void
+benchLookup (void)
+{
+  Ptr<Packet> p = Create<Packet> ();
+  Socket::SocketErrno err;
+  uint32_t nFound = 0;
+  for (uint32_t i = 0; i < g_bench.n; i++)
+    {
+      Ipv4Header const &header = g_bench.headers[i % g_bench.headers.size ()];
+      if (g_bench.routing->RouteOutput (p, header, 0, err) != 0)
+        {
+          nFound++;
+        }
+    }
+  NS_ABORT_MSG_UNLESS (nFound == g_bench.n, "Routes not found");
+}
+
+/**
+ * Run a benchmark several times and print its best lookup rate.
+ * \param bench the benchmark
+ * \param minIterations the number of runs
+ * \param name the benchmark name
+ */
+static void
+runBench (void (*bench) (void), uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) ();
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  minDelay = std::max (minDelay, static_cast<uint64_t> (1));
+  double lps = static_cast<double> (g_bench.n) * 1000 / minDelay;
+  std::cout << lps << " lookups/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+/**
+ * \param i a route index
+ * \returns the first host address of the i-th /24 network
+ */
+static Ipv4Address
+GetDestination (uint32_t i)
+{
+  return Ipv4Address (0x0b000001 | i << 8);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t nRoutes = 10000;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the route lookups of Ipv4GlobalRouting and Ipv4StaticRouting");
+  cmd.AddValue ("n", "number of lookups", n);
+  cmd.AddValue ("routes", "number of routes", nRoutes);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || nRoutes == 0 || nRoutes > 0xffff)
+    {
+      std::cerr << "Error-- number of lookups must be specified " <<
+        "by command-line argument --n=(number of lookups), " <<
+        "and the number of routes must be between 1 and 65535" << std::endl;
+      exit (1);
+    }
+
+  // A router with one /30 subnet per interface
+  Ptr<Node> router = CreateObject<Node> ();
+  InternetStackHelper stack;
+  stack.Install (router);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < N_INTERFACES; i++)
+    {
+      Ptr<Node> peer = CreateObject<Node> ();
+      devices.Add (simple.Install (NodeContainer (router, peer)).Get (0));
+    }
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < N_INTERFACES; i++)
+    {
+      address.Assign (NetDeviceContainer (devices.Get (i)));
+      address.NewNetwork ();
+    }
+  Ptr<Ipv4> ipv4 = router->GetObject<Ipv4> ();
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < std::min (n, 100000u); i++)
+    {
+      Ipv4Header header;
+      header.SetDestination (GetDestination (rand->GetInteger (0, nRoutes - 1)));
+      g_bench.headers.push_back (header);
+    }
+  g_bench.n = n;
+
+  std::cout << "Running bench-ipv4-routing with n=" << n << " routes=" << nRoutes << std::endl;
+  for (uint32_t host = 0; host < 2; host++)
+    {
+      // The destinations are in the /24 network routes, or match the host
+      // routes to the first address of these networks.
+      Ptr<Ipv4GlobalRouting> global = CreateObject<Ipv4GlobalRouting> ();
+      global->SetIpv4 (ipv4);
+      Ptr<Ipv4StaticRouting> staticRouting = CreateObject<Ipv4StaticRouting> ();
+      staticRouting->SetIpv4 (ipv4);
+      for (uint32_t i = 0; i < nRoutes; i++)
+        {
+          Ipv4Address dest = GetDestination (i);
+          Ipv4Mask mask (host ? "255.255.255.255" : "255.255.255.0");
+          uint32_t interface = 1 + i % N_INTERFACES;
+          Ipv4Address gateway (ipv4->GetAddress (interface, 0).GetLocal ().CombineMask ("255.255.255.252").Get () + 2);
+          if (host)
+            {
+              global->AddHostRouteTo (dest, gateway, interface);
+            }
+          else
+            {
+              global->AddNetworkRouteTo (dest.CombineMask (mask), mask, gateway, interface);
+            }
+          staticRouting->AddNetworkRouteTo (dest.CombineMask (mask), mask, gateway, interface);
+        }
+      g_bench.routing = global;
+      runBench (&benchLookup, minIterations, host ? "Ipv4GlobalRouting, host routes" : "Ipv4GlobalRouting, network routes");
+      g_bench.routing = staticRouting;
+      runBench (&benchLookup, minIterations, host ? "Ipv4StaticRouting, host routes" : "Ipv4StaticRouting, network routes");
+      global->Dispose ();
+      staticRouting->Dispose ();
+    }
+  g_bench.routing = 0;
+  Simulator::Destroy ();
+
+  return 0;
+}
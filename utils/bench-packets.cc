@@ -310,6 +310,32 @@ benchFragment (uint32_t n)
   }
 }
 
+static void
+benchForward (uint32_t n)
+{
+  BenchHeader<25> ipv4;
+  BenchHeader<8> udp;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (2000);
+    p->AddHeader (udp);
+    p->AddHeader (ipv4);
+    // At every hop the IP header is removed and added back, while the
+    // queue disc classifier and the flow monitor peek at both headers
+    for (uint32_t hop = 0; hop < 4; hop++) {
+      Ptr<Packet> o = p->Copy ();
+      o->RemoveHeader (ipv4);
+      o->PeekHeader (udp);
+      o->AddHeader (ipv4);
+      o->PeekHeader (ipv4);
+      o->PeekHeader (ipv4);
+      p = o;
+    }
+    p->RemoveHeader (ipv4);
+    p->RemoveHeader (udp);
+  }
+}
+
 static void
 benchByteTags (uint32_t n)
 {
@@ -362,12 +388,14 @@ int main (int argc, char *argv[])
   uint32_t n = 0;
   uint32_t minIterations = 1;
   bool enablePrinting = false;
+  bool enableHeaderCache = false;
 
   CommandLine cmd (__FILE__);
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("enable-header-cache", "enable the packet header cache", enableHeaderCache);
   cmd.Parse (argc, argv);
 
   if (n == 0)
@@ -376,6 +404,10 @@ int main (int argc, char *argv[])
         "by command-line argument --n=(number of packets)" << std::endl;
       exit (1);
     }
+  if (enableHeaderCache)
+    {
+      Packet::EnableHeaderCache ();
+    }
   std::cout << "Running bench-packets with n=" << n << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
@@ -384,6 +416,7 @@ int main (int argc, char *argv[])
   runBench (&benchC, n, minIterations, "Remove by func call");
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
+  runBench (&benchForward, n, minIterations, "Forward over four hops, peeking at headers");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
 
   return 0;
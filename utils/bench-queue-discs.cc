@@ -0,0 +1,436 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the enqueue and dequeue operations of the queue
+// discs. Each queue disc holds a backlog of 'backlog' packets of 'flows'
+// flows, which a link of rate 'rate' drains: every packet dequeued is
+// enqueued again, and the packets dropped are replaced by new packets of
+// the same flows. An operation is a dequeue followed by an enqueue, and
+// includes the simulator event that schedules it. For each queue disc, the
+// program reports the wall clock time and the heap allocations per
+// operation, and the heap memory held by the queue disc per queued packet,
+// on top of the packets themselves. With --csv, it prints the results as
+// comma separated values, one line per queue disc, preceded by a header
+// line.
+// Sample usage:  ./waf --run 'bench-queue-discs --queue-discs=Fifo,FqCoDel --csv'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <stdlib.h> // for exit ()
+#include <stdint.h>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Calls to operator new
+static uint64_t g_allocations = 0;
+
+/// Bytes currently allocated with operator new
+static uint64_t g_allocated = 0;
+
+/// Room kept before each allocation for its size
+static const size_t ALLOC_HEADER = alignof (std::max_align_t);
+
+void *
+operator new (size_t size)
+{
+  void *p = std::malloc (size + ALLOC_HEADER);
+  if (p == nullptr)
+    {
+      throw std::bad_alloc ();
+    }
+  *static_cast<size_t *> (p) = size;
+  g_allocations++;
+  g_allocated += size;
+  return static_cast<char *> (p) + ALLOC_HEADER;
+}
+
+void *
+operator new[] (size_t size)
+{
+  return operator new (size);
+}
+
+void
+operator delete (void *p) noexcept
+{
+  if (p == nullptr)
+    {
+      return;
+    }
+  char *block = static_cast<char *> (p) - ALLOC_HEADER;
+  g_allocated -= *reinterpret_cast<size_t *> (block);
+  std::free (block);
+}
+
+void
+operator delete[] (void *p) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete (void *p, size_t) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete[] (void *p, size_t) noexcept
+{
+  operator delete (p);
+}
+
+/// The queue discs benchmarked by default
+static const char *g_queueDiscs[] = { "Fifo", "PfifoFast", "Prio", "Red", "ARed", "Pie", "CoDel",
+                                      "FqCoDel", "Cobalt", "Tbf", "Mq" };
+
+/// Transmission queues of the device of the mq queue disc
+static const uint32_t MQ_TX_QUEUES = 4;
+
+/// Benchmark state
+struct BenchState
+{
+  /// The queue discs served: the root queue disc, or the children of mq
+  std::vector<Ptr<QueueDisc> > served;
+  std::vector<uint32_t> nextFlow;   //!< next flow of the packets created for each queue disc served
+  uint32_t flows;                   //!< number of flows
+  uint32_t packetSize;              //!< size of the IP packets
+  uint32_t backlog;                 //!< packets queued in each queue disc served
+  Time txTime;                      //!< transmission time of a packet
+  uint64_t ops;                     //!< operations done
+  uint64_t stopAt;                  //!< operations done when the simulation stops
+};
+
+static BenchState g_bench; //!< the benchmark state
+
+/**
+ * Create a packet of a flow. The flows differ by their destination address,
+ * their TOS and their socket priority, so that they are classified into
+ * different flows or bands by the queue discs.
+ * \param flow the flow
+ * \return the queue disc item of the packet
+ */
+static Ptr<QueueDiscItem>
+newItem (uint32_t flow)
+{
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.0.0.1"));
+  header.SetDestination (Ipv4Address (0x0b000000 + flow));
+  header.SetProtocol (17);
+  header.SetTos ((flow % 8) << 2);
+  header.SetPayloadSize (g_bench.packetSize - 20);
+  Ptr<Packet> p = Create<Packet> (g_bench.packetSize - 20);
+  SocketPriorityTag priorityTag;
+  priorityTag.SetPriority (flow % 16);
+  p->AddPacketTag (priorityTag);
+  return Create<Ipv4QueueDiscItem> (p, Address (), 0, header);
+}
+
+/**
+ * Create a packet of the next flow of a queue disc served.
+ * \param i the index of the queue disc served
+ * \return the queue disc item of the packet
+ */
+static Ptr<QueueDiscItem>
+newItemFor (uint32_t i)
+{
+  uint32_t flow = g_bench.nextFlow[i];
+  g_bench.nextFlow[i] += g_bench.served.size ();
+  if (g_bench.nextFlow[i] >= g_bench.flows)
+    {
+      g_bench.nextFlow[i] = i;
+    }
+  return newItem (flow);
+}
+
+/**
+ * Dequeue a packet from a queue disc served and enqueue it again, add a
+ * new packet to the queue disc if it dropped some, and schedule the next
+ * operation.
+ */
+static void
+operation (void)
+{
+  uint32_t i = g_bench.ops % g_bench.served.size ();
+  const Ptr<QueueDisc> &qd = g_bench.served[i];
+  Ptr<QueueDiscItem> item = qd->Dequeue ();
+  if (item == 0)
+    {
+      item = newItemFor (i);
+    }
+  qd->Enqueue (item);
+  // a packet at most, as the queue disc may drop all the packets for a while
+  if (qd->GetNPackets () < g_bench.backlog)
+    {
+      qd->Enqueue (newItemFor (i));
+    }
+  if (++g_bench.ops == g_bench.stopAt)
+    {
+      Simulator::Stop ();
+    }
+  Simulator::Schedule (g_bench.txTime, &operation);
+}
+
+/**
+ * Create a queue disc of the given kind, sized to hold the given backlog
+ * \param name the kind of queue disc
+ * \param backlog the packets queued
+ * \param rate the rate of the link draining the queue disc
+ * \return the root queue disc, or 0 if the kind is unknown
+ */
+static Ptr<QueueDisc>
+createQueueDisc (std::string name, uint32_t backlog, DataRate rate)
+{
+  ObjectFactory factory;
+  QueueSizeValue maxSize (QueueSize (QueueSizeUnit::PACKETS, 2 * backlog));
+
+  if (name == "Fifo" || name == "PfifoFast" || name == "Pie" || name == "CoDel"
+      || name == "Cobalt")
+    {
+      factory.SetTypeId ("ns3::" + name + "QueueDisc");
+      factory.Set ("MaxSize", maxSize);
+    }
+  else if (name == "FqCoDel")
+    {
+      // the quantum is the MTU of the device, if any
+      Ptr<FqCoDelQueueDisc> fqCoDel = CreateObject<FqCoDelQueueDisc> ();
+      fqCoDel->SetMaxSize (maxSize.Get ());
+      fqCoDel->SetQuantum (g_bench.packetSize);
+      return fqCoDel;
+    }
+  else if (name == "Prio")
+    {
+      // a band for each band of the default priomap
+      Ptr<QueueDisc> prio = CreateObject<PrioQueueDisc> ();
+      factory.SetTypeId ("ns3::FifoQueueDisc");
+      factory.Set ("MaxSize", maxSize);
+      for (uint32_t i = 0; i < 3; i++)
+        {
+          Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass> ();
+          c->SetQueueDisc (factory.Create<QueueDisc> ());
+          prio->AddQueueDiscClass (c);
+        }
+      return prio;
+    }
+  else if (name == "Red" || name == "ARed")
+    {
+      // the average queue size settles between the thresholds
+      factory.SetTypeId ("ns3::RedQueueDisc");
+      factory.Set ("MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, 4 * backlog)));
+      factory.Set ("MinTh", DoubleValue (backlog));
+      factory.Set ("MaxTh", DoubleValue (2 * backlog));
+      factory.Set ("LinkBandwidth", DataRateValue (rate));
+      factory.Set ("ARED", BooleanValue (name == "ARed"));
+    }
+  else if (name == "Tbf")
+    {
+      // the tokens never run out
+      factory.SetTypeId ("ns3::TbfQueueDisc");
+      factory.Set ("MaxSize", maxSize);
+      factory.Set ("Rate", DataRateValue (DataRate (2 * rate.GetBitRate ())));
+    }
+  else if (name == "Mq")
+    {
+      Ptr<QueueDisc> mq = CreateObject<MqQueueDisc> ();
+      for (uint32_t i = 0; i < MQ_TX_QUEUES; i++)
+        {
+          Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass> ();
+          c->SetQueueDisc (createQueueDisc ("FqCoDel", backlog, rate));
+          mq->AddQueueDiscClass (c);
+        }
+      return mq;
+    }
+  else
+    {
+      return 0;
+    }
+  return factory.Create<QueueDisc> ();
+}
+
+/**
+ * Benchmark a queue disc and print the results
+ * \param name the kind of queue disc
+ * \param backlog the packets queued
+ * \param packets the operations measured
+ * \param rate the rate of the link draining the queue disc
+ * \param csv whether to print comma separated values
+ * \return false if the kind of queue disc is unknown
+ */
+static bool
+bench (std::string name, uint32_t backlog, uint64_t packets, DataRate rate, bool csv)
+{
+  Ptr<QueueDisc> root = createQueueDisc (name, backlog, rate);
+  if (root == 0)
+    {
+      return false;
+    }
+  root->Initialize ();
+
+  g_bench.served.clear ();
+  if (root->GetWakeMode () == QueueDisc::WAKE_CHILD)
+    {
+      // the traffic control layer enqueues the packets in the child queue discs
+      for (std::size_t i = 0; i < root->GetNQueueDiscClasses (); i++)
+        {
+          g_bench.served.push_back (root->GetQueueDiscClass (i)->GetQueueDisc ());
+        }
+    }
+  else
+    {
+      g_bench.served.push_back (root);
+    }
+  uint32_t nServed = g_bench.served.size ();
+  g_bench.backlog = std::max (backlog / nServed, static_cast<uint32_t> (1));
+  g_bench.nextFlow.clear ();
+  for (uint32_t i = 0; i < nServed; i++)
+    {
+      g_bench.nextFlow.push_back (i);
+    }
+  g_bench.ops = 0;
+
+  // The memory held by the queue disc per queued packet
+  std::vector<std::vector<Ptr<QueueDiscItem> > > items (nServed);
+  for (uint32_t i = 0; i < nServed; i++)
+    {
+      for (uint32_t b = 0; b < g_bench.backlog; b++)
+        {
+          items[i].push_back (newItemFor (i));
+        }
+    }
+  uint64_t allocated = g_allocated;
+  uint32_t queued = 0;
+  for (uint32_t i = 0; i < nServed; i++)
+    {
+      for (auto &item : items[i])
+        {
+          g_bench.served[i]->Enqueue (item);
+        }
+      queued += g_bench.served[i]->GetNPackets ();
+    }
+  double perPacket = static_cast<double> (g_allocated - allocated) / std::max (queued, static_cast<uint32_t> (1));
+  items.clear ();
+
+  // The operations done before measuring, to reach the steady state
+  uint64_t warmup = 2 * nServed * g_bench.backlog;
+  g_bench.stopAt = warmup;
+  Simulator::Schedule (Seconds (0), &operation);
+  Simulator::Run ();
+
+  g_bench.stopAt = warmup + packets;
+  uint64_t allocations = g_allocations;
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  uint64_t elapsed = std::max (static_cast<uint64_t> (time.End ()), static_cast<uint64_t> (1));
+  allocations = g_allocations - allocations;
+
+  double nsPerOp = static_cast<double> (elapsed) * 1000000 / packets;
+  double allocationsPerOp = static_cast<double> (allocations) / packets;
+  if (csv)
+    {
+      std::cout << name << "," << nsPerOp << "," << allocationsPerOp << "," << perPacket
+                << "," << packets << "," << backlog << "," << g_bench.flows
+                << "," << g_bench.packetSize << std::endl;
+    }
+  else
+    {
+      std::cout << nsPerOp << " ns/op\t"
+                << allocationsPerOp << " allocations/op\t"
+                << perPacket << " bytes/queued packet"
+                << " (" << packets << " ops, " << elapsed << " ms elapsed)\t"
+                << name
+                << std::endl;
+    }
+
+  root->Dispose ();
+  g_bench.served.clear ();
+  Simulator::Destroy ();
+  return true;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string queueDiscs;
+  uint32_t flows = 16;
+  uint32_t backlog = 64;
+  uint32_t packetSize = 1500;
+  uint64_t packets = 200000;
+  DataRate rate ("10Gbps");
+  bool csv = false;
+
+  for (auto name : g_queueDiscs)
+    {
+      queueDiscs.append (queueDiscs.empty () ? "" : ",").append (name);
+    }
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the enqueue and dequeue operations of the queue discs");
+  cmd.AddValue ("queue-discs", "comma separated list of the queue discs benchmarked", queueDiscs);
+  cmd.AddValue ("flows", "number of flows", flows);
+  cmd.AddValue ("backlog", "packets queued in the queue disc", backlog);
+  cmd.AddValue ("packet-size", "size of the IP packets", packetSize);
+  cmd.AddValue ("packets", "number of operations measured", packets);
+  cmd.AddValue ("rate", "link rate", rate);
+  cmd.AddValue ("csv", "print comma separated values", csv);
+  cmd.Parse (argc, argv);
+
+  if (flows < MQ_TX_QUEUES || backlog < MQ_TX_QUEUES || packets == 0
+      || packetSize < 20 || packetSize > 65535)
+    {
+      std::cerr << "Error-- the flows and the backlog must be at least " << MQ_TX_QUEUES
+                << ", the packets must be positive, and the packet size must be in [20, 65535]"
+                << std::endl;
+      exit (1);
+    }
+
+  g_bench.flows = flows;
+  g_bench.packetSize = packetSize;
+  g_bench.txTime = rate.CalculateBytesTxTime (packetSize);
+
+  if (csv)
+    {
+      std::cout << "queue-disc,ns/op,allocations/op,bytes/queued-packet,ops,backlog,flows,packet-size"
+                << std::endl;
+    }
+  else
+    {
+      std::cout << "Running bench-queue-discs with flows=" << flows << " backlog=" << backlog
+                << " packet-size=" << packetSize << " packets=" << packets
+                << " rate=" << rate << std::endl;
+    }
+
+  std::istringstream names (queueDiscs);
+  std::string name;
+  while (std::getline (names, name, ','))
+    {
+      if (!bench (name, backlog, packets, rate, csv))
+        {
+          std::cerr << "Error-- unknown queue disc " << name << std::endl;
+          exit (1);
+        }
+    }
+  return 0;
+}
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program reports the memory used per TCP socket: the heap allocated
+// by the C++ operator new while creating 'sockets' sockets, and while
+// establishing as many connections between two nodes, divided by their
+// number.
+// Sample usage:  ./waf --run 'bench-tcp-socket-memory --sockets=10000'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include <iostream>
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <stdint.h>
+
+using namespace ns3;
+
+/// Bytes currently allocated with operator new
+static uint64_t g_allocated = 0;
+
+/// Room kept before each allocation for its size
+static const size_t ALLOC_HEADER = alignof (std::max_align_t);
+
+void *
+operator new (size_t size)
+{
+  void *p = std::malloc (size + ALLOC_HEADER);
+  if (p == nullptr)
+    {
+      throw std::bad_alloc ();
+    }
+  *static_cast<size_t *> (p) = size;
+  g_allocated += size;
+  return static_cast<char *> (p) + ALLOC_HEADER;
+}
+
+void *
+operator new[] (size_t size)
+{
+  return operator new (size);
+}
+
+void
+operator delete (void *p) noexcept
+{
+  if (p == nullptr)
+    {
+      return;
+    }
+  char *block = static_cast<char *> (p) - ALLOC_HEADER;
+  g_allocated -= *reinterpret_cast<size_t *> (block);
+  std::free (block);
+}
+
+void
+operator delete[] (void *p) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete (void *p, size_t) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete[] (void *p, size_t) noexcept
+{
+  operator delete (p);
+}
+
+/**
+ * Print the memory used per socket.
+ * \param name the measure name
+ * \param before the bytes allocated before creating the sockets
+ * \param sockets the number of sockets
+ */
+static void
+report (char const *name, uint64_t before, uint32_t sockets)
+{
+  double perSocket = static_cast<double> (g_allocated - before) / sockets;
+  std::cout << perSocket << " bytes/socket"
+            << " (" << sockets << " sockets)\t"
+            << name
+            << std::endl;
+}
+
+/// The sockets created on a node
+static std::vector<Ptr<Socket> > g_created;
+
+/**
+ * Create sockets on a node.
+ * \param node the node
+ * \param sockets the number of sockets
+ */
+static void
+createSockets (Ptr<Node> node, uint32_t sockets)
+{
+  g_created.reserve (sockets);
+  uint64_t before = g_allocated;
+  for (uint32_t i = 0; i < sockets; i++)
+    {
+      g_created.push_back (Socket::CreateSocket (node, TcpSocketFactory::GetTypeId ()));
+    }
+  report ("TcpSocketBase created", before, sockets);
+}
+
+/**
+ * Create sockets on a node, without connecting them.
+ *
+ * The sockets are created while the simulation runs: before, every Time
+ * constructed is recorded in case the time resolution changes.
+ * \param sockets the number of sockets
+ */
+static void
+benchCreate (uint32_t sockets)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Simulator::Schedule (Seconds (0), &createSockets, nodes.Get (0), sockets);
+  Simulator::Run ();
+  g_created.clear ();
+  Simulator::Destroy ();
+}
+
+/// The sockets accepted by the server
+static std::vector<Ptr<Socket> > g_accepted;
+
+/**
+ * Keep a socket accepted by the server.
+ * \param socket the socket
+ * \param from the address of the client
+ */
+static void
+accept (Ptr<Socket> socket, const Address &from)
+{
+  g_accepted.push_back (socket);
+}
+
+/**
+ * Establish connections between two nodes, the client and the server
+ * sockets of each connection being counted as two sockets.
+ * \param connections the number of connections
+ */
+static void
+benchConnect (uint32_t connections)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simpleHelper;
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  sink->Listen ();
+  sink->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                           MakeCallback (&accept));
+  // Resolve the addresses before measuring
+  Ptr<Socket> first = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  first->Connect (InetSocketAddress (interfaces.GetAddress (1), 5000));
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  std::vector<Ptr<Socket> > clients;
+  clients.reserve (connections);
+  g_accepted.reserve (connections + 1);
+  uint64_t before = g_allocated;
+  for (uint32_t i = 0; i < connections; i++)
+    {
+      Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+      client->Connect (InetSocketAddress (interfaces.GetAddress (1), 5000));
+      clients.push_back (client);
+    }
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  if (g_accepted.size () != connections + 1)
+    {
+      std::cerr << "Error-- " << g_accepted.size () - 1 << " connections established out of "
+                << connections << std::endl;
+    }
+  report ("TcpSocketBase established", before, 2 * connections);
+  clients.clear ();
+  g_accepted.clear ();
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t sockets = 10000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the memory used per TCP socket");
+  cmd.AddValue ("sockets", "number of sockets, and of connections", sockets);
+  cmd.Parse (argc, argv);
+
+  if (sockets == 0 || sockets > 60000)
+    {
+      std::cerr << "Error-- the number of sockets must be in [1, 60000]" << std::endl;
+      exit (1);
+    }
+
+  std::cout << "Running bench-tcp-socket-memory with sockets=" << sockets << std::endl;
+  benchCreate (sockets);
+  benchConnect (sockets);
+
+  return 0;
+}
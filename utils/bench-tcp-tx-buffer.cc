@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the scoreboard of TcpTxBuffer for
+// a high bandwidth-delay product: a window of 'segments' segments is sent,
+// a fraction 'loss' of them is lost, and the ACKs of the other ones, with
+// their SACK blocks, are processed as TcpSocketBase does during a recovery.
+// Sample usage:  ./waf --run 'bench-tcp-tx-buffer --segments=20000 --loss=0.01'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include <iostream>
+#include <vector>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Benchmark parameters
+struct BenchParameters
+{
+  uint32_t segments;          //!< number of segments in the window
+  uint32_t segmentSize;       //!< segment size
+  std::vector<bool> lost;     //!< whether each segment of the window is lost
+  uint64_t acks;              //!< number of ACKs processed
+};
+
+static BenchParameters g_bench; //!< the benchmark parameters
+
+/**
+ * Send a window, then process the ACKs of the segments which are not lost,
+ * retransmitting the lost segments, and finally the ACK of the whole window.
+ */
+static void
+benchRecovery (void)
+{
+  uint32_t segmentSize = g_bench.segmentSize;
+  SequenceNumber32 head (1);
+  Ptr<TcpTxBuffer> txBuffer = CreateObject<TcpTxBuffer> ();
+  txBuffer->SetHeadSequence (head);
+  txBuffer->SetMaxBufferSize (g_bench.segments * segmentSize);
+  txBuffer->SetDupAckThresh (3);
+  txBuffer->SetSegmentSize (segmentSize);
+  for (uint32_t i = 0; i < g_bench.segments; i++)
+    {
+      txBuffer->Add (Create<Packet> (segmentSize));
+    }
+  for (uint32_t i = 0; i < g_bench.segments; i++)
+    {
+      txBuffer->CopyFromSequence (segmentSize, head + i * segmentSize);
+    }
+
+  // The receiver reports the runs of segments received after a hole, the
+  // most recent first.
+  std::vector<TcpOptionSack::SackBlock> runs;
+  SequenceNumber32 ack = head;
+  for (uint32_t i = 0; i < g_bench.segments; i++)
+    {
+      SequenceNumber32 start = head + i * segmentSize;
+      if (g_bench.lost[i])
+        {
+          continue;
+        }
+      if (ack == start)
+        {
+          ack = start + segmentSize;
+          txBuffer->DiscardUpTo (ack);
+        }
+      else
+        {
+          if (runs.empty () || runs.back ().second != start)
+            {
+              runs.push_back (TcpOptionSack::SackBlock (start, start));
+            }
+          runs.back ().second = start + segmentSize;
+          TcpOptionSack::SackList sackList;
+          for (uint32_t j = 0; j < 3 && j < runs.size (); j++)
+            {
+              sackList.push_back (runs[runs.size () - 1 - j]);
+            }
+          txBuffer->Update (sackList);
+        }
+      g_bench.acks++;
+
+      // Retransmit what the scoreboard considers lost, as the pipe allows.
+      SequenceNumber32 next;
+      if (txBuffer->BytesInFlight () < g_bench.segments * segmentSize
+          && txBuffer->NextSeg (&next, true) && txBuffer->IsLost (next))
+        {
+          txBuffer->CopyFromSequence (segmentSize, next);
+        }
+    }
+  txBuffer->DiscardUpTo (head + g_bench.segments * segmentSize);
+  g_bench.acks++;
+}
+
+/**
+ * Run a benchmark several times and print its best ACK rate.
+ * \param bench the benchmark
+ * \param minIterations the number of runs
+ * \param name the benchmark name
+ */
+static void
+runBench (void (*bench) (void), uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint64_t acks = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      g_bench.acks = 0;
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) ();
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+      acks = g_bench.acks;
+    }
+  minDelay = std::max (minDelay, static_cast<uint64_t> (1));
+  double aps = static_cast<double> (acks) * 1000 / minDelay;
+  std::cout << aps << " acks/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t segments = 10000;
+  uint32_t segmentSize = 1448;
+  double loss = 0.01;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the SACK scoreboard of TcpTxBuffer");
+  cmd.AddValue ("segments", "number of segments in flight", segments);
+  cmd.AddValue ("segment-size", "segment size", segmentSize);
+  cmd.AddValue ("loss", "fraction of the segments which are lost", loss);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (segments == 0 || segmentSize == 0 || loss < 0 || loss >= 1
+      || static_cast<uint64_t> (segments) * segmentSize > 0x7fffffff)
+    {
+      std::cerr << "Error-- the number of segments and the segment size must be positive, " <<
+        "the window must fit in the sequence space, and the loss must be in [0, 1)" << std::endl;
+      exit (1);
+    }
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  g_bench.segments = segments;
+  g_bench.segmentSize = segmentSize;
+  for (uint32_t i = 0; i < segments; i++)
+    {
+      g_bench.lost.push_back (rand->GetValue () < loss);
+    }
+
+  std::cout << "Running bench-tcp-tx-buffer with segments=" << segments
+            << " segment-size=" << segmentSize << " loss=" << loss << std::endl;
+  runBench (&benchRecovery, minIterations, "TcpTxBuffer SACK recovery");
+
+  return 0;
+}
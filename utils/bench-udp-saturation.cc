@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the heap allocation rate and the
+// speed of a UdpClient saturating a point-to-point link, with and without
+// the packet pool of the application (see the UdpClient::PacketPoolSize
+// attribute).  The heap allocations counted are those going through the
+// global operator new, which all the packet data structures use.
+// Sample usage:  ./waf --run 'bench-udp-saturation --n=100000'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include <iostream>
+#include <new>
+#include <stdlib.h> // for exit (), malloc () and free ()
+
+using namespace ns3;
+
+/// Number of calls to the global operator new
+static uint64_t g_nAllocations = 0;
+
+void *
+operator new (std::size_t size)
+{
+  g_nAllocations++;
+  void *p = malloc (size > 0 ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  free (p);
+}
+
+void
+operator delete (void *p, std::size_t) noexcept
+{
+  free (p);
+}
+
+/**
+ * Send 'n' packets of 'size' bytes from a UdpClient to a UdpServer, as
+ * fast as the link allows, and print the allocations and time it took.
+ * \param n the number of packets
+ * \param size the packet size
+ * \param poolSize the size of the packet pool of the UdpClient
+ */
+static void
+runBench (uint32_t n, uint32_t size, uint32_t poolSize)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1us"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  UdpServerHelper server (9);
+  server.Install (nodes.Get (1));
+
+  // One packet every serialization time of the link
+  UdpClientHelper client (interfaces.GetAddress (1), 9);
+  client.SetAttribute ("MaxPackets", UintegerValue (n));
+  client.SetAttribute ("PacketSize", UintegerValue (size));
+  client.SetAttribute ("Interval", TimeValue (NanoSeconds ((size + 30) * 8 / 10)));
+  client.SetAttribute ("PacketPoolSize", UintegerValue (poolSize));
+  client.Install (nodes.Get (0));
+
+  uint64_t nAllocations = g_nAllocations;
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  uint64_t delay = time.End ();
+  nAllocations = g_nAllocations - nAllocations;
+  Simulator::Destroy ();
+
+  std::cout << static_cast<double> (nAllocations) / n << " allocations/packet, "
+            << (delay > 0 ? static_cast<double> (n) * 1000 / delay : 0) << " packets/s"
+            << " (" << delay << " ms elapsed)\t"
+            << (poolSize > 0 ? "with" : "without") << " packet pool"
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t size = 1024;
+  uint32_t poolSize = 256;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the heap allocations of a UdpClient saturating a link, "
+             "with and without a packet pool");
+  cmd.AddValue ("n", "number of packets", n);
+  cmd.AddValue ("size", "packet size (bytes)", size);
+  cmd.AddValue ("pool-size", "size of the packet pool", poolSize);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || size < 12 || poolSize == 0)
+    {
+      std::cerr << "Error-- number of packets must be specified " <<
+        "by command-line argument --n=(number of packets), " <<
+        "the size must be at least 12 bytes and the pool size positive" << std::endl;
+      exit (1);
+    }
+
+  std::cout << "Running bench-udp-saturation with n=" << n << " size=" << size << std::endl;
+  runBench (n, size, 0);
+  runBench (n, size, poolSize);
+
+  return 0;
+}
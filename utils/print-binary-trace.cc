@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup utils
+ * Convert a binary trace file (see AsciiTraceHelper::SetBinaryTraceFile)
+ * back to the ascii trace files it replaces.
+ *
+ * All enabled modules are linked in so that the headers of every module
+ * can be printed.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <map>
+
+#include "ns3/command-line.h"
+#include "ns3/packet.h"
+#include "ns3/binary-trace-file.h"
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string outputDir;
+  bool toStdout = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Convert a binary trace file back to ascii traces, "
+             "one file per ascii trace source.");
+  cmd.AddValue ("input", "the binary trace file", input);
+  cmd.AddValue ("output-dir", "directory the ascii trace files are written to", outputDir);
+  cmd.AddValue ("stdout", "print all the traces, in time order, to the standard output", toStdout);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "Missing --input" << std::endl;
+      return 1;
+    }
+
+  Packet::EnablePrinting ();
+
+  BinaryTraceReader reader;
+  if (!reader.Open (input))
+    {
+      std::cerr << "Unable to open " << input << std::endl;
+      return 1;
+    }
+
+  if (!outputDir.empty () && outputDir[outputDir.size () - 1] != '/')
+    {
+      outputDir += '/';
+    }
+
+  std::map<uint32_t, std::ofstream *> outputs;
+  BinaryTraceRecord record;
+  while (reader.Read (record))
+    {
+      if (toStdout)
+        {
+          reader.PrintAscii (record, std::cout);
+          continue;
+        }
+      std::map<uint32_t, std::ofstream *>::iterator i = outputs.find (record.source);
+      if (i == outputs.end ())
+        {
+          std::string filename = outputDir + reader.GetSourceName (record.source);
+          std::ofstream *os = new std::ofstream (filename.c_str ());
+          if (!os->is_open ())
+            {
+              std::cerr << "Unable to open " << filename << std::endl;
+              delete os;
+              return 1;
+            }
+          i = outputs.insert (std::make_pair (record.source, os)).first;
+        }
+      reader.PrintAscii (record, *i->second);
+    }
+
+  for (std::map<uint32_t, std::ofstream *>::iterator i = outputs.begin (); i != outputs.end (); ++i)
+    {
+      delete i->second;
+    }
+
+  if (reader.Fail ())
+    {
+      std::cerr << input << ": malformed binary trace file" << std::endl;
+      return 1;
+    }
+  return 0;
+}